@@ -0,0 +1,1407 @@
+/*
+  AnalyticEphemeris.cpp
+  Copyright (C) 2011 David M. Anderson
+
+  AnalyticEphemeris class: positions of the Sun, Earth, and Moon, and the
+  nutation, computed from truncated analytic series, needing no ephemeris
+  file.
+  AnalyticBarycentricEphemeris and AnalyticGeocentricEphemeris classes:
+  function objects, like JPLBarycentricEphemeris and JPLGeocentricEphemeris,
+  for use with ApparentEphemeris and the like.
+*/
+
+
+#include "AnalyticEphemeris.hpp"
+#include "AstroCoordTransformations.hpp"
+#include "Precession.hpp"
+#include "Obliquity.hpp"
+#include "AstroConst.hpp"
+#include "Epoch.hpp"
+#include "Array.hpp"
+#include "Exception.hpp"
+#include "Assert.hpp"
+#include <cmath>
+#include <cstdlib>
+#ifdef DEBUG
+#include "TestCheck.hpp"
+#include "Spherical.hpp"
+#include <iostream>
+#endif
+using namespace std;
+using namespace std::tr1;
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+namespace
+{                                                      //namespace
+
+//VSOP87D, abridged: Meeus, Appendix III. Units of 1.e-8 radian or AU, with
+// t in Julian millennia from J2000.
+
+struct VSOPTerm
+{
+    double m_a;
+    double m_b;
+    double m_c;
+};
+
+const VSOPTerm s_earthL0[] =
+{
+    { 175347046., 0., 0. },
+    { 3341656., 4.6692568, 6283.0758500 },
+    { 34894., 4.62610, 12566.15170 },
+    { 3497., 2.7441, 5753.3849 },
+    { 3418., 2.8289, 3.5231 },
+    { 3136., 3.6277, 77713.7715 },
+    { 2676., 4.4181, 7860.4194 },
+    { 2343., 6.1352, 3930.2097 },
+    { 1324., 0.7425, 11506.7698 },
+    { 1273., 2.0371, 529.6910 },
+    { 1199., 1.1096, 1577.3435 },
+    { 990., 5.233, 5884.927 },
+    { 902., 2.045, 26.298 },
+    { 857., 3.508, 398.149 },
+    { 780., 1.179, 5223.694 },
+    { 753., 2.533, 5507.553 },
+    { 505., 4.583, 18849.228 },
+    { 492., 4.205, 775.523 },
+    { 357., 2.920, 0.067 },
+    { 317., 5.849, 11790.629 },
+    { 284., 1.899, 796.298 },
+    { 271., 0.315, 10977.079 },
+    { 243., 0.345, 5486.778 },
+    { 206., 4.806, 2544.314 },
+    { 205., 1.869, 5573.143 },
+    { 202., 2.458, 6069.777 },
+    { 156., 0.833, 213.299 },
+    { 132., 3.411, 2942.463 },
+    { 126., 1.083, 20.775 },
+    { 115., 0.645, 0.980 },
+    { 103., 0.636, 4694.003 },
+    { 102., 0.976, 15720.839 },
+    { 102., 4.267, 7.114 },
+    { 99., 6.21, 2146.17 },
+    { 98., 0.68, 155.42 },
+    { 86., 5.98, 161000.69 },
+    { 85., 1.30, 6275.96 },
+    { 85., 3.67, 71430.70 },
+    { 80., 1.81, 17260.15 },
+    { 79., 3.04, 12036.46 },
+    { 75., 1.76, 5088.63 },
+    { 74., 3.50, 3154.69 },
+    { 74., 4.68, 801.82 },
+    { 70., 0.83, 9437.76 },
+    { 62., 3.98, 8827.39 },
+    { 61., 1.82, 7084.90 },
+    { 57., 2.78, 6286.60 },
+    { 56., 4.39, 14143.50 },
+    { 56., 3.47, 6279.55 },
+    { 52., 0.19, 12139.55 },
+    { 52., 1.33, 1748.02 },
+    { 51., 0.28, 5856.48 },
+    { 49., 0.49, 1194.45 },
+    { 41., 5.37, 8429.24 },
+    { 41., 2.40, 19651.05 },
+    { 39., 6.17, 10447.39 },
+    { 37., 6.04, 10213.29 },
+    { 37., 2.57, 1059.38 },
+    { 36., 1.71, 2352.87 },
+    { 36., 1.78, 6812.77 },
+    { 33., 0.59, 17789.85 },
+    { 30., 0.44, 83996.85 },
+    { 30., 2.74, 1349.87 },
+    { 25., 3.16, 4690.48 }
+};
+
+const VSOPTerm s_earthL1[] =
+{
+    { 628331966747., 0., 0. },
+    { 206059., 2.678235, 6283.075850 },
+    { 4303., 2.6351, 12566.1517 },
+    { 425., 1.590, 3.523 },
+    { 119., 5.796, 26.298 },
+    { 109., 2.966, 1577.344 },
+    { 93., 2.59, 18849.23 },
+    { 72., 1.14, 529.69 },
+    { 68., 1.87, 398.15 },
+    { 67., 4.41, 5507.55 },
+    { 59., 2.89, 5223.69 },
+    { 56., 2.17, 155.42 },
+    { 45., 0.40, 796.30 },
+    { 36., 0.47, 775.52 },
+    { 29., 2.65, 7.11 },
+    { 21., 5.34, 0.98 },
+    { 19., 1.85, 5486.78 },
+    { 19., 4.97, 213.30 },
+    { 17., 2.99, 6275.96 },
+    { 16., 0.03, 2544.31 },
+    { 16., 1.43, 2146.17 },
+    { 15., 1.21, 10977.08 },
+    { 12., 2.83, 1748.02 },
+    { 12., 3.26, 5088.63 },
+    { 12., 5.27, 1194.45 },
+    { 12., 2.08, 4694.00 },
+    { 11., 0.77, 553.57 },
+    { 10., 1.30, 6286.60 },
+    { 10., 4.24, 1349.87 },
+    { 9., 2.70, 242.73 },
+    { 9., 5.64, 951.72 },
+    { 8., 5.30, 2352.87 },
+    { 6., 2.65, 9437.76 },
+    { 6., 4.67, 4690.48 }
+};
+
+const VSOPTerm s_earthL2[] =
+{
+    { 52919., 0., 0. },
+    { 8720., 1.0721, 6283.0758 },
+    { 309., 0.867, 12566.152 },
+    { 27., 0.05, 3.52 },
+    { 16., 5.19, 26.30 },
+    { 16., 3.68, 155.42 },
+    { 10., 0.76, 18849.23 },
+    { 9., 2.06, 77713.77 },
+    { 7., 0.83, 775.52 },
+    { 5., 4.66, 1577.34 },
+    { 4., 1.03, 7.11 },
+    { 4., 3.44, 5573.14 },
+    { 3., 5.14, 796.30 },
+    { 3., 6.05, 5507.55 },
+    { 3., 1.19, 242.73 },
+    { 3., 6.12, 529.69 },
+    { 3., 0.31, 398.15 },
+    { 3., 2.28, 553.57 },
+    { 2., 4.38, 5223.69 },
+    { 2., 3.75, 0.98 }
+};
+
+const VSOPTerm s_earthL3[] =
+{
+    { 289., 5.844, 6283.076 },
+    { 35., 0., 0. },
+    { 17., 5.49, 12566.15 },
+    { 3., 5.20, 155.42 },
+    { 1., 4.72, 3.52 },
+    { 1., 5.30, 18849.23 },
+    { 1., 5.97, 242.73 }
+};
+
+const VSOPTerm s_earthL4[] =
+{
+    { 114., 3.142, 0. },
+    { 8., 4.13, 6283.08 },
+    { 1., 3.84, 12566.15 }
+};
+
+const VSOPTerm s_earthL5[] =
+{
+    { 1., 3.14, 0. }
+};
+
+const VSOPTerm s_earthB0[] =
+{
+    { 280., 3.199, 84334.662 },
+    { 102., 5.422, 5507.553 },
+    { 80., 3.88, 5223.69 },
+    { 44., 3.70, 2352.87 },
+    { 32., 4.00, 1577.34 }
+};
+
+const VSOPTerm s_earthB1[] =
+{
+    { 9., 3.90, 5507.55 },
+    { 6., 1.73, 5223.69 }
+};
+
+const VSOPTerm s_earthR0[] =
+{
+    { 100013989., 0., 0. },
+    { 1670700., 3.0984635, 6283.0758500 },
+    { 13956., 3.05525, 12566.15170 },
+    { 3084., 5.1985, 77713.7715 },
+    { 1628., 1.1739, 5753.3849 },
+    { 1576., 2.8469, 7860.4194 },
+    { 925., 5.453, 11506.770 },
+    { 542., 4.564, 3930.210 },
+    { 472., 3.661, 5884.927 },
+    { 346., 0.964, 5507.553 },
+    { 329., 5.900, 5223.694 },
+    { 307., 0.299, 5573.143 },
+    { 243., 4.273, 11790.629 },
+    { 212., 5.847, 1577.344 },
+    { 186., 5.022, 10977.079 },
+    { 175., 3.012, 18849.228 },
+    { 110., 5.055, 5486.778 },
+    { 98., 0.89, 6069.78 },
+    { 86., 5.69, 15720.84 },
+    { 86., 1.27, 161000.69 },
+    { 65., 0.27, 17260.15 },
+    { 63., 0.92, 529.69 },
+    { 57., 2.01, 83996.85 },
+    { 56., 5.24, 71430.70 },
+    { 49., 3.25, 2544.31 },
+    { 47., 2.58, 775.52 },
+    { 45., 5.54, 9437.76 },
+    { 43., 6.01, 6275.96 },
+    { 39., 5.36, 4694.00 },
+    { 38., 2.39, 8827.39 },
+    { 37., 0.83, 19651.05 },
+    { 37., 4.90, 12139.55 },
+    { 36., 1.67, 12036.46 },
+    { 35., 1.84, 2942.46 },
+    { 33., 0.24, 7084.90 },
+    { 32., 0.18, 5088.63 },
+    { 32., 1.78, 398.15 },
+    { 28., 1.21, 6286.60 },
+    { 28., 1.90, 6279.55 },
+    { 26., 4.59, 10447.39 }
+};
+
+const VSOPTerm s_earthR1[] =
+{
+    { 103019., 1.107490, 6283.075850 },
+    { 1721., 1.0644, 12566.1517 },
+    { 702., 3.142, 0. },
+    { 32., 1.02, 18849.23 },
+    { 31., 2.84, 5507.55 },
+    { 25., 1.32, 5223.69 },
+    { 18., 1.42, 1577.34 },
+    { 10., 5.91, 10977.08 },
+    { 9., 1.42, 6275.96 },
+    { 9., 0.27, 5486.78 }
+};
+
+const VSOPTerm s_earthR2[] =
+{
+    { 4359., 5.7846, 6283.0758 },
+    { 124., 5.579, 12566.152 },
+    { 12., 3.14, 0. },
+    { 9., 3.63, 77713.77 },
+    { 6., 1.87, 5573.14 },
+    { 3., 5.47, 18849.23 }
+};
+
+const VSOPTerm s_earthR3[] =
+{
+    { 145., 4.273, 6283.076 },
+    { 7., 3.92, 12566.15 }
+};
+
+const VSOPTerm s_earthR4[] =
+{
+    { 4., 2.56, 6283.08 }
+};
+
+struct VSOPSeries
+{
+    const VSOPTerm * m_terms;
+    int m_numTerms;
+};
+
+#define VSOP_SERIES( terms )  { terms, ARRAY_LENGTH( terms ) }
+
+const VSOPSeries s_earthL[] =
+{
+    VSOP_SERIES( s_earthL0 ), VSOP_SERIES( s_earthL1 ),
+    VSOP_SERIES( s_earthL2 ), VSOP_SERIES( s_earthL3 ),
+    VSOP_SERIES( s_earthL4 ), VSOP_SERIES( s_earthL5 )
+};
+
+const VSOPSeries s_earthB[] =
+{
+    VSOP_SERIES( s_earthB0 ), VSOP_SERIES( s_earthB1 )
+};
+
+const VSOPSeries s_earthR[] =
+{
+    VSOP_SERIES( s_earthR0 ), VSOP_SERIES( s_earthR1 ),
+    VSOP_SERIES( s_earthR2 ), VSOP_SERIES( s_earthR3 ),
+    VSOP_SERIES( s_earthR4 )
+};
+
+#undef VSOP_SERIES
+
+//-----------------------------------------------------------------------------
+
+//ELP-2000/82, abridged: Meeus, tables 47.A and 47.B. Multiples of D, M, M',
+// and F, and amplitudes in 1.e-6 degree (longitude and latitude) and 1.e-3
+// km (distance).
+
+struct LunarTerm
+{
+    int m_d;
+    int m_m;
+    int m_mp;
+    int m_f;
+    double m_a0;
+    double m_a1;
+};
+
+const LunarTerm s_moonLR[] =
+{
+    { 0, 0, 1, 0, 6288774., -20905355. },
+    { 2, 0, -1, 0, 1274027., -3699111. },
+    { 2, 0, 0, 0, 658314., -2955968. },
+    { 0, 0, 2, 0, 213618., -569925. },
+    { 0, 1, 0, 0, -185116., 48888. },
+    { 0, 0, 0, 2, -114332., -3149. },
+    { 2, 0, -2, 0, 58793., 246158. },
+    { 2, -1, -1, 0, 57066., -152138. },
+    { 2, 0, 1, 0, 53322., -170733. },
+    { 2, -1, 0, 0, 45758., -204586. },
+    { 0, 1, -1, 0, -40923., -129620. },
+    { 1, 0, 0, 0, -34720., 108743. },
+    { 0, 1, 1, 0, -30383., 104755. },
+    { 2, 0, 0, -2, 15327., 10321. },
+    { 0, 0, 1, 2, -12528., 0. },
+    { 0, 0, 1, -2, 10980., 79661. },
+    { 4, 0, -1, 0, 10675., -34782. },
+    { 0, 0, 3, 0, 10034., -23210. },
+    { 4, 0, -2, 0, 8548., -21636. },
+    { 2, 1, -1, 0, -7888., 24208. },
+    { 2, 1, 0, 0, -6766., 30824. },
+    { 1, 0, -1, 0, -5163., -8379. },
+    { 1, 1, 0, 0, 4987., -16675. },
+    { 2, -1, 1, 0, 4036., -12831. },
+    { 2, 0, 2, 0, 3994., -10445. },
+    { 4, 0, 0, 0, 3861., -11650. },
+    { 2, 0, -3, 0, 3665., 14403. },
+    { 0, 1, -2, 0, -2689., -7003. },
+    { 2, 0, -1, 2, -2602., 0. },
+    { 2, -1, -2, 0, 2390., 10056. },
+    { 1, 0, 1, 0, -2348., 6322. },
+    { 2, -2, 0, 0, 2236., -9884. },
+    { 0, 1, 2, 0, -2120., 5751. },
+    { 0, 2, 0, 0, -2069., 0. },
+    { 2, -2, -1, 0, 2048., -4950. },
+    { 2, 0, 1, -2, -1773., 4130. },
+    { 2, 0, 0, 2, -1595., 0. },
+    { 4, -1, -1, 0, 1215., -3958. },
+    { 0, 0, 2, 2, -1110., 0. },
+    { 3, 0, -1, 0, -892., 3258. },
+    { 2, 1, 1, 0, -810., 2616. },
+    { 4, -1, -2, 0, 759., -1897. },
+    { 0, 2, -1, 0, -713., -2117. },
+    { 2, 2, -1, 0, -700., 2354. },
+    { 2, 1, -2, 0, 691., 0. },
+    { 2, -1, 0, -2, 596., 0. },
+    { 4, 0, 1, 0, 549., -1423. },
+    { 0, 0, 4, 0, 537., -1117. },
+    { 4, -1, 0, 0, 520., -1571. },
+    { 1, 0, -2, 0, -487., -1739. },
+    { 2, 1, 0, -2, -399., 0. },
+    { 0, 0, 2, -2, -381., -4421. },
+    { 1, 1, 1, 0, 351., 0. },
+    { 3, 0, -2, 0, -340., 0. },
+    { 4, 0, -3, 0, 330., 0. },
+    { 2, -1, 2, 0, 327., 0. },
+    { 0, 2, 1, 0, -323., 1165. },
+    { 1, 1, -1, 0, 299., 0. },
+    { 2, 0, 3, 0, 294., 0. },
+    { 2, 0, -1, -2, 0., 8752. }
+};
+
+const LunarTerm s_moonB[] =
+{
+    { 0, 0, 0, 1, 5128122., 0. },
+    { 0, 0, 1, 1, 280602., 0. },
+    { 0, 0, 1, -1, 277693., 0. },
+    { 2, 0, 0, -1, 173237., 0. },
+    { 2, 0, -1, 1, 55413., 0. },
+    { 2, 0, -1, -1, 46271., 0. },
+    { 2, 0, 0, 1, 32573., 0. },
+    { 0, 0, 2, 1, 17198., 0. },
+    { 2, 0, 1, -1, 9266., 0. },
+    { 0, 0, 2, -1, 8822., 0. },
+    { 2, -1, 0, -1, 8216., 0. },
+    { 2, 0, -2, -1, 4324., 0. },
+    { 2, 0, 1, 1, 4200., 0. },
+    { 2, 1, 0, -1, -3359., 0. },
+    { 2, -1, -1, 1, 2463., 0. },
+    { 2, -1, 0, 1, 2211., 0. },
+    { 2, -1, -1, -1, 2065., 0. },
+    { 0, 1, -1, -1, -1870., 0. },
+    { 4, 0, -1, -1, 1828., 0. },
+    { 0, 1, 0, 1, -1794., 0. },
+    { 0, 0, 0, 3, -1749., 0. },
+    { 0, 1, -1, 1, -1565., 0. },
+    { 1, 0, 0, 1, -1491., 0. },
+    { 0, 1, 1, 1, -1475., 0. },
+    { 0, 1, 1, -1, -1410., 0. },
+    { 0, 1, 0, -1, -1344., 0. },
+    { 1, 0, 0, -1, -1335., 0. },
+    { 0, 0, 3, 1, 1107., 0. },
+    { 4, 0, 0, -1, 1021., 0. },
+    { 4, 0, -1, 1, 833., 0. },
+    { 0, 0, 1, -3, 777., 0. },
+    { 4, 0, -2, 1, 671., 0. },
+    { 2, 0, 0, -3, 607., 0. },
+    { 2, 0, 2, -1, 596., 0. },
+    { 2, -1, 1, -1, 491., 0. },
+    { 2, 0, -2, 1, -451., 0. },
+    { 0, 0, 3, -1, 439., 0. },
+    { 2, 0, 2, 1, 422., 0. },
+    { 2, 0, -3, -1, 421., 0. },
+    { 2, 1, -1, 1, -366., 0. },
+    { 2, 1, 0, 1, -351., 0. },
+    { 4, 0, 0, 1, 331., 0. },
+    { 2, -1, 1, 1, 315., 0. },
+    { 2, -2, 0, -1, 302., 0. },
+    { 0, 0, 1, 3, -283., 0. },
+    { 2, 1, 1, -1, -229., 0. },
+    { 1, 1, 0, -1, 223., 0. },
+    { 1, 1, 0, 1, 223., 0. },
+    { 0, 1, -2, -1, -220., 0. },
+    { 2, 1, -1, -1, -220., 0. },
+    { 1, 0, 1, 1, -185., 0. },
+    { 2, -1, -2, -1, 181., 0. },
+    { 0, 1, 2, 1, -177., 0. },
+    { 4, 0, -2, -1, 176., 0. },
+    { 4, -1, -1, -1, 166., 0. },
+    { 1, 0, 1, -1, -164., 0. },
+    { 4, 0, 1, -1, 132., 0. },
+    { 1, 0, -1, -1, -119., 0. },
+    { 4, -1, 0, -1, 115., 0. },
+    { 2, -2, 0, 1, 107., 0. }
+};
+
+//-----------------------------------------------------------------------------
+
+//IAU 1980 nutation: Meeus, table 22.A. Multiples of D, M, M', F, and Omega,
+// and coefficients in 0.0001" (and 0.0001" per Julian century).
+
+struct NutationTerm
+{
+    int m_d;
+    int m_m;
+    int m_mp;
+    int m_f;
+    int m_omega;
+    double m_sin0;
+    double m_sin1;
+    double m_cos0;
+    double m_cos1;
+};
+
+const NutationTerm s_nutation[] =
+{
+    { 0, 0, 0, 0, 1, -171996., -174.2, 92025., 8.9 },
+    { -2, 0, 0, 2, 2, -13187., -1.6, 5736., -3.1 },
+    { 0, 0, 0, 2, 2, -2274., -0.2, 977., -0.5 },
+    { 0, 0, 0, 0, 2, 2062., 0.2, -895., 0.5 },
+    { 0, 1, 0, 0, 0, 1426., -3.4, 54., -0.1 },
+    { 0, 0, 1, 0, 0, 712., 0.1, -7., 0. },
+    { -2, 1, 0, 2, 2, -517., 1.2, 224., -0.6 },
+    { 0, 0, 0, 2, 1, -386., -0.4, 200., 0. },
+    { 0, 0, 1, 2, 2, -301., 0., 129., -0.1 },
+    { -2, -1, 0, 2, 2, 217., -0.5, -95., 0.3 },
+    { -2, 0, 1, 0, 0, -158., 0., 0., 0. },
+    { -2, 0, 0, 2, 1, 129., 0.1, -70., 0. },
+    { 0, 0, -1, 2, 2, 123., 0., -53., 0. },
+    { 2, 0, 0, 0, 0, 63., 0., 0., 0. },
+    { 0, 0, 1, 0, 1, 63., 0.1, -33., 0. },
+    { 2, 0, -1, 2, 2, -59., 0., 26., 0. },
+    { 0, 0, -1, 0, 1, -58., -0.1, 32., 0. },
+    { 0, 0, 1, 2, 1, -51., 0., 27., 0. },
+    { -2, 0, 2, 0, 0, 48., 0., 0., 0. },
+    { 0, 0, -2, 2, 1, 46., 0., -24., 0. },
+    { 2, 0, 0, 2, 2, -38., 0., 16., 0. },
+    { 0, 0, 2, 2, 2, -31., 0., 13., 0. },
+    { 0, 0, 2, 0, 0, 29., 0., 0., 0. },
+    { -2, 0, 1, 2, 2, 29., 0., -12., 0. },
+    { 0, 0, 0, 2, 0, 26., 0., 0., 0. },
+    { -2, 0, 0, 2, 0, -22., 0., 0., 0. },
+    { 0, 0, -1, 2, 1, 21., 0., -10., 0. },
+    { 0, 2, 0, 0, 0, 17., -0.1, 0., 0. },
+    { 2, 0, -1, 0, 1, 16., 0., -8., 0. },
+    { -2, 2, 0, 2, 2, -16., 0.1, 7., 0. },
+    { 0, 1, 0, 0, 1, -15., 0., 9., 0. },
+    { -2, 0, 1, 0, 1, -13., 0., 7., 0. },
+    { 0, -1, 0, 0, 1, -12., 0., 6., 0. },
+    { 0, 0, 2, -2, 0, 11., 0., 0., 0. },
+    { 2, 0, -1, 2, 1, -10., 0., 5., 0. },
+    { 2, 0, 1, 2, 2, -8., 0., 3., 0. },
+    { 0, 1, 0, 2, 2, 7., 0., -3., 0. },
+    { -2, 1, 1, 0, 0, -7., 0., 0., 0. },
+    { 0, -1, 0, 2, 2, -7., 0., 3., 0. },
+    { 2, 0, 0, 2, 1, -7., 0., 3., 0. },
+    { 2, 0, 1, 0, 0, 6., 0., 0., 0. },
+    { -2, 0, 2, 2, 2, 6., 0., -3., 0. },
+    { -2, 0, 1, 2, 1, 6., 0., -3., 0. },
+    { 2, 0, -2, 0, 1, -6., 0., 3., 0. },
+    { 2, 0, 0, 0, 1, -6., 0., 3., 0. },
+    { 0, -1, 1, 0, 0, 5., 0., 0., 0. },
+    { -2, -1, 0, 2, 1, -5., 0., 3., 0. },
+    { -2, 0, 0, 0, 1, -5., 0., 3., 0. },
+    { 0, 0, 2, 2, 1, -5., 0., 3., 0. },
+    { -2, 0, 2, 0, 1, 4., 0., 0., 0. },
+    { -2, 1, 0, 2, 1, 4., 0., 0., 0. },
+    { 0, 0, 1, -2, 0, 4., 0., 0., 0. },
+    { -1, 0, 1, 0, 0, -4., 0., 0., 0. },
+    { -2, 1, 0, 0, 0, -4., 0., 0., 0. },
+    { 1, 0, 0, 0, 0, -4., 0., 0., 0. },
+    { 0, 0, 1, 2, 0, 3., 0., 0., 0. },
+    { 0, 0, -2, 2, 2, -3., 0., 0., 0. },
+    { -1, -1, 1, 0, 0, -3., 0., 0., 0. },
+    { 0, 1, 1, 0, 0, -3., 0., 0., 0. },
+    { 0, -1, 1, 2, 2, -3., 0., 0., 0. },
+    { 2, -1, -1, 2, 2, -3., 0., 0., 0. },
+    { 0, 0, 3, 2, 2, -3., 0., 0., 0. },
+    { 2, -1, 0, 2, 2, -3., 0., 0., 0. }
+};
+
+//-----------------------------------------------------------------------------
+
+const double s_degree = M_PI / 180.;
+const double s_arcSecond = M_PI / (180. * 3600.);
+const double s_kmPerAU = AstroConst::AstronomicalUnit( ) / 1000.;
+const double s_moonMeanDistance = 385000.56;    //km
+//Speed of general precession in longitude, radians per day.
+const double s_precessionRate = 5029.0966 * s_arcSecond / 36525.;
+
+//.............................................................................
+
+double
+Polynomial4( double t, double c0, double c1, double c2, double c3, double c4,
+             double * pRate )
+{
+    *pRate = c1  +  t * (2. * c2  +  t * (3. * c3  +  t * 4. * c4));
+    return c0  +  t * (c1  +  t * (c2  +  t * (c3  +  t * c4)));
+}
+
+//.............................................................................
+
+//Converts ecliptic coordinates of date, and their rates, to rectangular
+// coordinates on the J2000 equatorial axes.
+void
+EclipticToJ2000( double julianDay,
+                 double longitude, double latitude, double distance,
+                 double longitudeRate, double latitudeRate,
+                 double distanceRate,
+                 Point3D * pPosition, Vector3D * pVelocity )
+{
+    Matrix3D toJ2000 = Precession( julianDay ).Matrix( false )
+            * EclipticalToEquatorialMatrix( MeanObliquity( julianDay ) );
+    double cosLon = cos( longitude );
+    double sinLon = sin( longitude );
+    double cosLat = cos( latitude );
+    double sinLat = sin( latitude );
+    Point3D position( distance * cosLat * cosLon,
+                      distance * cosLat * sinLon,
+                      distance * sinLat );
+    *pPosition = toJ2000 * position;
+    if ( pVelocity )
+    {
+        //The ecliptic of date turns, mostly about its pole, at the rate of
+        // precession, which is not part of the motion on the J2000 axes.
+        double lonRate = longitudeRate - s_precessionRate;
+        double radialRate = distanceRate * cosLat
+                - distance * sinLat * latitudeRate;
+        Vector3D velocity( radialRate * cosLon
+                           - distance * cosLat * sinLon * lonRate,
+                           radialRate * sinLon
+                           + distance * cosLat * cosLon * lonRate,
+                           distanceRate * sinLat
+                           + distance * cosLat * latitudeRate );
+        *pVelocity = toJ2000 * velocity;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+}                                                      //namespace
+
+
+//*****************************************************************************
+
+
+AnalyticEphemeris::AnalyticEphemeris( Angle truncation )
+    :   m_truncation( truncation )
+{
+    Assert( truncation.Radians() >= 0. );
+    AddPowerSeries( &m_earthLongitude, 0 );
+    AddPowerSeries( &m_earthLatitude, 1 );
+    AddPowerSeries( &m_earthRadius, 2 );
+    AddLunarSeries( &m_moonLongitude, 0 );
+    AddLunarSeries( &m_moonLatitude, 1 );
+    AddLunarSeries( &m_moonDistance, 2 );
+    double threshold = truncation.Radians() / s_arcSecond * 1.e4;
+    for ( int i = 0; i < (int) ARRAY_LENGTH( s_nutation ); ++i )
+        if ( (fabs( s_nutation[i].m_sin0 ) >= threshold)
+             || (fabs( s_nutation[i].m_cos0 ) >= threshold) )
+            m_nutationTerms.push_back( i );
+}
+
+//-----------------------------------------------------------------------------
+
+void
+AnalyticEphemeris::AddPowerSeries( PowerSeries * pSeries, int index )
+{
+    const VSOPSeries * pSource = 0;
+    int numPowers = 0;
+    switch ( index )
+    {
+    case 0:
+        pSource = s_earthL;
+        numPowers = ARRAY_LENGTH( s_earthL );
+        break;
+    case 1:
+        pSource = s_earthB;
+        numPowers = ARRAY_LENGTH( s_earthB );
+        break;
+    default:
+        pSource = s_earthR;
+        numPowers = ARRAY_LENGTH( s_earthR );
+        break;
+    }
+    //Amplitudes are in 1.e-8 radian, or AU (i.e. relative to the mean
+    // distance), and the rates are per Julian millennium.
+    double threshold = m_truncation.Radians();
+    for ( int k = 0; k < numPowers; ++k )
+    {
+        for ( int i = 0; i < pSource[k].m_numTerms; ++i )
+        {
+            const VSOPTerm & term = pSource[k].m_terms[i];
+            double amplitude = term.m_a * 1.e-8;
+            if ( amplitude < threshold )
+                continue;
+            pSeries->m_amplitudes.push_back( amplitude );
+            pSeries->m_phases.push_back( term.m_b );
+            pSeries->m_frequencies.push_back( term.m_c );
+        }
+        pSeries->m_powerEnds.push_back( (int) pSeries->m_amplitudes.size() );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void
+AnalyticEphemeris::AddLunarSeries( LunarSeries * pSeries, int index )
+{
+    const LunarTerm * pTerms = (index == 1)  ?  s_moonB  :  s_moonLR;
+    int numTerms = (index == 1)
+            ?  ARRAY_LENGTH( s_moonB )  :  ARRAY_LENGTH( s_moonLR );
+    //Amplitudes are stored in radians (longitude and latitude) or km.
+    double scale = (index == 2)  ?  1.e-3  :  1.e-6 * s_degree;
+    double reference = (index == 2)  ?  s_moonMeanDistance  :  1.;
+    double threshold = m_truncation.Radians();
+    for ( int i = 0; i < numTerms; ++i )
+    {
+        const LunarTerm & term = pTerms[i];
+        double amplitude
+                = ((index == 2)  ?  term.m_a1  :  term.m_a0) * scale;
+        if ( fabs( amplitude ) / reference < threshold )
+            continue;
+        if ( amplitude == 0. )
+            continue;
+        pSeries->m_multD.push_back( term.m_d );
+        pSeries->m_multM.push_back( term.m_m );
+        pSeries->m_multMp.push_back( term.m_mp );
+        pSeries->m_multF.push_back( term.m_f );
+        pSeries->m_amplitudes.push_back( amplitude );
+        pSeries->m_powersE.push_back( abs( term.m_m ) );
+    }
+}
+
+//=============================================================================
+
+int
+AnalyticEphemeris::NumTerms( ) const
+{
+    return (int) (m_earthLongitude.m_amplitudes.size()
+                  + m_earthLatitude.m_amplitudes.size()
+                  + m_earthRadius.m_amplitudes.size()
+                  + m_moonLongitude.m_amplitudes.size()
+                  + m_moonLatitude.m_amplitudes.size()
+                  + m_moonDistance.m_amplitudes.size()
+                  + m_nutationTerms.size());
+}
+
+//=============================================================================
+
+shared_ptr< AnalyticEphemeris >
+AnalyticEphemeris::Default( )
+{
+    static shared_ptr< AnalyticEphemeris > spDefault(
+        new AnalyticEphemeris );
+    return spDefault;
+}
+
+//=============================================================================
+
+bool
+AnalyticEphemeris::GetBodyPosition( double julianDay,
+                                    JPLEphemeris::EBody body,
+                                    JPLEphemeris::EBody origin,
+                                    Point3D * pPosition,
+                                    Vector3D * pVelocity ) const
+{
+    return GetBodyPositions( &julianDay, 1, body, origin,
+                             pPosition, pVelocity );
+}
+
+//-----------------------------------------------------------------------------
+
+bool
+AnalyticEphemeris::GetBodyPositions( const double * julianDays, int count,
+                                     JPLEphemeris::EBody body,
+                                     JPLEphemeris::EBody origin,
+                                     Point3D * pPositions,
+                                     Vector3D * pVelocities ) const
+{
+    Assert( julianDays && pPositions );
+    if ( ! (BodyAvailable( body ) && BodyAvailable( origin )) )
+        return false;
+    //Heliocentric (= barycentric here, see Note 4) positions are
+    // Earth + k Moon, where k is the Moon's part relative to the Earth.
+    double bodyK = 0.;
+    double originK = 0.;
+    bool bodyEarth = false;
+    bool originEarth = false;
+    const double mu = AstroConst::MoonEarthMassRatio( );
+    switch ( body )
+    {
+    case JPLEphemeris::Earth:
+        bodyEarth = true;
+        break;
+    case JPLEphemeris::Moon:
+        bodyEarth = true;
+        bodyK = 1.;
+        break;
+    case JPLEphemeris::EarthMoonBarycenter:
+        bodyEarth = true;
+        bodyK = mu / (1. + mu);
+        break;
+    default:
+        break;
+    }
+    switch ( origin )
+    {
+    case JPLEphemeris::Earth:
+        originEarth = true;
+        break;
+    case JPLEphemeris::Moon:
+        originEarth = true;
+        originK = 1.;
+        break;
+    case JPLEphemeris::EarthMoonBarycenter:
+        originEarth = true;
+        originK = mu / (1. + mu);
+        break;
+    default:
+        break;
+    }
+    bool needEarth = (bodyEarth != originEarth);
+    double earthSign = bodyEarth  ?  1.  :  -1.;
+    double moonK = bodyK - originK;
+
+    Point3D earthPos[ BlockSize ];
+    Vector3D earthVel[ BlockSize ];
+    Point3D moonPos[ BlockSize ];
+    Vector3D moonVel[ BlockSize ];
+    Vector3D * pEarthVel = pVelocities  ?  earthVel  :  0;
+    Vector3D * pMoonVel = pVelocities  ?  moonVel  :  0;
+    for ( int start = 0; start < count; start += BlockSize )
+    {
+        int n = min( count - start, (int) BlockSize );
+        if ( needEarth )
+            GetEarthHeliocentric( julianDays + start, n, earthPos, pEarthVel );
+        if ( moonK != 0. )
+            GetMoonGeocentric( julianDays + start, n, moonPos, pMoonVel );
+        for ( int i = 0; i < n; ++i )
+        {
+            Vector3D pos = Vector3D::Zero;
+            Vector3D vel = Vector3D::Zero;
+            if ( needEarth )
+            {
+                pos = earthSign * earthPos[i].ToVector();
+                if ( pVelocities )
+                    vel = earthSign * earthVel[i];
+            }
+            if ( moonK != 0. )
+            {
+                pos += moonK * moonPos[i].ToVector();
+                if ( pVelocities )
+                    vel += moonK * moonVel[i];
+            }
+            pPositions[ start + i ] = Point3D( pos );
+            if ( pVelocities )
+                pVelocities[ start + i ] = vel;
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void
+AnalyticEphemeris::GetEarthHeliocentric( const double * julianDays,
+                                         int count,
+                                         Point3D * pPositions,
+                                         Vector3D * pVelocities ) const
+{
+    Assert( count <= BlockSize );
+    double t[ BlockSize ];
+    for ( int i = 0; i < count; ++i )
+        t[i] = (julianDays[i] - J2000) / 365250.;
+    double lon[ BlockSize ], lonRate[ BlockSize ];
+    double lat[ BlockSize ], latRate[ BlockSize ];
+    double rad[ BlockSize ], radRate[ BlockSize ];
+    SumPowerSeries( m_earthLongitude, t, count, lon, lonRate );
+    SumPowerSeries( m_earthLatitude, t, count, lat, latRate );
+    SumPowerSeries( m_earthRadius, t, count, rad, radRate );
+    for ( int i = 0; i < count; ++i )
+    {
+        //Conversion to FK5 (Meeus, ch. 32).
+        double centuries = 10. * t[i];
+        double lonP = lon[i]
+                - (1.397 + 0.00031 * centuries) * centuries * s_degree;
+        lon[i] -= 0.09033 * s_arcSecond;
+        lat[i] += 0.03916 * s_arcSecond * (cos( lonP ) - sin( lonP ));
+        EclipticToJ2000( julianDays[i], lon[i], lat[i], rad[i] * s_kmPerAU,
+                         lonRate[i] / 365250., latRate[i] / 365250.,
+                         radRate[i] / 365250. * s_kmPerAU,
+                         &pPositions[i],
+                         pVelocities  ?  &pVelocities[i]  :  0 );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void
+AnalyticEphemeris::GetMoonGeocentric( const double * julianDays, int count,
+                                      Point3D * pPositions,
+                                      Vector3D * pVelocities ) const
+{
+    Assert( count <= BlockSize );
+    //Meeus, ch. 47. Angles in degrees and rates per Julian century, here.
+    LunarArguments arguments;
+    double meanLon[ BlockSize ], meanLonRate[ BlockSize ];
+    double additiveLon[ BlockSize ], additiveLonRate[ BlockSize ];
+    double additiveLat[ BlockSize ], additiveLatRate[ BlockSize ];
+    for ( int i = 0; i < count; ++i )
+    {
+        double t = (julianDays[i] - J2000) / 36525.;
+        double lp = Polynomial4( t, 218.3164477, 481267.88123421, -0.0015786,
+                                 1. / 538841., -1. / 65194000.,
+                                 &meanLonRate[i] );
+        double (& args)[ 4 ][ BlockSize ] = arguments.m_args;
+        double (& rates)[ 4 ][ BlockSize ] = arguments.m_rates;
+        args[0][i] = Polynomial4( t, 297.8501921, 445267.1114034, -0.0018819,
+                                  1. / 545868., -1. / 113065000.,
+                                  &rates[0][i] );
+        args[1][i] = Polynomial4( t, 357.5291092, 35999.0502909, -0.0001536,
+                                  1. / 24490000., 0., &rates[1][i] );
+        args[2][i] = Polynomial4( t, 134.9633964, 477198.8675055, 0.0087414,
+                                  1. / 69699., -1. / 14712000.,
+                                  &rates[2][i] );
+        args[3][i] = Polynomial4( t, 93.2720950, 483202.0175233, -0.0036539,
+                                  -1. / 3526000., 1. / 863310000.,
+                                  &rates[3][i] );
+        for ( int a = 0; a < 4; ++a )
+        {
+            args[a][i] = fmod( args[a][i], 360. ) * s_degree;
+            rates[a][i] *= s_degree;
+        }
+        double e = 1.  -  t * (0.002516  +  t * 0.0000074);
+        arguments.m_powersE[0][i] = 1.;
+        arguments.m_powersE[1][i] = e;
+        arguments.m_powersE[2][i] = e * e;
+
+        lp = fmod( lp, 360. ) * s_degree;
+        meanLonRate[i] *= s_degree;
+        double f = args[3][i];
+        double fRate = rates[3][i];
+        double mp = args[2][i];
+        double mpRate = rates[2][i];
+        double a1 = (119.75 + 131.849 * t) * s_degree;
+        double a1Rate = 131.849 * s_degree;
+        double a2 = (53.09 + 479264.290 * t) * s_degree;
+        double a2Rate = 479264.290 * s_degree;
+        double a3 = (313.45 + 481266.484 * t) * s_degree;
+        double a3Rate = 481266.484 * s_degree;
+        const double u = 1.e-6 * s_degree;
+        additiveLon[i] = u * (3958. * sin( a1 )  +  1962. * sin( lp - f )
+                              +  318. * sin( a2 ));
+        additiveLonRate[i] = u * (3958. * cos( a1 ) * a1Rate
+                                  +  1962. * cos( lp - f )
+                                  * (meanLonRate[i] - fRate)
+                                  +  318. * cos( a2 ) * a2Rate);
+        additiveLat[i] = u * (-2235. * sin( lp )  +  382. * sin( a3 )
+                              +  175. * sin( a1 - f )
+                              +  175. * sin( a1 + f )
+                              +  127. * sin( lp - mp )
+                              -  115. * sin( lp + mp ));
+        additiveLatRate[i] = u * (-2235. * cos( lp ) * meanLonRate[i]
+                                  +  382. * cos( a3 ) * a3Rate
+                                  +  175. * cos( a1 - f ) * (a1Rate - fRate)
+                                  +  175. * cos( a1 + f ) * (a1Rate + fRate)
+                                  +  127. * cos( lp - mp )
+                                  * (meanLonRate[i] - mpRate)
+                                  -  115. * cos( lp + mp )
+                                  * (meanLonRate[i] + mpRate));
+        meanLon[i] = lp;
+    }
+
+    double lon[ BlockSize ], lonRate[ BlockSize ];
+    double lat[ BlockSize ], latRate[ BlockSize ];
+    double dist[ BlockSize ], distRate[ BlockSize ];
+    SumLunarSeries( m_moonLongitude, false, arguments, count, lon, lonRate );
+    SumLunarSeries( m_moonLatitude, false, arguments, count, lat, latRate );
+    SumLunarSeries( m_moonDistance, true, arguments, count, dist, distRate );
+    for ( int i = 0; i < count; ++i )
+    {
+        //The mean longitude includes the light-time; see Note 5.
+        double longitude = meanLon[i] + lon[i] + additiveLon[i]
+                + 0.70 * s_arcSecond;
+        double latitude = lat[i] + additiveLat[i];
+        double distance = s_moonMeanDistance + dist[i];
+        EclipticToJ2000( julianDays[i], longitude, latitude, distance,
+                         (meanLonRate[i] + lonRate[i] + additiveLonRate[i])
+                         / 36525.,
+                         (latRate[i] + additiveLatRate[i]) / 36525.,
+                         distRate[i] / 36525.,
+                         &pPositions[i],
+                         pVelocities  ?  &pVelocities[i]  :  0 );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void
+AnalyticEphemeris::SumPowerSeries( const PowerSeries & series,
+                                   const double * t, int count,
+                                   double * pSums, double * pRates )
+{
+    //Horner's rule on the powers of t, each coefficient being a sum of
+    // periodic terms, with the derivative carried along.
+    for ( int i = 0; i < count; ++i )
+        pSums[i] = pRates[i] = 0.;
+    const double * amplitudes = &series.m_amplitudes[0];
+    const double * phases = &series.m_phases[0];
+    const double * frequencies = &series.m_frequencies[0];
+    for ( int k = (int) series.m_powerEnds.size() - 1; k >= 0; --k )
+    {
+        double sums[ BlockSize ];
+        double rates[ BlockSize ];
+        for ( int i = 0; i < count; ++i )
+            sums[i] = rates[i] = 0.;
+        int begin = (k == 0)  ?  0  :  series.m_powerEnds[ k - 1 ];
+        int end = series.m_powerEnds[ k ];
+        for ( int j = begin; j < end; ++j )
+        {
+            double a = amplitudes[j];
+            double b = phases[j];
+            double c = frequencies[j];
+            double ac = a * c;
+            for ( int i = 0; i < count; ++i )
+            {
+                double arg = b  +  c * t[i];
+                sums[i] += a * cos( arg );
+                rates[i] -= ac * sin( arg );
+            }
+        }
+        for ( int i = 0; i < count; ++i )
+        {
+            pRates[i] = pRates[i] * t[i]  +  pSums[i]  +  rates[i];
+            pSums[i] = pSums[i] * t[i]  +  sums[i];
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void
+AnalyticEphemeris::SumLunarSeries( const LunarSeries & series, bool cosine,
+                                   const LunarArguments & arguments,
+                                   int count,
+                                   double * pSums, double * pRates )
+{
+    for ( int i = 0; i < count; ++i )
+        pSums[i] = pRates[i] = 0.;
+    const double * d = arguments.m_args[0];
+    const double * m = arguments.m_args[1];
+    const double * mp = arguments.m_args[2];
+    const double * f = arguments.m_args[3];
+    const double * dRate = arguments.m_rates[0];
+    const double * mRate = arguments.m_rates[1];
+    const double * mpRate = arguments.m_rates[2];
+    const double * fRate = arguments.m_rates[3];
+    int numTerms = (int) series.m_amplitudes.size();
+    for ( int j = 0; j < numTerms; ++j )
+    {
+        double multD = series.m_multD[j];
+        double multM = series.m_multM[j];
+        double multMp = series.m_multMp[j];
+        double multF = series.m_multF[j];
+        double a = series.m_amplitudes[j];
+        const double * powerE = arguments.m_powersE[ series.m_powersE[j] ];
+        if ( cosine )
+        {
+            for ( int i = 0; i < count; ++i )
+            {
+                double arg = multD * d[i]  +  multM * m[i]
+                        +  multMp * mp[i]  +  multF * f[i];
+                double argRate = multD * dRate[i]  +  multM * mRate[i]
+                        +  multMp * mpRate[i]  +  multF * fRate[i];
+                double ae = a * powerE[i];
+                pSums[i] += ae * cos( arg );
+                pRates[i] -= ae * argRate * sin( arg );
+            }
+        }
+        else
+        {
+            for ( int i = 0; i < count; ++i )
+            {
+                double arg = multD * d[i]  +  multM * m[i]
+                        +  multMp * mp[i]  +  multF * f[i];
+                double argRate = multD * dRate[i]  +  multM * mRate[i]
+                        +  multMp * mpRate[i]  +  multF * fRate[i];
+                double ae = a * powerE[i];
+                pSums[i] += ae * sin( arg );
+                pRates[i] += ae * argRate * cos( arg );
+            }
+        }
+    }
+}
+
+//=============================================================================
+
+void
+AnalyticEphemeris::GetNutation( double julianDay, Nutation * pNutation ) const
+{
+    Assert( pNutation );
+    //Meeus, ch. 22.
+    double t = (julianDay - J2000) / 36525.;
+    double args[ 5 ];
+    args[0] = 297.85036  +  t * (445267.111480
+                                 +  t * (-0.0019142  +  t / 189474.));
+    args[1] = 357.52772  +  t * (35999.050340
+                                 +  t * (-0.0001603  -  t / 300000.));
+    args[2] = 134.96298  +  t * (477198.867398
+                                 +  t * (0.0086972  +  t / 56250.));
+    args[3] = 93.27191  +  t * (483202.017538
+                                +  t * (-0.0036825  +  t / 327270.));
+    args[4] = 125.04452  +  t * (-1934.136261
+                                 +  t * (0.0020708  +  t / 450000.));
+    for ( int a = 0; a < 5; ++a )
+        args[a] = fmod( args[a], 360. ) * s_degree;
+    double nutLon = 0.;
+    double nutObl = 0.;
+    for ( int j = 0; j < (int) m_nutationTerms.size(); ++j )
+    {
+        const NutationTerm & term = s_nutation[ m_nutationTerms[j] ];
+        double arg = term.m_d * args[0]  +  term.m_m * args[1]
+                +  term.m_mp * args[2]  +  term.m_f * args[3]
+                +  term.m_omega * args[4];
+        nutLon += (term.m_sin0  +  term.m_sin1 * t) * sin( arg );
+        nutObl += (term.m_cos0  +  term.m_cos1 * t) * cos( arg );
+    }
+    pNutation->Set( Angle( nutLon * 1.e-4, Angle::ArcSecond ),
+                    Angle( nutObl * 1.e-4, Angle::ArcSecond ) );
+}
+
+
+//*****************************************************************************
+
+
+AnalyticBarycentricEphemeris::AnalyticBarycentricEphemeris(
+    shared_ptr< AnalyticEphemeris > spEphemeris, JPLEphemeris::EBody body )
+    :   m_spEphemeris( spEphemeris ),
+        m_body( body )
+{
+    Assert( m_spEphemeris );
+}
+
+//-----------------------------------------------------------------------------
+
+AnalyticBarycentricEphemeris::AnalyticBarycentricEphemeris(
+    JPLEphemeris::EBody body )
+    :   m_spEphemeris( AnalyticEphemeris::Default( ) ),
+        m_body( body )
+{
+}
+
+//=============================================================================
+
+Point3D
+AnalyticBarycentricEphemeris::operator()( double julianDay )
+{
+    Point3D bodyPos;
+    if ( ! m_spEphemeris->GetBodyPosition( julianDay, m_body,
+                                           JPLEphemeris::SolarSystemBarycenter,
+                                           &bodyPos ) )
+        throw RuntimeError( "AnalyticBarycentricEphemeris failed." );
+    return bodyPos;
+}
+
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+Point3D
+AnalyticBarycentricEphemeris::operator()( double julianDay0,
+                                          double julianDay1 )
+{
+    return (*this)( julianDay0 + julianDay1 );
+}
+
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void
+AnalyticBarycentricEphemeris::operator()( double julianDay,
+                                          Point3D * pPosition,
+                                          Vector3D * pVelocity )
+{
+    if ( ! m_spEphemeris->GetBodyPosition( julianDay, m_body,
+                                           JPLEphemeris::SolarSystemBarycenter,
+                                           pPosition, pVelocity ) )
+        throw RuntimeError( "AnalyticBarycentricEphemeris failed." );
+}
+
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void
+AnalyticBarycentricEphemeris::operator()( double julianDay0,
+                                          double julianDay1,
+                                          Point3D * pPosition,
+                                          Vector3D * pVelocity )
+{
+    (*this)( julianDay0 + julianDay1, pPosition, pVelocity );
+}
+
+
+//*****************************************************************************
+
+
+AnalyticGeocentricEphemeris::AnalyticGeocentricEphemeris(
+    shared_ptr< AnalyticEphemeris > spEphemeris, JPLEphemeris::EBody body )
+    :   m_spEphemeris( spEphemeris ),
+        m_body( body )
+{
+    Assert( m_spEphemeris );
+}
+
+//-----------------------------------------------------------------------------
+
+AnalyticGeocentricEphemeris::AnalyticGeocentricEphemeris(
+    JPLEphemeris::EBody body )
+    :   m_spEphemeris( AnalyticEphemeris::Default( ) ),
+        m_body( body )
+{
+}
+
+//=============================================================================
+
+Point3D
+AnalyticGeocentricEphemeris::operator()( double julianDay )
+{
+    Point3D bodyPos;
+    if ( ! m_spEphemeris->GetBodyPosition( julianDay, m_body,
+                                           JPLEphemeris::Earth, &bodyPos ) )
+        throw RuntimeError( "AnalyticGeocentricEphemeris failed." );
+    return bodyPos;
+}
+
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+Point3D
+AnalyticGeocentricEphemeris::operator()( double julianDay0,
+                                         double julianDay1 )
+{
+    return (*this)( julianDay0 + julianDay1 );
+}
+
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void
+AnalyticGeocentricEphemeris::operator()( double julianDay,
+                                         Point3D * pPosition,
+                                         Vector3D * pVelocity )
+{
+    if ( ! m_spEphemeris->GetBodyPosition( julianDay, m_body,
+                                           JPLEphemeris::Earth,
+                                           pPosition, pVelocity ) )
+        throw RuntimeError( "AnalyticGeocentricEphemeris failed." );
+}
+
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void
+AnalyticGeocentricEphemeris::operator()( double julianDay0,
+                                         double julianDay1,
+                                         Point3D * pPosition,
+                                         Vector3D * pVelocity )
+{
+    (*this)( julianDay0 + julianDay1, pPosition, pVelocity );
+}
+
+
+//*****************************************************************************
+
+
+#ifdef DEBUG
+
+namespace
+{                                                      //namespace
+
+//Ecliptic coordinates of date from J2000 equatorial rectangular coordinates.
+Spherical
+EclipticOfDate( double julianDay, const Point3D & position )
+{
+    Matrix3D toDate
+            = EquatorialToEclipticalMatrix( MeanObliquity( julianDay ) )
+            * Precession( julianDay ).Matrix( true );
+    return Spherical( toDate * position );
+}
+
+}                                                      //namespace
+
+//-----------------------------------------------------------------------------
+
+bool
+AnalyticEphemeris::Test( )
+{
+    bool ok = true;
+    cout << "Testing AnalyticEphemeris" << endl;
+
+    AnalyticEphemeris ephemeris;
+    {
+        //Meeus, Example 47.a
+        double jd = 2448724.5;
+        Point3D moonPos;
+        TESTCHECK( ephemeris.GetBodyPosition( jd, JPLEphemeris::Moon,
+                                              JPLEphemeris::Earth,
+                                              &moonPos ),
+                   true, &ok );
+        Spherical moonEcl = EclipticOfDate( jd, moonPos );
+        double lonDeg = moonEcl.Longitude().Degrees()  -  0.70 / 3600.;
+        TESTCHECKFE( lonDeg, 133.162655, &ok, 1.e-8 );
+        TESTCHECKFE( moonEcl.Latitude().Degrees(), -3.229126, &ok, 3.e-7 );
+        TESTCHECKFE( moonEcl.Distance(), 368409.7, &ok, 1.e-7 );
+    }
+    {
+        //Meeus, Example 25.b (before the conversion to FK5)
+        double jd = 2448908.5;
+        Point3D sunPos;
+        TESTCHECK( ephemeris.GetBodyPosition( jd, JPLEphemeris::Sun,
+                                              JPLEphemeris::Earth,
+                                              &sunPos ),
+                   true, &ok );
+        Spherical sunEcl = EclipticOfDate( jd, sunPos );
+        double lonDeg = sunEcl.Longitude().Degrees()  +  0.09033 / 3600.
+                +  360.;
+        TESTCHECKFE( lonDeg, 199.907372, &ok, 1.e-8 );
+        TESTCHECKFE( sunEcl.Distance() / s_kmPerAU, 0.99760775, &ok, 1.e-8 );
+    }
+    {
+        //Meeus, Example 22.a
+        Nutation nutation;
+        ephemeris.GetNutation( 2446895.5, &nutation );
+        TESTCHECKFE( nutation.NutLongitude().Radians() / s_arcSecond,
+                     -3.788, &ok, 2.e-4 );
+        TESTCHECKFE( nutation.NutObliquity().Radians() / s_arcSecond,
+                     9.443, &ok, 2.e-4 );
+    }
+    {
+        //Velocities are consistent with positions, and the batch agrees
+        // with single evaluations.
+        const double h = 0.01;
+        double days[ 3 * 40 ];
+        for ( int i = 0; i < 40; ++i )
+        {
+            days[ 3 * i ] = J2000  +  i * 91.7;
+            days[ 3 * i + 1 ] = days[ 3 * i ] - h;
+            days[ 3 * i + 2 ] = days[ 3 * i ] + h;
+        }
+        JPLEphemeris::EBody bodies[] = { JPLEphemeris::Earth,
+                                         JPLEphemeris::Moon };
+        JPLEphemeris::EBody origins[] = { JPLEphemeris::Sun,
+                                          JPLEphemeris::Earth };
+        for ( int b = 0; b < 2; ++b )
+        {
+            Point3D positions[ 3 * 40 ];
+            Vector3D velocities[ 3 * 40 ];
+            TESTCHECK( ephemeris.GetBodyPositions( days, 3 * 40, bodies[b],
+                                                   origins[b], positions,
+                                                   velocities ),
+                       true, &ok );
+            double maxVelErr = 0.;
+            double maxBatchErr = 0.;
+            for ( int i = 0; i < 40; ++i )
+            {
+                Vector3D diffVel = (positions[ 3 * i + 2 ]
+                                    - positions[ 3 * i + 1 ]) * (0.5 / h);
+                maxVelErr = max( maxVelErr,
+                                 (diffVel - velocities[ 3 * i ]).Length()
+                                 / velocities[ 3 * i ].Length() );
+                Point3D pos;
+                ephemeris.GetBodyPosition( days[ 3 * i ], bodies[b],
+                                           origins[b], &pos );
+                maxBatchErr = max( maxBatchErr,
+                                   (pos - positions[ 3 * i ]).Length() );
+            }
+            TESTCHECK( maxVelErr < 1.e-5, true, &ok );
+            TESTCHECK( maxBatchErr, 0., &ok );
+        }
+    }
+    {
+        //Truncation
+        AnalyticEphemeris coarse( Angle( 1., Angle::ArcSecond ) );
+        TESTCHECK( coarse.NumTerms() < ephemeris.NumTerms() / 2, true, &ok );
+        double maxSunErr = 0.;
+        double maxMoonErr = 0.;
+        for ( int i = 0; i < 100; ++i )
+        {
+            double jd = J2000  +  i * 73.1;
+            Point3D full;
+            Point3D trunc;
+            ephemeris.GetBodyPosition( jd, JPLEphemeris::Sun,
+                                       JPLEphemeris::Earth, &full );
+            coarse.GetBodyPosition( jd, JPLEphemeris::Sun,
+                                    JPLEphemeris::Earth, &trunc );
+            maxSunErr = max( maxSunErr,
+                             Separation( Spherical( full ),
+                                         Spherical( trunc ) ).Radians() );
+            ephemeris.GetBodyPosition( jd, JPLEphemeris::Moon,
+                                       JPLEphemeris::Earth, &full );
+            coarse.GetBodyPosition( jd, JPLEphemeris::Moon,
+                                    JPLEphemeris::Earth, &trunc );
+            maxMoonErr = max( maxMoonErr,
+                              Separation( Spherical( full ),
+                                          Spherical( trunc ) ).Radians() );
+        }
+        //See Note 2.
+        TESTCHECK( maxSunErr < 5. * s_arcSecond, true, &ok );
+        TESTCHECK( maxMoonErr < 7. * s_arcSecond, true, &ok );
+    }
+    {
+        AnalyticGeocentricEphemeris moonEphem( JPLEphemeris::Moon );
+        AnalyticBarycentricEphemeris earthEphem( JPLEphemeris::Earth );
+        AnalyticBarycentricEphemeris moonBaryEphem( JPLEphemeris::Moon );
+        double jd = J2000 + 1000.;
+        TESTCHECK( ((moonBaryEphem( jd ) - earthEphem( jd ))
+                    - moonEphem( jd ).ToVector()).Length() < 1.e-6,
+                   true, &ok );
+        Point3D pos;
+        TESTCHECK( ephemeris.GetBodyPosition( jd, JPLEphemeris::Mars,
+                                              JPLEphemeris::Sun, &pos ),
+                   false, &ok );
+    }
+
+    if ( ok )
+        cout << "AnalyticEphemeris PASSED." << endl << endl;
+    else
+        cout << "AnalyticEphemeris FAILED." << endl << endl;
+    return ok;
+}
+
+#endif //DEBUG
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
@@ -0,0 +1,225 @@
+#ifndef ANALYTICEPHEMERIS_HPP
+#define ANALYTICEPHEMERIS_HPP
+/*
+  AnalyticEphemeris.hpp
+  Copyright (C) 2011 David M. Anderson
+
+  AnalyticEphemeris class: positions of the Sun, Earth, and Moon, and the
+  nutation, computed from truncated analytic series, needing no ephemeris
+  file.
+  AnalyticBarycentricEphemeris and AnalyticGeocentricEphemeris classes:
+  function objects, like JPLBarycentricEphemeris and JPLGeocentricEphemeris,
+  for use with ApparentEphemeris and the like.
+  NOTES:
+  1. The Earth's heliocentric position is from VSOP87D (P. Bretagnon and
+     G. Francou), as abridged in Jean Meeus, "Astronomical Algorithms",
+     2nd ed., Appendix III, with the correction to the FK5 system of his
+     chapter 32. The Moon's geocentric position is from the ELP-2000/82
+     series, as abridged in his chapter 47. Nutation is the IAU 1980 theory,
+     as in his table 22.A. At full precision the errors are about 1" for the
+     Sun, 10" in longitude and 4" in latitude for the Moon, and 0.0003" for
+     the nutation, over several centuries around 2000.
+  2. The truncation passed to the constructor drops every term whose
+     amplitude, as an angle (or a distance divided by the mean distance),
+     is less than it. The time is roughly proportional to the number of
+     terms kept (see NumTerms()). A truncation of 1" keeps about 180 of the
+     420 terms, adding errors of up to about 5" to the Sun and 7" to the
+     Moon, and makes the Sun's position about four times as fast to compute;
+     that is ample for calendar day boundaries.
+  3. As with JPLEphemeris, julianDay is in TDB, positions are in km and
+     velocities in km/day, on the axes of the mean equator and equinox of
+     J2000. The velocities are the derivatives of the series, so they are
+     consistent with the positions. Only Sun, Earth, Moon,
+     EarthMoonBarycenter, and SolarSystemBarycenter are available (see
+     BodyAvailable()); GetBodyPosition() returns false for any other.
+  4. The series are heliocentric, so SolarSystemBarycenter is taken to be
+     the Sun. This displaces everything by up to about 0.01 AU, but the same
+     displacement is applied to the Earth, so geocentric positions, and the
+     aberration computed from the Earth's velocity, are hardly affected:
+     the error in the velocity is about 13 m/s, or 0.01" of aberration.
+  5. The Moon's series in Meeus include the light-time (0.70") in the
+     longitude. That is removed here, to give the geometric position that
+     ApparentEphemeris expects.
+  6. GetBodyPositions() evaluates the positions for several days at once.
+     The terms are stored as separate arrays of amplitudes, phases, and
+     frequencies, and the sums are done with the loop over days innermost,
+     so the compiler can vectorize them. The days need not be in order.
+  7. An AnalyticEphemeris is not changed after construction, so one
+     instance may be used from several threads at once. Default() returns a
+     shared instance at full precision.
+*/
+
+
+#include "JPLEphemeris.hpp"
+#include "Nutation.hpp"
+#include "Point3.hpp"
+#include "Vector3.hpp"
+#include "Angle.hpp"
+#include <vector>
+#include <tr1/memory>
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+class AnalyticEphemeris
+{
+public:
+    explicit AnalyticEphemeris( Angle truncation = Angle( 0. ) );
+
+    Angle Truncation( ) const;
+    int NumTerms( ) const;
+    static bool BodyAvailable( JPLEphemeris::EBody body );
+
+    bool GetBodyPosition( double julianDay,
+                          JPLEphemeris::EBody body, JPLEphemeris::EBody origin,
+                          Point3D * pPosition,
+                          Vector3D * pVelocity = 0 ) const;
+    bool GetBodyPositions( const double * julianDays, int count,
+                           JPLEphemeris::EBody body,
+                           JPLEphemeris::EBody origin,
+                           Point3D * pPositions,
+                           Vector3D * pVelocities = 0 ) const;
+    void GetNutation( double julianDay, Nutation * pNutation ) const;
+
+    static std::tr1::shared_ptr< AnalyticEphemeris > Default( );
+
+#ifdef DEBUG
+    static bool Test( );
+#endif
+
+private:
+    //Days are evaluated in blocks of this many, to bound the workspace.
+    static const int BlockSize = 32;
+
+    //Terms of the form A cos( B + C t ), grouped by the power of t that
+    // multiplies them: Sum_k t^k Sum_i A_ki cos( B_ki + C_ki t ).
+    struct PowerSeries
+    {
+        std::vector< double > m_amplitudes;
+        std::vector< double > m_phases;
+        std::vector< double > m_frequencies;
+        std::vector< int > m_powerEnds;
+    };
+    //Terms of the form A E^|m| sin( d D + m M + m' M' + f F ), or cos.
+    struct LunarSeries
+    {
+        std::vector< double > m_multD;
+        std::vector< double > m_multM;
+        std::vector< double > m_multMp;
+        std::vector< double > m_multF;
+        std::vector< double > m_amplitudes;
+        std::vector< int > m_powersE;
+    };
+    //D, M, M', F and their rates, and the powers of E, for a block of days.
+    struct LunarArguments
+    {
+        double m_args[ 4 ][ BlockSize ];
+        double m_rates[ 4 ][ BlockSize ];
+        double m_powersE[ 3 ][ BlockSize ];
+    };
+
+    void AddPowerSeries( PowerSeries * pSeries, int index );
+    void AddLunarSeries( LunarSeries * pSeries, int index );
+    static void SumPowerSeries( const PowerSeries & series,
+                                const double * t, int count,
+                                double * pSums, double * pRates );
+    static void SumLunarSeries( const LunarSeries & series, bool cosine,
+                                const LunarArguments & arguments, int count,
+                                double * pSums, double * pRates );
+    void GetEarthHeliocentric( const double * julianDays, int count,
+                               Point3D * pPositions,
+                               Vector3D * pVelocities ) const;
+    void GetMoonGeocentric( const double * julianDays, int count,
+                            Point3D * pPositions,
+                            Vector3D * pVelocities ) const;
+
+    Angle m_truncation;
+    PowerSeries m_earthLongitude;
+    PowerSeries m_earthLatitude;
+    PowerSeries m_earthRadius;
+    LunarSeries m_moonLongitude;
+    LunarSeries m_moonLatitude;
+    LunarSeries m_moonDistance;
+    std::vector< int > m_nutationTerms;
+};
+
+
+//*****************************************************************************
+
+
+class AnalyticBarycentricEphemeris
+{
+public:
+    AnalyticBarycentricEphemeris(
+        std::tr1::shared_ptr< AnalyticEphemeris > spEphemeris,
+        JPLEphemeris::EBody body );
+    explicit AnalyticBarycentricEphemeris( JPLEphemeris::EBody body );
+    Point3D operator()( double julianDay );
+    Point3D operator()( double julianDay0, double julianDay1 );
+    void operator()( double julianDay,
+                     Point3D * pPosition, Vector3D * pVelocity );
+    void operator()( double julianDay0, double julianDay1,
+                     Point3D * pPosition, Vector3D * pVelocity );
+
+private:
+    std::tr1::shared_ptr< AnalyticEphemeris > m_spEphemeris;
+    JPLEphemeris::EBody m_body;
+};
+
+
+//*****************************************************************************
+
+
+class AnalyticGeocentricEphemeris
+{
+public:
+    AnalyticGeocentricEphemeris(
+        std::tr1::shared_ptr< AnalyticEphemeris > spEphemeris,
+        JPLEphemeris::EBody body );
+    explicit AnalyticGeocentricEphemeris( JPLEphemeris::EBody body );
+    Point3D operator()( double julianDay );
+    Point3D operator()( double julianDay0, double julianDay1 );
+    void operator()( double julianDay,
+                     Point3D * pPosition, Vector3D * pVelocity );
+    void operator()( double julianDay0, double julianDay1,
+                     Point3D * pPosition, Vector3D * pVelocity );
+
+private:
+    std::tr1::shared_ptr< AnalyticEphemeris > m_spEphemeris;
+    JPLEphemeris::EBody m_body;
+};
+
+
+//*****************************************************************************
+
+
+inline
+Angle
+AnalyticEphemeris::Truncation( ) const
+{
+    return m_truncation;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+bool
+AnalyticEphemeris::BodyAvailable( JPLEphemeris::EBody body )
+{
+    return ( (body == JPLEphemeris::SolarSystemBarycenter)
+             || (body == JPLEphemeris::Sun)
+             || (body == JPLEphemeris::Earth)
+             || (body == JPLEphemeris::Moon)
+             || (body == JPLEphemeris::EarthMoonBarycenter) );
+}
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
+
+#endif //ANALYTICEPHEMERIS_HPP
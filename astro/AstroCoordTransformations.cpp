@@ -12,7 +12,10 @@
 
 
 #include "AstroCoordTransformations.hpp"
+#include "DirectionArray.hpp"
 #include <limits>
+#include <algorithm>
+#include <cmath>
 #ifdef DEBUG
 #include <iostream>
 #include "TestCheck.hpp"
@@ -32,6 +35,27 @@ namespace
 
 double infinity = numeric_limits< double >::infinity();
 
+//Positions are transformed in blocks of this many, to bound the workspace.
+const int s_blockSize = 1024;
+
+//.............................................................................
+
+template < typename TFrom, typename TTo >
+void
+TransformArray( const TFrom * from, int count, const Matrix3D & matrix,
+                TTo * pTo, bool refraction = false )
+{
+    DirectionArray directions;
+    for ( int start = 0; start < count; start += s_blockSize )
+    {
+        directions.Set( from + start, min( s_blockSize, count - start ) );
+        directions.Transform( matrix, &directions );
+        if ( refraction )
+            directions.Refract( );
+        directions.Get( pTo + start );
+    }
+}
+
 }                                                                   //namespace
 
 //=============================================================================
@@ -183,6 +207,39 @@ GalacticToEquatorial( const Galactic & galactic )
 
 //=============================================================================
 
+void
+EquatorialToEcliptical( const Equatorial * equatorial, int count,
+                        Angle obliquity, Ecliptical * pEcliptical )
+{
+    TransformArray( equatorial, count,
+                    EquatorialToEclipticalMatrix( obliquity ), pEcliptical );
+}
+
+//-----------------------------------------------------------------------------
+
+void
+EquatorialToHorizontal( const Equatorial * equatorial, int count,
+                        Angle localSiderealTime, Angle geographicLatitude,
+                        Horizontal * pHorizontal, bool refraction )
+{
+    TransformArray( equatorial, count,
+                    EquatorialToHorizontalMatrix( localSiderealTime,
+                                                  geographicLatitude ),
+                    pHorizontal, refraction );
+}
+
+//-----------------------------------------------------------------------------
+
+void
+EquatorialToGalactic( const Equatorial * equatorial, int count,
+                      Galactic * pGalactic )
+{
+    TransformArray( equatorial, count, EquatorialToGalacticMatrix( ),
+                    pGalactic );
+}
+
+//=============================================================================
+
 Matrix3D 
 EclipticalToEquatorialMatrix( Angle obliquity )
 {
@@ -297,6 +354,32 @@ EclipticalLongitude( const Point3D & equatorialRect, Angle obliquity )
 
 //=============================================================================
 
+Angle
+AtmosphericRefraction( Angle trueAltitude, double pressure,
+                       double temperature )
+{
+    //Saemundsson's formula, in degrees and minutes of arc, with Meeus's
+    // adjustment to make it 0 at the zenith. Below -1 degree, the value
+    // there is tapered linearly to 0 at -5 degrees.
+    const double lowestAltitude = -1.;
+    const double zeroAltitude = -5.;
+    double h = trueAltitude.Degrees();
+    if ( h <= zeroAltitude )
+        return Angle( 0. );
+    double taper = 1.;
+    if ( h < lowestAltitude )
+    {
+        taper = (h - zeroAltitude) / (lowestAltitude - zeroAltitude);
+        h = lowestAltitude;
+    }
+    double r = 1.02 / tan( (h  +  10.3 / (h + 5.11)) * M_PI / 180. )
+            +  0.0019279;
+    r *= taper * (pressure / 1010.) * (283. / (273. + temperature));
+    return Angle( r / 60., Angle::Degree );
+}
+
+//=============================================================================
+
 #ifdef DEBUG
 
 bool 
@@ -594,6 +677,23 @@ TestAstroCoordTransformations( )
     TESTCHECKF( dmsTest2Dec.Seconds(), 38.39, &ok );
     TESTCHECKFE( equatTest2.Distance(), 1., &ok, 1e-3 );
 
+    //About 29' at the horizon; 0 at the zenith.
+    cout << "AtmosphericRefraction( )" << endl;
+    TESTCHECKFE( AtmosphericRefraction( Angle( 0.5541, Angle::Degree ) )
+                 .Degrees() * 60., 24.620, &ok, 1.e-4 );
+    TESTCHECKFE( AtmosphericRefraction( Angle( 0. ) ).Degrees() * 60.,
+                 28.984, &ok, 1.e-4 );
+    TESTCHECKFE( AtmosphericRefraction( Angle( M_PI / 2. ) ).Degrees() * 60.,
+                 0., &ok, 1.e-6 );
+    TESTCHECKFE( AtmosphericRefraction( Angle( -1., Angle::Degree ) )
+                 .Degrees() * 60., 38.797, &ok, 1.e-4 );
+    TESTCHECKFE( AtmosphericRefraction( Angle( -3., Angle::Degree ) )
+                 .Degrees() * 60., 38.797 / 2., &ok, 1.e-4 );
+    TESTCHECK( AtmosphericRefraction( Angle( -30., Angle::Degree ) )
+               .Radians(), 0., &ok );
+    TESTCHECKFE( AtmosphericRefraction( Angle( 0. ), 800., -20. ).Degrees()
+                 * 60., 28.984 * (800. / 1010.) * (283. / 253.), &ok, 1.e-4 );
+
 
     if ( ok )
         cout << "AstroCoordTransformations PASSED." << endl << endl;
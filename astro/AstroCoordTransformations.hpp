@@ -24,6 +24,19 @@
      ecliptical longitude, inluding seasons, oppositions, and phases of the
      Moon. The function EclipticalLongitude() is provided so that this value
      can be computed directly from rectangular equatorial coordinates.
+  5. The overloads taking arrays of positions compute the rotation matrix
+     once and apply it to all of them, using a DirectionArray. When the same
+     positions are transformed repeatedly (e.g. a star field for each frame)
+     it is better to keep a DirectionArray of them, and Transform() that.
+  6. AtmosphericRefraction() is by the formula of Saemundsson (Meeus,
+     eq. 16.4), for the true (airless) altitude, scaled for the pressure, in
+     millibars, and temperature, in degrees Celsius. It is accurate to
+     about 0.1' above the horizon. The formula has a singularity a little
+     below -5 degrees, and refraction has no meaning for bodies well below
+     the horizon, so below -1 degree the refraction at -1 degree is tapered
+     linearly to zero at -5 degrees, and zero is returned below that. If
+     refraction is requested, the horizontal overload adds it to the
+     altitudes for the standard pressure and temperature.
 */
 
 
@@ -60,6 +73,16 @@ Equatorial HorizontalToEquatorial( const Horizontal & horizontal,
 Galactic EquatorialToGalactic( const Equatorial & equatorial );
 Equatorial GalacticToEquatorial( const Galactic & galactic );
 
+void EquatorialToEcliptical( const Equatorial * equatorial, int count,
+                             Angle obliquity, Ecliptical * pEcliptical );
+void EquatorialToHorizontal( const Equatorial * equatorial, int count,
+                             Angle localSiderealTime,
+                             Angle geographicLatitude,
+                             Horizontal * pHorizontal,
+                             bool refraction = false );
+void EquatorialToGalactic( const Equatorial * equatorial, int count,
+                           Galactic * pGalactic );
+
 Matrix3D EclipticalToEquatorialMatrix( Angle obliquity );
 Matrix3D EquatorialToEclipticalMatrix( Angle obliquity );
 Matrix3D EquatorialToHorizontalMatrix( Angle localSiderealTime,
@@ -75,6 +98,9 @@ Matrix3D GalacticToEquatorialMatrix( );
 
 Angle EclipticalLongitude( const Point3D & equatorialRect, Angle obliquity );
 
+Angle AtmosphericRefraction( Angle trueAltitude, double pressure = 1010.,
+                             double temperature = 10. );
+
 #ifdef DEBUG
 bool TestAstroCoordTransformations( );
 #endif
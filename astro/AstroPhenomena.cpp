@@ -10,12 +10,17 @@
 #include "AstroPhenomena.hpp"
 #include "JPLEphemeris.hpp"
 #include "CoordinateReduction.hpp"
+#include "ReductionContext.hpp"
 #include "AstroCoordTransformations.hpp"
 #include "Precession.hpp"
 #include "Nutation.hpp"
 #include "Obliquity.hpp"
+#include "ChebyshevFit.hpp"
 #include "Polynomial.hpp"
 #include "Epoch.hpp"
+#include "Exception.hpp"
+#include "PublishedPtr.hpp"
+#include "Mutex.hpp"
 #ifdef DEBUG
 #include "TestCheck.hpp"
 #include <iostream>
@@ -34,6 +39,187 @@ namespace
 
 Logger s_log( "AstroPhenomena" );
 
+//.............................................................................
+
+//Function object for the CoordinateReduction templates. It evaluates the
+// ephemeris only when the requested time is more than maxExtrapolation days
+// from the last evaluation, and otherwise extrapolates linearly using the
+// velocity. A light-time iteration requests times that differ only slightly,
+// so this saves most of the evaluations. (The templates copy their function
+// arguments, so a copy made after an evaluation shares its result.)
+
+class ExtrapolatedPosition
+{
+public:
+    ExtrapolatedPosition( const JPLEphemeris * pEphemeris,
+                          JPLEphemeris::Cursor * pCursor,
+                          JPLEphemeris::EBody body, JPLEphemeris::EBody origin,
+                          double maxExtrapolation );
+
+    bool Evaluate( double julianDay );
+    Point3D operator()( double julianDay );
+
+private:
+    const JPLEphemeris * m_pEphemeris;
+    JPLEphemeris::Cursor * m_pCursor;
+    JPLEphemeris::EBody m_body;
+    JPLEphemeris::EBody m_origin;
+    double m_maxExtrapolation;
+    bool m_valid;
+    double m_julianDay;
+    Point3D m_position;
+    Vector3D m_velocity;
+};
+
+//-----------------------------------------------------------------------------
+
+ExtrapolatedPosition::ExtrapolatedPosition( const JPLEphemeris * pEphemeris,
+                                            JPLEphemeris::Cursor * pCursor,
+                                            JPLEphemeris::EBody body,
+                                            JPLEphemeris::EBody origin,
+                                            double maxExtrapolation )
+    :   m_pEphemeris( pEphemeris ),
+        m_pCursor( pCursor ),
+        m_body( body ),
+        m_origin( origin ),
+        m_maxExtrapolation( maxExtrapolation ),
+        m_valid( false ),
+        m_julianDay( 0. )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+bool
+ExtrapolatedPosition::Evaluate( double julianDay )
+{
+    m_valid = m_pEphemeris->GetBodyPosition( m_pCursor, julianDay,
+                                             m_body, m_origin,
+                                             &m_position, &m_velocity );
+    m_julianDay = julianDay;
+    return m_valid;
+}
+
+//-----------------------------------------------------------------------------
+
+Point3D
+ExtrapolatedPosition::operator()( double julianDay )
+{
+    double dt = julianDay - m_julianDay;
+    if ( (! m_valid) || (fabs( dt ) > m_maxExtrapolation) )
+    {
+#ifdef DEBUG
+        bool evalRslt =
+#endif
+                Evaluate( julianDay );
+        Assert( evalRslt );
+        return m_position;
+    }
+    return m_position + dt * m_velocity;
+}
+
+//.............................................................................
+
+//For the Sun, whose barycentric acceleration is tiny, extrapolation over a
+// whole day errs by less than a kilometer. Mercury's heliocentric
+// acceleration is the largest of the bodies; extrapolated over 0.001 day
+// its position errs by about 0.2 km, and the Moon's geocentric position by
+// about 0.01 km.
+const double s_sunMaxExtrapolation = 1.;
+const double s_bodyMaxExtrapolation = 0.001;
+
+//.............................................................................
+
+//Rate of change of the ecliptical longitude (radians/day) of a body with the
+// given geocentric equatorial position and velocity.
+
+double
+LongitudeRate( const Vector3D & position, const Vector3D & velocity,
+               const Matrix3D & equatToEclipt )
+{
+    Vector3D pos = equatToEclipt * position;
+    Vector3D vel = equatToEclipt * velocity;
+    return (pos.X() * vel.Y()  -  pos.Y() * vel.X())
+            / (pos.X() * pos.X()  +  pos.Y() * pos.Y());
+}
+
+//.............................................................................
+
+//Registered fits of SolarLongitude() and LunarPhase() (see Note 5), read
+// without locking (see PublishedPtr).
+
+enum EFit { SolarLongitudeFit, LunarPhaseFit, NumFits };
+
+PublishedPtr< ChebyshevFit > s_registeredFits[ NumFits ];
+Mutex s_fitRegistryMutex;  //serializes RegisterFit()
+
+//.............................................................................
+
+shared_ptr< ChebyshevFit >
+RegisterFit( EFit fit, shared_ptr< ChebyshevFit > spFit )
+{
+    MutexLock lock( s_fitRegistryMutex );
+    shared_ptr< ChebyshevFit > spPrevious
+            = s_registeredFits[ fit ].GetShared( );
+    s_registeredFits[ fit ].Publish( spFit );
+    return spPrevious;
+}
+
+//.............................................................................
+
+//Function objects for ChebyshevFit::Fit(). Each call has its own context, so
+// they may be called concurrently.
+
+struct SolarLongitudeFunc
+{
+    double operator()( double julianDay ) const
+    {
+        ReductionContext context;
+        return SolarLongitude( julianDay, context ).Radians();
+    }
+};
+
+//.............................................................................
+
+struct LunarPhaseFunc
+{
+    double operator()( double julianDay ) const
+    {
+        ReductionContext context;
+        return LunarPhase( julianDay, context ).Radians();
+    }
+};
+
+//.............................................................................
+
+template < typename Function >
+shared_ptr< ChebyshevFit >
+FitAngle( Function function, double firstJulianDay, double lastJulianDay,
+          double tolerance, ThreadPool * pPool )
+{
+    if ( firstJulianDay >= lastJulianDay )
+        throw LogicError( "AstroPhenomena fit: Empty date range." );
+    if ( (! JPLEphemeris::GetEphemeris( firstJulianDay ))
+         || (! JPLEphemeris::GetEphemeris( lastJulianDay )) )
+        throw RuntimeError( "AstroPhenomena fit: The ephemeris does not"
+                            " cover the date range." );
+    shared_ptr< ChebyshevFit > spFit( new ChebyshevFit );
+    spFit->Fit( function, firstJulianDay, lastJulianDay, tolerance,
+                2. * M_PI, ChebyshevFit::DefaultNumCoefficients, pPool );
+    return spFit;
+}
+
+//.............................................................................
+
+inline
+Angle
+FittedAngle( const ChebyshevFit * pFit, double julianDay )
+{
+    Angle angle( pFit->Evaluate( julianDay ) );
+    angle.Normalize( );
+    return angle;
+}
+
 }                                                                   //namespace
 
 
@@ -44,8 +230,15 @@ bool
 GetEarthBarycentric( double julianDay,
                      Point3D * pEarthBarycentric,
                      Vector3D * pEarthBarycentricVelocity,
-                     shared_ptr< JPLEphemeris > spEphemeris )
+                     shared_ptr< JPLEphemeris > spEphemeris,
+                     JPLEphemeris::Cursor * pCursor )
 {
+    if ( pCursor )
+        return spEphemeris->GetBodyPosition( pCursor, julianDay,
+                                             JPLEphemeris::Earth,
+                                           JPLEphemeris::SolarSystemBarycenter,
+                                             pEarthBarycentric,
+                                             pEarthBarycentricVelocity );
     return spEphemeris->GetBodyPosition( julianDay, JPLEphemeris::Earth,
                                          JPLEphemeris::SolarSystemBarycenter,
                                          pEarthBarycentric, 
@@ -58,17 +251,21 @@ bool
 GetNutPrecAndObliquity( double julianDay,
                         Matrix3D * pNutAndPrecMatrix,
                         Angle * pTrueObliquity, 
-                        shared_ptr< JPLEphemeris > spEphemeris )
+                        shared_ptr< JPLEphemeris > spEphemeris,
+                        JPLEphemeris::Cursor * pCursor )
 {
-    s_log( Logger::Debug, "GetNutPrecAndObliquity JD=%11.2f ephem=%p",
-           julianDay, spEphemeris.get() );
+    if ( s_log.IsEnabled( Logger::Debug ) )
+        s_log( Logger::Debug, "GetNutPrecAndObliquity JD=%11.2f ephem=%p",
+               julianDay, spEphemeris.get() );
     Matrix3D precessionMatrix = Precession( julianDay ).Matrix( );
     Matrix3D nutationMatrix;
     Angle meanObliquity = MeanObliquity( julianDay );
     if ( spEphemeris->NutationAvailable() )
     {
         Nutation nutation;
-        bool ephRslt = spEphemeris->GetNutation( julianDay, &nutation );
+        bool ephRslt = pCursor
+                ?  spEphemeris->GetNutation( pCursor, julianDay, &nutation )
+                :  spEphemeris->GetNutation( julianDay, &nutation );
         if ( ! ephRslt )
             return false;
         nutationMatrix = nutation.Matrix( meanObliquity );
@@ -94,9 +291,11 @@ SolarEquatorialPosition( double julianDay,
                          const Point3D & earthBarycentric,
                          const Vector3D & earthBarycentricVelocity,
                          const Matrix3D & nutAndPrecMatrix,
-                         shared_ptr< JPLEphemeris > spEphemeris )
+                         shared_ptr< JPLEphemeris > spEphemeris,
+                         JPLEphemeris::Cursor * pCursor )
 {
-    JPLBarycentricEphemeris sunEphem( spEphemeris, JPLEphemeris::Sun );
+    JPLBarycentricEphemeris sunEphem( spEphemeris, JPLEphemeris::Sun,
+                                      pCursor );
     Point3D sunPos = GetSunApparentPlace( julianDay, sunEphem,
                                           earthBarycentric,
                                           earthBarycentricVelocity,
@@ -107,29 +306,27 @@ SolarEquatorialPosition( double julianDay,
 //-----------------------------------------------------------------------------
 
 Equatorial 
-SolarEquatorialPosition( double julianDay )
+SolarEquatorialPosition( double julianDay, ReductionContext & context )
 {
-    shared_ptr< JPLEphemeris > spEphemeris
-            = JPLEphemeris::GetEphemeris( julianDay );
-    Assert( spEphemeris );
-    Point3D earthBarycentric;
-    Vector3D earthBarycentricVelocity;
-#ifdef DEBUG
-    bool earthRslt = 
-#endif
-            GetEarthBarycentric( julianDay, &earthBarycentric,
-                                 &earthBarycentricVelocity, spEphemeris );
-    Assert( earthRslt );
-    Matrix3D nutAndPrecMatrix;
 #ifdef DEBUG
-    bool nutPrecRslt =
+    bool setRslt =
 #endif
-            GetNutPrecAndObliquity( julianDay, &nutAndPrecMatrix,
-                                    0, spEphemeris );
-    Assert( nutPrecRslt );
-    return  SolarEquatorialPosition( julianDay, earthBarycentric,
-                                     earthBarycentricVelocity,
-                                     nutAndPrecMatrix, spEphemeris );
+            context.Set( julianDay );
+    Assert( setRslt );
+    return  SolarEquatorialPosition( julianDay, context.EarthBarycentric(),
+                                     context.EarthBarycentricVelocity(),
+                                     context.NutAndPrecMatrix(),
+                                     context.Ephemeris(),
+                                     context.EphemerisCursor() );
+}
+
+//.............................................................................
+
+Equatorial 
+SolarEquatorialPosition( double julianDay )
+{
+    ReductionContext context;
+    return  SolarEquatorialPosition( julianDay, context );
 }
 
 //=============================================================================
@@ -137,9 +334,11 @@ SolarEquatorialPosition( double julianDay )
 Equatorial 
 LunarEquatorialPosition( double julianDay,
                          const Matrix3D & nutAndPrecMatrix,
-                         shared_ptr< JPLEphemeris > spEphemeris )
+                         shared_ptr< JPLEphemeris > spEphemeris,
+                         JPLEphemeris::Cursor * pCursor )
 {
-    JPLGeocentricEphemeris moonEphem( spEphemeris, JPLEphemeris::Moon );
+    JPLGeocentricEphemeris moonEphem( spEphemeris, JPLEphemeris::Moon,
+                                      pCursor );
     Point3D moonPos = GetMoonApparentPlace( julianDay, moonEphem,
                                             nutAndPrecMatrix );
     return  Equatorial( moonPos );
@@ -148,19 +347,25 @@ LunarEquatorialPosition( double julianDay,
 //-----------------------------------------------------------------------------
 
 Equatorial 
-LunarEquatorialPosition( double julianDay )
+LunarEquatorialPosition( double julianDay, ReductionContext & context )
 {
-    shared_ptr< JPLEphemeris > spEphemeris
-            = JPLEphemeris::GetEphemeris( julianDay );
-    Assert( spEphemeris );
-    Matrix3D nutAndPrecMatrix;
 #ifdef DEBUG
-    bool nutPrecRslt =
+    bool setRslt =
 #endif
-            GetNutPrecAndObliquity( julianDay, &nutAndPrecMatrix,
-                                    0, spEphemeris );
-    Assert( nutPrecRslt );
-    return  LunarEquatorialPosition( julianDay, nutAndPrecMatrix, spEphemeris );
+            context.Set( julianDay );
+    Assert( setRslt );
+    return  LunarEquatorialPosition( julianDay, context.NutAndPrecMatrix(),
+                                     context.Ephemeris(),
+                                     context.EphemerisCursor() );
+}
+
+//.............................................................................
+
+Equatorial 
+LunarEquatorialPosition( double julianDay )
+{
+    ReductionContext context;
+    return  LunarEquatorialPosition( julianDay, context );
 }
 
 //=============================================================================
@@ -172,12 +377,14 @@ PlanetEquatorialPosition( double julianDay,
                           const Point3D & earthHeliocentric,
                           const Vector3D & earthBarycentricVelocity,
                           const Matrix3D & nutAndPrecMatrix,
-                          shared_ptr< JPLEphemeris > spEphemeris )
+                          shared_ptr< JPLEphemeris > spEphemeris,
+                          JPLEphemeris::Cursor * pCursor )
 {
     Assert( body != SolarSystem::Earth );
     JPLEphemeris::EBody jplBody = JPLEphemeris::SolarSystemToJPLBody( body );
-    JPLBarycentricEphemeris bodyEphem( spEphemeris, jplBody );
-    JPLBarycentricEphemeris sunEphem( spEphemeris, JPLEphemeris::Sun );
+    JPLBarycentricEphemeris bodyEphem( spEphemeris, jplBody, pCursor );
+    JPLBarycentricEphemeris sunEphem( spEphemeris, JPLEphemeris::Sun,
+                                      pCursor );
     Point3D bodyPos = GetApparentPlace( julianDay, bodyEphem, sunEphem,
                                         earthBarycentric, earthHeliocentric,
                                         earthBarycentricVelocity,
@@ -188,41 +395,31 @@ PlanetEquatorialPosition( double julianDay,
 //-----------------------------------------------------------------------------
 
 Equatorial 
-PlanetEquatorialPosition( double julianDay,
-                          SolarSystem::EBody body )
+PlanetEquatorialPosition( double julianDay, SolarSystem::EBody body,
+                          ReductionContext & context )
 {
-    shared_ptr< JPLEphemeris > spEphemeris
-            = JPLEphemeris::GetEphemeris( julianDay );
-    Assert( spEphemeris );
-    Point3D earthBarycentric;
-    Vector3D earthBarycentricVelocity;
-#ifdef DEBUG
-    bool earthRslt =
-#endif
-            GetEarthBarycentric( julianDay, &earthBarycentric,
-                                 &earthBarycentricVelocity, spEphemeris );
-    Assert( earthRslt );
-    Point3D sunBarycentric;
 #ifdef DEBUG
-    bool sunRslt =
+    bool setRslt =
 #endif
-            spEphemeris->GetBodyPosition( julianDay, JPLEphemeris::Sun,
-                                          JPLEphemeris::SolarSystemBarycenter,
-                                          &sunBarycentric );
-    Assert( sunRslt );
-    Point3D earthHeliocentric = Translate( earthBarycentric, sunBarycentric );
-    Matrix3D nutAndPrecMatrix;
-#ifdef DEBUG
-    bool nutPrecRslt =
-#endif
-            GetNutPrecAndObliquity( julianDay, &nutAndPrecMatrix,
-                                    0, spEphemeris );
-    Assert( nutPrecRslt );
-    return  PlanetEquatorialPosition( julianDay, body, earthBarycentric,
-                                      earthHeliocentric,
-                                      earthBarycentricVelocity,
-                                      nutAndPrecMatrix,
-                                      spEphemeris );
+            context.Set( julianDay );
+    Assert( setRslt );
+    return  PlanetEquatorialPosition( julianDay, body,
+                                      context.EarthBarycentric(),
+                                      context.EarthHeliocentric(),
+                                      context.EarthBarycentricVelocity(),
+                                      context.NutAndPrecMatrix(),
+                                      context.Ephemeris(),
+                                      context.EphemerisCursor() );
+}
+
+//.............................................................................
+
+Equatorial 
+PlanetEquatorialPosition( double julianDay,
+                          SolarSystem::EBody body )
+{
+    ReductionContext context;
+    return  PlanetEquatorialPosition( julianDay, body, context );
 }
 
 //=============================================================================
@@ -233,9 +430,11 @@ SolarLongitude( double julianDay,
                 const Vector3D & earthBarycentricVelocity,
                 const Matrix3D & nutAndPrecMatrix,
                 Angle obliquity, 
-                shared_ptr< JPLEphemeris > spEphemeris )
+                shared_ptr< JPLEphemeris > spEphemeris,
+                JPLEphemeris::Cursor * pCursor )
 {
-    JPLBarycentricEphemeris sunEphem( spEphemeris, JPLEphemeris::Sun );
+    JPLBarycentricEphemeris sunEphem( spEphemeris, JPLEphemeris::Sun,
+                                      pCursor );
     Point3D sunPos = GetSunApparentPlace( julianDay, sunEphem,
                                           earthBarycentric,
                                           earthBarycentricVelocity,
@@ -246,31 +445,27 @@ SolarLongitude( double julianDay,
 //:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 Angle
-SolarLongitude( double julianDay )
+SolarLongitude( double julianDay, ReductionContext & context )
 {
-    shared_ptr< JPLEphemeris > spEphemeris
-            = JPLEphemeris::GetEphemeris( julianDay );
-    if ( spEphemeris == 0 )
+    if ( ! context.Set( julianDay ) )
         return Angle( 0. ); //!!!
-    Point3D earthBarycentric;
-    Vector3D earthBarycentricVelocity;
-    Matrix3D nutAndPrecMatrix;
-    Angle obliquity;
-#ifdef DEBUG
-    bool earthRslt =
-#endif
-            GetEarthBarycentric( julianDay, &earthBarycentric,
-                                 &earthBarycentricVelocity, spEphemeris );
-    Assert( earthRslt );
-#ifdef DEBUG
-    bool oblRslt =
-#endif
-            GetNutPrecAndObliquity( julianDay, &nutAndPrecMatrix,
-                                    &obliquity, spEphemeris );
-    Assert( oblRslt );
-    return SolarLongitude( julianDay,
-                           earthBarycentric, earthBarycentricVelocity,
-                           nutAndPrecMatrix, obliquity, spEphemeris );
+    return SolarLongitude( julianDay, context.EarthBarycentric(),
+                           context.EarthBarycentricVelocity(),
+                           context.NutAndPrecMatrix(),
+                           context.TrueObliquity(), context.Ephemeris(),
+                           context.EphemerisCursor() );
+}
+
+//.............................................................................
+
+Angle
+SolarLongitude( double julianDay )
+{
+    const ChebyshevFit * pFit = s_registeredFits[ SolarLongitudeFit ].Get( );
+    if ( pFit && pFit->Covers( julianDay ) )
+        return FittedAngle( pFit, julianDay );
+    ReductionContext context;
+    return SolarLongitude( julianDay, context );
 }
 
 //=============================================================================
@@ -296,9 +491,11 @@ Angle
 LunarLongitude( double julianDay, 
                 const Matrix3D & nutAndPrecMatrix,
                 Angle obliquity, 
-                shared_ptr< JPLEphemeris > spEphemeris )
+                shared_ptr< JPLEphemeris > spEphemeris,
+                JPLEphemeris::Cursor * pCursor )
 {
-    JPLGeocentricEphemeris moonEphem( spEphemeris, JPLEphemeris::Moon );
+    JPLGeocentricEphemeris moonEphem( spEphemeris, JPLEphemeris::Moon,
+                                      pCursor );
     Point3D moonPos = GetMoonApparentPlace( julianDay, moonEphem,
                                             nutAndPrecMatrix );
     return EclipticalLongitude( moonPos, obliquity );
@@ -306,73 +503,272 @@ LunarLongitude( double julianDay,
 
 //-----------------------------------------------------------------------------
 
+Angle
+LunarLongitude( double julianDay, ReductionContext & context )
+{
+    if ( ! context.Set( julianDay ) )
+        return Angle( 0. ); //!!!
+    return LunarLongitude( julianDay, context.NutAndPrecMatrix(),
+                           context.TrueObliquity(), context.Ephemeris(),
+                           context.EphemerisCursor() );
+}
+
+//-----------------------------------------------------------------------------
+
 Angle 
-LunarPhase( double julianDay )
+LunarPhase( double julianDay, ReductionContext & context )
 {
-    shared_ptr< JPLEphemeris > spEphemeris
-            = JPLEphemeris::GetEphemeris( julianDay );
-    if ( spEphemeris == 0 )
+    if ( ! context.Set( julianDay ) )
         return Angle( 0. ); //!!!
-    Point3D earthBarycentric;
-    Vector3D earthBarycentricVelocity;
-    Matrix3D nutAndPrecMatrix;
-    Angle obliquity;
-#ifdef DEBUG
-    bool earthRslt =
-#endif
-            GetEarthBarycentric( julianDay, &earthBarycentric,
-                                 &earthBarycentricVelocity, spEphemeris );
-    Assert( earthRslt );
-#ifdef DEBUG
-    bool oblRslt =
-#endif
-            GetNutPrecAndObliquity( julianDay, &nutAndPrecMatrix,
-                                    &obliquity, spEphemeris );
-    Assert( oblRslt );
-    Angle solarLong = SolarLongitude( julianDay, earthBarycentric,
-                                     earthBarycentricVelocity,
-                                     nutAndPrecMatrix, obliquity, spEphemeris );
-    Angle lunarLong = LunarLongitude( julianDay,
-                                     nutAndPrecMatrix, obliquity, spEphemeris );
+    Angle solarLong = SolarLongitude( julianDay, context );
+    Angle lunarLong = LunarLongitude( julianDay, context );
     Angle phase = lunarLong - solarLong;
     return phase;
 }
 
+//.............................................................................
+
+Angle 
+LunarPhase( double julianDay )
+{
+    const ChebyshevFit * pFit = s_registeredFits[ LunarPhaseFit ].Get( );
+    if ( pFit && pFit->Covers( julianDay ) )
+        return FittedAngle( pFit, julianDay );
+    ReductionContext context;
+    return LunarPhase( julianDay, context );
+}
+
 //-----------------------------------------------------------------------------
 
 Angle 
-LunarArcOfLight( double julianDay )
+LunarArcOfLight( double julianDay, ReductionContext & context )
 {
-    shared_ptr< JPLEphemeris > spEphemeris
-            = JPLEphemeris::GetEphemeris( julianDay );
-    if ( spEphemeris == 0 )
+    if ( ! context.Set( julianDay ) )
         return Angle( 0. ); //!!!
-    Point3D earthBarycentric;
-    Vector3D earthBarycentricVelocity;
-    Matrix3D nutAndPrecMatrix;
+    Equatorial solarPos = SolarEquatorialPosition( julianDay, context );
+    Equatorial lunarPos = LunarEquatorialPosition( julianDay, context );
+    Angle diffRA = lunarPos.RightAscension() - solarPos.RightAscension();
+    Angle diffDec = lunarPos.Declination() - solarPos.Declination();
+    return ArcCos( diffRA.Cos( ) * diffDec.Cos( ) );
+}
+
+//.............................................................................
+
+Angle 
+LunarArcOfLight( double julianDay )
+{
+    ReductionContext context;
+    return LunarArcOfLight( julianDay, context );
+}
+
+//=============================================================================
+
+bool
+SolarLongitudeRate( double julianDay, ReductionContext & context,
+                    double * pRate )
+{
+    Assert( pRate );
+    if ( ! context.Set( julianDay ) )
+        return false;
+    Point3D sunBarycentric;
+    Vector3D sunBarycentricVelocity;
 #ifdef DEBUG
-    bool earthRslt =
+    bool sunRslt =
 #endif
-            GetEarthBarycentric( julianDay, &earthBarycentric,
-                                 &earthBarycentricVelocity, spEphemeris );
-    Assert( earthRslt );
+            context.Ephemeris()->GetBodyPosition( context.EphemerisCursor(),
+                                           julianDay, JPLEphemeris::Sun,
+                                           JPLEphemeris::SolarSystemBarycenter,
+                                           &sunBarycentric,
+                                           &sunBarycentricVelocity );
+    Assert( sunRslt );
+    Matrix3D equatToEclipt
+            = EquatorialToEclipticalMatrix( context.TrueObliquity() )
+            * context.NutAndPrecMatrix();
+    *pRate = LongitudeRate( sunBarycentric - context.EarthBarycentric(),
+                            sunBarycentricVelocity
+                            - context.EarthBarycentricVelocity(),
+                            equatToEclipt );
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool
+LunarLongitudeRate( double julianDay, ReductionContext & context,
+                    double * pRate )
+{
+    Assert( pRate );
+    if ( ! context.Set( julianDay ) )
+        return false;
+    Point3D moonGeocentric;
+    Vector3D moonGeocentricVelocity;
 #ifdef DEBUG
-    bool oblRslt =
+    bool moonRslt =
 #endif
-            GetNutPrecAndObliquity( julianDay, &nutAndPrecMatrix,
-                                    0, spEphemeris );
-    Assert( oblRslt );
-    Equatorial solarPos = SolarEquatorialPosition( julianDay,
-                                                   earthBarycentric,
-                                                   earthBarycentricVelocity,
-                                                   nutAndPrecMatrix,
-                                                   spEphemeris );
-    Equatorial lunarPos = LunarEquatorialPosition( julianDay,
-                                                   nutAndPrecMatrix,
-                                                   spEphemeris );
-    Angle diffRA = lunarPos.RightAscension() - solarPos.RightAscension();
-    Angle diffDec = lunarPos.Declination() - solarPos.Declination();
-    return ArcCos( diffRA.Cos( ) * diffDec.Cos( ) );
+            context.Ephemeris()->GetBodyPosition( context.EphemerisCursor(),
+                                                  julianDay,
+                                                  JPLEphemeris::Moon,
+                                                  JPLEphemeris::Earth,
+                                                  &moonGeocentric,
+                                                  &moonGeocentricVelocity );
+    Assert( moonRslt );
+    Matrix3D equatToEclipt
+            = EquatorialToEclipticalMatrix( context.TrueObliquity() )
+            * context.NutAndPrecMatrix();
+    *pRate = LongitudeRate( moonGeocentric.ToVector(),
+                            moonGeocentricVelocity, equatToEclipt );
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool
+LunarPhaseRate( double julianDay, ReductionContext & context,
+                double * pRate )
+{
+    Assert( pRate );
+    double lunarRate;
+    double solarRate;
+    if ( ! (LunarLongitudeRate( julianDay, context, &lunarRate )
+            && SolarLongitudeRate( julianDay, context, &solarRate )) )
+        return false;
+    *pRate = lunarRate - solarRate;
+    return true;
+}
+
+//=============================================================================
+
+shared_ptr< ChebyshevFit >
+FitSolarLongitude( double firstJulianDay, double lastJulianDay,
+                   double tolerance, ThreadPool * pPool )
+{
+    return FitAngle( SolarLongitudeFunc( ), firstJulianDay, lastJulianDay,
+                     tolerance, pPool );
+}
+
+//-----------------------------------------------------------------------------
+
+shared_ptr< ChebyshevFit >
+FitLunarPhase( double firstJulianDay, double lastJulianDay,
+               double tolerance, ThreadPool * pPool )
+{
+    return FitAngle( LunarPhaseFunc( ), firstJulianDay, lastJulianDay,
+                     tolerance, pPool );
+}
+
+//-----------------------------------------------------------------------------
+
+shared_ptr< ChebyshevFit >
+RegisterSolarLongitudeFit( shared_ptr< ChebyshevFit > spFit )
+{
+    return RegisterFit( SolarLongitudeFit, spFit );
+}
+
+//-----------------------------------------------------------------------------
+
+shared_ptr< ChebyshevFit >
+RegisterLunarPhaseFit( shared_ptr< ChebyshevFit > spFit )
+{
+    return RegisterFit( LunarPhaseFit, spFit );
+}
+
+//-----------------------------------------------------------------------------
+
+const ChebyshevFit *
+RegisteredSolarLongitudeFit( )
+{
+    return s_registeredFits[ SolarLongitudeFit ].Get( );
+}
+
+//-----------------------------------------------------------------------------
+
+const ChebyshevFit *
+RegisteredLunarPhaseFit( )
+{
+    return s_registeredFits[ LunarPhaseFit ].Get( );
+}
+
+//=============================================================================
+
+bool
+GetApparentPositions( double julianDay,
+                      const SolarSystem::EBody * bodies, int count,
+                      Equatorial * pEquatorial, Ecliptical * pEcliptical,
+                      ReductionContext & context )
+{
+    if ( ! context.Set( julianDay ) )
+        return false;
+    const JPLEphemeris * pEphemeris = context.Ephemeris().get();
+    JPLEphemeris::Cursor * pCursor = context.EphemerisCursor();
+    ExtrapolatedPosition sunEphem( pEphemeris, pCursor, JPLEphemeris::Sun,
+                                   JPLEphemeris::SolarSystemBarycenter,
+                                   s_sunMaxExtrapolation );
+    if ( ! sunEphem.Evaluate( julianDay ) )
+        return false;
+    const Point3D & earthBarycentric = context.EarthBarycentric();
+    const Vector3D & earthBarycentricVelocity
+            = context.EarthBarycentricVelocity();
+    const Point3D earthHeliocentric = Translate( earthBarycentric,
+                                                 sunEphem( julianDay ) );
+    const Matrix3D & nutAndPrecMatrix = context.NutAndPrecMatrix();
+    Matrix3D equatToEclipt;
+    if ( pEcliptical )
+        equatToEclipt = EquatorialToEclipticalMatrix( context.TrueObliquity() );
+
+    for ( int i = 0; i < count; ++i )
+    {
+        SolarSystem::EBody body = bodies[ i ];
+        Assert( body != SolarSystem::Earth );
+        Point3D bodyPos;
+        if ( body == SolarSystem::Sun )
+        {
+            bodyPos = GetSunApparentPlace( julianDay, sunEphem,
+                                           earthBarycentric,
+                                           earthBarycentricVelocity,
+                                           nutAndPrecMatrix );
+        }
+        else if ( body == SolarSystem::Moon )
+        {
+            ExtrapolatedPosition moonEphem( pEphemeris, pCursor,
+                                            JPLEphemeris::Moon,
+                                            JPLEphemeris::Earth,
+                                            s_bodyMaxExtrapolation );
+            if ( ! moonEphem.Evaluate( julianDay ) )
+                return false;
+            bodyPos = GetMoonApparentPlace( julianDay, moonEphem,
+                                            nutAndPrecMatrix );
+        }
+        else
+        {
+            ExtrapolatedPosition bodyEphem( pEphemeris, pCursor,
+                                 JPLEphemeris::SolarSystemToJPLBody( body ),
+                                 JPLEphemeris::SolarSystemBarycenter,
+                                 s_bodyMaxExtrapolation );
+            if ( ! bodyEphem.Evaluate( julianDay ) )
+                return false;
+            bodyPos = GetApparentPlace( julianDay, bodyEphem, sunEphem,
+                                        earthBarycentric, earthHeliocentric,
+                                        earthBarycentricVelocity,
+                                        nutAndPrecMatrix );
+        }
+        if ( pEquatorial )
+            pEquatorial[ i ] = Equatorial( bodyPos );
+        if ( pEcliptical )
+            pEcliptical[ i ] = Ecliptical( equatToEclipt * bodyPos );
+    }
+    return true;
+}
+
+//.............................................................................
+
+bool
+GetApparentPositions( double julianDay,
+                      const SolarSystem::EBody * bodies, int count,
+                      Equatorial * pEquatorial, Ecliptical * pEcliptical )
+{
+    ReductionContext context;
+    return GetApparentPositions( julianDay, bodies, count,
+                                 pEquatorial, pEcliptical, context );
 }
 
 //=============================================================================
@@ -393,7 +789,112 @@ TestAstroPhenomena( )
     bool ok = true;
     cout << "Testing AstroPhenomena" << endl;
 
-    //!!!
+    double jd = 2451545.25;
+    if ( JPLEphemeris::GetEphemeris( jd ) )
+    {
+        cout << "GetApparentPositions( " << jd << ", ... )" << endl;
+        const SolarSystem::EBody bodies[]
+                = { SolarSystem::Sun, SolarSystem::Moon, SolarSystem::Mercury,
+                    SolarSystem::Venus, SolarSystem::Mars,
+                    SolarSystem::Jupiter, SolarSystem::Saturn,
+                    SolarSystem::Uranus, SolarSystem::Neptune,
+                    SolarSystem::Pluto };
+        const int numBodies = sizeof( bodies ) / sizeof( bodies[0] );
+        Equatorial equatorial[ numBodies ];
+        Ecliptical ecliptical[ numBodies ];
+        ReductionContext context;
+        TESTCHECK( GetApparentPositions( jd, bodies, numBodies,
+                                         equatorial, ecliptical, context ),
+                   true, &ok );
+        for ( int i = 0; i < numBodies; ++i )
+        {
+            Equatorial expected;
+            if ( bodies[i] == SolarSystem::Sun )
+                expected = SolarEquatorialPosition( jd, context );
+            else if ( bodies[i] == SolarSystem::Moon )
+                expected = LunarEquatorialPosition( jd, context );
+            else
+                expected = PlanetEquatorialPosition( jd, bodies[i], context );
+            //Agreement to about 1 milliarcsecond.
+            TESTCHECKFE( equatorial[i].RightAscension().Radians(),
+                         expected.RightAscension().Radians(), &ok, 5.e-9 );
+            TESTCHECKFE( equatorial[i].Declination().Radians(),
+                         expected.Declination().Radians(), &ok, 5.e-9 );
+            TESTCHECKFE( equatorial[i].Distance(), expected.Distance(),
+                         &ok, 1.e-8 );
+        }
+        //The longitudes may differ in range, so compare the difference.
+        Angle solarDiff = ecliptical[0].Longitude()
+                - SolarLongitude( jd, context );
+        solarDiff.Normalize( );
+        TESTCHECKFE( solarDiff.Radians(), 0., &ok, 5.e-9 );
+        Angle lunarDiff = ecliptical[1].Longitude()
+                - LunarLongitude( jd, context );
+        lunarDiff.Normalize( );
+        TESTCHECKFE( lunarDiff.Radians(), 0., &ok, 5.e-9 );
+
+        //Compare with differences of the apparent longitudes.
+        const double h = 0.01;
+        double solarRate = (SolarLongitude( jd + h, context )
+                            - SolarLongitude( jd - h, context )).Radians()
+                / (2. * h);
+        double rate = 0.;
+        TESTCHECK( SolarLongitudeRate( jd, context, &rate ), true, &ok );
+        TESTCHECKFE( rate, solarRate, &ok, 1.e-3 );
+        double lunarRate = (LunarLongitude( jd + h, context )
+                            - LunarLongitude( jd - h, context )).Radians()
+                / (2. * h);
+        TESTCHECK( LunarLongitudeRate( jd, context, &rate ), true, &ok );
+        TESTCHECKFE( rate, lunarRate, &ok, 1.e-3 );
+        TESTCHECK( LunarPhaseRate( jd, context, &rate ), true, &ok );
+        TESTCHECKFE( rate, lunarRate - solarRate, &ok, 1.e-3 );
+        //Outside the ephemeris, the rates are not available.
+        TESTCHECK( LunarPhaseRate( 0., context, &rate ), false, &ok );
+
+        double first = jd;
+        double last = jd + 60.;
+        shared_ptr< ChebyshevFit > spSolarFit
+                = FitSolarLongitude( first, last );
+        shared_ptr< ChebyshevFit > spPhaseFit = FitLunarPhase( first, last );
+        //Over 60 days, these need only a few intervals.
+        TESTCHECK( spSolarFit->NumIntervals( ) <= 8, true, &ok );
+        TESTCHECK( spPhaseFit->NumIntervals( ) <= 16, true, &ok );
+        shared_ptr< ChebyshevFit > spPrevSolarFit
+                = RegisterSolarLongitudeFit( spSolarFit );
+        shared_ptr< ChebyshevFit > spPrevPhaseFit
+                = RegisterLunarPhaseFit( spPhaseFit );
+        TESTCHECK( RegisteredSolarLongitudeFit( ),
+                   (const ChebyshevFit *) spSolarFit.get(), &ok );
+        TESTCHECK( RegisteredLunarPhaseFit( ),
+                   (const ChebyshevFit *) spPhaseFit.get(), &ok );
+        double maxSolarError = 0.;
+        double maxPhaseError = 0.;
+        for ( int i = 0; i < 200; ++i )
+        {
+            double day = first  +  i * 0.2999;
+            maxSolarError = max( maxSolarError,
+                                 fabs( (SolarLongitude( day )
+                                        - SolarLongitude( day, context ))
+                                       .Radians() ) );
+            maxPhaseError = max( maxPhaseError,
+                                 fabs( (LunarPhase( day )
+                                        - LunarPhase( day, context ))
+                                       .Radians() ) );
+        }
+        TESTCHECK( maxSolarError < 2.e-9, true, &ok );
+        TESTCHECK( maxPhaseError < 2.e-9, true, &ok );
+        //Restore the previous fits, so later tests use the live functions.
+        RegisterSolarLongitudeFit( spPrevSolarFit );
+        RegisterLunarPhaseFit( spPrevPhaseFit );
+        TESTCHECK( RegisteredSolarLongitudeFit( ),
+                   (const ChebyshevFit *) spPrevSolarFit.get(), &ok );
+        TESTCHECK( RegisteredLunarPhaseFit( ),
+                   (const ChebyshevFit *) spPrevPhaseFit.get(), &ok );
+        double phaseRate;
+        spPhaseFit->Evaluate( jd, &phaseRate );
+        LunarPhaseRate( jd, context, &rate );
+        TESTCHECKFE( phaseRate, rate, &ok, 1.e-3 );
+    }
 
     if ( ok )
         cout << "AstroPhenomena PASSED." << endl << endl;
@@ -6,6 +6,50 @@
 
   Routines fundamental to computing times and circumstances of astronomical
   phenomena such as seasons, lunar phases, conjunctions, and oppositions.
+  NOTES:
+  1. The functions that take only a Julian Day compute the Earth's position,
+     the nutation-and-precession matrix, and the obliquity afresh on each
+     call. The versions taking a ReductionContext share these among calls
+     for the same or (with interpolation) nearby instants. (See
+     ReductionContext.hpp.)
+  2. GetApparentPositions() computes the apparent places of several bodies
+     (not including the Earth) at one instant, filling the pEquatorial and/or
+     pEcliptical arrays (either may be null) in the order of bodies. The
+     Earth's position, the nutation-and-precession matrix, the obliquity, and
+     the Sun's position and velocity are obtained once for all the bodies.
+     Within each body's light-time iteration, positions are extrapolated
+     linearly from the last ephemeris evaluation, so each planet needs only
+     two ephemeris evaluations, and the Moon one; the resulting errors are
+     under a milliarcsecond. All of the evaluations use the context's
+     JPLEphemeris::Cursor. It returns false if the ephemeris does not cover
+     the date or does not include one of the bodies.
+  3. The functions taking a shared_ptr< JPLEphemeris > also take an optional
+     JPLEphemeris::Cursor. If one is given, the ephemeris is evaluated through
+     it, using the thread-safe functions. (See JPLEphemeris.hpp, Note 11.)
+     The versions taking a ReductionContext use the context's cursor, so they
+     may be called concurrently from different threads, each with its own
+     context. The versions taking only a Julian Day create a context for each
+     call, so they are thread-safe as well.
+  4. SolarLongitudeRate(), LunarLongitudeRate(), and LunarPhaseRate() set
+     *pRate to the rates of change, in radians per day, of SolarLongitude(),
+     LunarLongitude(), and LunarPhase(). They are computed from the geometric
+     positions and velocities given by the ephemeris, neglecting the slow
+     changes in light-time and aberration, so they are good to a few parts in
+     10^4: adequate for Newton's method, not for differencing. They return
+     false, leaving *pRate unchanged, if the ephemeris does not cover
+     julianDay.
+  5. FitSolarLongitude() and FitLunarPhase() fit piecewise Chebyshev
+     polynomials (see ChebyshevFit.hpp) to SolarLongitude() and LunarPhase(),
+     in radians, over a range of Julian days, to within tolerance radians.
+     They throw a RuntimeError unless the registered ephemerides cover the
+     range. Once a fit is registered with RegisterSolarLongitudeFit() or
+     RegisterLunarPhaseFit(), the versions of SolarLongitude() and
+     LunarPhase() taking only a Julian Day evaluate it instead, wherever it
+     covers the date; that is what the calendars call. As with
+     EventTable::Register(), registration is atomic, and the fits registered
+     are kept until the program ends. The registration functions return the
+     fit replaced, if any, and registering a null pointer unregisters the
+     fit. The versions taking a ReductionContext always compute afresh.
 */
 
 
@@ -13,7 +57,9 @@
 #include "Point3.hpp"
 #include "Matrix3.hpp"
 #include "Equatorial.hpp"
+#include "Ecliptical.hpp"
 #include "SolarSystem.hpp"
+#include "JPLEphemeris.hpp"
 #include "Logger.hpp"
 #include <tr1/memory>
 
@@ -24,7 +70,9 @@ namespace EpsilonDelta
 //*****************************************************************************
 
 
-class JPLEphemeris;
+class ReductionContext;
+class ChebyshevFit;
+class ThreadPool;
 
 
 //=============================================================================
@@ -33,22 +81,30 @@ class JPLEphemeris;
 bool GetEarthBarycentric( double julianDay,
                           Point3D * pEarthBarycentric,
                           Vector3D * pEarthBarycentricVelocity,
-                          std::tr1::shared_ptr< JPLEphemeris > spEphemeris );
+                          std::tr1::shared_ptr< JPLEphemeris > spEphemeris,
+                          JPLEphemeris::Cursor * pCursor = 0 );
 bool GetNutPrecAndObliquity( double julianDay,
                              Matrix3D * pNutAndPrecMatrix,
                              Angle * pTrueObliquity, 
-                             std::tr1::shared_ptr< JPLEphemeris > spEphemeris );
+                             std::tr1::shared_ptr< JPLEphemeris > spEphemeris,
+                             JPLEphemeris::Cursor * pCursor = 0 );
 
 Equatorial SolarEquatorialPosition( double julianDay,
                              const Point3D & earthBarycentric,
                              const Vector3D & earthBarycentricVelocity,
                              const Matrix3D & nutAndPrecMatrix,
-                             std::tr1::shared_ptr< JPLEphemeris > spEphemeris );
+                             std::tr1::shared_ptr< JPLEphemeris > spEphemeris,
+                             JPLEphemeris::Cursor * pCursor = 0 );
+Equatorial SolarEquatorialPosition( double julianDay,
+                                    ReductionContext & context );
 Equatorial SolarEquatorialPosition( double julianDay );
                                     
 Equatorial LunarEquatorialPosition( double julianDay,
                              const Matrix3D & nutAndPrecMatrix,
-                             std::tr1::shared_ptr< JPLEphemeris > spEphemeris );
+                             std::tr1::shared_ptr< JPLEphemeris > spEphemeris,
+                             JPLEphemeris::Cursor * pCursor = 0 );
+Equatorial LunarEquatorialPosition( double julianDay,
+                                    ReductionContext & context );
 Equatorial LunarEquatorialPosition( double julianDay );
 
 Equatorial PlanetEquatorialPosition( double julianDay,
@@ -57,7 +113,11 @@ Equatorial PlanetEquatorialPosition( double julianDay,
                              const Point3D & earthHeliocentric,
                              const Vector3D & earthBarycentricVelocity,
                              const Matrix3D & nutAndPrecMatrix,
-                             std::tr1::shared_ptr< JPLEphemeris > spEphemeris );
+                             std::tr1::shared_ptr< JPLEphemeris > spEphemeris,
+                             JPLEphemeris::Cursor * pCursor = 0 );
+Equatorial PlanetEquatorialPosition( double julianDay,
+                                     SolarSystem::EBody body,
+                                     ReductionContext & context );
 Equatorial PlanetEquatorialPosition( double julianDay,
                                      SolarSystem::EBody body );
                                      
@@ -66,17 +126,52 @@ Angle SolarLongitude( double julianDay,
                       const Vector3D & earthBarycentricVelocity,
                       const Matrix3D & nutAndPrecMatrix,
                       Angle obliquity, 
-                      std::tr1::shared_ptr< JPLEphemeris > spEphemeris );
+                      std::tr1::shared_ptr< JPLEphemeris > spEphemeris,
+                      JPLEphemeris::Cursor * pCursor = 0 );
+Angle SolarLongitude( double julianDay, ReductionContext & context );
 Angle SolarLongitude( double julianDay );
 Angle MeanSolarLongitude( double julianDay );
 
 Angle LunarLongitude( double julianDay, 
                       const Matrix3D & nutAndPrecMatrix,
                       Angle obliquity, 
-                      std::tr1::shared_ptr< JPLEphemeris > spEphemeris );
+                      std::tr1::shared_ptr< JPLEphemeris > spEphemeris,
+                      JPLEphemeris::Cursor * pCursor = 0 );
+Angle LunarLongitude( double julianDay, ReductionContext & context );
+Angle LunarPhase( double julianDay, ReductionContext & context );
 Angle LunarPhase( double julianDay );
+Angle LunarArcOfLight( double julianDay, ReductionContext & context );
 Angle LunarArcOfLight( double julianDay );
 
+bool SolarLongitudeRate( double julianDay, ReductionContext & context,
+                         double * pRate );
+bool LunarLongitudeRate( double julianDay, ReductionContext & context,
+                         double * pRate );
+bool LunarPhaseRate( double julianDay, ReductionContext & context,
+                     double * pRate );
+
+std::tr1::shared_ptr< ChebyshevFit > FitSolarLongitude(
+    double firstJulianDay, double lastJulianDay, double tolerance = 1.e-9,
+    ThreadPool * pPool = 0 );
+std::tr1::shared_ptr< ChebyshevFit > FitLunarPhase(
+    double firstJulianDay, double lastJulianDay, double tolerance = 1.e-9,
+    ThreadPool * pPool = 0 );
+std::tr1::shared_ptr< ChebyshevFit > RegisterSolarLongitudeFit(
+    std::tr1::shared_ptr< ChebyshevFit > spFit );
+std::tr1::shared_ptr< ChebyshevFit > RegisterLunarPhaseFit(
+    std::tr1::shared_ptr< ChebyshevFit > spFit );
+const ChebyshevFit * RegisteredSolarLongitudeFit( );
+const ChebyshevFit * RegisteredLunarPhaseFit( );
+
+bool GetApparentPositions( double julianDay,
+                           const SolarSystem::EBody * bodies, int count,
+                           Equatorial * pEquatorial, Ecliptical * pEcliptical,
+                           ReductionContext & context );
+bool GetApparentPositions( double julianDay,
+                           const SolarSystem::EBody * bodies, int count,
+                           Equatorial * pEquatorial,
+                           Ecliptical * pEcliptical = 0 );
+
 Logger & AstroPhenomenaLog( );
 
 #ifdef DEBUG
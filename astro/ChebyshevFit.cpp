@@ -0,0 +1,367 @@
+/*
+  ChebyshevFit.cpp
+  Copyright (C) 2011 David M. Anderson
+
+  ChebyshevFit class: a piecewise Chebyshev approximation to a smooth scalar
+  function (e.g. of the Julian day) over a range, fitted to a tolerance,
+  which may be saved to a file and memory-mapped.
+*/
+
+
+#include "ChebyshevFit.hpp"
+#include "MappedFileReader.hpp"
+#include "FileException.hpp"
+#include "StringUtil.hpp"
+#include "StdInt.hpp"
+#include <cstring>
+#include <cmath>
+#ifdef DEBUG
+#include "FileReader.hpp"
+#include "FileWriter.hpp"
+#include "TestCheck.hpp"
+#include <cstdio>
+#include <iostream>
+#endif
+using namespace std;
+using namespace std::tr1;
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+namespace
+{                                                                   //namespace
+
+const char s_magic[ 8 ] = { 'E', 'D', 'C', 'H', 'E', 'B', 'F', 'T' };
+const uint32_t s_byteOrderMark = 0x01020304;
+const int s_alignment = 64;
+
+}                                                                   //namespace
+
+
+//*****************************************************************************
+
+
+ChebyshevFit::ChebyshevFit( )
+{
+    Clear( );
+}
+
+//-----------------------------------------------------------------------------
+
+ChebyshevFit::ChebyshevFit( shared_ptr< Reader > spReader )
+{
+    Load( spReader );
+}
+
+//-----------------------------------------------------------------------------
+
+void
+ChebyshevFit::Clear( )
+{
+    m_first = m_last = 0.;
+    m_intervalLength = 0.;
+    m_period = 0.;
+    m_maxError = 0.;
+    m_numIntervals = 0;
+    m_numCoefficients = 0;
+    m_coefficients = 0;
+    m_ownedCoefficients.clear( );
+    m_spReader.reset( );
+}
+
+//=============================================================================
+
+double
+ChebyshevFit::Node( int index, int numCoefficients )
+{
+    return cos( M_PI * (index + 0.5) / numCoefficients );
+}
+
+//-----------------------------------------------------------------------------
+
+double
+ChebyshevFit::FitInterval( double * pSamples, int numCoefficients,
+                           double period, double * pCoefficients )
+{
+    if ( period != 0. )
+        for ( int k = 1; k < numCoefficients; ++k )
+            pSamples[k] += period * floor( (pSamples[k - 1] - pSamples[k])
+                                           / period  +  0.5 );
+    for ( int j = 0; j < numCoefficients; ++j )
+    {
+        double sum = 0.;
+        for ( int k = 0; k < numCoefficients; ++k )
+            sum += pSamples[k] * cos( M_PI * j * (k + 0.5) / numCoefficients );
+        pCoefficients[j] = 2. * sum / numCoefficients;
+    }
+    pCoefficients[0] *= 0.5;
+    //The coefficients of a smooth function fall off rapidly, so the last two
+    // bound the error of the interpolation.
+    return fabs( pCoefficients[ numCoefficients - 1 ] )
+            + fabs( pCoefficients[ numCoefficients - 2 ] );
+}
+
+//=============================================================================
+
+void
+ChebyshevFit::Load( shared_ptr< Reader > spReader )
+{
+    Assert( spReader );
+    Clear( );
+    char magic[ sizeof( s_magic ) ];
+    spReader->Seek( 0 );
+    spReader->Read( magic, sizeof( magic ) );
+    if ( memcmp( magic, s_magic, sizeof( magic ) ) != 0 )
+        throw FileException( "Not a Chebyshev fit file." );
+    uint32_t formatVersion;
+    spReader->Read( &formatVersion );
+    uint32_t byteOrderMark;
+    spReader->Read( &byteOrderMark );
+    if ( byteOrderMark != s_byteOrderMark )
+        throw FileException( "Chebyshev fit file has the wrong byte order." );
+    if ( formatVersion != FormatVersion )
+        throw FileException( "Unsupported Chebyshev fit file version "
+                             + IntToString( formatVersion ) + "." );
+    int32_t numIntervals, numCoefficients, dataOffset;
+    spReader->Read( &numIntervals );
+    spReader->Read( &numCoefficients );
+    spReader->Read( &dataOffset );
+    double first, last, period, maxError;
+    spReader->Read( &first );
+    spReader->Read( &last );
+    spReader->Read( &period );
+    spReader->Read( &maxError );
+    if ( (numIntervals <= 0) || (numIntervals > MaxIntervals)
+         || (numCoefficients < 3) || (numCoefficients > MaxCoefficients)
+         || ! (last > first)
+         || (dataOffset % (int) sizeof( double ) != 0)
+         || (spReader->Seek( 0, RandomAccess::End )
+             < dataOffset + (int) (numIntervals * numCoefficients
+                                   * sizeof( double ))) )
+        throw FileException( "Unable to read Chebyshev fit file header." );
+
+    shared_ptr< MappedFileReader > spMapped
+            = dynamic_pointer_cast< MappedFileReader >( spReader );
+    if ( spMapped )
+    {
+        m_coefficients = reinterpret_cast< const double * >( spMapped->Data()
+                                                             + dataOffset );
+        m_spReader = spReader;
+    }
+    else
+    {
+        m_ownedCoefficients.resize( numIntervals * numCoefficients );
+        spReader->Seek( dataOffset );
+        spReader->Read( reinterpret_cast< char * >( &m_ownedCoefficients[0] ),
+                        numIntervals * numCoefficients
+                        * (int) sizeof( double ) );
+        m_coefficients = &m_ownedCoefficients[0];
+    }
+    m_first = first;
+    m_last = last;
+    m_intervalLength = (last - first) / numIntervals;
+    m_period = period;
+    m_maxError = maxError;
+    m_numIntervals = numIntervals;
+    m_numCoefficients = numCoefficients;
+}
+
+//-----------------------------------------------------------------------------
+
+void
+ChebyshevFit::Write( Writer & writer ) const
+{
+    Assert( m_numIntervals > 0 );
+    const int headerSize = (int) sizeof( s_magic )
+            + 2 * (int) sizeof( uint32_t )
+            + 3 * (int) sizeof( int32_t )
+            + 4 * (int) sizeof( double );
+    int dataOffset = ((headerSize + s_alignment - 1) / s_alignment)
+            * s_alignment;
+
+    writer.Write( s_magic, (int) sizeof( s_magic ) );
+    writer.Write( (uint32_t) FormatVersion );
+    writer.Write( s_byteOrderMark );
+    writer.Write( (int32_t) m_numIntervals );
+    writer.Write( (int32_t) m_numCoefficients );
+    writer.Write( (int32_t) dataOffset );
+    writer.Write( m_first );
+    writer.Write( m_last );
+    writer.Write( m_period );
+    writer.Write( m_maxError );
+    vector< char > padding( dataOffset - headerSize + 1, 0 );
+    writer.Write( &padding[0], dataOffset - headerSize );
+    writer.Write( reinterpret_cast< const char * >( m_coefficients ),
+                  m_numIntervals * m_numCoefficients * (int) sizeof( double ) );
+}
+
+//=============================================================================
+
+bool
+ChebyshevFit::Mapped( ) const
+{
+    return bool( m_spReader );
+}
+
+//=============================================================================
+
+double
+ChebyshevFit::Evaluate( double x, double * pDerivative ) const
+{
+    Assert( Covers( x ) );
+    int index = (int) floor( (x - m_first) / m_intervalLength );
+    if ( index >= m_numIntervals )
+        index = m_numIntervals - 1;
+    else if ( index < 0 )
+        index = 0;
+    double u = 2. * (x - m_first - index * m_intervalLength)
+            / m_intervalLength  -  1.;
+    const double * c = m_coefficients  +  index * m_numCoefficients;
+    int n = m_numCoefficients;
+    //Clenshaw's recurrence for Sum c_j T_j(u).
+    double twoU = 2. * u;
+    double b1 = 0.;
+    double b2 = 0.;
+    for ( int j = n - 1; j > 0; --j )
+    {
+        double b0 = twoU * b1  -  b2  +  c[j];
+        b2 = b1;
+        b1 = b0;
+    }
+    if ( pDerivative )
+    {
+        //T_j' = j U_{j-1}, so the derivative is Sum (j+1) c_{j+1} U_j(u).
+        double d1 = 0.;
+        double d2 = 0.;
+        for ( int j = n - 2; j >= 0; --j )
+        {
+            double d0 = twoU * d1  -  d2  +  (j + 1) * c[ j + 1 ];
+            d2 = d1;
+            d1 = d0;
+        }
+        *pDerivative = d1 * 2. / m_intervalLength;
+    }
+    return  u * b1  -  b2  +  c[0];
+}
+
+
+//=============================================================================
+
+
+#ifdef DEBUG
+
+namespace
+{                                                                   //namespace
+
+double
+TestFunction( double x )
+{
+    return sin( x )  +  0.3 * x  +  0.01 * x * x;
+}
+
+//.............................................................................
+
+struct TestAngleFunction
+{
+    double operator()( double x ) const
+    {
+        double angle = fmod( 1.1 * x  +  0.2 * sin( 3. * x ), 2. * M_PI );
+        return (angle > M_PI)  ?  angle - 2. * M_PI  :  angle;
+    }
+};
+
+}                                                                   //namespace
+
+//-----------------------------------------------------------------------------
+
+bool
+ChebyshevFit::Test( const string & testDirectory )
+{
+    bool ok = true;
+    cout << "Testing ChebyshevFit" << endl;
+
+    ThreadPool pool( 4 );
+    ChebyshevFit fit;
+    TESTCHECK( fit.Covers( 0. ), false, &ok );
+    fit.Fit( TestFunction, -10., 90., 1.e-12, 0., DefaultNumCoefficients,
+             &pool );
+    TESTCHECK( fit.First( ), -10., &ok );
+    TESTCHECK( fit.Last( ), 90., &ok );
+    TESTCHECK( fit.Mapped( ), false, &ok );
+    TESTCHECK( fit.MaxError( ) <= 1.e-12, true, &ok );
+    //128 intervals of 12 coefficients suffice for this smooth function.
+    TESTCHECK( fit.NumIntervals( ) <= 128, true, &ok );
+    double maxError = 0.;
+    double maxDerivError = 0.;
+    for ( int i = 0; i <= 1000; ++i )
+    {
+        double x = -10.  +  i * 0.1;
+        double deriv;
+        double value = fit.Evaluate( x, &deriv );
+        maxError = max( maxError, fabs( value - TestFunction( x ) ) );
+        maxDerivError = max( maxDerivError,
+                             fabs( deriv
+                                   - (cos( x )  +  0.3  +  0.02 * x) ) );
+    }
+    TESTCHECK( maxError < 1.e-12, true, &ok );
+    TESTCHECK( maxDerivError < 1.e-9, true, &ok );
+
+    ChebyshevFit angleFit;
+    TestAngleFunction angleFunction;
+    angleFit.Fit( angleFunction, 0., 50., 1.e-10, 2. * M_PI, 14, &pool );
+    TESTCHECK( angleFit.Period( ), 2. * M_PI, &ok );
+    maxError = 0.;
+    for ( int i = 0; i <= 997; ++i )
+    {
+        double x = i * 0.05013;
+        double diff = angleFit.Evaluate( x ) - angleFunction( x );
+        diff -= 2. * M_PI * floor( diff / (2. * M_PI)  +  0.5 );
+        maxError = max( maxError, fabs( diff ) );
+    }
+    TESTCHECK( maxError < 1.e-10, true, &ok );
+
+    string fitFileName = testDirectory + "angle.fit";
+    {
+        FileWriter writer( fitFileName );
+        angleFit.Write( writer );
+    }
+    {
+        ChebyshevFit mappedFit( shared_ptr< Reader >(
+                                    new MappedFileReader( fitFileName ) ) );
+        ChebyshevFit readFit( shared_ptr< Reader >(
+                                  new FileReader( fitFileName ) ) );
+        TESTCHECK( mappedFit.Mapped( ), true, &ok );
+        TESTCHECK( readFit.Mapped( ), false, &ok );
+        TESTCHECK( mappedFit.NumIntervals( ), angleFit.NumIntervals( ), &ok );
+        TESTCHECK( readFit.Last( ), angleFit.Last( ), &ok );
+        TESTCHECK( readFit.Period( ), angleFit.Period( ), &ok );
+        int numErrors = 0;
+        for ( int i = 0; i <= 997; ++i )
+        {
+            double x = i * 0.05013;
+            double value = angleFit.Evaluate( x );
+            if ( (mappedFit.Evaluate( x ) != value)
+                 || (readFit.Evaluate( x ) != value) )
+                ++numErrors;
+        }
+        TESTCHECK( numErrors, 0, &ok );
+    }
+    remove( fitFileName.c_str() );
+
+    if ( ok )
+        cout << "ChebyshevFit PASSED." << endl << endl;
+    else
+        cout << "ChebyshevFit FAILED." << endl << endl;
+    return ok;
+}
+
+#endif //DEBUG
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
@@ -0,0 +1,294 @@
+#ifndef CHEBYSHEVFIT_HPP
+#define CHEBYSHEVFIT_HPP
+/*
+  ChebyshevFit.hpp
+  Copyright (C) 2011 David M. Anderson
+
+  ChebyshevFit class: a piecewise Chebyshev approximation to a smooth scalar
+  function (e.g. of the Julian day) over a range, fitted to a tolerance,
+  which may be saved to a file and memory-mapped.
+  NOTES:
+  1. Fit() divides [first, last] into equal intervals, interpolates the
+     function at the Chebyshev nodes of each interval, and halves the
+     intervals until the estimated error, from the last two coefficients,
+     is within tolerance everywhere. It throws a ConvergenceException if
+     that takes more than MaxIntervals intervals (e.g. because the function
+     is noisier than the tolerance).
+  2. The function should be a function or function object of the form
+     double function( double x ).
+     The intervals are fitted in parallel, as tasks in pPool (or in a
+     temporary ThreadPool, if it is null), each with its own copy of the
+     function, so it must be safe to call concurrently.
+  3. If period is not 0, the function is taken to be an angle or the like,
+     determined only up to multiples of period, and its values within each
+     interval are adjusted by multiples of period to make them continuous.
+     Evaluate() then returns a value that may differ from the function's by
+     a multiple of period. Each interval must be short enough that the
+     function changes by less than half a period between nodes, which the
+     halving ensures.
+  4. Evaluate() uses Clenshaw's recurrence: with the default 12
+     coefficients, about 50 floating-point operations, and as many again
+     for the derivative, if pDerivative is not null. x must be within
+     [First(), Last()].
+  5. Write() writes a file with a fixed header followed by the coefficients,
+     as doubles in native byte order, aligned to 64 bytes. As with
+     EventTable, if the Reader given to Load() (or the constructor) is a
+     MappedFileReader, the coefficients are used in place; otherwise they are
+     read into memory. A file of the other byte order is rejected with a
+     FileException.
+*/
+
+
+#include "ThreadPool.hpp"
+#include "ConvergenceException.hpp"
+#include "Reader.hpp"
+#include "Writer.hpp"
+#include "Assert.hpp"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <tr1/memory>
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+class ChebyshevFit
+{
+public:
+    ChebyshevFit( );
+    explicit ChebyshevFit( std::tr1::shared_ptr< Reader > spReader );
+
+    template < typename Function >
+    void Fit( Function function, double first, double last,
+              double tolerance, double period = 0.,
+              int numCoefficients = DefaultNumCoefficients,
+              ThreadPool * pPool = 0 );
+    void Load( std::tr1::shared_ptr< Reader > spReader );
+    void Write( Writer & writer ) const;
+
+    double First( ) const;
+    double Last( ) const;
+    bool Covers( double x ) const;
+    double Period( ) const;
+    double MaxError( ) const;
+    int NumIntervals( ) const;
+    int NumCoefficients( ) const;
+    bool Mapped( ) const;
+
+    double Evaluate( double x, double * pDerivative = 0 ) const;
+
+    static const int DefaultNumCoefficients = 12;
+    static const int MaxCoefficients = 32;
+    static const int MaxIntervals = 1 << 22;
+    static const int FormatVersion = 1;
+
+#ifdef DEBUG
+    static bool Test( const std::string & testDirectory );
+#endif
+
+private:
+    ChebyshevFit( const ChebyshevFit & );
+    ChebyshevFit & operator=( const ChebyshevFit & );
+
+    void Clear( );
+    static double Node( int index, int numCoefficients );
+    static double FitInterval( double * pSamples, int numCoefficients,
+                               double period, double * pCoefficients );
+
+    template < typename Function >
+    class FitTask
+        :   public ThreadPool::Task
+    {
+    public:
+        FitTask( Function function, double first, double intervalLength,
+                 int numCoefficients, double period,
+                 std::vector< double > & coefficients,
+                 std::vector< double > & errors );
+
+        virtual void operator()( int index );
+
+    private:
+        //Undefined, to avoid warning:
+        FitTask & operator=( const FitTask & );
+
+        Function m_function;
+        double m_first;
+        double m_intervalLength;
+        int m_numCoefficients;
+        double m_period;
+        std::vector< double > & m_coefficients;
+        std::vector< double > & m_errors;
+    };
+
+    double m_first;
+    double m_last;
+    double m_intervalLength;
+    double m_period;
+    double m_maxError;
+    int m_numIntervals;
+    int m_numCoefficients;
+    const double * m_coefficients;
+    std::vector< double > m_ownedCoefficients;
+    std::tr1::shared_ptr< Reader > m_spReader;
+};
+
+
+//*****************************************************************************
+
+
+template < typename Function >
+void
+ChebyshevFit::Fit( Function function, double first, double last,
+                   double tolerance, double period, int numCoefficients,
+                   ThreadPool * pPool )
+{
+    Assert( last > first );
+    Assert( tolerance > 0. );
+    Assert( (numCoefficients >= 3) && (numCoefficients <= MaxCoefficients) );
+    ThreadPool * pRunPool = pPool;
+    std::tr1::shared_ptr< ThreadPool > spTempPool;
+    if ( ! pRunPool )
+    {
+        spTempPool.reset( new ThreadPool );
+        pRunPool = spTempPool.get();
+    }
+    for ( int numIntervals = 1; numIntervals <= MaxIntervals;
+          numIntervals *= 2 )
+    {
+        double intervalLength = (last - first) / numIntervals;
+        std::vector< double > coefficients( numIntervals * numCoefficients );
+        std::vector< double > errors( numIntervals );
+        FitTask< Function > task( function, first, intervalLength,
+                                  numCoefficients, period,
+                                  coefficients, errors );
+        pRunPool->Run( task, numIntervals );
+        double maxError = *std::max_element( errors.begin(), errors.end() );
+        if ( maxError <= tolerance )
+        {
+            Clear( );
+            m_first = first;
+            m_last = last;
+            m_intervalLength = intervalLength;
+            m_period = period;
+            m_maxError = maxError;
+            m_numIntervals = numIntervals;
+            m_numCoefficients = numCoefficients;
+            m_ownedCoefficients.swap( coefficients );
+            m_coefficients = &m_ownedCoefficients[0];
+            return;
+        }
+    }
+    throw ConvergenceException( "ChebyshevFit::Fit: Tolerance not reached." );
+}
+
+//=============================================================================
+
+template < typename Function >
+ChebyshevFit::FitTask< Function >::FitTask( Function function, double first,
+                                            double intervalLength,
+                                            int numCoefficients,
+                                            double period,
+                                    std::vector< double > & coefficients,
+                                    std::vector< double > & errors )
+    :   m_function( function ),
+        m_first( first ),
+        m_intervalLength( intervalLength ),
+        m_numCoefficients( numCoefficients ),
+        m_period( period ),
+        m_coefficients( coefficients ),
+        m_errors( errors )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+template < typename Function >
+void
+ChebyshevFit::FitTask< Function >::operator()( int index )
+{
+    Function function = m_function;
+    double start = m_first  +  index * m_intervalLength;
+    double samples[ MaxCoefficients ];
+    for ( int k = 0; k < m_numCoefficients; ++k )
+        samples[k] = function( start  +  0.5 * m_intervalLength
+                               * (1.  +  Node( k, m_numCoefficients )) );
+    m_errors[ index ] = FitInterval( samples, m_numCoefficients, m_period,
+                                     &m_coefficients[ index
+                                                      * m_numCoefficients ] );
+}
+
+
+//*****************************************************************************
+
+
+inline
+double
+ChebyshevFit::First( ) const
+{
+    return m_first;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+double
+ChebyshevFit::Last( ) const
+{
+    return m_last;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+bool
+ChebyshevFit::Covers( double x ) const
+{
+    return ( (m_numIntervals > 0) && (x >= m_first) && (x <= m_last) );
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+double
+ChebyshevFit::Period( ) const
+{
+    return m_period;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+double
+ChebyshevFit::MaxError( ) const
+{
+    return m_maxError;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+int
+ChebyshevFit::NumIntervals( ) const
+{
+    return m_numIntervals;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+int
+ChebyshevFit::NumCoefficients( ) const
+{
+    return m_numCoefficients;
+}
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
+
+#endif //CHEBYSHEVFIT_HPP
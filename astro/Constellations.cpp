@@ -10,6 +10,10 @@
 #include "Precession.hpp"
 #include "Array.hpp"
 #include "Assert.hpp"
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cmath>
 #ifdef DEBUG
 #include <iostream>
 #include "TestCheck.hpp"
@@ -853,6 +857,128 @@ BoundaryDatum s_boundaryData[]
       Angle( -90.0000, Angle::Degree ), Octans }
 };
 
+//=============================================================================
+
+/* The boundary data are searched in order, and the first box containing the
+   position wins. BoundaryIndex precomputes the result of that search: the
+   distinct lower declinations divide the sky into bands, and within each
+   band the boxes that reach down to it divide the right ascensions into
+   segments, each belonging to one constellation. A lookup is then two binary
+   searches.
+*/
+
+class BoundaryIndex
+{
+public:
+    BoundaryIndex( );
+
+    Constellation Find( double ra, double dec ) const;  //radians, B1875
+
+private:
+    struct Band
+    {
+        double decLower;
+        vector< double > raLower;      //start of each segment
+        vector< Constellation > constellations;
+    };
+
+    struct DecGreater
+    {
+        bool operator()( const Band & band, double dec ) const
+        {
+            return band.decLower > dec;
+        }
+    };
+
+    vector< Band > m_bands;    //by decreasing decLower
+};
+
+//-----------------------------------------------------------------------------
+
+BoundaryIndex::BoundaryIndex( )
+{
+    const int numBoundaries = ARRAY_LENGTH( s_boundaryData );
+    vector< double > decs;
+    for ( int i = 0; i < numBoundaries; ++i )
+        decs.push_back( s_boundaryData[ i ].decLower.Radians() );
+    sort( decs.begin(), decs.end(), greater< double >() );
+    decs.erase( unique( decs.begin(), decs.end() ), decs.end() );
+    m_bands.resize( decs.size() );
+
+    for ( int b = 0; b < (int)decs.size(); ++b )
+    {
+        Band & band = m_bands[ b ];
+        band.decLower = decs[ b ];
+        vector< const BoundaryDatum * > boxes;
+        vector< double > breaks( 1, 0. );
+        breaks.push_back( 2. * M_PI );
+        for ( int i = 0; i < numBoundaries; ++i )
+        {
+            const BoundaryDatum & bndry = s_boundaryData[ i ];
+            if ( bndry.decLower.Radians() <= band.decLower )
+            {
+                boxes.push_back( &bndry );
+                breaks.push_back( bndry.raLower.Radians() );
+                breaks.push_back( bndry.raUpper.Radians() );
+            }
+        }
+        sort( breaks.begin(), breaks.end() );
+        breaks.erase( unique( breaks.begin(), breaks.end() ),
+                      breaks.end() );
+        //Every box either contains or excludes each elementary segment.
+        for ( int j = 0; j + 1 < (int)breaks.size(); ++j )
+        {
+            Constellation constellation = NumConstellations;
+            for ( int k = 0; k < (int)boxes.size(); ++k )
+                if ( (boxes[ k ]->raLower.Radians() <= breaks[ j ])
+                     && (breaks[ j + 1 ] <= boxes[ k ]->raUpper.Radians()) )
+                {
+                    constellation = boxes[ k ]->constellation;
+                    break;
+                }
+            if ( band.constellations.empty()
+                 || (constellation != band.constellations.back()) )
+            {
+                band.raLower.push_back( breaks[ j ] );
+                band.constellations.push_back( constellation );
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+Constellation
+BoundaryIndex::Find( double ra, double dec ) const
+{
+    vector< Band >::const_iterator pBand
+            = lower_bound( m_bands.begin(), m_bands.end(), dec,
+                                DecGreater() );
+    if ( pBand == m_bands.end() )
+        return NumConstellations;
+    if ( (ra < 0.) || (ra >= 2. * M_PI) )
+    {
+        ra = fmod( ra, 2. * M_PI );
+        if ( ra < 0. )
+            ra += 2. * M_PI;
+    }
+    int seg = (int)(upper_bound( pBand->raLower.begin(),
+                                      pBand->raLower.end(), ra )
+                    - pBand->raLower.begin()) - 1;
+    Assert( seg >= 0 );
+    return pBand->constellations[ seg ];
+}
+
+//.............................................................................
+
+const BoundaryIndex s_boundaryIndex;
+
+//=============================================================================
+
+//Positions are precessed in blocks, so that the matrix multiplication runs
+// over arrays and can be vectorized by the compiler.
+const int s_precessionBlockSize = 256;
+
 
 //-----------------------------------------------------------------------------
 }                                                                   //namespace
@@ -878,17 +1004,74 @@ GetConstellation( Equatorial equatorialPos, double epoch )
         equatorial1875 = equatorialPos;
     else
         equatorial1875 = Precession( B1875, epoch ).Reduce( equatorialPos );
-    Angle ra = equatorial1875.RightAscension();
-    Angle dec = equatorial1875.Declination();
-    for ( int i = 0; i < ARRAY_LENGTH( s_boundaryData ); ++i )
+    Constellation constellation
+            = s_boundaryIndex.Find( equatorial1875.RightAscension().Radians(),
+                                    equatorial1875.Declination().Radians() );
+    Assert( (constellation != NumConstellations) && "No constellation found" );
+    return constellation;
+}
+
+//-----------------------------------------------------------------------------
+
+void
+GetConstellations( const Equatorial * equatorialPositions, int count,
+                   double epoch, Constellation * pConstellations )
+{
+    if ( epoch == B1875 )
+    {
+        for ( int i = 0; i < count; ++i )
+        {
+            const Equatorial & equat = equatorialPositions[ i ];
+            pConstellations[ i ]
+                    = s_boundaryIndex.Find( equat.RightAscension().Radians(),
+                                            equat.Declination().Radians() );
+            Assert( pConstellations[ i ] != NumConstellations );
+        }
+        return;
+    }
+    const Matrix3D precessionMatrix = Precession( B1875, epoch ).Matrix( );
+    const double m00 = precessionMatrix( 0, 0 );
+    const double m01 = precessionMatrix( 0, 1 );
+    const double m02 = precessionMatrix( 0, 2 );
+    const double m10 = precessionMatrix( 1, 0 );
+    const double m11 = precessionMatrix( 1, 1 );
+    const double m12 = precessionMatrix( 1, 2 );
+    const double m20 = precessionMatrix( 2, 0 );
+    const double m21 = precessionMatrix( 2, 1 );
+    const double m22 = precessionMatrix( 2, 2 );
+    double x[ s_precessionBlockSize ];
+    double y[ s_precessionBlockSize ];
+    double z[ s_precessionBlockSize ];
+    double x1[ s_precessionBlockSize ];
+    double y1[ s_precessionBlockSize ];
+    double z1[ s_precessionBlockSize ];
+    for ( int start = 0; start < count; start += s_precessionBlockSize )
     {
-        BoundaryDatum & bndry = s_boundaryData[ i ];
-        if ( (bndry.decLower <= dec)
-             && (bndry.raLower <= ra) && (ra < bndry.raUpper) )
-            return bndry.constellation;
+        int n = min( count - start, s_precessionBlockSize );
+        for ( int i = 0; i < n; ++i )
+        {
+            const Equatorial & equat = equatorialPositions[ start + i ];
+            double cosDec = equat.Declination().Cos( );
+            x[ i ] = cosDec * equat.RightAscension().Cos( );
+            y[ i ] = cosDec * equat.RightAscension().Sin( );
+            z[ i ] = equat.Declination().Sin( );
+        }
+        for ( int i = 0; i < n; ++i )
+        {
+            x1[ i ] = m00 * x[ i ]  +  m01 * y[ i ]  +  m02 * z[ i ];
+            y1[ i ] = m10 * x[ i ]  +  m11 * y[ i ]  +  m12 * z[ i ];
+            z1[ i ] = m20 * x[ i ]  +  m21 * y[ i ]  +  m22 * z[ i ];
+        }
+        for ( int i = 0; i < n; ++i )
+        {
+            double ra = atan2( y1[ i ], x1[ i ] );
+            double dec = atan2( z1[ i ],
+                                     sqrt( x1[ i ] * x1[ i ]
+                                                +  y1[ i ] * y1[ i ] ) );
+            pConstellations[ start + i ] = s_boundaryIndex.Find( ra, dec );
+            Assert( pConstellations[ start + i ] != NumConstellations );
+        }
     }
-    Assert( 0 && "No constellation found" );
-    return NumConstellations;
 }
 
 //=============================================================================
@@ -945,6 +1128,70 @@ TestConstellations( )
                 = GetConstellationInfo( constellation );
         TESTCHECK( constInfo.Abbrev(), datum.constAbbrev, &ok );
     }
+
+    cout << "GetConstellations( ... )" << endl;
+    const int numTestData = ARRAY_LENGTH( s_testData );
+    vector< Equatorial > positions;
+    vector< Constellation > expected;
+    for ( int i = 0; i < numTestData; ++i )
+    {
+        TestDatum & datum = s_testData[ i ];
+        positions.push_back( Equatorial( Angle( AngleHMS( datum.raH ) ),
+                                     Angle( datum.decD, Angle::Degree ) ) );
+        expected.push_back( GetConstellation( positions.back(),
+                                              datum.epoch ) );
+    }
+    vector< Constellation > constellations( positions.size() );
+    GetConstellations( &positions[0], (int)positions.size(), B1950,
+                       &constellations[0] );
+    TESTCHECK( (constellations == expected), true, &ok );
+    //More positions than one precession block, at J2000, B1875, and B1950.
+    positions.clear( );
+    for ( int i = 0; i < 1000; ++i )
+    {
+        Angle ra( 0.737 * i, Angle::Degree );
+        Angle dec( asin( 0.0019 * i - 0.9495 ) );
+        positions.push_back( Equatorial( ra, dec ) );
+    }
+    const double epochs[ 3 ] = { J2000, B1875, B1950 };
+    for ( int e = 0; e < 3; ++e )
+    {
+        cout << "GetConstellations( positions, " << positions.size()
+             << ", " << epochs[ e ] << " )" << endl;
+        constellations.resize( positions.size() );
+        GetConstellations( &positions[0], (int)positions.size(), epochs[ e ],
+                           &constellations[0] );
+        int numErrors = 0;
+        for ( int i = 0; i < (int)positions.size(); ++i )
+            if ( constellations[ i ]
+                 != GetConstellation( positions[ i ], epochs[ e ] ) )
+                ++numErrors;
+        TESTCHECK( numErrors, 0, &ok );
+    }
+
+    cout << "Index vs. linear search of boundaries" << endl;
+    const int numBoundaries = ARRAY_LENGTH( s_boundaryData );
+    int mismatches = 0;
+    for ( double decD = -89.75; decD < 90.; decD += 0.5 )
+        for ( double raD = 0.125; raD < 360.; raD += 0.25 )
+        {
+            Angle ra( raD, Angle::Degree );
+            Angle dec( decD, Angle::Degree );
+            Constellation linear = NumConstellations;
+            for ( int i = 0; i < numBoundaries; ++i )
+            {
+                BoundaryDatum & bndry = s_boundaryData[ i ];
+                if ( (bndry.decLower <= dec)
+                     && (bndry.raLower <= ra) && (ra < bndry.raUpper) )
+                {
+                    linear = bndry.constellation;
+                    break;
+                }
+            }
+            if ( GetConstellation( Equatorial( ra, dec ), B1875 ) != linear )
+                ++mismatches;
+        }
+    TESTCHECK( mismatches, 0, &ok );
     
     if ( ok )
         cout << "Constellations PASSED." << endl << endl;
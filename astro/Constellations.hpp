@@ -6,7 +6,15 @@
 
   The constellations in the sky.
   NOTES:
-  
+  1. GetConstellation() identifies the constellation containing a position,
+     using the boundaries as defined for B1875. The boundary table is indexed
+     once, at static initialization, by declination band and right ascension,
+     so each lookup takes two binary searches.
+  2. GetConstellations() does the same for an array of positions at a common
+     epoch. The precession matrix is computed once and applied to the
+     positions in blocks, rather than reducing each position separately.
+     Apart from positions within rounding error of a boundary, the results are
+     the same as from GetConstellation().
 */
 
 
@@ -143,6 +151,8 @@ const ConstellationInfo & GetConstellationInfo( Constellation constellation );
 
 
 Constellation GetConstellation( Equatorial equatorialPos, double epoch );
+void GetConstellations( const Equatorial * equatorialPositions, int count,
+                        double epoch, Constellation * pConstellations );
 
 #ifdef DEBUG
 bool TestConstellations( );
@@ -87,6 +87,23 @@ Point3D GetApparentPlace( double julianDay,
     return starGeocentric;
 }
 
+//-----------------------------------------------------------------------------
+
+Point3D GetApparentPlace( const Point3D & starBarycentric,
+                          const Vector3D & starVelocity,
+                          const ReductionContext & context,
+                          double epoch )
+{
+    Assert( context.Ephemeris() );
+    return GetApparentPlace( context.JulianDay(),
+                             starBarycentric, starVelocity,
+                             context.EarthBarycentric(),
+                             context.EarthHeliocentric(),
+                             context.EarthBarycentricVelocity(),
+                             context.NutAndPrecMatrix(),
+                             epoch );
+}
+
 //=============================================================================
 
 Point3D 
@@ -66,6 +66,11 @@
      ephemeris time (e.g., TDB).
   7. No correction is made for atmospheric refraction in any of these
      reductions.
+  8. The apparent-place routines that take a ReductionContext use the Julian
+     Day for which the context was last Set(), and the Earth's position and
+     velocity and the nutation-and-precession matrix that it holds. (See
+     ReductionContext.hpp.) When several bodies are reduced for the same
+     instant, these are computed only once.
 */
 
 
@@ -73,6 +78,8 @@
 #include "Matrix3.hpp"
 #include "AstroConst.hpp"
 #include "Epoch.hpp"
+#include "ReductionContext.hpp"
+#include "Assert.hpp"
 #include <tr1/memory>
 
 
@@ -197,6 +204,21 @@ Point3D GetApparentPlace( double julianDay,
                           const Matrix3D & nutAndPrecMatrix, 
                           double epoch = J2000 );
 
+//Using a ReductionContext (see Note 8):
+template < typename SunBaryFunc >
+Point3D GetSunApparentPlace( SunBaryFunc sunBaryFunc,
+                             const ReductionContext & context );
+template < typename MoonGeoFunc >
+Point3D GetMoonApparentPlace( MoonGeoFunc moonGeoFunc,
+                              const ReductionContext & context );
+template < typename BodyBaryFunc, typename SunBaryFunc >
+Point3D GetApparentPlace( BodyBaryFunc bodyBaryFunc, SunBaryFunc sunBaryFunc,
+                          const ReductionContext & context );
+Point3D GetApparentPlace( const Point3D & starBarycentric,
+                          const Vector3D & starVelocity,
+                          const ReductionContext & context,
+                          double epoch = J2000 );
+
 //Underlying reduction routines: (Correction for light-time is made in the
 // GetAstrometricPlace() functions.)
 Point3D CorrectForLightDeflection( const Point3D & bodyGeocentric,
@@ -590,6 +612,47 @@ GetApparentPlace( double julianDay0, double julianDay1,
     return bodyGeocentric;
 }
 
+//=============================================================================
+
+template < typename SunBaryFunc >
+Point3D 
+GetSunApparentPlace( SunBaryFunc sunBaryFunc,
+                     const ReductionContext & context )
+{
+    Assert( context.Ephemeris() );
+    return GetSunApparentPlace( context.JulianDay(), sunBaryFunc,
+                                context.EarthBarycentric(),
+                                context.EarthBarycentricVelocity(),
+                                context.NutAndPrecMatrix() );
+}
+
+//-----------------------------------------------------------------------------
+
+template < typename MoonGeoFunc >
+Point3D 
+GetMoonApparentPlace( MoonGeoFunc moonGeoFunc,
+                      const ReductionContext & context )
+{
+    Assert( context.Ephemeris() );
+    return GetMoonApparentPlace( context.JulianDay(), moonGeoFunc,
+                                 context.NutAndPrecMatrix() );
+}
+
+//-----------------------------------------------------------------------------
+
+template < typename BodyBaryFunc, typename SunBaryFunc >
+Point3D 
+GetApparentPlace( BodyBaryFunc bodyBaryFunc, SunBaryFunc sunBaryFunc,
+                  const ReductionContext & context )
+{
+    Assert( context.Ephemeris() );
+    return GetApparentPlace( context.JulianDay(), bodyBaryFunc, sunBaryFunc,
+                             context.EarthBarycentric(),
+                             context.EarthHeliocentric(),
+                             context.EarthBarycentricVelocity(),
+                             context.NutAndPrecMatrix() );
+}
+
 
 //*****************************************************************************
 
@@ -0,0 +1,277 @@
+/*
+  DirectionArray.cpp
+  Copyright (C) 2011 David M. Anderson
+
+  DirectionArray class: the directions (and distances) of many points, e.g.
+  the stars of a catalog, stored as separate arrays of the components of
+  unit vectors, for transforming from one coordinate system to another all
+  at once.
+*/
+
+
+#include "DirectionArray.hpp"
+#include "AstroCoordTransformations.hpp"
+#include "Assert.hpp"
+#include <cmath>
+#ifdef DEBUG
+#include "TestCheck.hpp"
+#include "Equatorial.hpp"
+#include "Horizontal.hpp"
+#include "Galactic.hpp"
+#include <iostream>
+#endif
+using namespace std;
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+DirectionArray::DirectionArray( )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+DirectionArray::DirectionArray( int size )
+{
+    Resize( size );
+}
+
+//=============================================================================
+
+void
+DirectionArray::Resize( int size )
+{
+    Assert( size >= 0 );
+    m_x.resize( size );
+    m_y.resize( size );
+    m_z.resize( size );
+    m_distances.resize( size, 1. );
+}
+
+//=============================================================================
+
+void
+DirectionArray::Set( const double * longitudes, const double * latitudes,
+                     int count )
+{
+    Resize( count );
+    for ( int i = 0; i < count; ++i )
+    {
+        double cosLat = cos( latitudes[i] );
+        m_x[i] = cos( longitudes[i] ) * cosLat;
+        m_y[i] = sin( longitudes[i] ) * cosLat;
+        m_z[i] = sin( latitudes[i] );
+    }
+    fill( m_distances.begin(), m_distances.end(), 1. );
+}
+
+//-----------------------------------------------------------------------------
+
+void
+DirectionArray::Get( double * longitudes, double * latitudes ) const
+{
+    int size = Size( );
+    for ( int start = 0; start < size; start += BlockSize )
+        GetSpherical( start, std::min( BlockSize, size - start ),
+                      longitudes + start, latitudes + start );
+}
+
+//-----------------------------------------------------------------------------
+
+void
+DirectionArray::GetSpherical( int start, int count,
+                              double * longitudes, double * latitudes ) const
+{
+    const double * x = X() + start;
+    const double * y = Y() + start;
+    const double * z = Z() + start;
+    for ( int i = 0; i < count; ++i )
+    {
+        double lng = atan2( y[i], x[i] );
+        longitudes[i] = (lng < 0.)  ?  lng + 2. * M_PI  :  lng;
+        latitudes[i] = atan2( z[i], sqrt( x[i] * x[i]  +  y[i] * y[i] ) );
+    }
+}
+
+//=============================================================================
+
+void
+DirectionArray::Transform( const Matrix3D & matrix,
+                           DirectionArray * pResult ) const
+{
+    Assert( pResult );
+    int size = Size( );
+    if ( pResult != this )
+    {
+        pResult->Resize( size );
+        pResult->m_distances = m_distances;
+    }
+    if ( size == 0 )
+        return;
+    const double m00 = matrix( 0, 0 ), m01 = matrix( 0, 1 ),
+            m02 = matrix( 0, 2 );
+    const double m10 = matrix( 1, 0 ), m11 = matrix( 1, 1 ),
+            m12 = matrix( 1, 2 );
+    const double m20 = matrix( 2, 0 ), m21 = matrix( 2, 1 ),
+            m22 = matrix( 2, 2 );
+    const double * x = &m_x[0];
+    const double * y = &m_y[0];
+    const double * z = &m_z[0];
+    double * rx = &pResult->m_x[0];
+    double * ry = &pResult->m_y[0];
+    double * rz = &pResult->m_z[0];
+    for ( int i = 0; i < size; ++i )
+    {
+        double xi = x[i];
+        double yi = y[i];
+        double zi = z[i];
+        rx[i] = m00 * xi  +  m01 * yi  +  m02 * zi;
+        ry[i] = m10 * xi  +  m11 * yi  +  m12 * zi;
+        rz[i] = m20 * xi  +  m21 * yi  +  m22 * zi;
+    }
+}
+
+//=============================================================================
+
+void
+DirectionArray::Refract( double pressure, double temperature )
+{
+    int size = Size( );
+    for ( int i = 0; i < size; ++i )
+    {
+        double horiz = sqrt( m_x[i] * m_x[i]  +  m_y[i] * m_y[i] );
+        double altitude = atan2( m_z[i], horiz );
+        double apparent = altitude
+                +  AtmosphericRefraction( Angle( altitude ), pressure,
+                                          temperature ).Radians();
+        if ( apparent > M_PI / 2. )
+            apparent = M_PI / 2.;
+        double newHoriz = cos( apparent );
+        if ( horiz > 0. )
+        {
+            double scale = newHoriz / horiz;
+            m_x[i] *= scale;
+            m_y[i] *= scale;
+        }
+        m_z[i] = sin( apparent );
+    }
+}
+
+
+//=============================================================================
+
+
+#ifdef DEBUG
+
+bool
+DirectionArray::Test( )
+{
+    bool ok = true;
+    cout << "Testing DirectionArray" << endl;
+
+    const int numStars = 1000;
+    vector< Equatorial > stars( numStars );
+    for ( int i = 0; i < numStars; ++i )
+        stars[i].Set( Angle( 0.0137 * i * i  +  0.1 ),
+                      Angle( asin( 0.998 * sin( 0.7 * i ) ) ),
+                      1. + 0.01 * i );
+    DirectionArray directions;
+    directions.Set( &stars[0], numStars );
+    TESTCHECK( directions.Size( ), numStars, &ok );
+
+    Angle lst( 1.234 );
+    Angle latitude( 0.68 );
+    Matrix3D equatToHoriz = EquatorialToHorizontalMatrix( lst, latitude );
+    DirectionArray horizDirections;
+    directions.Transform( equatToHoriz, &horizDirections );
+    vector< Horizontal > horizontal( numStars );
+    horizDirections.Get( &horizontal[0] );
+    vector< double > azimuths( numStars );
+    vector< double > altitudes( numStars );
+    horizDirections.Get( &azimuths[0], &altitudes[0] );
+    double maxError = 0.;
+    for ( int i = 0; i < numStars; ++i )
+    {
+        Horizontal expected = EquatorialToHorizontal( stars[i], lst,
+                                                      latitude );
+        Angle dAz = horizontal[i].Azimuth() - expected.Azimuth();
+        dAz.Normalize( );
+        maxError = max( maxError, fabs( dAz.Radians() )
+                        * expected.Altitude().Cos() );
+        maxError = max( maxError, fabs( horizontal[i].Altitude().Radians()
+                                        - expected.Altitude().Radians() ) );
+        maxError = max( maxError, fabs( horizontal[i].Distance()
+                                        - expected.Distance() ) );
+        maxError = max( maxError, fabs( azimuths[i]
+                                        - horizontal[i].Azimuth().Radians() ) );
+        maxError = max( maxError, fabs( altitudes[i]
+                                     - horizontal[i].Altitude().Radians() ) );
+    }
+    TESTCHECK( maxError < 1.e-12, true, &ok );
+
+    //In place, and via the array overloads in AstroCoordTransformations.
+    vector< Galactic > galactic( numStars );
+    EquatorialToGalactic( &stars[0], numStars, &galactic[0] );
+    directions.Transform( EquatorialToGalacticMatrix( ), &directions );
+    vector< double > longitudes( numStars );
+    vector< double > latitudes( numStars );
+    directions.Get( &longitudes[0], &latitudes[0] );
+    maxError = 0.;
+    for ( int i = 0; i < numStars; ++i )
+    {
+        Galactic expected = EquatorialToGalactic( stars[i] );
+        Angle dLong = Angle( longitudes[i] ) - expected.Longitude();
+        dLong.Normalize( );
+        maxError = max( maxError, fabs( dLong.Radians() )
+                        * expected.Latitude().Cos() );
+        maxError = max( maxError, fabs( latitudes[i]
+                                        - expected.Latitude().Radians() ) );
+        maxError = max( maxError,
+                        Separation( galactic[i], expected ).Radians() );
+    }
+    //The matrix and the spherical formulae agree to about 1.e-11.
+    TESTCHECK( maxError < 1.e-9, true, &ok );
+
+    DirectionArray sphericalDirections;
+    sphericalDirections.Set( &longitudes[0], &latitudes[0], numStars );
+    maxError = 0.;
+    for ( int i = 0; i < numStars; ++i )
+    {
+        maxError = max( maxError, fabs( sphericalDirections.X()[i]
+                                        - directions.X()[i] ) );
+        maxError = max( maxError, fabs( sphericalDirections.Z()[i]
+                                        - directions.Z()[i] ) );
+    }
+    TESTCHECK( maxError < 1.e-12, true, &ok );
+
+    vector< Horizontal > refracted( numStars );
+    EquatorialToHorizontal( &stars[0], numStars, lst, latitude,
+                            &refracted[0], true );
+    maxError = 0.;
+    for ( int i = 0; i < numStars; ++i )
+    {
+        Angle refraction = AtmosphericRefraction( horizontal[i].Altitude() );
+        maxError = max( maxError,
+                        fabs( refracted[i].Altitude().Radians()
+                              - horizontal[i].Altitude().Radians()
+                              - refraction.Radians() ) );
+    }
+    TESTCHECK( maxError < 1.e-12, true, &ok );
+
+    if ( ok )
+        cout << "DirectionArray PASSED." << endl << endl;
+    else
+        cout << "DirectionArray FAILED." << endl << endl;
+    return ok;
+}
+
+#endif //DEBUG
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
@@ -0,0 +1,183 @@
+#ifndef DIRECTIONARRAY_HPP
+#define DIRECTIONARRAY_HPP
+/*
+  DirectionArray.hpp
+  Copyright (C) 2011 David M. Anderson
+
+  DirectionArray class: the directions (and distances) of many points, e.g.
+  the stars of a catalog, stored as separate arrays of the components of
+  unit vectors, for transforming from one coordinate system to another all
+  at once.
+  NOTES:
+  1. Set() converts the positions to unit vectors once. Transform() then
+     multiplies each by a rotation matrix, such as those returned by
+     EquatorialToHorizontalMatrix(), EquatorialToEclipticalMatrix(), and
+     EquatorialToGalacticMatrix(), or the product of several. That is nine
+     multiplications and six additions per point, with no trigonometry, and
+     the loop is over plain arrays of doubles, so the compiler can
+     vectorize it. The matrix need be computed only once per instant (and
+     location), however many points there are.
+  2. So for a star field that is redrawn for each frame, build the
+     DirectionArray from the catalog once, and for each frame Transform() it
+     into a second DirectionArray with the current EquatorialToHorizontal
+     matrix. The components (X(), Y(), Z()) may be used directly for drawing,
+     or Get() used to convert to spherical coordinates.
+  3. Get() into arrays of doubles gives longitudes in [0, 2pi) and latitudes
+     in [-pi/2, pi/2], in radians. For horizontal coordinates these are the
+     azimuth and altitude. Get() into an array of Equatorial, Horizontal,
+     etc. computes these and then sets each element, with its distance.
+  4. Refract() takes the directions to be horizontal, and raises each by the
+     atmospheric refraction for its altitude; see AtmosphericRefraction() in
+     AstroCoordTransformations.hpp.
+  5. Transform() may put its result in the same DirectionArray
+     (pResult == this).
+*/
+
+
+#include "Matrix3.hpp"
+#include "Point3.hpp"
+#include "Angle.hpp"
+#include <vector>
+#include <algorithm>
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+class DirectionArray
+{
+public:
+    DirectionArray( );
+    explicit DirectionArray( int size );
+
+    void Resize( int size );
+    int Size( ) const;
+
+    template < typename T >
+    void Set( const T * positions, int count );
+    void Set( const double * longitudes, const double * latitudes, int count );
+    template < typename T >
+    void Get( T * positions ) const;
+    void Get( double * longitudes, double * latitudes ) const;
+
+    void Transform( const Matrix3D & matrix, DirectionArray * pResult ) const;
+    void Refract( double pressure = 1010., double temperature = 10. );
+
+    const double * X( ) const;
+    const double * Y( ) const;
+    const double * Z( ) const;
+    const double * Distances( ) const;
+
+#ifdef DEBUG
+    static bool Test( );
+#endif
+
+private:
+    //Spherical coordinates are computed in blocks of this many, to bound the
+    // workspace.
+    static const int BlockSize = 256;
+
+    void GetSpherical( int start, int count,
+                       double * longitudes, double * latitudes ) const;
+
+    std::vector< double > m_x;
+    std::vector< double > m_y;
+    std::vector< double > m_z;
+    std::vector< double > m_distances;
+};
+
+
+//*****************************************************************************
+
+
+inline
+int
+DirectionArray::Size( ) const
+{
+    return (int) m_x.size( );
+}
+
+//=============================================================================
+
+template < typename T >
+void
+DirectionArray::Set( const T * positions, int count )
+{
+    Resize( count );
+    for ( int i = 0; i < count; ++i )
+    {
+        Point3D rect = positions[i].Rectangular( );
+        double distance = positions[i].Distance( );
+        double scale = (distance == 0.)  ?  0.  :  1. / distance;
+        m_x[i] = rect.X() * scale;
+        m_y[i] = rect.Y() * scale;
+        m_z[i] = rect.Z() * scale;
+        m_distances[i] = distance;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+template < typename T >
+void
+DirectionArray::Get( T * positions ) const
+{
+    double longitudes[ BlockSize ];
+    double latitudes[ BlockSize ];
+    int size = Size( );
+    for ( int start = 0; start < size; start += BlockSize )
+    {
+        int count = std::min( BlockSize, size - start );
+        GetSpherical( start, count, longitudes, latitudes );
+        for ( int i = 0; i < count; ++i )
+            positions[ start + i ].Set( Angle( longitudes[i] ),
+                                        Angle( latitudes[i] ),
+                                        m_distances[ start + i ] );
+    }
+}
+
+//=============================================================================
+
+inline
+const double *
+DirectionArray::X( ) const
+{
+    return (m_x.empty()  ?  0  :  &m_x[0]);
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+const double *
+DirectionArray::Y( ) const
+{
+    return (m_y.empty()  ?  0  :  &m_y[0]);
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+const double *
+DirectionArray::Z( ) const
+{
+    return (m_z.empty()  ?  0  :  &m_z[0]);
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+const double *
+DirectionArray::Distances( ) const
+{
+    return (m_distances.empty()  ?  0  :  &m_distances[0]);
+}
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
+
+#endif //DIRECTIONARRAY_HPP
@@ -0,0 +1,191 @@
+#ifndef EVENTSEARCH_HPP
+#define EVENTSEARCH_HPP
+/*
+  EventSearch.hpp
+  Copyright (C) 2011 David M. Anderson
+
+  FindAllEvents() template function: finds all of the occurrences of an
+  astronomical event (e.g. a lunar phase or an equinox) in a range of Julian
+  days, searching parts of the range in parallel.
+  NOTES:
+  1. The NextEventFunc should be a function or function object of the form
+     bool nextEventFunc( double julianDay, double * pEventJD,
+                         double * pResumeJD );
+     It searches for the first event on or after julianDay. If it finds one,
+     it sets *pEventJD and returns true. In either case it sets *pResumeJD,
+     which must be greater than julianDay, to the day from which the search
+     for the following event is to begin.
+  2. The range [startJulianDay, endJulianDay) is divided into chunks of
+     chunkDays, which are searched independently, as tasks in a ThreadPool,
+     and the events found are merged in order. The search of each chunk
+     begins margin days before its start, for the sake of functions that can
+     return events a little before julianDay (e.g. because they search in
+     one time scale and report in another).
+     tolerance is the precision of the event times: two searches may report
+     the same event at times up to tolerance apart. So an event near the
+     boundary between two chunks might be reported by both, or by neither.
+     Each chunk therefore keeps the events up to tolerance beyond its ends
+     (but within the range), and, in merging, an event less than tolerance
+     after the one before it is taken to be the same event and dropped.
+  3. Each task works with its own copy of nextEventFunc, which must be safe
+     to call concurrently in different threads. The routines in
+     AstroPhenomena, RiseSet, MoonPhases, and Seasons are, as they use
+     separate ReductionContexts or JPLEphemeris::Cursors.
+  4. If pPool is null, a temporary ThreadPool with a thread for each
+     processor is used.
+  5. With enough chunks for the threads, the time is roughly inversely
+     proportional to the number of cores. Each chunk costs one extra search
+     (for the event before or at its start), so a chunk should span several
+     events.
+*/
+
+
+#include "ThreadPool.hpp"
+#include "Assert.hpp"
+#include <vector>
+#include <cmath>
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+template < typename NextEventFunc >
+std::vector< double > FindAllEvents( double startJulianDay,
+                                     double endJulianDay,
+                                     double chunkDays, double margin,
+                                     double tolerance,
+                                     NextEventFunc nextEventFunc,
+                                     ThreadPool * pPool = 0 );
+
+
+//*****************************************************************************
+
+
+template < typename NextEventFunc >
+class EventSearchTask
+    :   public ThreadPool::Task
+{
+public:
+    EventSearchTask( double startJulianDay, double endJulianDay,
+                     double chunkDays, double margin, double tolerance,
+                     NextEventFunc nextEventFunc,
+                     std::vector< std::vector< double > > & chunkEvents );
+
+    virtual void operator()( int index );
+
+private:
+    //Undefined, to avoid warning:
+    EventSearchTask & operator=( const EventSearchTask & );
+
+    double m_startJulianDay;
+    double m_endJulianDay;
+    double m_chunkDays;
+    double m_margin;
+    double m_tolerance;
+    NextEventFunc m_nextEventFunc;
+    std::vector< std::vector< double > > & m_chunkEvents;
+};
+
+
+//*****************************************************************************
+
+
+template < typename NextEventFunc >
+std::vector< double >
+FindAllEvents( double startJulianDay, double endJulianDay,
+               double chunkDays, double margin, double tolerance,
+               NextEventFunc nextEventFunc, ThreadPool * pPool )
+{
+    Assert( chunkDays > 0. );
+    Assert( margin >= 0. );
+    Assert( tolerance >= 0. );
+    std::vector< double > events;
+    if ( endJulianDay <= startJulianDay )
+        return events;
+    int numChunks
+            = (int) std::ceil( (endJulianDay - startJulianDay) / chunkDays );
+    std::vector< std::vector< double > > chunkEvents( numChunks );
+    EventSearchTask< NextEventFunc > task( startJulianDay, endJulianDay,
+                                           chunkDays, margin, tolerance,
+                                           nextEventFunc, chunkEvents );
+    if ( pPool )
+        pPool->Run( task, numChunks );
+    else
+    {
+        ThreadPool pool;
+        pool.Run( task, numChunks );
+    }
+    for ( int i = 0; i < numChunks; ++i )
+        for ( int j = 0; j < (int) chunkEvents[ i ].size(); ++j )
+        {
+            double eventJD = chunkEvents[ i ][ j ];
+            if ( events.empty() || (eventJD - events.back() >= tolerance) )
+                events.push_back( eventJD );
+        }
+    return events;
+}
+
+
+//=============================================================================
+
+
+template < typename NextEventFunc >
+EventSearchTask< NextEventFunc >::EventSearchTask( double startJulianDay,
+                                                   double endJulianDay,
+                                                   double chunkDays,
+                                                   double margin,
+                                                   double tolerance,
+                                                   NextEventFunc nextEventFunc,
+                    std::vector< std::vector< double > > & chunkEvents )
+    :   m_startJulianDay( startJulianDay ),
+        m_endJulianDay( endJulianDay ),
+        m_chunkDays( chunkDays ),
+        m_margin( margin ),
+        m_tolerance( tolerance ),
+        m_nextEventFunc( nextEventFunc ),
+        m_chunkEvents( chunkEvents )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+template < typename NextEventFunc >
+void
+EventSearchTask< NextEventFunc >::operator()( int index )
+{
+    //The events kept run from chunkStart to chunkEnd, which overlap the
+    // neighboring chunks by the tolerance (see Note 2).
+    double chunkStart = m_startJulianDay  +  index * m_chunkDays;
+    double chunkEnd = chunkStart  +  m_chunkDays  +  m_tolerance;
+    if ( index > 0 )
+        chunkStart -= m_tolerance;
+    if ( chunkEnd > m_endJulianDay )
+        chunkEnd = m_endJulianDay;
+    NextEventFunc nextEventFunc = m_nextEventFunc;
+    std::vector< double > & events = m_chunkEvents[ index ];
+    double jd = chunkStart - m_margin;
+    while ( jd < chunkEnd )
+    {
+        double eventJD = 0.;
+        double resumeJD = jd;
+        if ( nextEventFunc( jd, &eventJD, &resumeJD ) )
+        {
+            if ( eventJD >= chunkEnd )
+                break;
+            if ( eventJD >= chunkStart )
+                events.push_back( eventJD );
+        }
+        Assert( resumeJD > jd );
+        jd = resumeJD;
+    }
+}
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
+
+#endif //EVENTSEARCH_HPP
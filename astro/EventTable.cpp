@@ -0,0 +1,558 @@
+/*
+  EventTable.cpp
+  Copyright (C) 2011 David M. Anderson
+
+  EventTable class: a precomputed table of the times of the new moons, full
+  moons, and solar terms (including the equinoxes and solstices) over a
+  range of Julian days, which may be saved to a file and memory-mapped.
+*/
+
+
+#include "EventTable.hpp"
+#include "AstroPhenomena.hpp"
+#include "ReductionContext.hpp"
+#include "JPLEphemeris.hpp"
+#include "EventSearch.hpp"
+#include "MappedFileReader.hpp"
+#include "FileException.hpp"
+#include "ConvergenceException.hpp"
+#include "Exception.hpp"
+#include "Angle.hpp"
+#include "DivMod.hpp"
+#include "StringUtil.hpp"
+#include "StdInt.hpp"
+#include "PublishedPtr.hpp"
+#include "Mutex.hpp"
+#include "Assert.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#ifdef DEBUG
+#include "MoonPhases.hpp"
+#include "Seasons.hpp"
+#include "TimeStandards.hpp"
+#include "FileReader.hpp"
+#include "FileWriter.hpp"
+#include "TestCheck.hpp"
+#include <cstdio>
+#include <iostream>
+#endif
+using namespace std;
+using namespace std::tr1;
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+namespace
+{                                                                   //namespace
+
+const char s_magic[ 8 ] = { 'E', 'D', 'E', 'V', 'T', 'T', 'B', 'L' };
+const uint32_t s_byteOrderMark = 0x01020304;
+const int s_alignment = 64;
+
+//-----------------------------------------------------------------------------
+
+//Finds the successive times at which the lunar phase (for NewMoon and
+// FullMoon) or the solar longitude (for SolarTerm) reaches its next target
+// value, for FindAllEvents().
+
+class NextEventFunc
+{
+public:
+    NextEventFunc( EventTable::EEvent event, double lastJulianDay );
+    bool operator()( double julianDay, double * pEventJD, double * pResumeJD );
+
+private:
+    Angle Value( double julianDay );
+    double Rate( double julianDay );
+
+    EventTable::EEvent m_event;
+    double m_lastJulianDay;
+    ReductionContext m_context;
+};
+
+//.............................................................................
+
+NextEventFunc::NextEventFunc( EventTable::EEvent event,
+                              double lastJulianDay )
+    :   m_event( event ),
+        m_lastJulianDay( lastJulianDay )
+{
+}
+
+//.............................................................................
+
+bool
+NextEventFunc::operator()( double julianDay, double * pEventJD,
+                           double * pResumeJD )
+{
+    const double accuracy = 1.e-8;
+    const int maxIterations = 20;
+    bool lunar = (m_event != EventTable::SolarTerm);
+    double step = lunar  ?  (2. * M_PI)  :  (M_PI / 12.);
+    double offset = (m_event == EventTable::FullMoon)  ?  M_PI  :  0.;
+    double meanRate = lunar  ?  (2. * M_PI / 29.530588861)
+            :  (2. * M_PI / 365.2421896698);
+    Angle value = Value( julianDay );
+    double ahead = ModRP( (offset - value.Radians()), step );
+    Angle target = value + Angle( ahead );
+    double eventJD = julianDay  +  ahead / meanRate;
+    if ( eventJD > m_lastJulianDay + 1. )
+    {
+        *pResumeJD = max( eventJD, julianDay + 1. );
+        return false;
+    }
+    for ( int i = 0; i < maxIterations; ++i )
+    {
+        Angle diff = target - Value( eventJD );
+        diff.Normalize( );
+        double correction = diff.Radians() / Rate( eventJD );
+        eventJD += correction;
+        if ( std::fabs( correction ) < accuracy )
+        {
+            *pEventJD = eventJD;
+            //Successive events are at least two weeks apart.
+            *pResumeJD = max( eventJD, julianDay ) + 1.;
+            return true;
+        }
+    }
+    throw ConvergenceException( "EventTable: Event search did not converge"
+                                " near JD " + RealToString( julianDay )
+                                + "." );
+}
+
+//.............................................................................
+
+Angle
+NextEventFunc::Value( double julianDay )
+{
+    if ( ! m_context.Set( julianDay ) )
+        throw RuntimeError( "EventTable: No ephemeris for JD "
+                            + RealToString( julianDay ) + "." );
+    if ( m_event == EventTable::SolarTerm )
+        return SolarLongitude( julianDay, m_context );
+    return LunarPhase( julianDay, m_context );
+}
+
+//.............................................................................
+
+double
+NextEventFunc::Rate( double julianDay )
+{
+    double rate;
+    bool rateOK = (m_event == EventTable::SolarTerm)
+            ?  SolarLongitudeRate( julianDay, m_context, &rate )
+            :  LunarPhaseRate( julianDay, m_context, &rate );
+    if ( ! rateOK )
+        throw RuntimeError( "EventTable: No ephemeris for JD "
+                            + RealToString( julianDay ) + "." );
+    return rate;
+}
+
+//-----------------------------------------------------------------------------
+
+//The registered table is read without locking (see PublishedPtr).
+PublishedPtr< EventTable > s_registered;
+Mutex s_registryMutex;  //serializes Register()
+
+}                                                                   //namespace
+
+
+//*****************************************************************************
+
+
+EventTable::EventTable( )
+{
+    Clear( );
+}
+
+//-----------------------------------------------------------------------------
+
+EventTable::EventTable( shared_ptr< Reader > spReader )
+{
+    Clear( );
+    Load( spReader );
+}
+
+//-----------------------------------------------------------------------------
+
+void
+EventTable::Clear( )
+{
+    m_firstJulianDay = m_lastJulianDay = 0.;
+    m_firstSolarTerm = 0;
+    for ( int e = 0; e < NumEventTypes; ++e )
+    {
+        m_numEvents[ e ] = 0;
+        m_julianDays[ e ] = 0;
+        m_ownedJulianDays[ e ].clear( );
+    }
+    m_spReader.reset( );
+}
+
+//=============================================================================
+
+void
+EventTable::Generate( double firstJulianDay, double lastJulianDay,
+                      ThreadPool * pPool )
+{
+    if ( firstJulianDay >= lastJulianDay )
+        throw LogicError( "EventTable::Generate: Empty date range." );
+    //The searches look up to a couple of days beyond the range.
+    if ( (! JPLEphemeris::GetEphemeris( firstJulianDay - 2. ))
+         || (! JPLEphemeris::GetEphemeris( lastJulianDay + 2. )) )
+        throw RuntimeError( "EventTable::Generate: The ephemeris does not"
+                            " cover the date range." );
+    vector< double > julianDays[ NumEventTypes ];
+    const double chunkDays[ NumEventTypes ] = { 295., 295., 365.25 };
+    for ( int e = 0; e < NumEventTypes; ++e )
+    {
+        EEvent event = static_cast< EEvent >( e );
+        julianDays[ e ] = FindAllEvents( firstJulianDay, lastJulianDay,
+                                         chunkDays[ e ], 0., 1.e-6,
+                                         NextEventFunc( event, lastJulianDay ),
+                                         pPool );
+    }
+    int firstSolarTerm = 0;
+    if ( julianDays[ SolarTerm ].size() > 0 )
+    {
+        ReductionContext context;
+        Angle solarLong = SolarLongitude( julianDays[ SolarTerm ][ 0 ],
+                                          context );
+        solarLong.NormalizePositive( );
+        firstSolarTerm
+                = (int) std::floor( solarLong.Cycles() * 24. + 0.5 ) % 24;
+    }
+
+    Clear( );
+    m_firstJulianDay = firstJulianDay;
+    m_lastJulianDay = lastJulianDay;
+    m_firstSolarTerm = firstSolarTerm;
+    for ( int e = 0; e < NumEventTypes; ++e )
+    {
+        m_ownedJulianDays[ e ].swap( julianDays[ e ] );
+        m_numEvents[ e ] = (int) m_ownedJulianDays[ e ].size();
+        m_julianDays[ e ] = m_numEvents[ e ]  ?  &m_ownedJulianDays[ e ][0]
+                :  0;
+    }
+}
+
+//=============================================================================
+
+void
+EventTable::Load( shared_ptr< Reader > spReader )
+{
+    Assert( spReader );
+    Clear( );
+    char magic[ sizeof( s_magic ) ];
+    spReader->Seek( 0 );
+    spReader->Read( magic, sizeof( magic ) );
+    if ( memcmp( magic, s_magic, sizeof( magic ) ) != 0 )
+        throw FileException( "Not an event table file." );
+    uint32_t formatVersion;
+    spReader->Read( &formatVersion );
+    uint32_t byteOrderMark;
+    spReader->Read( &byteOrderMark );
+    if ( byteOrderMark != s_byteOrderMark )
+        throw FileException( "Event table file has the wrong byte order." );
+    if ( formatVersion != FormatVersion )
+        throw FileException( "Unsupported event table file version "
+                             + IntToString( formatVersion ) + "." );
+    int32_t i32;
+    int totalEvents = 0;
+    int numEvents[ NumEventTypes ];
+    for ( int e = 0; e < NumEventTypes; ++e )
+    {
+        spReader->Read( &i32 );
+        numEvents[ e ] = i32;
+        if ( numEvents[ e ] < 0 )
+            throw FileException( "Unable to read event table file header." );
+        totalEvents += numEvents[ e ];
+    }
+    spReader->Read( &i32 );
+    int firstSolarTerm = i32;
+    spReader->Read( &i32 );
+    int dataOffset = i32;
+    double firstJulianDay, lastJulianDay;
+    spReader->Read( &firstJulianDay );
+    spReader->Read( &lastJulianDay );
+    if ( (firstSolarTerm < 0) || (firstSolarTerm >= 24)
+         || (dataOffset % (int) sizeof( double ) != 0)
+         || (spReader->Seek( 0, RandomAccess::End )
+             < dataOffset + totalEvents * (int) sizeof( double )) )
+        throw FileException( "Unable to read event table file header." );
+
+    shared_ptr< MappedFileReader > spMapped
+            = dynamic_pointer_cast< MappedFileReader >( spReader );
+    const double * pMappedDays = spMapped
+            ?  reinterpret_cast< const double * >( spMapped->Data()
+                                                   + dataOffset )
+            :  0;
+    spReader->Seek( dataOffset );
+    for ( int e = 0; e < NumEventTypes; ++e )
+    {
+        m_numEvents[ e ] = numEvents[ e ];
+        if ( numEvents[ e ] == 0 )
+            continue;
+        if ( pMappedDays )
+        {
+            m_julianDays[ e ] = pMappedDays;
+            pMappedDays += numEvents[ e ];
+        }
+        else
+        {
+            m_ownedJulianDays[ e ].resize( numEvents[ e ] );
+            spReader->Read( reinterpret_cast< char * >(
+                                &m_ownedJulianDays[ e ][0] ),
+                            numEvents[ e ] * (int) sizeof( double ) );
+            m_julianDays[ e ] = &m_ownedJulianDays[ e ][0];
+        }
+    }
+    m_firstJulianDay = firstJulianDay;
+    m_lastJulianDay = lastJulianDay;
+    m_firstSolarTerm = firstSolarTerm;
+    if ( spMapped )
+        m_spReader = spReader;
+}
+
+//-----------------------------------------------------------------------------
+
+void
+EventTable::Write( Writer & writer ) const
+{
+    const int headerSize = (int) sizeof( s_magic )
+            + 2 * (int) sizeof( uint32_t )
+            + (NumEventTypes + 2) * (int) sizeof( int32_t )
+            + 2 * (int) sizeof( double );
+    int dataOffset = ((headerSize + s_alignment - 1) / s_alignment)
+            * s_alignment;
+
+    writer.Write( s_magic, (int) sizeof( s_magic ) );
+    writer.Write( (uint32_t) FormatVersion );
+    writer.Write( s_byteOrderMark );
+    for ( int e = 0; e < NumEventTypes; ++e )
+        writer.Write( (int32_t) m_numEvents[ e ] );
+    writer.Write( (int32_t) m_firstSolarTerm );
+    writer.Write( (int32_t) dataOffset );
+    writer.Write( m_firstJulianDay );
+    writer.Write( m_lastJulianDay );
+    vector< char > padding( dataOffset - headerSize + 1, 0 );
+    writer.Write( &padding[0], dataOffset - headerSize );
+    for ( int e = 0; e < NumEventTypes; ++e )
+        if ( m_numEvents[ e ] > 0 )
+            writer.Write( reinterpret_cast< const char * >(
+                              m_julianDays[ e ] ),
+                          m_numEvents[ e ] * (int) sizeof( double ) );
+}
+
+//=============================================================================
+
+bool
+EventTable::Mapped( ) const
+{
+    return bool( m_spReader );
+}
+
+//=============================================================================
+
+int
+EventTable::FindPrior( double julianDay, EEvent event ) const
+{
+    if ( ! Covers( julianDay ) )
+        return -1;
+    const double * pBegin = m_julianDays[ event ];
+    const double * pEnd = pBegin + m_numEvents[ event ];
+    return (int)(lower_bound( pBegin, pEnd, julianDay ) - pBegin) - 1;
+}
+
+//-----------------------------------------------------------------------------
+
+int
+EventTable::FindNext( double julianDay, EEvent event ) const
+{
+    if ( ! Covers( julianDay ) )
+        return -1;
+    const double * pBegin = m_julianDays[ event ];
+    const double * pEnd = pBegin + m_numEvents[ event ];
+    const double * pNext = lower_bound( pBegin, pEnd, julianDay );
+    return (pNext == pEnd)  ?  -1  :  (int)(pNext - pBegin);
+}
+
+//-----------------------------------------------------------------------------
+
+int
+EventTable::FindPriorSolarTerm( double julianDay, int term ) const
+{
+    Assert( (term >= 0) && (term < 24) );
+    int index = FindPrior( julianDay, SolarTerm );
+    if ( index < 0 )
+        return -1;
+    index -= ModP( SolarTermNumber( index ) - term, 24 );
+    return (index >= 0)  ?  index  :  -1;
+}
+
+//-----------------------------------------------------------------------------
+
+int
+EventTable::FindNextSolarTerm( double julianDay, int term ) const
+{
+    Assert( (term >= 0) && (term < 24) );
+    int index = FindNext( julianDay, SolarTerm );
+    if ( index < 0 )
+        return -1;
+    index += ModP( term - SolarTermNumber( index ), 24 );
+    return (index < m_numEvents[ SolarTerm ])  ?  index  :  -1;
+}
+
+//=============================================================================
+
+shared_ptr< EventTable >
+EventTable::Register( shared_ptr< EventTable > spTable )
+{
+    MutexLock lock( s_registryMutex );
+    shared_ptr< EventTable > spPrevious = s_registered.GetShared( );
+    s_registered.Publish( spTable );
+    return spPrevious;
+}
+
+//-----------------------------------------------------------------------------
+
+const EventTable *
+EventTable::Registered( )
+{
+    return s_registered.Get( );
+}
+
+
+//=============================================================================
+
+
+#ifdef DEBUG
+
+bool
+EventTable::Test( const string & testDirectory )
+{
+    bool ok = true;
+    cout << "Testing EventTable" << endl;
+
+    const double first = 2451545.;      //1 Jan 2000
+    const double last = 2451545. + 390.;
+    EventTable table;
+    table.Generate( first, last );
+    TESTCHECK( table.FirstJulianDay( ), first, &ok );
+    TESTCHECK( table.LastJulianDay( ), last, &ok );
+    TESTCHECK( table.Mapped( ), false, &ok );
+    TESTCHECK( table.NumEvents( NewMoon ), 14, &ok );
+    TESTCHECK( table.NumEvents( FullMoon ), 13, &ok );
+    TESTCHECK( table.NumEvents( SolarTerm ), 26, &ok );
+    //The first term after 1 Jan 2000 is Xiaohan, at 285 degrees.
+    TESTCHECK( table.SolarTermNumber( 0 ), 19, &ok );
+
+    const MoonPhases::EPhase phases[ 2 ]
+            = { MoonPhases::New, MoonPhases::Full };
+    for ( int e = NewMoon; e <= FullMoon; ++e )
+    {
+        EEvent event = static_cast< EEvent >( e );
+        double jd = first - 1.;
+        for ( int i = 0; i < table.NumEvents( event ); ++i )
+        {
+            double tdb = table.JulianDay( event, i );
+            double ut = MoonPhases::FindNextFast( jd, phases[ e ] );
+            TESTCHECKFE( tdb - TDB_UT( tdb ).Days(), ut, &ok, 1.e-10 );
+            jd = ut + 1.;
+        }
+    }
+    const Seasons::ESeason seasons[ 4 ]
+            = { Seasons::SpringEquinox, Seasons::SummerSolstice,
+                Seasons::AutumnalEquinox, Seasons::WinterSolstice };
+    for ( int i = 0; i < table.NumEvents( SolarTerm ); ++i )
+    {
+        int term = table.SolarTermNumber( i );
+        if ( term % 6 != 0 )
+            continue;
+        double tdb = table.JulianDay( SolarTerm, i );
+        double ut = Seasons::FindNextFast( tdb - 10., seasons[ term / 6 ] );
+        TESTCHECKFE( tdb - TDB_UT( tdb ).Days(), ut, &ok, 1.e-10 );
+    }
+
+    double jd = table.JulianDay( NewMoon, 5 );
+    TESTCHECK( table.FindPrior( jd, NewMoon ), 4, &ok );
+    TESTCHECK( table.FindNext( jd, NewMoon ), 5, &ok );
+    TESTCHECK( table.FindPrior( jd + 1.e-6, NewMoon ), 5, &ok );
+    TESTCHECK( table.FindNext( jd + 1.e-6, NewMoon ), 6, &ok );
+    TESTCHECK( table.FindPrior( first + 1., NewMoon ), -1, &ok );
+    TESTCHECK( table.FindPrior( first - 1., NewMoon ), -1, &ok );
+    TESTCHECK( table.FindNext( last - 1., NewMoon ), -1, &ok );
+    TESTCHECK( table.FindNext( last + 1., NewMoon ), -1, &ok );
+    int spring = table.FindNextSolarTerm( first, 0 );
+    TESTCHECK( table.SolarTermNumber( spring ), 0, &ok );
+    TESTCHECK( (table.JulianDay( SolarTerm, spring ) > first + 75.), true,
+               &ok );
+    TESTCHECK( (table.JulianDay( SolarTerm, spring ) < first + 82.), true,
+               &ok );
+    TESTCHECK( table.FindPriorSolarTerm( last, 0 ), spring, &ok );
+    TESTCHECK( table.FindPriorSolarTerm( last, 18 ), 23, &ok );
+    TESTCHECK( table.FindPriorSolarTerm( first + 200., 18 ), -1, &ok );
+    TESTCHECK( table.FindNextSolarTerm( last - 20., 6 ), -1, &ok );
+
+    string tableFileName = testDirectory + "events.tbl";
+    {
+        FileWriter writer( tableFileName );
+        table.Write( writer );
+    }
+    shared_ptr< EventTable > spReadTable(
+        new EventTable( shared_ptr< Reader >(
+                            new FileReader( tableFileName ) ) ) );
+    TESTCHECK( spReadTable->Mapped( ), false, &ok );
+    {
+        EventTable mappedTable( shared_ptr< Reader >(
+                                    new MappedFileReader( tableFileName ) ) );
+        TESTCHECK( mappedTable.Mapped( ), true, &ok );
+        TESTCHECK( mappedTable.SolarTermNumber( 0 ),
+                   table.SolarTermNumber( 0 ), &ok );
+        TESTCHECK( mappedTable.LastJulianDay( ), last, &ok );
+        int numErrors = 0;
+        for ( int e = 0; e < NumEventTypes; ++e )
+        {
+            EEvent event = static_cast< EEvent >( e );
+            TESTCHECK( mappedTable.NumEvents( event ),
+                       table.NumEvents( event ), &ok );
+            TESTCHECK( spReadTable->NumEvents( event ),
+                       table.NumEvents( event ), &ok );
+            for ( int i = 0; i < table.NumEvents( event ); ++i )
+            {
+                double jd = table.JulianDay( event, i );
+                if ( (mappedTable.JulianDay( event, i ) != jd)
+                     || (spReadTable->JulianDay( event, i ) != jd) )
+                    ++numErrors;
+            }
+        }
+        TESTCHECK( numErrors, 0, &ok );
+    }
+    //The registered table is kept, so register one that is not mapped.
+    shared_ptr< EventTable > spPrevious = Register( spReadTable );
+    TESTCHECK( Registered( ), (const EventTable *) spReadTable.get(), &ok );
+    cout << "Register( 0 )" << endl;
+    Register( shared_ptr< EventTable >( ) );
+    TESTCHECK( Registered( ), (const EventTable *) 0, &ok );
+    Register( spPrevious );
+    TESTCHECK( Registered( ), (const EventTable *) spPrevious.get(), &ok );
+    remove( tableFileName.c_str() );
+
+    if ( ok )
+        cout << "EventTable PASSED." << endl << endl;
+    else
+        cout << "EventTable FAILED." << endl << endl;
+    return ok;
+}
+
+#endif //DEBUG
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
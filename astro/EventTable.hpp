@@ -0,0 +1,202 @@
+#ifndef EVENTTABLE_HPP
+#define EVENTTABLE_HPP
+/*
+  EventTable.hpp
+  Copyright (C) 2011 David M. Anderson
+
+  EventTable class: a precomputed table of the times of the new moons, full
+  moons, and solar terms (including the equinoxes and solstices) over a
+  range of Julian days, which may be saved to a file and memory-mapped.
+  NOTES:
+  1. Times are Julian days in TDB, as taken by LunarPhase() and
+     SolarLongitude() (see AstroPhenomena.hpp). The events are found by
+     Newton's method on the phase or longitude, to within about 1.e-8 day,
+     so they agree with the live root finding to its precision.
+  2. The solar terms are the times when the Sun's apparent longitude is a
+     multiple of 15 degrees. SolarTermNumber() gives the multiple, from 0
+     (vernal equinox) to 23. Terms 6, 12, and 18 are the summer solstice,
+     autumnal equinox, and winter solstice.
+  3. Generate() computes the events in [firstJulianDay, lastJulianDay),
+     in parallel, using pPool (or a temporary ThreadPool if it is null). It
+     throws a RuntimeError unless the registered ephemerides cover the
+     range, and a ConvergenceException in the unlikely event that a search
+     fails. Over the 600 years of DE405 this takes some minutes; the result
+     is meant to be saved with Write() and loaded thereafter.
+  4. Write() writes a file with a fixed header followed by the times, as
+     doubles in native byte order, aligned to 64 bytes. If the Reader given
+     to Load() (or the constructor) is a MappedFileReader, the times are
+     used in place, requiring almost no work; otherwise they are read into
+     memory. A file of the other byte order is rejected with a
+     FileException.
+  5. FindPrior() returns the index of the last event of the given kind
+     before julianDay, and FindNext() that of the first on or after it, by
+     binary search. They return -1 if julianDay is outside the table's range
+     (where the answer might be missing) or if there is no such event in
+     the table. FindPriorSolarTerm() and FindNextSolarTerm() do the same for
+     a particular solar term.
+  6. Register() makes a table available to the calendars (ChineseCalendar,
+     PersianCalendar, and FrenchRevolutionaryCalendar), which use it in
+     place of root finding wherever it covers the date. Registered() may be
+     called from any thread; Register(), like
+     JPLEphemeris::RegisterEphemeris(), replaces the table atomically, and
+     the tables registered are kept until the program ends (see
+     PublishedPtr). Register() returns the table it replaced, if any, and
+     registering a null pointer unregisters the table, so a caller can
+     restore the previous registration.
+  7. EventDay() gives the day, in a calendar's reckoning, on which an event
+     at julianDay (TDB) occurs. dayOf( jd ) is the calendar's day number for
+     a time, and dayStart( jdi ) the time at which day jdi begins. The two
+     may disagree by a day near midnight, so the result is adjusted to be
+     the day that, according to dayStart(), contains julianDay.
+*/
+
+
+#include "Reader.hpp"
+#include "Writer.hpp"
+#include <string>
+#include <vector>
+#include <tr1/memory>
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+class ThreadPool;
+
+//*****************************************************************************
+
+
+class EventTable
+{
+public:
+    enum EEvent
+    { NewMoon, FullMoon, SolarTerm, NumEventTypes };
+
+    EventTable( );
+    explicit EventTable( std::tr1::shared_ptr< Reader > spReader );
+
+    void Generate( double firstJulianDay, double lastJulianDay,
+                   ThreadPool * pPool = 0 );
+    void Load( std::tr1::shared_ptr< Reader > spReader );
+    void Write( Writer & writer ) const;
+
+    double FirstJulianDay( ) const;
+    double LastJulianDay( ) const;
+    bool Mapped( ) const;
+    int NumEvents( EEvent event ) const;
+    double JulianDay( EEvent event, int index ) const;
+    int SolarTermNumber( int index ) const;
+
+    int FindPrior( double julianDay, EEvent event ) const;
+    int FindNext( double julianDay, EEvent event ) const;
+    int FindPriorSolarTerm( double julianDay, int term ) const;
+    int FindNextSolarTerm( double julianDay, int term ) const;
+
+    static std::tr1::shared_ptr< EventTable >
+    Register( std::tr1::shared_ptr< EventTable > spTable );
+    static const EventTable * Registered( );
+
+    static const int FormatVersion = 1;
+
+#ifdef DEBUG
+    static bool Test( const std::string & testDirectory );
+#endif
+
+private:
+    EventTable( const EventTable & );
+    EventTable & operator=( const EventTable & );
+
+    void Clear( );
+    bool Covers( double julianDay ) const;
+
+    double m_firstJulianDay;
+    double m_lastJulianDay;
+    int m_firstSolarTerm;
+    int m_numEvents[ NumEventTypes ];
+    const double * m_julianDays[ NumEventTypes ];
+    std::vector< double > m_ownedJulianDays[ NumEventTypes ];
+    std::tr1::shared_ptr< Reader > m_spReader;
+};
+
+//.............................................................................
+
+template < typename DayFunc, typename DayStartFunc >
+long EventDay( double julianDay, DayFunc dayOf, DayStartFunc dayStart );
+
+
+//*****************************************************************************
+
+
+inline
+double
+EventTable::FirstJulianDay( ) const
+{
+    return m_firstJulianDay;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+double
+EventTable::LastJulianDay( ) const
+{
+    return m_lastJulianDay;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+int
+EventTable::NumEvents( EEvent event ) const
+{
+    return m_numEvents[ event ];
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+double
+EventTable::JulianDay( EEvent event, int index ) const
+{
+    return m_julianDays[ event ][ index ];
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+int
+EventTable::SolarTermNumber( int index ) const
+{
+    return (m_firstSolarTerm + index) % 24;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+bool
+EventTable::Covers( double julianDay ) const
+{
+    return ( (julianDay >= m_firstJulianDay)
+             && (julianDay <= m_lastJulianDay) );
+}
+
+//=============================================================================
+
+template < typename DayFunc, typename DayStartFunc >
+long
+EventDay( double julianDay, DayFunc dayOf, DayStartFunc dayStart )
+{
+    long jdi = dayOf( julianDay );
+    if ( dayStart( jdi ) > julianDay )
+        --jdi;
+    else if ( dayStart( jdi + 1 ) <= julianDay )
+        ++jdi;
+    return jdi;
+}
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
+
+#endif //EVENTTABLE_HPP
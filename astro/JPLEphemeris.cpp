@@ -7,9 +7,13 @@
   NOTES:
   1. Certain data and computations are retained (cached) to allow some
      performance optimization.
-     First, the last two blocks of Chebyshev coefficients are cached. This
-     means that for multiple positions at the same epoch, or within 32 days
-     (for DE405) or 64 days (for DE406), disk reads will be minimized.
+     These caches are kept in a Cursor (see the header, Note 11).
+     First, the Cursor holds the block of Chebyshev coefficients it last
+     used, so that for multiple positions at the same epoch, or within 32
+     days (for DE405) or 64 days (for DE406), no lookup is needed at all.
+     Other blocks come from the shared block cache (see the header, Note 13),
+     which is only consulted, under the mutex, when the Cursor moves to a
+     different block.
      Second, the evaluation of Chebyshev polynomials for the latest timeFrac
      are retained. However, the timeFrac depends on both the Julian Day and
      the number of sub-intervals for the body. To take advantage of this, it
@@ -20,6 +24,9 @@
      unimportant, especially since it is inapplicable when computing
      apparent positions, for which positions at different times must be
      calculated to allow for light-time.
+  2. When the ephemeris file is memory-mapped or preloaded (see the header,
+     Notes 10 and 13), the block cache is bypassed: LoadCoeffBlock() simply
+     points into the coefficients in memory.
 */
 
 
@@ -30,6 +37,10 @@
 #include "Vector3.hpp"
 #include "StringUtil.hpp"
 #include "FixEndian.hpp"
+#include "MappedFileReader.hpp"
+#include "PublishedPtr.hpp"
+#include <algorithm>
+#include <cstring>
 #ifdef DEBUG
 #include <iostream>
 #include "TestCheck.hpp"
@@ -50,8 +61,13 @@ Logger JPLEphemeris::ms_log( "JPLEphemeris" );
 
 JPLEphemeris::JPLEphemeris( )
     :   m_wrongEndian( false ),
-        m_curBlock( 0 )
+        m_compact( false ),
+        m_mappedCoeffs( 0 ),
+        m_numBlocks( 0 ),
+        m_preloaded( false ),
+        m_cacheCapacity( DefaultCacheCapacity )
 {
+    ResetCacheStatistics( );
 }
 
 //.............................................................................
@@ -59,8 +75,13 @@ JPLEphemeris::JPLEphemeris( )
 JPLEphemeris::JPLEphemeris( shared_ptr< Reader > reader,
                             bool storeConstants )
     :   m_wrongEndian( false ),
-        m_curBlock( 0 )
+        m_compact( false ),
+        m_mappedCoeffs( 0 ),
+        m_numBlocks( 0 ),
+        m_preloaded( false ),
+        m_cacheCapacity( DefaultCacheCapacity )
 {
+    ResetCacheStatistics( );
     Init( reader, storeConstants );
 }
 
@@ -70,13 +91,16 @@ void
 JPLEphemeris::Init( shared_ptr< Reader > reader, bool storeConstants )
 {
     m_pReader = reader;
+    m_wrongEndian = false;
+    m_cursor.Reset( );
+    m_preloaded = false;
+    m_blockCache.clear( );
+    m_lruBlocks.clear( );
+    ResetCacheStatistics( );
 
-    ReadBinaryFileHeader( storeConstants );
-
-    m_chebyVals[0] = 1.0;
-    m_chebyVals[1] = -1000.0;
-    m_chebyDerivs[0] = 0.0;
-    m_chebyDerivs[1] = 1.0;
+    if ( ! ReadCompactFileHeader( storeConstants ) )
+        ReadBinaryFileHeader( storeConstants );
+    MapCoeffBlocks( );
 
     ms_log( Logger::Info, "Init complete" );
     if ( storeConstants )
@@ -237,6 +261,197 @@ JPLEphemeris::ReadBinaryFileHeader( bool storeConstants )
     }
 }                                                        //ReadBinaryFileHeader
 
+//.............................................................................
+
+namespace
+{
+
+const char s_compactMagic[ 8 ] = { 'E', 'D', 'J', 'P', 'L', 'C', 'M', 'P' };
+const uint32_t s_byteOrderMark = 0x01020304;
+const int s_compactAlignment = 64;
+
+}
+
+//.............................................................................
+
+bool 
+JPLEphemeris::ReadCompactFileHeader( bool storeConstants )
+{                                                       //ReadCompactFileHeader
+    Assert( m_pReader );
+    if ( ! m_pReader )
+        throw LogicError( "JPLEphemeris: Not initialized." );
+
+    m_compact = false;
+    char magic[ sizeof( s_compactMagic ) ];
+    m_pReader->Seek( 0 );
+    if ( m_pReader->Seek( 0, RandomAccess::End ) < (int) sizeof( magic ) )
+    {
+        m_pReader->Seek( 0 );
+        return false;
+    }
+    m_pReader->Seek( 0 );
+    m_pReader->Read( magic, sizeof( magic ) );
+    if ( memcmp( magic, s_compactMagic, sizeof( magic ) ) != 0 )
+    {
+        m_pReader->Seek( 0 );
+        return false;
+    }
+
+    uint32_t formatVersion;
+    m_pReader->Read( &formatVersion );
+    uint32_t byteOrderMark;
+    m_pReader->Read( &byteOrderMark );
+    if ( byteOrderMark != s_byteOrderMark )
+        throw FileException( "Compact JPL ephemeris file has the wrong"
+                             " byte order." );
+    if ( formatVersion != CompactFormatVersion )
+        throw FileException( "Unsupported compact JPL ephemeris file version "
+                             + IntToString( formatVersion ) + "." );
+    int32_t i32;
+    m_pReader->Read( &i32 );
+    m_version = i32;
+    m_pReader->Read( &i32 );    //number of blocks, implied by the file size
+    m_pReader->Read( &i32 );
+    m_coeffsPerBlock = i32;
+    m_pReader->Read( &i32 );
+    m_dataOffset = i32;
+    m_pReader->Read( &m_jdStart );
+    m_pReader->Read( &m_jdEnd );
+    m_pReader->Read( &m_blockInterval );
+    m_pReader->Read( &m_astronomicalUnit );
+    m_pReader->Read( &m_earthMoonRatio );
+    for ( int i = 0; i < NumTargets; ++i )
+    {
+        m_pReader->Read( &i32 );
+        m_coeffLayouts[i].m_offset = i32;
+        m_pReader->Read( &i32 );
+        m_coeffLayouts[i].m_numCoeffs = i32;
+        m_pReader->Read( &i32 );
+        m_coeffLayouts[i].m_numComponents = i32;
+        m_pReader->Read( &i32 );
+        m_coeffLayouts[i].m_numSubIntervals = i32;
+        if ( (m_coeffLayouts[i].m_numCoeffs > MaxCoeffs)
+             || (m_coeffLayouts[i].m_offset + m_coeffLayouts[i].m_numCoeffs
+                 * m_coeffLayouts[i].m_numComponents
+                 * m_coeffLayouts[i].m_numSubIntervals > m_coeffsPerBlock) )
+            throw FileException( "Unable to read compact JPL ephemeris file"
+                                 " header." );
+    }
+    char title[ TitleLen + 1 ];
+    title[ TitleLen ] = 0;
+    for ( int i = 0; i < NumTitles; ++i )
+    {
+        m_pReader->Read( title, TitleLen );
+        if ( storeConstants )
+        {
+            TrimTrailing( title );
+            m_titles[i] = title;
+        }
+    }
+    m_constants.clear( );
+    m_compact = true;
+    ms_log( Logger::Debug1, "Compact file, block size: %d",
+            (int)(m_coeffsPerBlock * sizeof( double )) );
+    return true;
+}                                                       //ReadCompactFileHeader
+
+//.............................................................................
+
+void 
+JPLEphemeris::MapCoeffBlocks( )
+{
+    m_mappedCoeffs = 0;
+    m_numBlocks = 0;
+    m_ownedCoeffs.clear( );
+    shared_ptr< MappedFileReader > spMapped
+            = dynamic_pointer_cast< MappedFileReader >( m_pReader );
+    if ( ! spMapped )
+        return;
+
+    int blockSize = m_coeffsPerBlock * sizeof( double );
+    m_numBlocks = (spMapped->Size() - m_dataOffset) / blockSize;
+    if ( m_numBlocks <= 0 )
+        throw FileException( "JPL ephemeris file contains no data." );
+    const double * coeffs = reinterpret_cast< const double * >(
+        spMapped->Data() + m_dataOffset );
+    if ( m_wrongEndian )
+    {
+        //One-time conversion, so that lookups never need to swap.
+        int numCoeffs = m_numBlocks * m_coeffsPerBlock;
+        m_ownedCoeffs.assign( coeffs, coeffs + numCoeffs );
+        double * pCoeff = &m_ownedCoeffs[0];
+        for ( int i = 0; i < numCoeffs; ++i, ++pCoeff )
+            SwapEndian( pCoeff );
+        coeffs = &m_ownedCoeffs[0];
+    }
+    m_mappedCoeffs = coeffs;
+    ms_log( Logger::Info, "Mapped %d blocks", m_numBlocks );
+}
+
+//=============================================================================
+
+void 
+JPLEphemeris::SetCacheCapacity( int numBlocks )
+{
+    Assert( numBlocks >= 0 );
+    MutexLock lock( m_readerMutex );
+    m_cacheCapacity = max( numBlocks, 0 );
+    while ( (int) m_blockCache.size() > m_cacheCapacity )
+    {
+        m_blockCache.erase( m_lruBlocks.back() );
+        m_lruBlocks.pop_back( );
+        ++m_cacheStats.m_evictions;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void 
+JPLEphemeris::Preload( )
+{
+    if ( m_mappedCoeffs != 0 )
+        return;     //Already in memory.
+    Assert( m_pReader );
+    if ( ! m_pReader )
+        throw LogicError( "JPLEphemeris: Not initialized." );
+    MutexLock lock( m_readerMutex );
+    int blockSize = m_coeffsPerBlock * sizeof( double );
+    int fileSize = m_pReader->Seek( 0, RandomAccess::End );
+    int numBlocks = (fileSize - m_dataOffset) / blockSize;
+    if ( numBlocks <= 0 )
+        throw FileException( "JPL ephemeris file contains no data." );
+    m_ownedCoeffs.resize( numBlocks * m_coeffsPerBlock );
+    for ( int i = 0; i < numBlocks; ++i )
+        ReadBlock( i, &m_ownedCoeffs[ i * m_coeffsPerBlock ] );
+    m_numBlocks = numBlocks;
+    m_mappedCoeffs = &m_ownedCoeffs[0];
+    m_preloaded = true;
+    //The cache is no longer needed.
+    m_blockCache.clear( );
+    m_lruBlocks.clear( );
+    ms_log( Logger::Info, "Preloaded %d blocks", m_numBlocks );
+}
+
+//-----------------------------------------------------------------------------
+
+JPLEphemeris::CacheStatistics 
+JPLEphemeris::GetCacheStatistics( ) const
+{
+    MutexLock lock( m_readerMutex );
+    return m_cacheStats;
+}
+
+//.............................................................................
+
+void 
+JPLEphemeris::ResetCacheStatistics( )
+{
+    MutexLock lock( m_readerMutex );
+    m_cacheStats.m_hits = 0;
+    m_cacheStats.m_misses = 0;
+    m_cacheStats.m_evictions = 0;
+}
+
 //-----------------------------------------------------------------------------
 
 JPLEphemeris::~JPLEphemeris( )
@@ -245,6 +460,30 @@ JPLEphemeris::~JPLEphemeris( )
 
 //=============================================================================
 
+JPLEphemeris::Cursor::Cursor( )
+{
+    Reset( );
+}
+
+//-----------------------------------------------------------------------------
+
+void 
+JPLEphemeris::Cursor::Reset( )
+{
+    m_pEphemeris = 0;
+    m_spCoeffBlock.reset( );
+    m_curCoeffBlock = 0;
+    m_targetCoeffs = 0;
+    m_chebyVals[0] = 1.0;
+    m_chebyVals[1] = -1000.0;
+    m_chebyDerivs[0] = 0.0;
+    m_chebyDerivs[1] = 1.0;
+    m_numChebys = 0;
+    m_numDerivs = 0;
+}
+
+//=============================================================================
+
 JPLEphemeris::EBody 
 JPLEphemeris::SolarSystemToJPLBody( SolarSystem::EBody body )
 {
@@ -277,21 +516,46 @@ JPLEphemeris::GetBodyPosition( double julianDay,
                                EBody body, EBody origin,
                                Point3D * pPosition, Vector3D * pVelocity )
 {
-    return GetBodyPosition( julianDay, 0.0, body, origin,
+    return GetBodyPosition( &m_cursor, julianDay, 0.0, body, origin,
                             pPosition, pVelocity );
 }
 
-//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//.............................................................................
 
 bool 
 JPLEphemeris::GetBodyPosition( double julianDay0, double julianDay1,
                                EBody body, EBody origin,
                                Point3D * pPosition, Vector3D * pVelocity )
+{
+    return GetBodyPosition( &m_cursor, julianDay0, julianDay1, body, origin,
+                            pPosition, pVelocity );
+}
+
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool 
+JPLEphemeris::GetBodyPosition( Cursor * pCursor, double julianDay,
+                               EBody body, EBody origin,
+                               Point3D * pPosition, Vector3D * pVelocity ) const
+{
+    return GetBodyPosition( pCursor, julianDay, 0.0, body, origin,
+                            pPosition, pVelocity );
+}
+
+//.............................................................................
+
+bool 
+JPLEphemeris::GetBodyPosition( Cursor * pCursor,
+                               double julianDay0, double julianDay1,
+                               EBody body, EBody origin,
+                               Point3D * pPosition, Vector3D * pVelocity ) const
 {                                                           /*GetBodyPosition*/
+    Assert( pCursor != 0 );
     Assert( pPosition != 0 );
 
-    ms_log( Logger::Debug1, "GetBodyPosition JD=%11.2f body=%d origin=%d",
-            (julianDay0 + julianDay1), body, origin );
+    if ( ms_log.IsEnabled( Logger::Debug1 ) )
+        ms_log( Logger::Debug1, "GetBodyPosition JD=%11.2f body=%d origin=%d",
+                (julianDay0 + julianDay1), body, origin );
             
     if ( body == origin )
     {
@@ -300,6 +564,8 @@ JPLEphemeris::GetBodyPosition( double julianDay0, double julianDay1,
             pVelocity->Set( 0., 0., 0. );
         return true;
     }
+    if ( ! (BodyAvailable( body ) && BodyAvailable( origin )) )
+        return false;
 
     if ( (body == SolarSystemBarycenter)
          || ((body == Earth) && (origin != SolarSystemBarycenter))
@@ -309,8 +575,8 @@ JPLEphemeris::GetBodyPosition( double julianDay0, double julianDay1,
              && (origin != SolarSystemBarycenter) && (origin != Earth)) )
     {
         Point3D origPos;
-        bool posRslt = GetBodyPosition( julianDay0, julianDay1, origin, body,
-                                        &origPos, pVelocity );
+        bool posRslt = GetBodyPosition( pCursor, julianDay0, julianDay1,
+                                        origin, body, &origPos, pVelocity );
         pPosition->Set( - origPos.ToVector() );
         if ( pVelocity != 0 )
             *pVelocity = - *pVelocity;
@@ -331,11 +597,11 @@ JPLEphemeris::GetBodyPosition( double julianDay0, double julianDay1,
         Assert( origin == SolarSystemBarycenter );
         if ( pVelocity == 0 )
         {
-            bool compRslt = ComputeComponents( julianDay0, julianDay1,
+            bool compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
                                                MoonGeo, &moonPos );
             if ( ! compRslt )
                 return false;
-            compRslt = ComputeComponents( julianDay0, julianDay1,
+            compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
                                           EMBary, &embPos );
             Assert( compRslt );
             GetEarthBarycentric( pPosition,
@@ -343,11 +609,11 @@ JPLEphemeris::GetBodyPosition( double julianDay0, double julianDay1,
         }
         else
         {
-            bool compRslt = ComputeComponents( julianDay0, julianDay1,
+            bool compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
                                                MoonGeo, &moonPos, &moonVel );
             if ( ! compRslt )
                 return false;
-            compRslt = ComputeComponents( julianDay0, julianDay1,
+            compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
                                           EMBary, &embPos, &embVel );
             Assert(  compRslt );
             GetEarthBarycentric( pPosition,
@@ -359,15 +625,16 @@ JPLEphemeris::GetBodyPosition( double julianDay0, double julianDay1,
     {
         if ( origin == Earth )
         {
-            bool compRslt =  ComputeComponents( julianDay0, julianDay1, MoonGeo,
-                                                &moonPos, pVelocity );
+            bool compRslt =  ComputeComponents( pCursor, julianDay0,
+                                                julianDay1, MoonGeo, &moonPos,
+                                                pVelocity );
             if ( compRslt )
                 pPosition->Set( moonPos );
             return compRslt;
         }
         if ( pVelocity == 0 )
         {
-            bool compRslt = ComputeComponents( julianDay0, julianDay1,
+            bool compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
                                                MoonGeo, &moonPos );
             if ( ! compRslt )
                 return false;
@@ -379,7 +646,7 @@ JPLEphemeris::GetBodyPosition( double julianDay0, double julianDay1,
             else
             {
                 Assert( origin == SolarSystemBarycenter );
-                compRslt = ComputeComponents( julianDay0, julianDay1,
+                compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
                                               EMBary, &embPos );
                 Assert( compRslt );
                 GetMoonBarycentric( pPosition,
@@ -388,7 +655,7 @@ JPLEphemeris::GetBodyPosition( double julianDay0, double julianDay1,
         }
         else
         {
-            bool compRslt = ComputeComponents( julianDay0, julianDay1,
+            bool compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
                                                MoonGeo, &moonPos, &moonVel );
             if ( ! compRslt )
                 return false;
@@ -402,7 +669,7 @@ JPLEphemeris::GetBodyPosition( double julianDay0, double julianDay1,
             else
             {
                 Assert( origin == SolarSystemBarycenter );
-                compRslt = ComputeComponents( julianDay0, julianDay1,
+                compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
                                               EMBary, &embPos, &embVel );
                 Assert( compRslt );
                 GetMoonBarycentric( pPosition,
@@ -416,8 +683,8 @@ JPLEphemeris::GetBodyPosition( double julianDay0, double julianDay1,
         if ( origin == SolarSystemBarycenter )
         {
             
-            bool compRslt = ComputeComponents( julianDay0, julianDay1, EMBary,
-                                               &bodyPos, pVelocity );
+            bool compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
+                                               EMBary, &bodyPos, pVelocity );
             if ( compRslt )
                 pPosition->Set( bodyPos );
             return compRslt;
@@ -425,7 +692,7 @@ JPLEphemeris::GetBodyPosition( double julianDay0, double julianDay1,
         Assert( origin == Earth );
         if ( pVelocity == 0 )
         {
-            bool compRslt = ComputeComponents( julianDay0, julianDay1,
+            bool compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
                                                MoonGeo, &moonPos );
             if ( ! compRslt )
                 return false;
@@ -434,7 +701,7 @@ JPLEphemeris::GetBodyPosition( double julianDay0, double julianDay1,
         }
         else
         {
-            bool compRslt = ComputeComponents( julianDay0, julianDay1,
+            bool compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
                                                MoonGeo, &moonPos, &moonVel );
             if ( ! compRslt )
                 return false;
@@ -453,31 +720,31 @@ JPLEphemeris::GetBodyPosition( double julianDay0, double julianDay1,
         Assert( target < NumTargets );
         if ( origin == SolarSystemBarycenter )
         {
-            bool compRslt = ComputeComponents( julianDay0, julianDay1, target,
-                                               &bodyPos, pVelocity );
+            bool compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
+                                               target, &bodyPos, pVelocity );
             if ( compRslt )
                 pPosition->Set( bodyPos );
             return compRslt;
         }
         if ( pVelocity == 0 )
         {
-            bool compRslt = ComputeComponents( julianDay0, julianDay1, target,
-                                               &bodyPos );
+            bool compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
+                                               target, &bodyPos );
             if ( ! compRslt )
                 return false;
             ETarget center = bodyToTarget[ origin ];
             if ( center < NumTargets )
             {
-                compRslt = ComputeComponents( julianDay0, julianDay1, center,
-                                              &originPos );
+                compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
+                                              center, &originPos );
                 Assert( compRslt );
             }
             else
             {
-                compRslt = ComputeComponents( julianDay0, julianDay1,
+                compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
                                               MoonGeo, &moonPos );
                 Assert( compRslt );
-                compRslt = ComputeComponents( julianDay0, julianDay1,
+                compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
                                               EMBary, &embPos );
                 Assert( compRslt );
                 Point3D pos;
@@ -498,23 +765,23 @@ JPLEphemeris::GetBodyPosition( double julianDay0, double julianDay1,
         }
         else
         {
-            bool compRslt = ComputeComponents( julianDay0, julianDay1, target,
-                                               &bodyPos, &bodyVel );
+            bool compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
+                                               target, &bodyPos, &bodyVel );
             if ( ! compRslt )
                 return false;
             ETarget center = bodyToTarget[ origin ];
             if ( center < NumTargets )
             {
-                compRslt = ComputeComponents( julianDay0, julianDay1, center,
-                                              &originPos, &originVel );
+                compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
+                                              center, &originPos, &originVel );
                 Assert( compRslt );
             }
             else
             {
-                compRslt = ComputeComponents( julianDay0, julianDay1,
+                compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
                                               MoonGeo, &moonPos, &moonVel );
                 Assert( compRslt );
-                compRslt = ComputeComponents( julianDay0, julianDay1,
+                compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
                                               EMBary, &embPos, &embVel );
                 Assert( compRslt );
                 Point3D pos;
@@ -547,16 +814,38 @@ bool
 JPLEphemeris::GetNutation( double julianDay,
                            Nutation * pNutation, Nutation * pDerivative )
 {
-    return GetNutation( julianDay, 0.0, pNutation, pDerivative );
+    return GetNutation( &m_cursor, julianDay, 0.0, pNutation, pDerivative );
 }
 
-//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//.............................................................................
 
-bool 
+bool
 JPLEphemeris::GetNutation( double julianDay0, double julianDay1,
                            Nutation * pNutation, Nutation * pDerivative )
 {
-    ms_log( Logger::Debug1, "GetNutation JD=%11.2f", (julianDay0+julianDay1) );
+    return GetNutation( &m_cursor, julianDay0, julianDay1,
+                        pNutation, pDerivative );
+}
+
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool
+JPLEphemeris::GetNutation( Cursor * pCursor, double julianDay,
+                           Nutation * pNutation, Nutation * pDerivative ) const
+{
+    return GetNutation( pCursor, julianDay, 0.0, pNutation, pDerivative );
+}
+
+//.............................................................................
+
+bool 
+JPLEphemeris::GetNutation( Cursor * pCursor,
+                           double julianDay0, double julianDay1,
+                           Nutation * pNutation, Nutation * pDerivative ) const
+{
+    if ( ms_log.IsEnabled( Logger::Debug1 ) )
+        ms_log( Logger::Debug1, "GetNutation JD=%11.2f",
+                (julianDay0 + julianDay1) );
             
     if ( ! NutationAvailable() )
         return false;
@@ -565,16 +854,16 @@ JPLEphemeris::GetNutation( double julianDay0, double julianDay1,
     Vector3D comp;
     if ( pDerivative == 0 )
     {
-        bool compRslt = ComputeComponents( julianDay0, julianDay1, Nut,
-                                           &comp );
+        bool compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
+                                           Nut, &comp );
         pNutation->Set( Angle( comp[0] ), Angle( comp[1] ) );
         return compRslt;
     }
     else
     {
         Vector3D vel;
-        bool compRslt = ComputeComponents( julianDay0, julianDay1, Nut,
-                                           &comp, &vel );
+        bool compRslt = ComputeComponents( pCursor, julianDay0, julianDay1,
+                                           Nut, &comp, &vel );
         pNutation->Set( Angle( comp[0] ), Angle( comp[1] ) );
         pDerivative->Set( Angle( vel[0] ), Angle( vel[1] ) );
         return compRslt;
@@ -588,25 +877,49 @@ JPLEphemeris::GetLibration( double julianDay,
                             Vector3< Angle > * pComponents,
                             Vector3< Angle > * pVelocity )
 {
-    return GetLibration( julianDay, 0.0, pComponents, pVelocity );
+    return GetLibration( &m_cursor, julianDay, 0.0, pComponents, pVelocity );
 }
 
-//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//.............................................................................
 
 bool 
 JPLEphemeris::GetLibration( double julianDay0, double julianDay1,
                             Vector3< Angle > * pComponents,
                             Vector3< Angle > * pVelocity )
 {
-    ms_log( Logger::Debug1, "GetLibration JD=%11.2f", (julianDay0+julianDay1) );
+    return GetLibration( &m_cursor, julianDay0, julianDay1,
+                         pComponents, pVelocity );
+}
+
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool 
+JPLEphemeris::GetLibration( Cursor * pCursor, double julianDay,
+                            Vector3< Angle > * pComponents,
+                            Vector3< Angle > * pVelocity ) const
+{
+    return GetLibration( pCursor, julianDay, 0.0, pComponents, pVelocity );
+}
+
+//.............................................................................
+
+bool 
+JPLEphemeris::GetLibration( Cursor * pCursor,
+                            double julianDay0, double julianDay1,
+                            Vector3< Angle > * pComponents,
+                            Vector3< Angle > * pVelocity ) const
+{
+    if ( ms_log.IsEnabled( Logger::Debug1 ) )
+        ms_log( Logger::Debug1, "GetLibration JD=%11.2f",
+                (julianDay0 + julianDay1) );
 
     if ( ! LibrationAvailable() )
         return false;
     Vector3D comp;
     if ( pVelocity == 0 )
     {
-        bool compRslt =  ComputeComponents( julianDay0, julianDay1, Lib,
-                                            &comp );
+        bool compRslt =  ComputeComponents( pCursor, julianDay0, julianDay1,
+                                            Lib, &comp );
         pComponents->Set( Angle( comp[0] ), Angle( comp[1] ),
                           Angle( comp[2] ) );
         return compRslt;
@@ -614,8 +927,8 @@ JPLEphemeris::GetLibration( double julianDay0, double julianDay1,
     else
     {
         Vector3D vel;
-        bool compRslt =  ComputeComponents( julianDay0, julianDay1, Lib,
-                                            &comp, &vel );
+        bool compRslt =  ComputeComponents( pCursor, julianDay0, julianDay1,
+                                            Lib, &comp, &vel );
         pComponents->Set( Angle( comp[0] ), Angle( comp[1] ),
                           Angle( comp[2] ) );
         pVelocity->Set( Angle( vel[0] ), Angle( vel[1] ), Angle( vel[2] ) );
@@ -701,6 +1014,24 @@ JPLEphemeris::NutationAvailable( ) const
 
 //-----------------------------------------------------------------------------
 
+bool 
+JPLEphemeris::BodyAvailable( EBody body ) const
+{
+    const ETarget bodyToTarget[ NumBodies ]
+            = { NumTargets, Sol, Mer, Ven, MoonGeo, MoonGeo,
+                EMBary, Mar, Jup, Sat, Ura, Nep, Plu };
+    if ( body == SolarSystemBarycenter )
+        return true;
+    if ( m_coeffLayouts[ bodyToTarget[ body ] ].m_numCoeffs == 0 )
+        return false;
+    if ( (body == Earth) || (body == Moon) || (body == EarthMoonBarycenter) )
+        return ( (m_coeffLayouts[ MoonGeo ].m_numCoeffs > 0)
+                 && (m_coeffLayouts[ EMBary ].m_numCoeffs > 0) );
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
 bool 
 JPLEphemeris::LibrationAvailable( ) const
 {
@@ -743,9 +1074,8 @@ JPLEphemeris::CoeffLayout( int target ) const
 
 //=============================================================================
 
-void
-JPLEphemeris::ReadCoeffBlock( double julianDay0, double julianDay1,
-                              double * coeffBlock )
+int
+JPLEphemeris::BlockNumber( double julianDay0, double julianDay1 ) const
 {
     double ephemDiff = julianDay0 - m_jdStart;
     ephemDiff += julianDay1;
@@ -754,6 +1084,157 @@ JPLEphemeris::ReadCoeffBlock( double julianDay0, double julianDay1,
     int blockNumber = (int)( ephemDiff / m_blockInterval );
     if ( m_jdStart + ephemDiff == m_jdEnd )
         --blockNumber;  //Special case at end of ephemeris.
+    return blockNumber;
+}
+
+//-----------------------------------------------------------------------------
+
+void
+JPLEphemeris::ReadCoeffBlock( double julianDay0, double julianDay1,
+                              double * coeffBlock ) const
+{
+    int blockNumber = BlockNumber( julianDay0, julianDay1 );
+    if ( m_mappedCoeffs != 0 )
+    {
+        if ( blockNumber >= m_numBlocks )
+            throw LogicError( "Date out of range of JPL ephemeris." );
+        const double * block = m_mappedCoeffs
+                + (blockNumber * m_coeffsPerBlock);
+        copy( block, block + m_coeffsPerBlock, coeffBlock );
+        return;
+    }
+    MutexLock lock( m_readerMutex );
+    ReadBlock( blockNumber, coeffBlock );
+}
+
+//-----------------------------------------------------------------------------
+
+void 
+JPLEphemeris::WriteCompact( Writer & writer,
+                            const vector< ETarget > & targets ) const
+{
+    WriteCompact( writer, targets, m_jdStart, m_jdEnd );
+}
+
+//.............................................................................
+
+void 
+JPLEphemeris::WriteCompact( Writer & writer,
+                            const vector< ETarget > & targets,
+                            double firstJulianDay, double lastJulianDay ) const
+{                                                                /*WriteCompact*/
+    if ( firstJulianDay > lastJulianDay )
+        throw LogicError( "WriteCompact: Empty date range." );
+    bool selected[ NumTargets ];
+    for ( int i = 0; i < NumTargets; ++i )
+        selected[i] = false;
+    for ( int i = 0; i < (int) targets.size(); ++i )
+    {
+        Assert( (targets[i] >= 0) && (targets[i] < NumTargets) );
+        selected[ targets[i] ] = true;
+    }
+    if ( selected[ MoonGeo ] || selected[ EMBary ] )
+        selected[ MoonGeo ] = selected[ EMBary ] = true;
+
+    CoefficientLayout layouts[ NumTargets ];
+    int coeffsPerBlock = 2;     //start and end dates
+    for ( int i = 0; i < NumTargets; ++i )
+    {
+        layouts[i] = m_coeffLayouts[i];
+        if ( selected[i] && (m_coeffLayouts[i].m_numCoeffs > 0) )
+        {
+            layouts[i].m_offset = coeffsPerBlock;
+            coeffsPerBlock += layouts[i].m_numCoeffs
+                    * layouts[i].m_numComponents
+                    * layouts[i].m_numSubIntervals;
+        }
+        else
+        {
+            layouts[i].m_offset = 0;
+            layouts[i].m_numCoeffs = 0;
+            layouts[i].m_numSubIntervals = 0;
+        }
+    }
+    const int alignmentCoeffs = s_compactAlignment / (int) sizeof( double );
+    coeffsPerBlock = ((coeffsPerBlock + alignmentCoeffs - 1) / alignmentCoeffs)
+            * alignmentCoeffs;
+
+    int firstBlock = BlockNumber( firstJulianDay, 0. );
+    int lastBlock = BlockNumber( lastJulianDay, 0. );
+    int numBlocks = lastBlock - firstBlock + 1;
+    vector< double > sourceBlock( m_coeffsPerBlock );
+    ReadCoeffBlock( m_jdStart + (firstBlock + 0.5) * m_blockInterval, 0.,
+                    &sourceBlock[0] );
+    double jdStart = sourceBlock[0];
+    ReadCoeffBlock( m_jdStart + (lastBlock + 0.5) * m_blockInterval, 0.,
+                    &sourceBlock[0] );
+    double jdEnd = sourceBlock[1];
+
+    const int headerSize = (int) sizeof( s_compactMagic )
+            + 2 * (int) sizeof( uint32_t )  +  4 * (int) sizeof( int32_t )
+            + 5 * (int) sizeof( double )
+            + NumTargets * 4 * (int) sizeof( int32_t )
+            + NumTitles * TitleLen;
+    int dataOffset = ((headerSize + s_compactAlignment - 1)
+                      / s_compactAlignment) * s_compactAlignment;
+
+    writer.Write( s_compactMagic, (int) sizeof( s_compactMagic ) );
+    writer.Write( (uint32_t) CompactFormatVersion );
+    writer.Write( s_byteOrderMark );
+    writer.Write( (int32_t) m_version );
+    writer.Write( (int32_t) numBlocks );
+    writer.Write( (int32_t) coeffsPerBlock );
+    writer.Write( (int32_t) dataOffset );
+    writer.Write( jdStart );
+    writer.Write( jdEnd );
+    writer.Write( m_blockInterval );
+    writer.Write( m_astronomicalUnit );
+    writer.Write( m_earthMoonRatio );
+    for ( int i = 0; i < NumTargets; ++i )
+    {
+        writer.Write( (int32_t) layouts[i].m_offset );
+        writer.Write( (int32_t) layouts[i].m_numCoeffs );
+        writer.Write( (int32_t) layouts[i].m_numComponents );
+        writer.Write( (int32_t) layouts[i].m_numSubIntervals );
+    }
+    for ( int i = 0; i < NumTitles; ++i )
+    {
+        string title = m_titles[i];
+        title.resize( TitleLen, ' ' );
+        writer.Write( title.data(), TitleLen );
+    }
+    vector< char > padding( dataOffset - headerSize + 1, 0 );
+    writer.Write( &padding[0], dataOffset - headerSize );
+
+    vector< double > block( coeffsPerBlock, 0. );
+    for ( int b = firstBlock; b <= lastBlock; ++b )
+    {
+        ReadCoeffBlock( m_jdStart + (b + 0.5) * m_blockInterval, 0.,
+                        &sourceBlock[0] );
+        block[0] = sourceBlock[0];
+        block[1] = sourceBlock[1];
+        for ( int i = 0; i < NumTargets; ++i )
+        {
+            if ( layouts[i].m_numCoeffs == 0 )
+                continue;
+            int count = layouts[i].m_numCoeffs * layouts[i].m_numComponents
+                    * layouts[i].m_numSubIntervals;
+            const double * source = &sourceBlock[ m_coeffLayouts[i].m_offset ];
+            copy( source, source + count, &block[ layouts[i].m_offset ] );
+        }
+        writer.Write( reinterpret_cast< const char * >( &block[0] ),
+                      coeffsPerBlock * (int) sizeof( double ) );
+    }
+    ms_log( Logger::Info, "Wrote compact ephemeris: %d blocks of %d coeffs",
+            numBlocks, coeffsPerBlock );
+}                                                                /*WriteCompact*/
+
+//.............................................................................
+
+void
+JPLEphemeris::ReadBlock( int blockNumber, double * coeffBlock ) const
+{
+    //The caller must hold m_readerMutex.
     int blockSize = m_coeffsPerBlock * sizeof( double );
     int blockOffset = m_dataOffset + (blockNumber * blockSize);
     Assert( m_pReader );
@@ -771,55 +1252,93 @@ JPLEphemeris::ReadCoeffBlock( double julianDay0, double julianDay1,
 
 //-----------------------------------------------------------------------------
 
-void 
-JPLEphemeris::LoadCoeffBlock( double julianDay0, double julianDay1 )
+shared_ptr< vector< double > >
+JPLEphemeris::CachedCoeffBlock( int blockNumber,
+                                const shared_ptr< vector< double > > &
+                                spOldBlock ) const
 {
-    //We maintain a cache of two blocks to avoid thrashing if we are computing
-    // positions at a variety of times near a block boundary.
-    //On success, m_coeffBlocks[ m_curBlock ] will be the appropriate block.
-    double * block;
-    if ( m_coeffBlocks[ m_curBlock ].empty() )
+    MutexLock lock( m_readerMutex );
+    if ( m_cacheCapacity > 0 )
     {
-        m_coeffBlocks[ m_curBlock ].resize( m_coeffsPerBlock );
-        block = &(m_coeffBlocks[ m_curBlock ][0]);
+        map< int, CacheEntry >::iterator pEntry
+                = m_blockCache.find( blockNumber );
+        if ( pEntry != m_blockCache.end() )
+        {
+            ++m_cacheStats.m_hits;
+            m_lruBlocks.splice( m_lruBlocks.begin(), m_lruBlocks,
+                                pEntry->second.m_lruPos );
+            return pEntry->second.m_spBlock;
+        }
     }
+    ++m_cacheStats.m_misses;
+    shared_ptr< vector< double > > spBlock;
+    if ( (m_cacheCapacity == 0) && spOldBlock && spOldBlock.unique() )
+        spBlock = spOldBlock;   //Nobody else has it, so reuse the buffer.
     else
+        spBlock.reset( new vector< double >( m_coeffsPerBlock ) );
+    ReadBlock( blockNumber, &(*spBlock)[0] );
+    if ( m_cacheCapacity > 0 )
+    {
+        //Cursors may still hold evicted blocks; they are freed when released.
+        while ( (int) m_blockCache.size() >= m_cacheCapacity )
+        {
+            m_blockCache.erase( m_lruBlocks.back() );
+            m_lruBlocks.pop_back( );
+            ++m_cacheStats.m_evictions;
+        }
+        m_lruBlocks.push_front( blockNumber );
+        CacheEntry & entry = m_blockCache[ blockNumber ];
+        entry.m_spBlock = spBlock;
+        entry.m_lruPos = m_lruBlocks.begin();
+    }
+    return spBlock;
+}
+
+//-----------------------------------------------------------------------------
+
+void 
+JPLEphemeris::LoadCoeffBlock( Cursor * pCursor,
+                              double julianDay0, double julianDay1 ) const
+{
+    //On success, pCursor->m_curCoeffBlock will point to the appropriate block.
+    if ( pCursor->m_pEphemeris != this )
+    {
+        //The cursor's cached blocks, if any, belong to another ephemeris.
+        pCursor->Reset( );
+        pCursor->m_pEphemeris = this;
+    }
+    if ( m_mappedCoeffs != 0 )
+    {
+        //Mapped: no cache needed, just point into the mapping.
+        int blockNumber = BlockNumber( julianDay0, julianDay1 );
+        if ( blockNumber >= m_numBlocks )
+            throw LogicError( "Date out of range of JPL ephemeris." );
+        pCursor->m_curCoeffBlock
+                = m_mappedCoeffs + (blockNumber * m_coeffsPerBlock);
+        return;
+    }
+    const double * block = pCursor->m_curCoeffBlock;
+    if ( block != 0 )
     {
-        block = &(m_coeffBlocks[ m_curBlock ][0]);
         double blockDiff = julianDay0 - block[0];
         blockDiff += julianDay1;
         //block[0] and block[1] contain the start and end dates of the block.
         if ( (blockDiff >= 0.0) && (block[0] + blockDiff <= block[1]) )
             return;
-        else
-        {
-            m_curBlock = 1 - m_curBlock;  //toggle 0 <-> 1
-            if ( m_coeffBlocks[ m_curBlock ].empty() )
-            {
-                m_coeffBlocks[ m_curBlock ].resize( m_coeffsPerBlock );
-                block = &(m_coeffBlocks[ m_curBlock ][0]);
-            }
-            else
-            {
-                block = &(m_coeffBlocks[ m_curBlock ][0]);
-                blockDiff = julianDay0 - block[0];
-                blockDiff += julianDay1;
-                if ( (blockDiff >= 0.0) && (block[0] + blockDiff <= block[1]) )
-                    return;
-            }
-        }
     }
-    ReadCoeffBlock( julianDay0, julianDay1, block );
+    int blockNumber = BlockNumber( julianDay0, julianDay1 );
+    pCursor->m_spCoeffBlock
+            = CachedCoeffBlock( blockNumber, pCursor->m_spCoeffBlock );
+    pCursor->m_curCoeffBlock = &(*pCursor->m_spCoeffBlock)[0];
 }
 
 //.............................................................................
 
-void 
-JPLEphemeris::GetTargetCoefficients( double julianDay0, double julianDay1, 
-                                     ETarget target )
+int
+JPLEphemeris::SubInterval( const double * coeffBlock,
+                           double julianDay0, double julianDay1,
+                           ETarget target, double * pTimeFrac ) const
 {
-    const double * coeffBlock = &m_coeffBlocks[ m_curBlock ][0];
-    m_targetCoeffs = coeffBlock + m_coeffLayouts[ target ].m_offset;
     double blockDiff = julianDay0 - coeffBlock[0];
     blockDiff += julianDay1;
     double blockFrac = blockDiff / m_blockInterval;
@@ -827,60 +1346,81 @@ JPLEphemeris::GetTargetCoefficients( double julianDay0, double julianDay1,
     double bf1 = (double)((int) blockFrac);
     //use bf1 to catch the special case blockFrac==1.0.
     int subIntervalIndex = (int)( blockFrac * numSubIntervals  -  bf1 );
+    double subInterval = m_blockInterval / numSubIntervals;
+    double subIntervalDiff = blockDiff  -  subIntervalIndex * subInterval;
+    *pTimeFrac = subIntervalDiff / subInterval;
+    Assert( (*pTimeFrac >= 0.0) && (*pTimeFrac <= 1.0) );
+    return subIntervalIndex;
+}
+
+//.............................................................................
+
+void 
+JPLEphemeris::GetTargetCoefficients( Cursor * pCursor,
+                                     double julianDay0, double julianDay1, 
+                                     ETarget target ) const
+{
+    const double * coeffBlock = pCursor->m_curCoeffBlock;
+    Assert( coeffBlock != 0 );
+    int subIntervalIndex = SubInterval( coeffBlock, julianDay0, julianDay1,
+                                        target, &pCursor->m_timeFrac );
     int offset = subIntervalIndex * m_coeffLayouts[ target ].m_numCoeffs
             * m_coeffLayouts[ target ].m_numComponents;
-    m_targetCoeffs += offset;
-    m_subInterval = m_blockInterval / numSubIntervals;
-    double subIntervalDiff = blockDiff  -  subIntervalIndex * m_subInterval;
-    m_timeFrac = subIntervalDiff / m_subInterval;
-    Assert( (m_timeFrac >= 0.0) && (m_timeFrac <= 1.0) );
+    pCursor->m_targetCoeffs = coeffBlock + m_coeffLayouts[ target ].m_offset
+            + offset;
+    pCursor->m_subInterval = m_blockInterval
+            / m_coeffLayouts[ target ].m_numSubIntervals;
 }
 
 //.............................................................................
 
 double 
-JPLEphemeris::EvalChebyshev( const double * coeffs, int numCoeffs,
+JPLEphemeris::EvalChebyshev( Cursor * pCursor,
+                             const double * coeffs, int numCoeffs,
                              double timeFrac,
-                             double * pDerivative )
+                             double * pDerivative ) const
 {
     Assert( (timeFrac >= 0.0) && (timeFrac <= 1.0) );
+    double * chebyVals = pCursor->m_chebyVals;
+    double * chebyDerivs = pCursor->m_chebyDerivs;
     double t = 2.0 * timeFrac  -  1.0;
-    if ( t != m_chebyVals[1] )
+    if ( t != chebyVals[1] )
     {
         //Chebyshev polynomials not cached; start from scratch.
-        m_numChebys = 2;
-        m_chebyVals[1] = t;
-        m_t2 = t + t;
-        m_numDerivs = 3;
-        m_chebyDerivs[2] = m_t2 + m_t2;
+        pCursor->m_numChebys = 2;
+        chebyVals[1] = t;
+        pCursor->m_t2 = t + t;
+        pCursor->m_numDerivs = 3;
+        chebyDerivs[2] = pCursor->m_t2 + pCursor->m_t2;
     }
-    if ( m_numChebys < numCoeffs )
+    double t2 = pCursor->m_t2;
+    if ( pCursor->m_numChebys < numCoeffs )
     {
         //Compute remaining Chebyshev polynomials.
-        double * pVal = m_chebyVals + m_numChebys;
-        for ( int i = (numCoeffs - m_numChebys); i > 0; --i, ++pVal )
-            *pVal = m_t2 * pVal[-1]  -  pVal[-2];
-        m_numChebys = numCoeffs;
+        double * pVal = chebyVals + pCursor->m_numChebys;
+        for ( int i = (numCoeffs - pCursor->m_numChebys); i > 0; --i, ++pVal )
+            *pVal = t2 * pVal[-1]  -  pVal[-2];
+        pCursor->m_numChebys = numCoeffs;
     }
     double x = 0.0;
-    const double * pVal = m_chebyVals + numCoeffs;
+    const double * pVal = chebyVals + numCoeffs;
     const double * pCoeff = coeffs + numCoeffs;
     for ( int i = numCoeffs; i > 0; --i )
         x += (*--pVal) * (*--pCoeff);
 
     if ( pDerivative != 0 )
     {
-        if ( m_numDerivs < numCoeffs )
+        if ( pCursor->m_numDerivs < numCoeffs )
         {
-            double * pDeriv = m_chebyDerivs + m_numDerivs;
-            pVal = m_chebyVals + m_numDerivs - 1;
-            for ( int i = (numCoeffs - m_numDerivs); i > 0;
+            double * pDeriv = chebyDerivs + pCursor->m_numDerivs;
+            pVal = chebyVals + pCursor->m_numDerivs - 1;
+            for ( int i = (numCoeffs - pCursor->m_numDerivs); i > 0;
                   --i, ++pDeriv, ++pVal )
-                *pDeriv = m_t2 * pDeriv[-1]  +  *pVal + *pVal  -  pDeriv[-2];
-            m_numDerivs = numCoeffs;
+                *pDeriv = t2 * pDeriv[-1]  +  *pVal + *pVal  -  pDeriv[-2];
+            pCursor->m_numDerivs = numCoeffs;
         }
         double v = 0.0;
-        const double * pDeriv = m_chebyDerivs + numCoeffs;
+        const double * pDeriv = chebyDerivs + numCoeffs;
         pCoeff = coeffs + numCoeffs;
         for ( int i = numCoeffs; i > 1; --i )
             v += (*--pDeriv) * (*--pCoeff);
@@ -893,33 +1433,36 @@ JPLEphemeris::EvalChebyshev( const double * coeffs, int numCoeffs,
 //.............................................................................
 
 bool 
-JPLEphemeris::ComputeComponents( double julianDay0, double julianDay1,
+JPLEphemeris::ComputeComponents( Cursor * pCursor,
+                                 double julianDay0, double julianDay1,
                                  ETarget target,
                                  Vector3D * pComponents,
-                                 Vector3D * pDerivatives )
+                                 Vector3D * pDerivatives ) const
 {
-    ms_log( Logger::Debug1, "ComputeComponents JD="
-            + RealToString( julianDay0 + julianDay1, 10, 1 )
-            + " target=" + IntToString( target ) );
+    if ( ms_log.IsEnabled( Logger::Debug1 ) )
+        ms_log( Logger::Debug1, "ComputeComponents JD="
+                + RealToString( julianDay0 + julianDay1, 10, 1 )
+                + " target=" + IntToString( target ) );
 
     Assert( pComponents != 0 );
-    LoadCoeffBlock( julianDay0, julianDay1 );
-    GetTargetCoefficients( julianDay0, julianDay1, target );
+    LoadCoeffBlock( pCursor, julianDay0, julianDay1 );
+    GetTargetCoefficients( pCursor, julianDay0, julianDay1, target );
     int numComponents = m_coeffLayouts[ target ].m_numComponents;
     int numCoeffs = m_coeffLayouts[ target ].m_numCoeffs;
     for ( int i = 0; i < numComponents; ++i )
     {
         double & comp = (*pComponents)[i];
         if ( pDerivatives == 0 )
-            comp = EvalChebyshev( m_targetCoeffs, numCoeffs, m_timeFrac );
+            comp = EvalChebyshev( pCursor, pCursor->m_targetCoeffs, numCoeffs,
+                                  pCursor->m_timeFrac );
         else
         {
             double & deriv = (*pDerivatives)[i];
-            comp = EvalChebyshev( m_targetCoeffs, numCoeffs, m_timeFrac,
-                                  &deriv );
-            deriv /= m_subInterval;
+            comp = EvalChebyshev( pCursor, pCursor->m_targetCoeffs, numCoeffs,
+                                  pCursor->m_timeFrac, &deriv );
+            deriv /= pCursor->m_subInterval;
         }
-        m_targetCoeffs += numCoeffs;
+        pCursor->m_targetCoeffs += numCoeffs;
     }
     return true;
 }
@@ -929,7 +1472,403 @@ JPLEphemeris::ComputeComponents( double julianDay0, double julianDay1,
 namespace
 {
 
-vector< shared_ptr< JPLEphemeris > > s_ephemerides;
+const int BatchSize = 64;
+
+//-----------------------------------------------------------------------------
+
+//Evaluates one component of a Chebyshev series for several values of
+// t = 2 timeFrac - 1, using Clenshaw's recurrence. The loops over the epochs
+// are innermost, so they can be vectorized.
+void
+EvalChebyshevBatch( const double * coeffs, int numCoeffs,
+                    const double * t, int count,
+                    double * values, double * derivatives )
+{
+    Assert( count <= BatchSize );
+    double t2[ BatchSize ];
+    double b1[ BatchSize ];
+    double b2[ BatchSize ];
+    for ( int e = 0; e < count; ++e )
+    {
+        t2[e] = t[e] + t[e];
+        b1[e] = 0.0;
+        b2[e] = 0.0;
+    }
+    for ( int k = numCoeffs - 1; k > 0; --k )
+    {
+        double c = coeffs[k];
+        for ( int e = 0; e < count; ++e )
+        {
+            double b0 = c  +  t2[e] * b1[e]  -  b2[e];
+            b2[e] = b1[e];
+            b1[e] = b0;
+        }
+    }
+    double c0 = coeffs[0];
+    for ( int e = 0; e < count; ++e )
+        values[e] = c0  +  t[e] * b1[e]  -  b2[e];
+
+    if ( derivatives != 0 )
+    {
+        //d/dt T[k](t) = k U[k-1](t), so sum k c[k] U[k-1](t).
+        for ( int e = 0; e < count; ++e )
+        {
+            b1[e] = 0.0;
+            b2[e] = 0.0;
+        }
+        for ( int k = numCoeffs - 1; k > 0; --k )
+        {
+            double c = k * coeffs[k];
+            for ( int e = 0; e < count; ++e )
+            {
+                double b0 = c  +  t2[e] * b1[e]  -  b2[e];
+                b2[e] = b1[e];
+                b1[e] = b0;
+            }
+        }
+        for ( int e = 0; e < count; ++e )
+            derivatives[e] = 2.0 * b1[e];
+    }
+}
+
+}
+
+//-----------------------------------------------------------------------------
+
+void 
+JPLEphemeris::ComputeComponentsBatch( Cursor * pCursor,
+                                      const double * julianDays, int count,
+                                      ETarget target,
+                                      Vector3D * pComponents,
+                                      Vector3D * pDerivatives ) const
+{
+    Assert( count <= BatchSize );
+    const CoefficientLayout & layout = m_coeffLayouts[ target ];
+    double subInterval = m_blockInterval / layout.m_numSubIntervals;
+    double t[ BatchSize ];
+    double values[ BatchSize ];
+    double derivs[ BatchSize ];
+    int start = 0;
+    while ( start < count )
+    {
+        //Gather the following epochs that share a sub-interval.
+        LoadCoeffBlock( pCursor, julianDays[ start ], 0.0 );
+        const double * block = pCursor->m_curCoeffBlock;
+        double timeFrac;
+        int subIntervalIndex = SubInterval( block, julianDays[ start ], 0.0,
+                                            target, &timeFrac );
+        t[0] = 2.0 * timeFrac  -  1.0;
+        int end = start + 1;
+        while ( end < count )
+        {
+            double blockDiff = julianDays[ end ] - block[0];
+            if ( (blockDiff < 0.0) || (block[0] + blockDiff > block[1]) )
+                break;
+            if ( SubInterval( block, julianDays[ end ], 0.0, target,
+                              &timeFrac ) != subIntervalIndex )
+                break;
+            t[ end - start ] = 2.0 * timeFrac  -  1.0;
+            ++end;
+        }
+
+        int num = end - start;
+        const double * coeffs = block + layout.m_offset
+                + subIntervalIndex * layout.m_numCoeffs
+                * layout.m_numComponents;
+        for ( int i = 0; i < layout.m_numComponents; ++i )
+        {
+            if ( pDerivatives == 0 )
+            {
+                EvalChebyshevBatch( coeffs, layout.m_numCoeffs, t, num,
+                                    values, 0 );
+                for ( int e = 0; e < num; ++e )
+                    pComponents[ start + e ][i] = values[e];
+            }
+            else
+            {
+                EvalChebyshevBatch( coeffs, layout.m_numCoeffs, t, num,
+                                    values, derivs );
+                for ( int e = 0; e < num; ++e )
+                {
+                    pComponents[ start + e ][i] = values[e];
+                    pDerivatives[ start + e ][i] = derivs[e] / subInterval;
+                }
+            }
+            coeffs += layout.m_numCoeffs;
+        }
+        start = end;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+bool 
+JPLEphemeris::GetBodyPositions( const double * julianDays, int count,
+                                EBody body, EBody origin,
+                                Point3D * pPositions, Vector3D * pVelocities )
+{
+    return GetBodyPositions( &m_cursor, julianDays, count, body, origin,
+                             pPositions, pVelocities );
+}
+
+//.............................................................................
+
+bool 
+JPLEphemeris::GetBodyPositions( Cursor * pCursor,
+                                const double * julianDays, int count,
+                                EBody body, EBody origin,
+                                Point3D * pPositions,
+                                Vector3D * pVelocities ) const
+{                                                          /*GetBodyPositions*/
+    Assert( pCursor != 0 );
+    Assert( pPositions != 0 );
+
+    if ( body == origin )
+    {
+        for ( int i = 0; i < count; ++i )
+        {
+            pPositions[i].Set( 0., 0., 0. );
+            if ( pVelocities != 0 )
+                pVelocities[i].Set( 0., 0., 0. );
+        }
+        return true;
+    }
+    if ( ! (BodyAvailable( body ) && BodyAvailable( origin )) )
+        return false;
+
+    //Same cases as GetBodyPosition().
+    if ( (body == SolarSystemBarycenter)
+         || ((body == Earth) && (origin != SolarSystemBarycenter))
+         || ((body == Moon) && (origin != SolarSystemBarycenter)
+             && (origin != Earth) && (origin != EarthMoonBarycenter))
+         || ((body == EarthMoonBarycenter)
+             && (origin != SolarSystemBarycenter) && (origin != Earth)) )
+    {
+        bool posRslt = GetBodyPositions( pCursor, julianDays, count,
+                                         origin, body,
+                                         pPositions, pVelocities );
+        for ( int i = 0; i < count; ++i )
+        {
+            pPositions[i].Set( - pPositions[i].ToVector() );
+            if ( pVelocities != 0 )
+                pVelocities[i] = - pVelocities[i];
+        }
+        return posRslt;
+    }
+
+    const ETarget bodyToTarget[ NumBodies ]
+            = { NumTargets, Sol, Mer, Ven, NumTargets, NumTargets,
+                EMBary, Mar, Jup, Sat, Ura, Nep, Plu };
+    const double emrr = m_earthMoonRatio / (1.0 + m_earthMoonRatio);
+    const double emrr1 = 1.0 / (1.0 + m_earthMoonRatio);
+    Vector3D bodyPos[ BatchSize ];
+    Vector3D bodyVel[ BatchSize ];
+    Vector3D originPos[ BatchSize ];
+    Vector3D originVel[ BatchSize ];
+    Vector3D moonPos[ BatchSize ];
+    Vector3D moonVel[ BatchSize ];
+    Vector3D embPos[ BatchSize ];
+    Vector3D embVel[ BatchSize ];
+    bool vel = (pVelocities != 0);
+
+    for ( int start = 0; start < count; start += BatchSize )
+    {
+        int num = min( BatchSize, count - start );
+        const double * jds = julianDays + start;
+        Point3D * pPos = pPositions + start;
+        Vector3D * pVel = vel  ?  pVelocities + start  :  0;
+
+        if ( body == Earth )
+        {
+            ComputeComponentsBatch( pCursor, jds, num, MoonGeo,
+                                    moonPos, (vel ? moonVel : 0) );
+            ComputeComponentsBatch( pCursor, jds, num, EMBary,
+                                    embPos, (vel ? embVel : 0) );
+            for ( int e = 0; e < num; ++e )
+            {
+                pPos[e].Set( embPos[e]  -  moonPos[e] * emrr1 );
+                if ( vel )
+                    pVel[e] = embVel[e]  -  moonVel[e] * emrr1;
+            }
+        }
+        else if ( (body == Moon) || (body == EarthMoonBarycenter) )
+        {
+            if ( (body == EarthMoonBarycenter)
+                 && (origin == SolarSystemBarycenter) )
+            {
+                ComputeComponentsBatch( pCursor, jds, num, EMBary,
+                                        embPos, (vel ? embVel : 0) );
+                for ( int e = 0; e < num; ++e )
+                {
+                    pPos[e].Set( embPos[e] );
+                    if ( vel )
+                        pVel[e] = embVel[e];
+                }
+                continue;
+            }
+            ComputeComponentsBatch( pCursor, jds, num, MoonGeo,
+                                    moonPos, (vel ? moonVel : 0) );
+            if ( (body == Moon) && (origin == SolarSystemBarycenter) )
+                ComputeComponentsBatch( pCursor, jds, num, EMBary,
+                                        embPos, (vel ? embVel : 0) );
+            for ( int e = 0; e < num; ++e )
+            {
+                if ( body == EarthMoonBarycenter )
+                {
+                    Assert( origin == Earth );
+                    pPos[e].Set( moonPos[e] * emrr1 );
+                    if ( vel )
+                        pVel[e] = moonVel[e] * emrr1;
+                }
+                else if ( origin == Earth )
+                {
+                    pPos[e].Set( moonPos[e] );
+                    if ( vel )
+                        pVel[e] = moonVel[e];
+                }
+                else if ( origin == EarthMoonBarycenter )
+                {
+                    pPos[e].Set( moonPos[e] * emrr );
+                    if ( vel )
+                        pVel[e] = moonVel[e] * emrr;
+                }
+                else
+                {
+                    Assert( origin == SolarSystemBarycenter );
+                    pPos[e].Set( embPos[e]  +  moonPos[e] * emrr );
+                    if ( vel )
+                        pVel[e] = embVel[e]  +  moonVel[e] * emrr;
+                }
+            }
+        }
+        else
+        {
+            ETarget target = bodyToTarget[ body ];
+            Assert( target < NumTargets );
+            ComputeComponentsBatch( pCursor, jds, num, target,
+                                    bodyPos, (vel ? bodyVel : 0) );
+            if ( origin == SolarSystemBarycenter )
+            {
+                for ( int e = 0; e < num; ++e )
+                {
+                    pPos[e].Set( bodyPos[e] );
+                    if ( vel )
+                        pVel[e] = bodyVel[e];
+                }
+                continue;
+            }
+            ETarget center = bodyToTarget[ origin ];
+            if ( center < NumTargets )
+            {
+                ComputeComponentsBatch( pCursor, jds, num, center,
+                                        originPos, (vel ? originVel : 0) );
+            }
+            else
+            {
+                Assert( (origin == Earth) || (origin == Moon) );
+                ComputeComponentsBatch( pCursor, jds, num, MoonGeo,
+                                        moonPos, (vel ? moonVel : 0) );
+                ComputeComponentsBatch( pCursor, jds, num, EMBary,
+                                        embPos, (vel ? embVel : 0) );
+                double f = (origin == Earth)  ?  - emrr1  :  emrr;
+                for ( int e = 0; e < num; ++e )
+                {
+                    originPos[e] = embPos[e]  +  moonPos[e] * f;
+                    if ( vel )
+                        originVel[e] = embVel[e]  +  moonVel[e] * f;
+                }
+            }
+            for ( int e = 0; e < num; ++e )
+            {
+                pPos[e].Set( bodyPos[e] - originPos[e] );
+                if ( vel )
+                    pVel[e] = bodyVel[e] - originVel[e];
+            }
+        }
+    }
+    return true;
+}                                                          /*GetBodyPositions*/
+
+//=============================================================================
+
+namespace
+{
+
+//An immutable snapshot of the registered ephemerides (see Note 8).
+struct EphemerisRegistry
+{
+    void Index( );
+    int Select( double jd ) const;
+    int Find( double jd ) const;
+
+    //in order of registration
+    vector< shared_ptr< JPLEphemeris > > m_ephemerides;
+    //distinct first and last Julian Days of the ephemerides, sorted
+    vector< double > m_breakpoints;
+    //index of the ephemeris selected at each breakpoint, and between it and
+    // the next; -1 if none
+    vector< int > m_atBreakpoint;
+    vector< int > m_afterBreakpoint;
+};
+
+//.............................................................................
+
+void
+EphemerisRegistry::Index( )
+{
+    m_breakpoints.clear( );
+    for ( int i = 0; i < (int) m_ephemerides.size(); ++i )
+    {
+        m_breakpoints.push_back( m_ephemerides[i]->firstJulianDay() );
+        m_breakpoints.push_back( m_ephemerides[i]->lastJulianDay() );
+    }
+    sort( m_breakpoints.begin(), m_breakpoints.end() );
+    m_breakpoints.erase( unique( m_breakpoints.begin(), m_breakpoints.end() ),
+                         m_breakpoints.end() );
+    int numBreakpoints = (int) m_breakpoints.size();
+    m_atBreakpoint.resize( numBreakpoints );
+    m_afterBreakpoint.resize( numBreakpoints );
+    for ( int i = 0; i < numBreakpoints; ++i )
+    {
+        m_atBreakpoint[i] = Select( m_breakpoints[i] );
+        m_afterBreakpoint[i] = (i + 1 < numBreakpoints)
+                ?  Select( 0.5 * (m_breakpoints[i] + m_breakpoints[i+1]) )
+                :  -1;
+    }
+}
+
+//.............................................................................
+
+int
+EphemerisRegistry::Select( double jd ) const
+{
+    for ( int i = 0; i < (int) m_ephemerides.size(); ++i )
+        if ( (m_ephemerides[i]->firstJulianDay() <= jd)
+             && (jd <= m_ephemerides[i]->lastJulianDay()) )
+            return i;
+    return -1;
+}
+
+//.............................................................................
+
+int
+EphemerisRegistry::Find( double jd ) const
+{
+    vector< double >::const_iterator pBreak
+            = upper_bound( m_breakpoints.begin(), m_breakpoints.end(), jd );
+    if ( pBreak == m_breakpoints.begin() )
+        return -1;
+    int i = (int)(pBreak - m_breakpoints.begin()) - 1;
+    if ( m_breakpoints[i] == jd )
+        return m_atBreakpoint[i];
+    return m_afterBreakpoint[i];
+}
+
+//-----------------------------------------------------------------------------
+
+//The current registry is read without locking (see PublishedPtr).
+PublishedPtr< EphemerisRegistry > s_registry;
+Mutex s_registryMutex;  //serializes RegisterEphemeris()
 
 } //namespace
 
@@ -938,7 +1877,15 @@ vector< shared_ptr< JPLEphemeris > > s_ephemerides;
 void 
 JPLEphemeris::RegisterEphemeris( shared_ptr< JPLEphemeris > spEphem )
 {
-    s_ephemerides.push_back( spEphem );
+    Assert( spEphem );
+    MutexLock lock( s_registryMutex );
+    shared_ptr< EphemerisRegistry > spRegistry( new EphemerisRegistry );
+    const EphemerisRegistry * pOldRegistry = s_registry.Get( );
+    if ( pOldRegistry )
+        spRegistry->m_ephemerides = pOldRegistry->m_ephemerides;
+    spRegistry->m_ephemerides.push_back( spEphem );
+    spRegistry->Index( );
+    s_registry.Publish( spRegistry );
 }
 
 //-----------------------------------------------------------------------------
@@ -946,19 +1893,25 @@ JPLEphemeris::RegisterEphemeris( shared_ptr< JPLEphemeris > spEphem )
 shared_ptr< JPLEphemeris >
 JPLEphemeris::GetEphemeris( double jd )
 {
-    ms_log( Logger::Debug1, "GetEphemeris JD=%11.2f ephems.size=%d",
-            jd, (int) s_ephemerides.size() );
-    for ( int i = 0; i < (int) s_ephemerides.size(); ++i )
-    {
-        ms_log( Logger::Debug2, " %d: ephem=%p  firstJD=%11.2f  lastJD=%11.2f",
-                i, s_ephemerides[i].get(),
-                s_ephemerides[i]->firstJulianDay(),
-                s_ephemerides[i]->lastJulianDay() );
-        if ( (s_ephemerides[i]->firstJulianDay() <= jd)
-             && (jd <= s_ephemerides[i]->lastJulianDay()) )
-            return s_ephemerides[i];
-    }
-    return shared_ptr< JPLEphemeris >();
+    const EphemerisRegistry * pRegistry = s_registry.Get( );
+    int index = pRegistry  ?  pRegistry->Find( jd )  :  -1;
+    if ( ms_log.IsEnabled( Logger::Debug1 ) )
+        ms_log( Logger::Debug1, "GetEphemeris JD=%11.2f index=%d", jd, index );
+    if ( index < 0 )
+        return shared_ptr< JPLEphemeris >();
+    return pRegistry->m_ephemerides[ index ];
+}
+
+//-----------------------------------------------------------------------------
+
+JPLEphemeris *
+JPLEphemeris::FindEphemeris( double jd )
+{
+    const EphemerisRegistry * pRegistry = s_registry.Get( );
+    int index = pRegistry  ?  pRegistry->Find( jd )  :  -1;
+    if ( index < 0 )
+        return 0;
+    return pRegistry->m_ephemerides[ index ].get();
 }
 
 //=============================================================================
@@ -976,12 +1929,17 @@ JPLEphemeris::Log( )
 Point3D 
 JPLBarycentricEphemeris::operator()( double julianDay )
 {
-    shared_ptr< JPLEphemeris > spEphemeris = GetEphemeris( julianDay );
+    JPLEphemeris * pEphemeris = GetEphemeris( julianDay );
     Point3D bodyPos;
-    bool posRslt
-            = spEphemeris->GetBodyPosition( julianDay, m_body,
-                                            JPLEphemeris::SolarSystemBarycenter,
-                                            &bodyPos );
+    bool posRslt;
+    if ( m_pCursor )
+        posRslt = pEphemeris->GetBodyPosition( m_pCursor, julianDay, m_body,
+                                         JPLEphemeris::SolarSystemBarycenter,
+                                         &bodyPos );
+    else
+        posRslt = pEphemeris->GetBodyPosition( julianDay, m_body,
+                                         JPLEphemeris::SolarSystemBarycenter,
+                                         &bodyPos );
     if ( ! posRslt )
         throw RuntimeError( "JPLBarycentricEphemeris failed." );
     return bodyPos;
@@ -992,13 +1950,18 @@ JPLBarycentricEphemeris::operator()( double julianDay )
 Point3D 
 JPLBarycentricEphemeris::operator()( double julianDay0, double julianDay1 )
 {
-    shared_ptr< JPLEphemeris > spEphemeris
-            = GetEphemeris( julianDay0 + julianDay1 );
+    JPLEphemeris * pEphemeris = GetEphemeris( julianDay0 + julianDay1 );
     Point3D bodyPos;
-    bool posRslt
-            = spEphemeris->GetBodyPosition( julianDay0, julianDay1, m_body,
-                                            JPLEphemeris::SolarSystemBarycenter,
-                                            &bodyPos );
+    bool posRslt;
+    if ( m_pCursor )
+        posRslt = pEphemeris->GetBodyPosition( m_pCursor,
+                                         julianDay0, julianDay1, m_body,
+                                         JPLEphemeris::SolarSystemBarycenter,
+                                         &bodyPos );
+    else
+        posRslt = pEphemeris->GetBodyPosition( julianDay0, julianDay1, m_body,
+                                         JPLEphemeris::SolarSystemBarycenter,
+                                         &bodyPos );
     if ( ! posRslt )
         throw RuntimeError( "JPLBarycentricEphemeris failed." );
     return bodyPos;
@@ -1011,11 +1974,16 @@ JPLBarycentricEphemeris::operator()( double julianDay,
                                      Point3D * pPosition,
                                      Vector3D * pVelocity )
 {
-    shared_ptr< JPLEphemeris > spEphemeris = GetEphemeris( julianDay );
-    bool posRslt
-            = spEphemeris->GetBodyPosition( julianDay, m_body,
-                                            JPLEphemeris::SolarSystemBarycenter,
-                                            pPosition, pVelocity );
+    JPLEphemeris * pEphemeris = GetEphemeris( julianDay );
+    bool posRslt;
+    if ( m_pCursor )
+        posRslt = pEphemeris->GetBodyPosition( m_pCursor, julianDay, m_body,
+                                         JPLEphemeris::SolarSystemBarycenter,
+                                         pPosition, pVelocity );
+    else
+        posRslt = pEphemeris->GetBodyPosition( julianDay, m_body,
+                                         JPLEphemeris::SolarSystemBarycenter,
+                                         pPosition, pVelocity );
     if ( ! posRslt )
         throw RuntimeError( "JPLBarycentricEphemeris failed." );
 }
@@ -1027,12 +1995,17 @@ JPLBarycentricEphemeris::operator()( double julianDay0, double julianDay1,
                                      Point3D * pPosition,
                                      Vector3D * pVelocity )
 {
-    shared_ptr< JPLEphemeris > spEphemeris
-            = GetEphemeris( julianDay0 + julianDay1 );
-    bool posRslt
-            = spEphemeris->GetBodyPosition( julianDay0, julianDay1, m_body,
-                                            JPLEphemeris::SolarSystemBarycenter,
-                                            pPosition, pVelocity );
+    JPLEphemeris * pEphemeris = GetEphemeris( julianDay0 + julianDay1 );
+    bool posRslt;
+    if ( m_pCursor )
+        posRslt = pEphemeris->GetBodyPosition( m_pCursor,
+                                         julianDay0, julianDay1, m_body,
+                                         JPLEphemeris::SolarSystemBarycenter,
+                                         pPosition, pVelocity );
+    else
+        posRslt = pEphemeris->GetBodyPosition( julianDay0, julianDay1, m_body,
+                                         JPLEphemeris::SolarSystemBarycenter,
+                                         pPosition, pVelocity );
     if ( ! posRslt )
         throw RuntimeError( "JPLBarycentricEphemeris failed." );
 }
@@ -1044,12 +2017,17 @@ JPLBarycentricEphemeris::operator()( double julianDay0, double julianDay1,
 Point3D 
 JPLGeocentricEphemeris::operator()( double julianDay )
 {
-    shared_ptr< JPLEphemeris > spEphemeris = GetEphemeris( julianDay );
+    JPLEphemeris * pEphemeris = GetEphemeris( julianDay );
     Point3D bodyPos;
-    bool posRslt
-            = spEphemeris->GetBodyPosition( julianDay, m_body,
-                                            JPLEphemeris::Earth, 
-                                            &bodyPos );
+    bool posRslt;
+    if ( m_pCursor )
+        posRslt = pEphemeris->GetBodyPosition( m_pCursor, julianDay, m_body,
+                                         JPLEphemeris::Earth,
+                                         &bodyPos );
+    else
+        posRslt = pEphemeris->GetBodyPosition( julianDay, m_body,
+                                         JPLEphemeris::Earth,
+                                         &bodyPos );
     if ( ! posRslt )
         throw RuntimeError( "JPLGeocentricEphemeris failed." );
     return bodyPos;
@@ -1060,13 +2038,18 @@ JPLGeocentricEphemeris::operator()( double julianDay )
 Point3D 
 JPLGeocentricEphemeris::operator()( double julianDay0, double julianDay1 )
 {
-    shared_ptr< JPLEphemeris > spEphemeris
-            = GetEphemeris( julianDay0 + julianDay1 );
+    JPLEphemeris * pEphemeris = GetEphemeris( julianDay0 + julianDay1 );
     Point3D bodyPos;
-    bool posRslt
-            = spEphemeris->GetBodyPosition( julianDay0, julianDay1, m_body,
-                                            JPLEphemeris::Earth, 
-                                            &bodyPos );
+    bool posRslt;
+    if ( m_pCursor )
+        posRslt = pEphemeris->GetBodyPosition( m_pCursor,
+                                         julianDay0, julianDay1, m_body,
+                                         JPLEphemeris::Earth,
+                                         &bodyPos );
+    else
+        posRslt = pEphemeris->GetBodyPosition( julianDay0, julianDay1, m_body,
+                                         JPLEphemeris::Earth,
+                                         &bodyPos );
     if ( ! posRslt )
         throw RuntimeError( "JPLGeocentricEphemeris failed." );
     return bodyPos;
@@ -1079,11 +2062,16 @@ JPLGeocentricEphemeris::operator()( double julianDay,
                                     Point3D * pPosition,
                                     Vector3D * pVelocity )
 {
-    shared_ptr< JPLEphemeris > spEphemeris = GetEphemeris( julianDay );
-    bool posRslt
-            = spEphemeris->GetBodyPosition( julianDay, m_body,
-                                            JPLEphemeris::Earth,
-                                            pPosition, pVelocity );
+    JPLEphemeris * pEphemeris = GetEphemeris( julianDay );
+    bool posRslt;
+    if ( m_pCursor )
+        posRslt = pEphemeris->GetBodyPosition( m_pCursor, julianDay, m_body,
+                                         JPLEphemeris::Earth,
+                                         pPosition, pVelocity );
+    else
+        posRslt = pEphemeris->GetBodyPosition( julianDay, m_body,
+                                         JPLEphemeris::Earth,
+                                         pPosition, pVelocity );
     if ( ! posRslt )
         throw RuntimeError( "JPLBarycentricEphemeris failed." );
 }
@@ -1095,12 +2083,17 @@ JPLGeocentricEphemeris::operator()( double julianDay0, double julianDay1,
                                     Point3D * pPosition,
                                     Vector3D * pVelocity )
 {
-    shared_ptr< JPLEphemeris > spEphemeris
-            = GetEphemeris( julianDay0 + julianDay1 );
-    bool posRslt
-            = spEphemeris->GetBodyPosition( julianDay0, julianDay1, m_body,
-                                            JPLEphemeris::Earth,
-                                            pPosition, pVelocity );
+    JPLEphemeris * pEphemeris = GetEphemeris( julianDay0 + julianDay1 );
+    bool posRslt;
+    if ( m_pCursor )
+        posRslt = pEphemeris->GetBodyPosition( m_pCursor,
+                                         julianDay0, julianDay1, m_body,
+                                         JPLEphemeris::Earth,
+                                         pPosition, pVelocity );
+    else
+        posRslt = pEphemeris->GetBodyPosition( julianDay0, julianDay1, m_body,
+                                         JPLEphemeris::Earth,
+                                         pPosition, pVelocity );
     if ( ! posRslt )
         throw RuntimeError( "JPLBarycentricEphemeris failed." );
 }
@@ -1157,6 +2150,7 @@ JPLEphemeris::Test( const string & testFileName, bool verbose )
 
     char testLine[ 102 ];
     int lineNum = 0;
+    Cursor cursor;
 
     for ( int i = 0; i < NumTitles; ++i )
         if ( Title( i ).size() > 0 )
@@ -1192,6 +2186,8 @@ JPLEphemeris::Test( const string & testFileName, bool verbose )
         bool rslt;
         if ( targNum == 14 )
         {
+            if ( m_compact && ! NutationAvailable() )
+                continue;   //Not all targets are in a compact file.
             Nutation nutation;
             if ( component < 2 )
             {
@@ -1225,6 +2221,8 @@ JPLEphemeris::Test( const string & testFileName, bool verbose )
         }
         else if ( targNum == 15 )
         {
+            if ( m_compact && ! LibrationAvailable() )
+                continue;
             Vector3< Angle > libration;
             if ( component < 3 )
             {
@@ -1263,6 +2261,9 @@ JPLEphemeris::Test( const string & testFileName, bool verbose )
             Assert( body < NumBodies );
             EBody origin = numToBody[ origNum - 1 ];
             Assert( origin < NumBodies );
+            if ( m_compact
+                 && ! (BodyAvailable( body ) && BodyAvailable( origin )) )
+                continue;
 
             Point3D position;
             if ( component < 3 )
@@ -1290,6 +2291,43 @@ JPLEphemeris::Test( const string & testFileName, bool verbose )
                 }
                 computedValue = velocity[ component - 3 ] / AUinKM();
             }
+
+            //The thread-safe version should agree exactly.
+            Point3D cursorPosition;
+            Vector3D cursorVelocity;
+            rslt = GetBodyPosition( &cursor, julianDay, body, origin,
+                                    &cursorPosition, &cursorVelocity );
+            double cursorValue = ( (component < 3)
+                                   ?  cursorPosition[ component ]
+                                   :  cursorVelocity[ component - 3 ] )
+                    / AUinKM();
+            if ( (! rslt) || (cursorValue != computedValue) )
+            {
+                cout << "GetBodyPosition( Cursor * ) disagrees. Line "
+                     << lineNum << endl;
+                ok = false;
+            }
+
+            //The batch version should agree to within rounding.
+            double batchDays[ 3 ]
+                    = { julianDay - 1.5, julianDay, julianDay + 0.7 };
+            Point3D batchPositions[ 3 ];
+            Vector3D batchVelocities[ 3 ];
+            int b = ( (batchDays[0] < firstJulianDay( )) ? 1 : 0 );
+            int e = ( (batchDays[2] > lastJulianDay( )) ? 2 : 3 );
+            rslt = GetBodyPositions( &cursor, batchDays + b, e - b,
+                                     body, origin, batchPositions + b,
+                                     batchVelocities + b );
+            double batchValue = ( (component < 3)
+                                  ?  batchPositions[1][ component ]
+                                  :  batchVelocities[1][ component - 3 ] )
+                    / AUinKM();
+            if ( (! rslt) || (fabs( batchValue - computedValue ) > 1.e-13) )
+            {
+                cout << "GetBodyPositions() disagrees. Line "
+                     << lineNum << endl;
+                ok = false;
+            }
         }
 
         double valDiff = fabs( computedValue - correctValue );
@@ -64,9 +64,63 @@
      specified date. So, generally, the more accurate, but smaller-range
      ephemerides should be registered first. (E.g., a DE405 and then a DE406
      ephemeris.
+     Registration is serialized internally, and GetEphemeris() does not lock:
+     each registration publishes a new, immutable index of the ephemerides'
+     date ranges, which lookups search in O(log n) time. FindEphemeris() is
+     like GetEphemeris(), but returns a plain pointer, avoiding the reference
+     counting of the shared_ptr. Registered ephemerides are never released,
+     so the pointer remains valid for the life of the program. Neither are
+     the superseded indexes, one per registration, since a lookup may still
+     be searching one (see PublishedPtr); they are small.
   9. The enum EBody here differs from the SolarSystem::EBody enumeration.
      Functions are provided to make the translations. Note that the latter
      does not include barycenters.
+  10. If the Reader passed to the constructor or Init() is a MappedFileReader,
+     the coefficients are used in place, directly from the mapped file, so
+     no disk reads or copies are needed to evaluate positions. If the file is
+     of the wrong endianness, the coefficients are converted once, when the
+     ephemeris is initialized, into a separate memory buffer.
+  11. The evaluation functions that take a Cursor argument are const and
+     thread-safe: all of the scratch state (cached coefficient blocks and
+     Chebyshev polynomial values) is kept in the caller-owned Cursor, so
+     once Init() has completed, any number of threads may share one
+     JPLEphemeris, each using its own Cursor. A Cursor may be used with
+     different ephemerides, but not by two threads at once.
+     The functions without a Cursor argument use one owned by the
+     JPLEphemeris object, so they are not safe to call concurrently.
+     JPLBarycentricEphemeris and JPLGeocentricEphemeris use the thread-safe
+     functions if they are constructed with a Cursor.
+     Disk reads, if the file is not memory-mapped, are serialized internally.
+  12. GetBodyPositions() computes positions (and optionally velocities) for
+     an array of Julian Days at once. Epochs that fall in the same
+     coefficient sub-interval are evaluated together, with the Chebyshev
+     recurrence run across the epochs in the inner loop, so that the
+     compiler can vectorize it. This is much faster than repeated calls to
+     GetBodyPosition(), especially if the epochs are sorted. The results
+     agree with GetBodyPosition() to within rounding error.
+  13. Unless the file is memory-mapped, coefficient blocks read from the file
+     are kept in a least-recently-used cache shared by all Cursors. Its
+     capacity, in blocks, is DefaultCacheCapacity initially and may be changed
+     with SetCacheCapacity(); zero disables it, so that each Cursor keeps only
+     the block it is using. Preload() instead reads the whole file into memory
+     once, after which it behaves as if mapped (Note 10).
+     GetCacheStatistics() reports the hits, misses, and evictions, to help in
+     choosing the capacity. A lookup happens only when a Cursor moves out of
+     its current block, so repeated evaluation within one block is not
+     counted.
+     SetCacheCapacity() and Preload(), like Init(), should not be called while
+     other threads are using the JPLEphemeris.
+  14. WriteCompact() writes a compact ephemeris file containing only the
+     selected targets (e.g. Sol, MoonGeo, EMBary, and Nut), optionally for a
+     limited date range. Since the Earth's and Moon's positions both depend
+     on MoonGeo and EMBary, either one implies the other. The file has a
+     fixed header, including an index of the coefficient layout, and stores
+     the coefficients in native byte order, with each block aligned to 64
+     bytes. The constructor and Init() recognize such a file, so it is used
+     just like the original, but with a MappedFileReader it requires almost
+     no work at startup. It contains the titles, but not the constants.
+     BodyAvailable() reports whether the positions of a body can be
+     computed; if not, GetBodyPosition() and GetBodyPositions() return false.
 */
 
 
@@ -76,9 +130,14 @@
 #include "Nutation.hpp"
 #include "SolarSystem.hpp"
 #include "Reader.hpp"
+#include "Writer.hpp"
 #include "Logger.hpp"
+#include "Mutex.hpp"
+#include "StdInt.hpp"
 #include <tr1/memory>
 #include <vector>
+#include <list>
+#include <map>
 #include <string>
 #include <cstdio>
 
@@ -108,6 +167,30 @@ public:
     static EBody SolarSystemToJPLBody( SolarSystem::EBody body );
     static SolarSystem::EBody JPLToSolarSystemBody( EBody body );
 
+    static const int MaxCoeffs = 18;
+
+    class Cursor
+    {
+    public:
+        Cursor( );
+        void Reset( );
+
+    private:
+        const JPLEphemeris * m_pEphemeris;
+        std::tr1::shared_ptr< std::vector< double > > m_spCoeffBlock;
+        const double * m_curCoeffBlock;
+        const double * m_targetCoeffs;
+        double m_timeFrac;
+        double m_subInterval;
+        double m_chebyVals[ MaxCoeffs ];
+        double m_chebyDerivs[ MaxCoeffs ];
+        int m_numChebys;
+        int m_numDerivs;
+        double m_t2;
+
+        friend class JPLEphemeris;
+    };
+
     bool GetBodyPosition( double julianDay,
                           EBody body, EBody origin,
                           Point3D * pPosition, Vector3D * pVelocity = 0 );
@@ -124,6 +207,36 @@ public:
     bool GetLibration( double julianDay0, double julianDay1,
                        Vector3< Angle > * pComponents,
                        Vector3< Angle > * pVelocity = 0 );
+    bool GetBodyPositions( const double * julianDays, int count,
+                           EBody body, EBody origin,
+                           Point3D * pPositions, Vector3D * pVelocities = 0 );
+    //Thread-safe versions (see Note 11):
+    bool GetBodyPosition( Cursor * pCursor, double julianDay,
+                          EBody body, EBody origin,
+                          Point3D * pPosition,
+                          Vector3D * pVelocity = 0 ) const;
+    bool GetBodyPosition( Cursor * pCursor,
+                          double julianDay0, double julianDay1,
+                          EBody body, EBody origin,
+                          Point3D * pPosition,
+                          Vector3D * pVelocity = 0 ) const;
+    bool GetBodyPositions( Cursor * pCursor,
+                           const double * julianDays, int count,
+                           EBody body, EBody origin,
+                           Point3D * pPositions,
+                           Vector3D * pVelocities = 0 ) const;
+    bool GetNutation( Cursor * pCursor, double julianDay,
+                      Nutation * pNutation,
+                      Nutation * pDerivative = 0 ) const;
+    bool GetNutation( Cursor * pCursor, double julianDay0, double julianDay1,
+                      Nutation * pNutation,
+                      Nutation * pDerivative = 0 ) const;
+    bool GetLibration( Cursor * pCursor, double julianDay,
+                       Vector3< Angle > * pComponents,
+                       Vector3< Angle > * pVelocity = 0 ) const;
+    bool GetLibration( Cursor * pCursor, double julianDay0, double julianDay1,
+                       Vector3< Angle > * pComponents,
+                       Vector3< Angle > * pVelocity = 0 ) const;
     void GetEarthBarycentric( Point3D * pEarthPos,
                               const Point3D & moonGeoPos,
                               const Point3D & embPos ) const;
@@ -145,6 +258,7 @@ public:
 
     double firstJulianDay( ) const;
     double lastJulianDay( ) const;
+    bool BodyAvailable( EBody body ) const;
     bool NutationAvailable( ) const;
     bool LibrationAvailable( ) const;
     double AUinKM( ) const;     //Astronomical Unit in kilometers
@@ -164,8 +278,23 @@ public:
     static const int ConstNameLen = 6;
     const std::vector< Constant > & Constants( ) const;
 
+    //Block cache (see Note 13):
+    static const int DefaultCacheCapacity = 8;
+    void SetCacheCapacity( int numBlocks );
+    int CacheCapacity( ) const;
+    void Preload( );
+    struct CacheStatistics
+    {
+        uint64_t m_hits;
+        uint64_t m_misses;
+        uint64_t m_evictions;
+    };
+    CacheStatistics GetCacheStatistics( ) const;
+    void ResetCacheStatistics( );
+
     static void RegisterEphemeris( std::tr1::shared_ptr<JPLEphemeris> spEphem );
     static std::tr1::shared_ptr< JPLEphemeris > GetEphemeris( double jd );
+    static JPLEphemeris * FindEphemeris( double jd );
 
     //For internal use and with tools:
     enum ETarget { Mer, Ven, EMBary, Mar, Jup, Sat, Ura, Nep, Plu,
@@ -180,8 +309,18 @@ public:
     const CoefficientLayout & CoeffLayout( int target ) const;
     double BlockInterval( ) const;
     int CoeffsPerBlock( ) const;
+    bool Mapped( ) const;
+    bool Preloaded( ) const;
+    bool Compact( ) const;
     void ReadCoeffBlock( double julianDay0, double julianDay1,
-                         double * coeffBlock );
+                         double * coeffBlock ) const;
+    //Compact file format (see Note 14):
+    void WriteCompact( Writer & writer,
+                       const std::vector< ETarget > & targets ) const;
+    void WriteCompact( Writer & writer,
+                       const std::vector< ETarget > & targets,
+                       double firstJulianDay, double lastJulianDay ) const;
+    static const int CompactFormatVersion = 1;
     
     static Logger & Log( );
 #ifdef DEBUG
@@ -192,17 +331,37 @@ public:
 //.............................................................................
 
 private:
+    bool ReadCompactFileHeader( bool storeConstants = false );
     void ReadBinaryFileHeader( bool storeConstants = false );
-    void LoadCoeffBlock( double julianDay0, double julianDay1 );
-    void GetTargetCoefficients( double julianDay0, double julianDay1, 
-                                ETarget target );
-    double EvalChebyshev( const double * coeffs, int numCoeffs,
+    void MapCoeffBlocks( );
+    int BlockNumber( double julianDay0, double julianDay1 ) const;
+    void ReadBlock( int blockNumber, double * coeffBlock ) const;
+    std::tr1::shared_ptr< std::vector< double > > CachedCoeffBlock(
+        int blockNumber,
+        const std::tr1::shared_ptr< std::vector< double > > & spOldBlock )
+        const;
+    void LoadCoeffBlock( Cursor * pCursor,
+                         double julianDay0, double julianDay1 ) const;
+    int SubInterval( const double * coeffBlock,
+                     double julianDay0, double julianDay1, ETarget target,
+                     double * pTimeFrac ) const;
+    void GetTargetCoefficients( Cursor * pCursor,
+                                double julianDay0, double julianDay1, 
+                                ETarget target ) const;
+    double EvalChebyshev( Cursor * pCursor,
+                          const double * coeffs, int numCoeffs,
                           double timeFrac,
-                          double * pDerivative = 0 );
-    bool ComputeComponents( double julianDay0, double julianDay1,
+                          double * pDerivative = 0 ) const;
+    bool ComputeComponents( Cursor * pCursor,
+                            double julianDay0, double julianDay1,
                             ETarget target,
                             Vector3D * pComponents, 
-                            Vector3D * pDerivatives = 0 );
+                            Vector3D * pDerivatives = 0 ) const;
+    void ComputeComponentsBatch( Cursor * pCursor,
+                                 const double * julianDays, int count,
+                                 ETarget target,
+                                 Vector3D * pComponents, 
+                                 Vector3D * pDerivatives = 0 ) const;
 
     std::tr1::shared_ptr< Reader > m_pReader;
 
@@ -219,19 +378,31 @@ private:
     CoefficientLayout m_coeffLayouts[ NumTargets ];
     int m_coeffsPerBlock;
     int m_dataOffset;
+    bool m_compact;
 
-    //data obtained from subroutines
-    std::vector< double > m_coeffBlocks[2];
-    int m_curBlock;
-    const double * m_targetCoeffs;
-    double m_timeFrac;
-    double m_subInterval;
-    static const int MaxCoeffs = 18;
-    double m_chebyVals[ MaxCoeffs ];
-    double m_chebyDerivs[ MaxCoeffs ];
-    int m_numChebys;
-    int m_numDerivs;
-    double m_t2;
+    //memory-mapped or preloaded coefficients (see Notes 10 and 13)
+    const double * m_mappedCoeffs;
+    int m_numBlocks;
+    std::vector< double > m_ownedCoeffs;
+    bool m_preloaded;
+
+    //block cache (see Note 13)
+    struct CacheEntry
+    {
+        std::tr1::shared_ptr< std::vector< double > > m_spBlock;
+        std::list< int >::iterator m_lruPos;
+    };
+    int m_cacheCapacity;
+    mutable std::map< int, CacheEntry > m_blockCache;
+    mutable std::list< int > m_lruBlocks;   //most recently used first
+    mutable CacheStatistics m_cacheStats;
+
+    //serializes m_pReader and block cache access from const (thread-safe)
+    // functions
+    mutable Mutex m_readerMutex;
+
+    //scratch state for the functions without a Cursor argument
+    Cursor m_cursor;
 
     static Logger ms_log;
 };
@@ -244,8 +415,10 @@ class JPLBarycentricEphemeris
 {
 public:
     JPLBarycentricEphemeris( std::tr1::shared_ptr< JPLEphemeris > spEphemeris,
-                             JPLEphemeris::EBody body );
-    JPLBarycentricEphemeris( JPLEphemeris::EBody body );
+                             JPLEphemeris::EBody body,
+                             JPLEphemeris::Cursor * pCursor = 0 );
+    JPLBarycentricEphemeris( JPLEphemeris::EBody body,
+                             JPLEphemeris::Cursor * pCursor = 0 );
     Point3D operator()( double julianDay );
     Point3D operator()( double julianDay0, double julianDay1 );
     void operator()( double julianDay,
@@ -254,10 +427,11 @@ public:
                      Point3D * pPosition, Vector3D * pVelocity );
 
 private:
-    std::tr1::shared_ptr< JPLEphemeris > GetEphemeris( double julianDay );
+    JPLEphemeris * GetEphemeris( double julianDay );
     
     std::tr1::shared_ptr< JPLEphemeris > m_spEphemeris;
     JPLEphemeris::EBody m_body;
+    JPLEphemeris::Cursor * m_pCursor;
 };
 
 
@@ -268,8 +442,10 @@ class JPLGeocentricEphemeris
 {
 public:
     JPLGeocentricEphemeris( std::tr1::shared_ptr< JPLEphemeris > spEphemeris,
-                            JPLEphemeris::EBody body );
-    JPLGeocentricEphemeris( JPLEphemeris::EBody body );
+                            JPLEphemeris::EBody body,
+                            JPLEphemeris::Cursor * pCursor = 0 );
+    JPLGeocentricEphemeris( JPLEphemeris::EBody body,
+                            JPLEphemeris::Cursor * pCursor = 0 );
     Point3D operator()( double julianDay );
     Point3D operator()( double julianDay0, double julianDay1 );
     void operator()( double julianDay,
@@ -278,10 +454,11 @@ public:
                      Point3D * pPosition, Vector3D * pVelocity );
 
 private:
-    std::tr1::shared_ptr< JPLEphemeris > GetEphemeris( double julianDay );
+    JPLEphemeris * GetEphemeris( double julianDay );
 
     std::tr1::shared_ptr< JPLEphemeris > m_spEphemeris;
     JPLEphemeris::EBody m_body;
+    JPLEphemeris::Cursor * m_pCursor;
 };
 
 
@@ -322,6 +499,42 @@ JPLEphemeris::CoeffsPerBlock( ) const
     return m_coeffsPerBlock;
 }
 
+//-----------------------------------------------------------------------------
+
+inline
+bool
+JPLEphemeris::Mapped( ) const
+{
+    return (m_mappedCoeffs != 0);
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+bool
+JPLEphemeris::Preloaded( ) const
+{
+    return m_preloaded;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+bool
+JPLEphemeris::Compact( ) const
+{
+    return m_compact;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+int
+JPLEphemeris::CacheCapacity( ) const
+{
+    return m_cacheCapacity;
+}
+
 
 //*****************************************************************************
 
@@ -329,28 +542,31 @@ JPLEphemeris::CoeffsPerBlock( ) const
 inline 
 JPLBarycentricEphemeris::JPLBarycentricEphemeris(
     std::tr1::shared_ptr< JPLEphemeris > spEphemeris,
-    JPLEphemeris::EBody body )
+    JPLEphemeris::EBody body, JPLEphemeris::Cursor * pCursor )
     :   m_spEphemeris( spEphemeris ),
-        m_body( body )
+        m_body( body ),
+        m_pCursor( pCursor )
 {
 }
 
 //.............................................................................
 
 inline 
-JPLBarycentricEphemeris::JPLBarycentricEphemeris( JPLEphemeris::EBody body )
-    :   m_body( body )
+JPLBarycentricEphemeris::JPLBarycentricEphemeris( JPLEphemeris::EBody body,
+                                                 JPLEphemeris::Cursor * pCursor )
+    :   m_body( body ),
+        m_pCursor( pCursor )
 {
 }
 
 //-----------------------------------------------------------------------------
 
 inline 
-std::tr1::shared_ptr< JPLEphemeris >
+JPLEphemeris *
 JPLBarycentricEphemeris::GetEphemeris( double julianDay )
 {
-    return m_spEphemeris  ?  m_spEphemeris
-            :  JPLEphemeris::GetEphemeris( julianDay );
+    return m_spEphemeris  ?  m_spEphemeris.get()
+            :  JPLEphemeris::FindEphemeris( julianDay );
 }
 
 //*****************************************************************************
@@ -359,28 +575,31 @@ JPLBarycentricEphemeris::GetEphemeris( double julianDay )
 inline 
 JPLGeocentricEphemeris::JPLGeocentricEphemeris(
     std::tr1::shared_ptr< JPLEphemeris > spEphemeris,
-    JPLEphemeris::EBody body )
+    JPLEphemeris::EBody body, JPLEphemeris::Cursor * pCursor )
     :   m_spEphemeris( spEphemeris ),
-        m_body( body )
+        m_body( body ),
+        m_pCursor( pCursor )
 {
 }
 
 //.............................................................................
 
 inline 
-JPLGeocentricEphemeris::JPLGeocentricEphemeris( JPLEphemeris::EBody body )
-    :   m_body( body )
+JPLGeocentricEphemeris::JPLGeocentricEphemeris( JPLEphemeris::EBody body,
+                                               JPLEphemeris::Cursor * pCursor )
+    :   m_body( body ),
+        m_pCursor( pCursor )
 {
 }
 
 //-----------------------------------------------------------------------------
 
 inline 
-std::tr1::shared_ptr< JPLEphemeris >
+JPLEphemeris *
 JPLGeocentricEphemeris::GetEphemeris( double julianDay )
 {
-    return m_spEphemeris  ?  m_spEphemeris
-            :  JPLEphemeris::GetEphemeris( julianDay );
+    return m_spEphemeris  ?  m_spEphemeris.get()
+            :  JPLEphemeris::FindEphemeris( julianDay );
 }
 
 
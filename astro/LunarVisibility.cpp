@@ -35,9 +35,9 @@ bool ComputeShaukat( double julianDay, const GeodeticLocation & location,
 
 bool 
 CheckNext( double julianDay, const GeodeticLocation & location,
-           ETime timeOfDay )
+           ETime timeOfDay, ECriterion criterion )
 {
-    switch ( s_criterion )
+    switch ( criterion )
     {
     case Shaukat:
     default:
@@ -47,6 +47,15 @@ CheckNext( double julianDay, const GeodeticLocation & location,
 
 //:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+bool 
+CheckNext( double julianDay, const GeodeticLocation & location,
+           ETime timeOfDay )
+{
+    return CheckNext( julianDay, location, timeOfDay, s_criterion );
+}
+
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 bool 
 CheckNext( double julianDay, const GeodeticLocation & location )
 {
@@ -5,6 +5,11 @@
   Copyright (C) 2007 David M. Anderson
 
   Functions to determine whether the lunar crescent is visible.
+  NOTES:
+  1. SetCriterion() chooses the criterion used by the CheckNext() functions
+     that do not take one. Since it is shared by the whole program, code that
+     may run in several threads with different criteria should pass the
+     criterion explicitly.
 */
 
 
@@ -27,6 +32,8 @@ enum ETime
 enum ECriterion
 { Shaukat/*, Yallop, SAAO*/ };
 
+bool CheckNext( double julianDay, const GeodeticLocation & location,
+                ETime timeOfDay, ECriterion criterion );
 bool CheckNext( double julianDay, const GeodeticLocation & location,
                 ETime timeOfDay );
 bool CheckNext( double julianDay, const GeodeticLocation & location );
@@ -9,9 +9,13 @@
 
 #include "MoonPhases.hpp"
 #include "AstroPhenomena.hpp"
+#include "ReductionContext.hpp"
 #include "RootFinder.hpp"
+#include "Polynomial.hpp"
 #include "TimeStandards.hpp"
+#include "EventSearch.hpp"
 #include "Assert.hpp"
+#include <cmath>
 #ifdef DEBUG
 #include "TestCheck.hpp"
 #include <iostream>
@@ -54,6 +58,78 @@ MoonPhaseFunc::operator()( double julianDay )
 }
 
 
+//*****************************************************************************
+
+
+namespace
+{                                                                   //namespace
+
+//Estimated time (TDB) of the phase which is phaseCycles of a cycle after
+// lunation, counting lunations from the new moon of 6 January 2000.
+// Meeus, "Astronomical Algorithms", (49.1)-(49.5), with the principal terms
+// of the Sun's and Moon's equations of center, and the evection, variation,
+// and annual equation of the Moon.
+
+double
+EstimatePhase( double lunation, double phaseCycles )
+{
+    static const Polynomial< double > meanPhasePoly( 4,
+                                      2451550.09766, 29.530588861 * 1236.85,
+                                      0.00015437, -0.000000150,
+                                      0.00000000073 );
+    double k = lunation + phaseCycles;
+    double t = k / 1236.85;
+    double meanPhase = meanPhasePoly( t );
+    Angle sunAnomaly( 2.5534 + 29.10535670 * k, Angle::Degree );
+    Angle moonAnomaly( 201.5643  +  385.81693528 * k  +  0.0107582 * t * t,
+                       Angle::Degree );
+    Angle elongation( phaseCycles, Angle::Cycle );
+    double moonCorr = 6.289 * moonAnomaly.Sin( )
+            +  1.274 * (2. * elongation - moonAnomaly).Sin( )
+            +  0.658 * (2. * elongation).Sin( )
+            +  0.214 * (2. * moonAnomaly).Sin( )
+            -  0.186 * sunAnomaly.Sin( );
+    double sunCorr = 1.915 * sunAnomaly.Sin( );
+    const double degreesPerDay = 360. / 29.530588861;
+    return  meanPhase  -  (moonCorr - sunCorr) / degreesPerDay;
+}
+
+}                                                                   //namespace
+
+
+//*****************************************************************************
+
+
+class NextMoonPhaseFunc
+{
+public:
+    NextMoonPhaseFunc( Angle phaseAngle );
+    bool operator()( double julianDay, double * pEventJD, double * pResumeJD );
+
+private:
+    Angle m_phaseAngle;
+};
+
+//-----------------------------------------------------------------------------
+
+NextMoonPhaseFunc::NextMoonPhaseFunc( Angle phaseAngle )
+    :   m_phaseAngle( phaseAngle )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+bool
+NextMoonPhaseFunc::operator()( double julianDay, double * pEventJD,
+                               double * pResumeJD )
+{
+    *pEventJD = MoonPhases::FindNext( julianDay, m_phaseAngle );
+    //Occurrences of a phase are a synodic month apart.
+    *pResumeJD = *pEventJD + 1.;
+    return true;
+}
+
+
 //*****************************************************************************
 
 double 
@@ -96,6 +172,93 @@ MoonPhases::FindNext( double julianDay, EPhase phase )
 
 //=============================================================================
 
+double
+MoonPhases::FindNextFast( double julianDay, Angle phaseAngle )
+{
+    const double synodicMonth = 29.530588861;
+    const double accuracy = 1.e-5;
+    const int maxIterations = 10;
+    phaseAngle.NormalizePositive( );
+    double phaseCycles = phaseAngle.Cycles();
+    double lunation = std::floor( (julianDay - 2451550.09766) / synodicMonth )
+            - 1.;
+    //The estimate errs by less than a day.
+    while ( EstimatePhase( lunation, phaseCycles ) < julianDay - 1. )
+        lunation += 1.;
+    ReductionContext context;
+    while ( true )
+    {
+        double phaseJD = EstimatePhase( lunation, phaseCycles );
+        bool converged = false;
+        for ( int i = 0; i < maxIterations; ++i )
+        {
+            double rate;
+            if ( ! LunarPhaseRate( phaseJD, context, &rate ) )
+                break;
+            Angle diff = phaseAngle - LunarPhase( phaseJD, context );
+            diff.Normalize( );
+            double correction = diff.Radians() / rate;
+            phaseJD += correction;
+            if ( std::fabs( correction ) < accuracy )
+            {
+                converged = true;
+                break;
+            }
+        }
+        if ( ! converged )
+            return FindNext( julianDay, phaseAngle );
+        double ut_tdb = - TDB_UT( phaseJD ).Days();
+        double phaseUT = phaseJD + ut_tdb;
+        if ( phaseUT >= julianDay )
+            return phaseUT;
+        lunation += 1.;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+double 
+MoonPhases::FindNextFast( double julianDay, EPhase phase )
+{
+    const Angle phaseAngles[4]
+            = { Angle( 0 ), Angle( M_PI / 2. ),
+                Angle( M_PI ), Angle( M_PI * 3. / 2. ) };
+    return  FindNextFast( julianDay, phaseAngles[ phase ] );
+}
+
+//=============================================================================
+
+vector< double >
+MoonPhases::FindAll( double startJulianDay, double endJulianDay,
+                     Angle phaseAngle, ThreadPool * pPool )
+{
+    //About ten phases per chunk. FindNext() may return a time a little
+    // before its argument, because of the difference between UT and TDB,
+    // hence the margin. Its root finder's tolerance is 1.e-4 day, so two
+    // searches for the same phase may differ by twice that.
+    const double chunkDays = 295.;
+    const double margin = 1.;
+    const double tolerance = 2.e-4;
+    NextMoonPhaseFunc nextPhaseFunc( phaseAngle );
+    return FindAllEvents( startJulianDay, endJulianDay, chunkDays, margin,
+                          tolerance, nextPhaseFunc, pPool );
+}
+
+//-----------------------------------------------------------------------------
+
+vector< double >
+MoonPhases::FindAll( double startJulianDay, double endJulianDay,
+                     EPhase phase, ThreadPool * pPool )
+{
+    const Angle phaseAngles[4]
+            = { Angle( 0 ), Angle( M_PI / 2. ),
+                Angle( M_PI ), Angle( M_PI * 3. / 2. ) };
+    return  FindAll( startJulianDay, endJulianDay, phaseAngles[ phase ],
+                     pPool );
+}
+
+//=============================================================================
+
 #ifdef DEBUG
 
 bool 
@@ -117,6 +280,51 @@ MoonPhases::Test( )
     TESTCHECKFE( FindNext( jan2000, LastQuarter ),
                  DateTime( 28, January, 2000, 7, 57 ).JulianDay( ), &ok,
                  2.e-10 );
+    TESTCHECKFE( FindNextFast( jan2000, New ),
+                 DateTime( 6, January, 2000, 18, 14 ).JulianDay( ), &ok,
+                 2.e-10 );
+    TESTCHECKFE( FindNextFast( jan2000, FirstQuarter ),
+                 DateTime( 14, January, 2000, 13, 34 ).JulianDay( ), &ok,
+                 2.e-10 );
+    TESTCHECKFE( FindNextFast( jan2000, Full ),
+                 DateTime( 21, January, 2000, 4, 40 ).JulianDay( ), &ok,
+                 2.e-10 );
+    TESTCHECKFE( FindNextFast( jan2000, LastQuarter ),
+                 DateTime( 28, January, 2000, 7, 57 ).JulianDay( ), &ok,
+                 2.e-10 );
+    for ( int i = 0; i < 100; ++i )
+    {
+        double jd = jan2000  +  i * 3.7;
+        Angle phaseAngle( i * 0.37, Angle::Cycle );
+        //FindNext() converges to 1.e-4 day.
+        TESTCHECKFE( FindNextFast( jd, phaseAngle ),
+                     FindNext( jd, phaseAngle ), &ok, 1.e-10 );
+    }
+
+    ThreadPool pool( 4 );
+    for ( int p = 0; p < 4; ++p )
+    {
+        EPhase phase = static_cast< EPhase >( p );
+        double endJD = jan2000 + 1000.;
+        vector< double > phases = FindAll( jan2000, endJD, phase, &pool );
+        vector< double > expected;
+        for ( double jd = FindNext( jan2000, phase ); jd < endJD;
+              jd = FindNext( jd + 1., phase ) )
+            expected.push_back( jd );
+        TESTCHECK( phases.size(), expected.size(), &ok );
+        if ( phases.size() == expected.size() )
+            for ( int i = 0; i < (int)phases.size(); ++i )
+                TESTCHECKFE( phases[ i ], expected[ i ], &ok, 1.e-10 );
+    }
+    //A phase at the boundary between two chunks is reported once.
+    double newMoon = FindNext( jan2000 + 400., New );
+    vector< double > newMoons = FindAll( newMoon - 295., newMoon + 295., New,
+                                         &pool );
+    int numFound = 0;
+    for ( int i = 0; i < (int)newMoons.size(); ++i )
+        if ( fabs( newMoons[ i ] - newMoon ) < 1.e-3 )
+            ++numFound;
+    TESTCHECK( numFound, 1, &ok );
 
     if ( ok )
         cout << "MoonPhases PASSED." << endl << endl;
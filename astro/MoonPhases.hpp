@@ -8,15 +8,34 @@
   the specified Julian day.
   NOTES: 
   1. Time is UTC after 2441317.5 (1 Jan 1972); UT1 (approximate), before.
+  2. FindAll() returns the Julian days of all occurrences of the phase in
+     [startJulianDay, endJulianDay), in order. The range is searched in
+     parallel chunks, using pPool (or a temporary ThreadPool if it is null).
+     (See EventSearch.hpp.)
+  3. FindNextFast() is a faster alternative to FindNext(). It starts from
+     an estimate based on the mean phases and the principal periodic terms
+     of the Sun's and Moon's longitudes (after Meeus, "Astronomical
+     Algorithms", ch. 49), which is generally within an hour, and refines it
+     by Newton's method, using the rate of change of the phase from the
+     ephemeris velocities (LunarPhaseRate() in AstroPhenomena.hpp). It
+     typically needs three evaluations of the phase, where FindNext() needs
+     about twenty, and its result is more accurate. It returns the first
+     occurrence of the phase on or after julianDay. If the rate is not
+     available or Newton's method does not converge, it falls back on
+     FindNext().
 */
 
 
 #include "Angle.hpp"
+#include <vector>
 
 
 namespace EpsilonDelta
 {                                                      //namespace EpsilonDelta
 
+class ThreadPool;
+
+
 namespace MoonPhases
 {                                                      /*namespace MoonPhases*/
 
@@ -27,6 +46,12 @@ enum EPhase
 
 double FindNext( double julianDay, Angle phaseAngle );
 double FindNext( double julianDay, EPhase phase );
+double FindNextFast( double julianDay, Angle phaseAngle );
+double FindNextFast( double julianDay, EPhase phase );
+std::vector< double > FindAll( double startJulianDay, double endJulianDay,
+                               Angle phaseAngle, ThreadPool * pPool = 0 );
+std::vector< double > FindAll( double startJulianDay, double endJulianDay,
+                               EPhase phase, ThreadPool * pPool = 0 );
 
 
 #ifdef DEBUG
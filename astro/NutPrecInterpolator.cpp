@@ -0,0 +1,233 @@
+/*
+  NutPrecInterpolator.cpp
+  Copyright (C) 2011 David M. Anderson
+
+  NutPrecInterpolator class: the combined nutation-and-precession matrix and
+  the true obliquity (as from GetNutPrecAndObliquity()), interpolated from
+  values computed at nodes spaced evenly in time, for dense series of dates.
+*/
+
+
+#include "NutPrecInterpolator.hpp"
+#include "AstroPhenomena.hpp"
+#include "Assert.hpp"
+#include <cmath>
+#ifdef DEBUG
+#include "TestCheck.hpp"
+#include <iostream>
+#endif
+using namespace std;
+using namespace std::tr1;
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+const double NutPrecInterpolator::DefaultNodeSpacing = 0.5;
+
+//=============================================================================
+
+
+NutPrecInterpolator::NutPrecInterpolator( double nodeSpacing )
+    :   m_nodeSpacing( nodeSpacing )
+{
+    Assert( nodeSpacing > 0. );
+    Clear( );
+}
+
+//=============================================================================
+
+void
+NutPrecInterpolator::SetNodeSpacing( double nodeSpacing )
+{
+    Assert( nodeSpacing > 0. );
+    if ( nodeSpacing == m_nodeSpacing )
+        return;
+    m_nodeSpacing = nodeSpacing;
+    Clear( );
+}
+
+//-----------------------------------------------------------------------------
+
+void
+NutPrecInterpolator::Clear( )
+{
+    for ( int i = 0; i < NumNodes; ++i )
+        m_nodes[i].m_valid = false;
+    m_spEphemeris.reset( );
+}
+
+//=============================================================================
+
+bool
+NutPrecInterpolator::Get( double julianDay,
+                          Matrix3D * pNutAndPrecMatrix, Angle * pTrueObliquity,
+                          shared_ptr< JPLEphemeris > spEphemeris,
+                          JPLEphemeris::Cursor * pCursor )
+{
+    Assert( spEphemeris );
+    if ( spEphemeris != m_spEphemeris )
+    {
+        Clear( );
+        m_spEphemeris = spEphemeris;
+    }
+    double index = floor( julianDay / m_nodeSpacing );
+    const Node * nodes[ NumNodes ];
+    for ( int i = 0; i < NumNodes; ++i )
+    {
+        nodes[i] = GetNode( index - 1. + i, spEphemeris, pCursor,
+                            index - 1., index + 2. );
+        if ( ! nodes[i] )
+            //A node is beyond the ephemeris, so compute exactly.
+            return GetNutPrecAndObliquity( julianDay, pNutAndPrecMatrix,
+                                           pTrueObliquity, spEphemeris,
+                                           pCursor );
+    }
+
+    //Lagrange's cubic, through nodes at u = -1, 0, 1, 2.
+    double u = julianDay / m_nodeSpacing  -  index;
+    double up1 = u + 1.;
+    double um1 = u - 1.;
+    double um2 = u - 2.;
+    double weights[ NumNodes ]
+            = { - u * um1 * um2 / 6.,  up1 * um1 * um2 / 2.,
+                - up1 * u * um2 / 2.,  up1 * u * um1 / 6. };
+    if ( pNutAndPrecMatrix )
+    {
+        Matrix3D & matrix = *pNutAndPrecMatrix;
+        for ( int r = 0; r < 3; ++r )
+            for ( int c = 0; c < 3; ++c )
+                matrix( r, c )
+                        = weights[0] * nodes[0]->m_nutAndPrecMatrix( r, c )
+                        +  weights[1] * nodes[1]->m_nutAndPrecMatrix( r, c )
+                        +  weights[2] * nodes[2]->m_nutAndPrecMatrix( r, c )
+                        +  weights[3] * nodes[3]->m_nutAndPrecMatrix( r, c );
+    }
+    if ( pTrueObliquity )
+        pTrueObliquity->Set( weights[0] * nodes[0]->m_trueObliquity
+                             +  weights[1] * nodes[1]->m_trueObliquity
+                             +  weights[2] * nodes[2]->m_trueObliquity
+                             +  weights[3] * nodes[3]->m_trueObliquity );
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+const NutPrecInterpolator::Node *
+NutPrecInterpolator::GetNode( double index,
+                              shared_ptr< JPLEphemeris > spEphemeris,
+                              JPLEphemeris::Cursor * pCursor,
+                              double firstNeeded, double lastNeeded )
+{
+    int slot = -1;
+    for ( int i = 0; i < NumNodes; ++i )
+    {
+        if ( m_nodes[i].m_valid && (m_nodes[i].m_index == index) )
+            return &m_nodes[i];
+        //Replace a node that isn't needed for this date.
+        if ( (slot < 0)
+             && ( ! m_nodes[i].m_valid
+                  || (m_nodes[i].m_index < firstNeeded)
+                  || (m_nodes[i].m_index > lastNeeded) ) )
+            slot = i;
+    }
+    Assert( slot >= 0 );
+    double julianDay = index * m_nodeSpacing;
+    if ( (julianDay < spEphemeris->firstJulianDay())
+         || (julianDay > spEphemeris->lastJulianDay()) )
+        return 0;
+    Node & node = m_nodes[ slot ];
+    Angle trueObliquity;
+    node.m_valid = GetNutPrecAndObliquity( julianDay,
+                                           &node.m_nutAndPrecMatrix,
+                                           &trueObliquity,
+                                           spEphemeris, pCursor );
+    node.m_index = index;
+    node.m_trueObliquity = trueObliquity.Radians();
+    return node.m_valid  ?  &node  :  0;
+}
+
+
+//=============================================================================
+
+
+#ifdef DEBUG
+
+bool
+NutPrecInterpolator::Test( )
+{
+    bool ok = true;
+    cout << "Testing NutPrecInterpolator" << endl;
+
+    double jd = 2451545.;
+    shared_ptr< JPLEphemeris > spEphemeris = JPLEphemeris::GetEphemeris( jd );
+    if ( ! spEphemeris )
+    {
+        cout << "No ephemeris registered for " << jd << endl;
+        cout << "NutPrecInterpolator FAILED." << endl << endl;
+        return false;
+    }
+    NutPrecInterpolator interpolator;
+    TESTCHECK( interpolator.NodeSpacing( ), DefaultNodeSpacing, &ok );
+    double maxError = 0.;
+    double maxOrthoError = 0.;
+    int numErrors = 0;
+    //One-minute steps for 10 days, and then back.
+    for ( int i = -14400; i < 14400; ++i )
+    {
+        double day = jd  +  abs( i ) / 1440.;
+        Matrix3D nutAndPrecMatrix;
+        Angle trueObliquity;
+        if ( ! interpolator.Get( day, &nutAndPrecMatrix, &trueObliquity,
+                                 spEphemeris ) )
+        {
+            ++numErrors;
+            continue;
+        }
+        Matrix3D exactMatrix;
+        Angle exactObliquity;
+        GetNutPrecAndObliquity( day, &exactMatrix, &exactObliquity,
+                                spEphemeris );
+        for ( int r = 0; r < 3; ++r )
+            for ( int c = 0; c < 3; ++c )
+                maxError = max( maxError, fabs( nutAndPrecMatrix( r, c )
+                                                - exactMatrix( r, c ) ) );
+        maxError = max( maxError, fabs( trueObliquity.Radians()
+                                        - exactObliquity.Radians() ) );
+        Matrix3D product = nutAndPrecMatrix * nutAndPrecMatrix.Transpose( );
+        for ( int r = 0; r < 3; ++r )
+            for ( int c = 0; c < 3; ++c )
+                maxOrthoError = max( maxOrthoError,
+                                     fabs( product( r, c )
+                                           - ((r == c)  ?  1.  :  0.) ) );
+    }
+    TESTCHECK( numErrors, 0, &ok );
+    //0.1 milliarcsecond is 4.8e-10 radian.
+    TESTCHECK( maxError < 5.e-10, true, &ok );
+    TESTCHECK( maxOrthoError < 1.e-9, true, &ok );
+
+    //Near the end of the ephemeris, the exact values are returned.
+    double lastDay = spEphemeris->lastJulianDay();
+    Matrix3D nutAndPrecMatrix;
+    Matrix3D exactMatrix;
+    TESTCHECK( interpolator.Get( lastDay - 0.3, &nutAndPrecMatrix, 0,
+                                 spEphemeris ), true, &ok );
+    GetNutPrecAndObliquity( lastDay - 0.3, &exactMatrix, 0, spEphemeris );
+    TESTCHECK( nutAndPrecMatrix == exactMatrix, true, &ok );
+
+    if ( ok )
+        cout << "NutPrecInterpolator PASSED." << endl << endl;
+    else
+        cout << "NutPrecInterpolator FAILED." << endl << endl;
+    return ok;
+}
+
+#endif //DEBUG
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
@@ -0,0 +1,179 @@
+/*
+  ReductionContext.cpp
+  Copyright (C) 2011 David M. Anderson
+
+  ReductionContext class: holds the epoch-dependent quantities needed for
+  coordinate reduction (see CoordinateReduction.hpp) and for the routines in
+  AstroPhenomena, so that they can be shared by several computations at one
+  instant, or at nearby instants.
+*/
+
+
+#include "ReductionContext.hpp"
+#include "AstroPhenomena.hpp"
+#include "JPLEphemeris.hpp"
+#include "Assert.hpp"
+#ifdef DEBUG
+#include "TestCheck.hpp"
+#include <iostream>
+#endif
+using namespace std;
+using namespace std::tr1;
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+ReductionContext::ReductionContext( double nodeSpacing,
+                                    shared_ptr< JPLEphemeris > spEphemeris )
+    :   m_nodeSpacing( nodeSpacing ),
+        m_spFixedEphemeris( spEphemeris ),
+        m_julianDay( 0. ),
+        m_haveHeliocentric( false )
+{
+    Assert( nodeSpacing >= 0. );
+    if ( nodeSpacing > 0. )
+        m_nutPrecInterpolator.SetNodeSpacing( nodeSpacing );
+}
+
+//=============================================================================
+
+void
+ReductionContext::SetNodeSpacing( double nodeSpacing )
+{
+    Assert( nodeSpacing >= 0. );
+    if ( nodeSpacing == m_nodeSpacing )
+        return;
+    m_nodeSpacing = nodeSpacing;
+    if ( nodeSpacing > 0. )
+        m_nutPrecInterpolator.SetNodeSpacing( nodeSpacing );
+    m_spEphemeris.reset( );     //Force recomputation.
+}
+
+//=============================================================================
+
+bool
+ReductionContext::Set( double julianDay )
+{
+    if ( m_spEphemeris && (julianDay == m_julianDay) )
+        return true;
+    shared_ptr< JPLEphemeris > spEphemeris = m_spFixedEphemeris
+            ?  m_spFixedEphemeris  :  JPLEphemeris::GetEphemeris( julianDay );
+    if ( ! spEphemeris )
+        return false;
+    m_spEphemeris = spEphemeris;
+    m_haveHeliocentric = false;
+
+    bool earthRslt = GetEarthBarycentric( julianDay, &m_earthBarycentric,
+                                          &m_earthBarycentricVelocity,
+                                          m_spEphemeris, &m_cursor );
+    if ( ! earthRslt )
+    {
+        m_spEphemeris.reset( );
+        return false;
+    }
+
+    bool nutPrecRslt = (m_nodeSpacing > 0.)
+            ?  m_nutPrecInterpolator.Get( julianDay, &m_nutAndPrecMatrix,
+                                          &m_trueObliquity, m_spEphemeris,
+                                          &m_cursor )
+            :  GetNutPrecAndObliquity( julianDay, &m_nutAndPrecMatrix,
+                                       &m_trueObliquity,
+                                       m_spEphemeris, &m_cursor );
+    if ( ! nutPrecRslt )
+    {
+        m_spEphemeris.reset( );
+        return false;
+    }
+    m_julianDay = julianDay;
+    return true;
+}
+
+//=============================================================================
+
+const Point3D &
+ReductionContext::EarthHeliocentric( ) const
+{
+    Assert( m_spEphemeris );
+    if ( ! m_haveHeliocentric )
+    {
+        Point3D sunBarycentric;
+#ifdef DEBUG
+        bool sunRslt =
+#endif
+                m_spEphemeris->GetBodyPosition( &m_cursor, m_julianDay,
+                                           JPLEphemeris::Sun,
+                                           JPLEphemeris::SolarSystemBarycenter,
+                                           &sunBarycentric );
+        Assert( sunRslt );
+        m_earthHeliocentric = Translate( m_earthBarycentric, sunBarycentric );
+        m_haveHeliocentric = true;
+    }
+    return m_earthHeliocentric;
+}
+
+
+//=============================================================================
+
+
+#ifdef DEBUG
+
+bool
+ReductionContext::Test( )
+{
+    bool ok = true;
+    cout << "Testing ReductionContext" << endl;
+
+    double jd = 2451545.;
+    shared_ptr< JPLEphemeris > spEphemeris = JPLEphemeris::GetEphemeris( jd );
+    if ( ! spEphemeris )
+    {
+        cout << "No ephemeris registered for " << jd << endl;
+        cout << "ReductionContext FAILED." << endl << endl;
+        return false;
+    }
+    ReductionContext exactContext;
+    ReductionContext interpContext( 0.5 );
+    for ( int i = 0; i < 40; ++i )
+    {
+        double day = jd + i * 0.37;
+        Point3D earthBarycentric;
+        Vector3D earthBarycentricVelocity;
+        Matrix3D nutAndPrecMatrix;
+        Angle trueObliquity;
+        GetEarthBarycentric( day, &earthBarycentric,
+                             &earthBarycentricVelocity, spEphemeris );
+        GetNutPrecAndObliquity( day, &nutAndPrecMatrix, &trueObliquity,
+                                spEphemeris );
+        TESTCHECK( exactContext.Set( day ), true, &ok );
+        TESTCHECK( exactContext.EarthBarycentric( ) == earthBarycentric,
+                   true, &ok );
+        TESTCHECK( exactContext.NutAndPrecMatrix( ) == nutAndPrecMatrix,
+                   true, &ok );
+        TESTCHECK( interpContext.Set( day ), true, &ok );
+        TESTCHECK( interpContext.EarthBarycentric( ) == earthBarycentric,
+                   true, &ok );
+        for ( int r = 0; r < 3; ++r )
+            for ( int c = 0; c < 3; ++c )
+                TESTCHECKFE( interpContext.NutAndPrecMatrix( )( r, c ),
+                             nutAndPrecMatrix( r, c ), &ok, 5.e-8 );
+        TESTCHECKFE( interpContext.TrueObliquity( ).Radians( ),
+                     trueObliquity.Radians( ), &ok, 5.e-8 );
+    }
+
+    if ( ok )
+        cout << "ReductionContext PASSED." << endl << endl;
+    else
+        cout << "ReductionContext FAILED." << endl << endl;
+    return ok;
+}
+
+#endif //DEBUG
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
@@ -0,0 +1,174 @@
+#ifndef REDUCTIONCONTEXT_HPP
+#define REDUCTIONCONTEXT_HPP
+/*
+  ReductionContext.hpp
+  Copyright (C) 2011 David M. Anderson
+
+  ReductionContext class: holds the epoch-dependent quantities needed for
+  coordinate reduction (see CoordinateReduction.hpp) and for the routines in
+  AstroPhenomena, so that they can be shared by several computations at one
+  instant, or at nearby instants.
+  NOTES:
+  1. Set() makes the context current for a Julian Day (TDB). It obtains the
+     Earth's barycentric position and velocity from the ephemeris, and the
+     nutation-and-precession matrix and the true obliquity. Calling Set()
+     again with the same Julian Day does nothing, so any number of bodies can
+     be reduced for the cost of one computation. Set() returns false if no
+     ephemeris covers the date.
+  2. nodeSpacing is the spacing, in days, of the nodes from which the
+     nutation-and-precession matrix and obliquity are interpolated. If it is
+     zero (the default), they are computed exactly for every date. Otherwise
+     they are computed at nodes spaced nodeSpacing days apart, and
+     interpolated by cubics through the four nodes nearest the date, with a
+     NutPrecInterpolator. The nodes are cached, so a dense series of dates
+     needs only one new computation per node. These quantities change
+     slowly: with nodes 0.5 day apart, the interpolation errors are about
+     0.03 milliarcsecond (see NutPrecInterpolator.hpp). The Earth's position
+     and velocity, which change quickly, are always obtained for the exact
+     date.
+  3. If an ephemeris is passed to the constructor, it is used for all dates.
+     Otherwise the registered ephemeris for each date is used (see
+     JPLEphemeris.hpp, Note 8).
+  4. EarthHeliocentric() is computed only when first needed for a date.
+  5. The context evaluates the ephemeris through its own JPLEphemeris::Cursor,
+     which EphemerisCursor() makes available to the routines that take a
+     ReductionContext. So, while a ReductionContext must not be used by two
+     threads at once, different threads may use their own contexts
+     concurrently. (See JPLEphemeris.hpp, Note 11.)
+*/
+
+
+#include "Point3.hpp"
+#include "Matrix3.hpp"
+#include "Angle.hpp"
+#include "JPLEphemeris.hpp"
+#include "NutPrecInterpolator.hpp"
+#include <tr1/memory>
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+class ReductionContext
+{
+public:
+    explicit ReductionContext( double nodeSpacing = 0.,
+                               std::tr1::shared_ptr< JPLEphemeris > spEphemeris
+                               = std::tr1::shared_ptr< JPLEphemeris >() );
+
+    void SetNodeSpacing( double nodeSpacing );
+    double NodeSpacing( ) const;
+
+    bool Set( double julianDay );
+
+    double JulianDay( ) const;
+    std::tr1::shared_ptr< JPLEphemeris > Ephemeris( ) const;
+    const Point3D & EarthBarycentric( ) const;
+    const Vector3D & EarthBarycentricVelocity( ) const;
+    const Point3D & EarthHeliocentric( ) const;
+    const Matrix3D & NutAndPrecMatrix( ) const;
+    Angle TrueObliquity( ) const;
+    JPLEphemeris::Cursor * EphemerisCursor( ) const;
+
+#ifdef DEBUG
+    static bool Test( );
+#endif
+
+private:
+    double m_nodeSpacing;
+    std::tr1::shared_ptr< JPLEphemeris > m_spFixedEphemeris;
+    std::tr1::shared_ptr< JPLEphemeris > m_spEphemeris;
+    double m_julianDay;
+    Point3D m_earthBarycentric;
+    Vector3D m_earthBarycentricVelocity;
+    mutable Point3D m_earthHeliocentric;
+    mutable bool m_haveHeliocentric;
+    Matrix3D m_nutAndPrecMatrix;
+    Angle m_trueObliquity;
+    NutPrecInterpolator m_nutPrecInterpolator;
+    mutable JPLEphemeris::Cursor m_cursor;
+};
+
+
+//*****************************************************************************
+
+
+inline
+double
+ReductionContext::NodeSpacing( ) const
+{
+    return m_nodeSpacing;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+double
+ReductionContext::JulianDay( ) const
+{
+    return m_julianDay;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+std::tr1::shared_ptr< JPLEphemeris >
+ReductionContext::Ephemeris( ) const
+{
+    return m_spEphemeris;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+const Point3D &
+ReductionContext::EarthBarycentric( ) const
+{
+    return m_earthBarycentric;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+const Vector3D &
+ReductionContext::EarthBarycentricVelocity( ) const
+{
+    return m_earthBarycentricVelocity;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+const Matrix3D &
+ReductionContext::NutAndPrecMatrix( ) const
+{
+    return m_nutAndPrecMatrix;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+Angle
+ReductionContext::TrueObliquity( ) const
+{
+    return m_trueObliquity;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+JPLEphemeris::Cursor *
+ReductionContext::EphemerisCursor( ) const
+{
+    return &m_cursor;
+}
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
+
+#endif //REDUCTIONCONTEXT_HPP
@@ -11,6 +11,12 @@
 #include "JPLEphemeris.hpp"
 #include "AstroPhenomena.hpp"
 #include "AngleDMS.hpp"
+#include "ReductionContext.hpp"
+#include "EventSearch.hpp"
+#include "Mutex.hpp"
+#include <list>
+#include <map>
+#include <cmath>
 #ifdef DEBUG
 #include "TestCheck.hpp"
 #include <iostream>
@@ -30,6 +36,128 @@ namespace
 
 Logger s_log( "RiseSet" );
 
+//-----------------------------------------------------------------------------
+
+//Result cache (see Note 7 in RiseSet.hpp).
+
+struct CacheKey
+{
+    double m_julianDay;
+    int m_body;
+    int m_event;
+    double m_targetAltitude;
+    double m_accuracySecs;
+    double m_longitude;
+    double m_latitude;
+    double m_height;
+    //The tolerances the location was quantized with. These are not part of
+    // the ordering, since all stored keys have the current tolerances.
+    double m_angleTolerance;
+    double m_heightTolerance;
+
+    bool operator<( const CacheKey & rhs ) const;
+};
+
+struct CacheEntry
+{
+    RiseSet::Result m_result;
+    list< CacheKey >::iterator m_lruPos;
+};
+
+int s_cacheCapacity = 0;
+double s_cacheAngleTolerance = 0.;
+double s_cacheHeightTolerance = 0.;
+map< CacheKey, CacheEntry > s_resultCache;
+list< CacheKey > s_lruResults;  //most recently used first
+RiseSet::CacheStatistics s_cacheStats = { 0, 0, 0 };
+Mutex s_cacheMutex;             //serializes access to all of the above
+
+//.............................................................................
+
+bool
+CacheKey::operator<( const CacheKey & rhs ) const
+{
+    if ( m_julianDay != rhs.m_julianDay )
+        return m_julianDay < rhs.m_julianDay;
+    if ( m_body != rhs.m_body )
+        return m_body < rhs.m_body;
+    if ( m_event != rhs.m_event )
+        return m_event < rhs.m_event;
+    if ( m_targetAltitude != rhs.m_targetAltitude )
+        return m_targetAltitude < rhs.m_targetAltitude;
+    if ( m_accuracySecs != rhs.m_accuracySecs )
+        return m_accuracySecs < rhs.m_accuracySecs;
+    if ( m_longitude != rhs.m_longitude )
+        return m_longitude < rhs.m_longitude;
+    if ( m_latitude != rhs.m_latitude )
+        return m_latitude < rhs.m_latitude;
+    return m_height < rhs.m_height;
+}
+
+//.............................................................................
+
+inline
+double
+Quantize( double value, double tolerance )
+{
+    if ( tolerance <= 0. )
+        return value;
+    return std::floor( value / tolerance + 0.5 );
+}
+
+//.............................................................................
+
+//If the cache is enabled, quantizes the location in *pKey and looks it up.
+
+bool
+FindCachedResult( CacheKey * pKey, RiseSet::Result * pResult )
+{
+    MutexLock lock( s_cacheMutex );
+    if ( s_cacheCapacity == 0 )
+        return false;
+    pKey->m_angleTolerance = s_cacheAngleTolerance;
+    pKey->m_heightTolerance = s_cacheHeightTolerance;
+    pKey->m_longitude = Quantize( pKey->m_longitude, s_cacheAngleTolerance );
+    pKey->m_latitude = Quantize( pKey->m_latitude, s_cacheAngleTolerance );
+    pKey->m_height = Quantize( pKey->m_height, s_cacheHeightTolerance );
+    map< CacheKey, CacheEntry >::iterator pEntry
+            = s_resultCache.find( *pKey );
+    if ( pEntry == s_resultCache.end() )
+    {
+        ++s_cacheStats.m_misses;
+        return false;
+    }
+    ++s_cacheStats.m_hits;
+    s_lruResults.splice( s_lruResults.begin(), s_lruResults,
+                         pEntry->second.m_lruPos );
+    *pResult = pEntry->second.m_result;
+    return true;
+}
+
+//.............................................................................
+
+void
+CacheResult( const CacheKey & key, const RiseSet::Result & result )
+{
+    MutexLock lock( s_cacheMutex );
+    if ( (s_cacheCapacity == 0)
+         || (s_resultCache.find( key ) != s_resultCache.end()) )
+        return;     //Disabled, or another thread got here first.
+    if ( (key.m_angleTolerance != s_cacheAngleTolerance)
+         || (key.m_heightTolerance != s_cacheHeightTolerance) )
+        return;     //SetCacheTolerance() was called since the lookup.
+    while ( (int) s_resultCache.size() >= s_cacheCapacity )
+    {
+        s_resultCache.erase( s_lruResults.back() );
+        s_lruResults.pop_back( );
+        ++s_cacheStats.m_evictions;
+    }
+    s_lruResults.push_front( key );
+    CacheEntry & entry = s_resultCache[ key ];
+    entry.m_result = result;
+    entry.m_lruPos = s_lruResults.begin();
+}
+
 }                                                                   //namespace
 
 
@@ -41,7 +169,8 @@ class BodyEquatorialPos
 public:
     BodyEquatorialPos( SolarSystem::EBody body,
                        shared_ptr< JPLEphemeris > spEphemeris,
-                       const Matrix3D & nutAndPrecMatrix );
+                       const Matrix3D & nutAndPrecMatrix,
+                       JPLEphemeris::Cursor * pCursor );
 
     Equatorial operator()( double julianDay );
 
@@ -52,6 +181,7 @@ private:
     SolarSystem::EBody          m_body;
     shared_ptr< JPLEphemeris >  m_spEphemeris;
     const Matrix3D &            m_nutAndPrecMatrix;
+    JPLEphemeris::Cursor *      m_pCursor;
 };
 
 
@@ -60,10 +190,12 @@ private:
 
 BodyEquatorialPos::BodyEquatorialPos( SolarSystem::EBody body,
                                       shared_ptr< JPLEphemeris > spEphemeris,
-                                      const Matrix3D & nutAndPrecMatrix )
+                                      const Matrix3D & nutAndPrecMatrix,
+                                      JPLEphemeris::Cursor * pCursor )
     :   m_body( body ),
         m_spEphemeris( spEphemeris ),
-        m_nutAndPrecMatrix( nutAndPrecMatrix )
+        m_nutAndPrecMatrix( nutAndPrecMatrix ),
+        m_pCursor( pCursor )
 {
     Assert( body != SolarSystem::Earth );
     Assert( spEphemeris );
@@ -84,16 +216,18 @@ BodyEquatorialPos::operator()( double julianDay )
         bool earthRslt =
 #endif
                 GetEarthBarycentric( julianDay, &earthBarycentric,
-                                     &earthBarycentricVelocity, m_spEphemeris );
+                                     &earthBarycentricVelocity, m_spEphemeris,
+                                     m_pCursor );
         Assert( earthRslt );
         return  SolarEquatorialPosition( julianDay, earthBarycentric,
                                          earthBarycentricVelocity,
-                                         m_nutAndPrecMatrix, m_spEphemeris );
+                                         m_nutAndPrecMatrix, m_spEphemeris,
+                                         m_pCursor );
     }
     case SolarSystem::Moon:
     {
         return  LunarEquatorialPosition( julianDay, m_nutAndPrecMatrix,
-                                         m_spEphemeris );
+                                         m_spEphemeris, m_pCursor );
     }
     default:
     {
@@ -103,13 +237,15 @@ BodyEquatorialPos::operator()( double julianDay )
         bool earthRslt =
 #endif
                 GetEarthBarycentric( julianDay, &earthBarycentric,
-                                     &earthBarycentricVelocity, m_spEphemeris );
+                                     &earthBarycentricVelocity, m_spEphemeris,
+                                     m_pCursor );
         Assert( earthRslt );
         Point3D sunBarycentric;
 #ifdef DEBUG
         bool sunRslt =
 #endif
-                m_spEphemeris->GetBodyPosition( julianDay, JPLEphemeris::Sun,
+                m_spEphemeris->GetBodyPosition( m_pCursor, julianDay,
+                                           JPLEphemeris::Sun,
                                            JPLEphemeris::SolarSystemBarycenter,
                                            &sunBarycentric );
         Assert( sunRslt );
@@ -119,7 +255,8 @@ BodyEquatorialPos::operator()( double julianDay )
                                           earthBarycentric,
                                           earthHeliocentric,
                                           earthBarycentricVelocity,
-                                          m_nutAndPrecMatrix, m_spEphemeris );
+                                          m_nutAndPrecMatrix, m_spEphemeris,
+                                          m_pCursor );
     }
     }
 }
@@ -165,39 +302,179 @@ FixedEquatorialPos::operator()( double /*julianDay*/ )
 //*****************************************************************************
 
 
-RiseSet::Result 
-RiseSet::FindNext( double julianDay, SolarSystem::EBody body,
-                   EEvent event, Angle targetAltitude,
-                   const GeodeticLocation & location, double accuracySecs )
+//The apparent right ascension and declination of a body, tabulated at equal
+// steps and interpolated with a four-point Lagrange (cubic) formula. The
+// right ascensions are unwrapped, so that they are continuous.
+
+class TabulatedEquatorialPos
+{
+public:
+    TabulatedEquatorialPos( double firstJulianDay, double step,
+                            const vector< double > & rightAscensions,
+                            const vector< double > & declinations );
+
+    Equatorial operator()( double julianDay );
+
+private:
+    //Undefined, to avoid warning:
+    TabulatedEquatorialPos & operator=( const TabulatedEquatorialPos & );
+
+    double                  m_firstJulianDay;
+    double                  m_step;
+    const vector< double > & m_rightAscensions;
+    const vector< double > & m_declinations;
+};
+
+
+//=============================================================================
+
+
+TabulatedEquatorialPos::TabulatedEquatorialPos( double firstJulianDay,
+                                      double step,
+                                      const vector< double > & rightAscensions,
+                                      const vector< double > & declinations )
+    :   m_firstJulianDay( firstJulianDay ),
+        m_step( step ),
+        m_rightAscensions( rightAscensions ),
+        m_declinations( declinations )
+{
+    Assert( rightAscensions.size() == declinations.size() );
+    Assert( rightAscensions.size() >= 4 );
+}
+
+//=============================================================================
+
+Equatorial
+TabulatedEquatorialPos::operator()( double julianDay )
+{
+    double x = (julianDay - m_firstJulianDay) / m_step;
+    int i = (int)( floor( x ) ) - 1;
+    int maxI = (int)( m_rightAscensions.size() ) - 4;
+    if ( i < 0 )
+        i = 0;
+    else if ( i > maxI )
+        i = maxI;
+    double u = x - (i + 1);
+    double w0 = - u * (u - 1.) * (u - 2.) / 6.;
+    double w1 = (u + 1.) * (u - 1.) * (u - 2.) / 2.;
+    double w2 = - (u + 1.) * u * (u - 2.) / 2.;
+    double w3 = (u + 1.) * u * (u - 1.) / 6.;
+    const double * ra = &m_rightAscensions[ i ];
+    const double * dec = &m_declinations[ i ];
+    return Equatorial( Angle( w0 * ra[0]  +  w1 * ra[1]
+                              +  w2 * ra[2]  +  w3 * ra[3] ),
+                       Angle( w0 * dec[0]  +  w1 * dec[1]
+                              +  w2 * dec[2]  +  w3 * dec[3] ) );
+}
+
+
+//*****************************************************************************
+
+
+namespace
+{                                                                   //namespace
+
+RiseSet::EBodyType
+BodyType( SolarSystem::EBody body )
 {
-    s_log( Logger::Debug, "FindNext JD=%11.2f body=%d event=%d alt=%4.2f",
-           julianDay, body, event, targetAltitude.Degrees() );
-    EBodyType bodyType;
     switch ( body )
     {
     case SolarSystem::Sun:
-        bodyType = Sun;
-        break;
+        return RiseSet::Sun;
     case SolarSystem::Moon:
-        bodyType = Moon;
-        break;
+        return RiseSet::Moon;
     default:
-        bodyType = Planet;
-        break;
+        return RiseSet::Planet;
     }
+}
+
+//=============================================================================
+
+class NextRiseSetFunc
+{
+public:
+    NextRiseSetFunc( SolarSystem::EBody body, RiseSet::EEvent event,
+                     const GeodeticLocation & location, double accuracySecs );
+    bool operator()( double julianDay, double * pEventJD, double * pResumeJD );
+
+private:
+    SolarSystem::EBody m_body;
+    RiseSet::EEvent m_event;
+    GeodeticLocation m_location;
+    double m_accuracySecs;
+};
+
+//-----------------------------------------------------------------------------
+
+NextRiseSetFunc::NextRiseSetFunc( SolarSystem::EBody body,
+                                  RiseSet::EEvent event,
+                                  const GeodeticLocation & location,
+                                  double accuracySecs )
+    :   m_body( body ),
+        m_event( event ),
+        m_location( location ),
+        m_accuracySecs( accuracySecs )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+bool
+NextRiseSetFunc::operator()( double julianDay, double * pEventJD,
+                             double * pResumeJD )
+{
+    RiseSet::Result result = RiseSet::FindNext( julianDay, m_body, m_event,
+                                                m_location, m_accuracySecs );
+    if ( result.m_status != RiseSet::OK )
+    {
+        *pResumeJD = julianDay + 1.;
+        return false;
+    }
+    *pEventJD = result.m_julianDay;
+    //Even for the Moon, successive events are nearly a day apart.
+    *pResumeJD = result.m_julianDay + 0.5;
+    return true;
+}
+
+}                                                                   //namespace
+
+
+//*****************************************************************************
+
+
+RiseSet::Result 
+RiseSet::FindNext( double julianDay, SolarSystem::EBody body,
+                   EEvent event, Angle targetAltitude,
+                   const GeodeticLocation & location, double accuracySecs )
+{
+    if ( s_log.IsEnabled( Logger::Debug ) )
+        s_log( Logger::Debug, "FindNext JD=%11.2f body=%d event=%d alt=%4.2f",
+               julianDay, body, event, targetAltitude.Degrees() );
+    CacheKey key = { julianDay, body, event, targetAltitude.Radians(),
+                     accuracySecs, location.Longitude().Radians(),
+                     location.Latitude().Radians(), location.Height(),
+                     0., 0. };
+    Result result;
+    if ( FindCachedResult( &key, &result ) )
+        return result;
+    EBodyType bodyType = BodyType( body );
     shared_ptr< JPLEphemeris > spEphemeris
             = JPLEphemeris::GetEphemeris( julianDay );
     Assert( spEphemeris );
+    JPLEphemeris::Cursor cursor;
     Matrix3D nutAndPrecMatrix;
 #ifdef DEBUG
     bool nutPrecRslt =
 #endif
             GetNutPrecAndObliquity( julianDay, &nutAndPrecMatrix,
-                                    0, spEphemeris );
+                                    0, spEphemeris, &cursor );
     Assert( nutPrecRslt );
-    BodyEquatorialPos bodyEquatorialPos( body, spEphemeris, nutAndPrecMatrix );
-    return  FindNext( julianDay, event, targetAltitude, bodyEquatorialPos,
-                      bodyType, location, accuracySecs );
+    BodyEquatorialPos bodyEquatorialPos( body, spEphemeris, nutAndPrecMatrix,
+                                         &cursor );
+    result = FindNext( julianDay, event, targetAltitude, bodyEquatorialPos,
+                       bodyType, location, accuracySecs );
+    CacheResult( key, result );
+    return result;
 }
 
 //=============================================================================
@@ -206,25 +483,8 @@ RiseSet::Result
 RiseSet::FindNext( double julianDay, SolarSystem::EBody body, EEvent event,
                    const GeodeticLocation & location, double accuracySecs )
 {
-    Angle targetAltitude( 0. );
-    switch ( body )
-    {
-    case SolarSystem::Sun:
-        targetAltitude.Set( AngleDMS( 0, -50 ) );
-        break;
-    case SolarSystem::Moon:
-        //Approximate, doesn't allow for variations in lunar parallax:
-        targetAltitude.Set( 0.125, Angle::Degree );
-        break;
-    default:
-        targetAltitude.Set( AngleDMS( 0, -34 ) );
-        break;
-    }
-    if ( location.Height() > 0. )
-        targetAltitude -= Angle( AngleDMS( 0.0353
-                                          * std::sqrt( location.Height() ) ) );
-    return FindNext( julianDay, body, event, targetAltitude, location,
-                     accuracySecs );
+    return FindNext( julianDay, body, event, StandardAltitude( body, location ),
+                     location, accuracySecs );
 }
 
 //=============================================================================
@@ -265,6 +525,232 @@ RiseSet::FindNextTwilight( double julianDay, EEvent event, ETwilight twilight,
 
 //=============================================================================
 
+vector< double >
+RiseSet::FindAll( double startJulianDay, double endJulianDay,
+                  SolarSystem::EBody body, EEvent event,
+                  const GeodeticLocation & location, ThreadPool * pPool,
+                  double accuracySecs )
+{
+    //FindNext() returns an event on or after its argument, so no margin is
+    // needed.
+    const double chunkDays = 30.;
+    const double margin = 0.;
+    const double tolerance = 2. * accuracySecs / (24. * 60. * 60.);
+    NextRiseSetFunc nextEventFunc( body, event, location, accuracySecs );
+    return FindAllEvents( startJulianDay, endJulianDay, chunkDays, margin,
+                          tolerance, nextEventFunc, pPool );
+}
+
+//=============================================================================
+
+const double RiseSet::Almanac::TabulationStep = 0.125;
+
+//-----------------------------------------------------------------------------
+
+RiseSet::Almanac::Almanac( )
+    :   m_startJulianDay( 0. ),
+        m_numDays( 0 ),
+        m_numLocations( 0 ),
+        m_numBodies( 0 ),
+        m_numEvents( 0 )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+void
+RiseSet::Almanac::Compute( double startJulianDay, int numDays,
+                           const vector< GeodeticLocation > & locations,
+                           const vector< SolarSystem::EBody > & bodies,
+                           const vector< EEvent > & events,
+                           double accuracySecs )
+{
+    Assert( numDays >= 0 );
+    m_startJulianDay = startJulianDay;
+    m_numDays = numDays;
+    m_numLocations = (int) locations.size();
+    m_numBodies = (int) bodies.size();
+    m_numEvents = (int) events.size();
+    int size = m_numLocations * m_numBodies * m_numEvents * m_numDays;
+    m_julianDays.assign( size, 0. );
+    m_statuses.assign( size, (unsigned char) OK );
+    if ( size == 0 )
+        return;
+
+    //Each search may range a little over a day beyond its start, and the
+    // interpolation needs a point on either side.
+    double firstJD = startJulianDay - TabulationStep;
+    int numSteps = (int)( ceil( (numDays + 1.25) / TabulationStep ) ) + 3;
+    vector< vector< double > > rightAscensions( m_numBodies,
+                                               vector< double >( numSteps ) );
+    vector< vector< double > > declinations( m_numBodies,
+                                            vector< double >( numSteps ) );
+    vector< Equatorial > positions( m_numBodies );
+    ReductionContext context;
+    for ( int k = 0; k < numSteps; ++k )
+    {
+        double jd = firstJD  +  k * TabulationStep;
+#ifdef DEBUG
+        bool posRslt =
+#endif
+                GetApparentPositions( jd, &bodies[0], m_numBodies,
+                                      &positions[0], 0, context );
+        Assert( posRslt );
+        for ( int b = 0; b < m_numBodies; ++b )
+        {
+            double ra = positions[ b ].RightAscension().Radians();
+            if ( k > 0 )
+            {
+                double prevRA = rightAscensions[ b ][ k - 1 ];
+                ra += 2. * M_PI * floor( (prevRA - ra) / (2. * M_PI) + 0.5 );
+            }
+            rightAscensions[ b ][ k ] = ra;
+            declinations[ b ][ k ] = positions[ b ].Declination().Radians();
+        }
+    }
+
+    for ( int b = 0; b < m_numBodies; ++b )
+    {
+        TabulatedEquatorialPos bodyPos( firstJD, TabulationStep,
+                                        rightAscensions[ b ],
+                                        declinations[ b ] );
+        EBodyType bodyType = BodyType( bodies[ b ] );
+        double period = (bodyType == Moon)
+                ?  1. / (1.0027379 - 0.0366)
+                :  ((bodyType == Sun)  ?  1.  :  1. / 1.0027379);
+        for ( int l = 0; l < m_numLocations; ++l )
+        {
+            const GeodeticLocation & location = locations[ l ];
+            Angle targetAltitude = StandardAltitude( bodies[ b ], location );
+            for ( int e = 0; e < m_numEvents; ++e )
+            {
+                int column = ColumnStart( l, b, e );
+                double guess = startJulianDay;
+                for ( int d = 0; d < m_numDays; ++d )
+                {
+                    double dayStart = startJulianDay + d;
+                    if ( guess < dayStart )
+                        guess = dayStart;
+                    Result result = FindNextFrom( dayStart, guess, events[ e ],
+                                                  targetAltitude, bodyPos,
+                                                  bodyType, location,
+                                                  accuracySecs );
+                    //The status depends on the declination at the first
+                    // guess, so an event near a polar limit is rechecked
+                    // from the start of the day, as FindNext() would do.
+                    if ( (result.m_status != OK) && (guess != dayStart) )
+                        result = FindNextFrom( dayStart, dayStart, events[ e ],
+                                               targetAltitude, bodyPos,
+                                               bodyType, location,
+                                               accuracySecs );
+                    m_julianDays[ column + d ] = result.m_julianDay;
+                    m_statuses[ column + d ]
+                            = (unsigned char) result.m_status;
+                    if ( result.m_status == OK )
+                        guess = result.m_julianDay + period;
+                }
+            }
+        }
+    }
+}
+
+//=============================================================================
+
+Angle
+RiseSet::StandardAltitude( SolarSystem::EBody body,
+                           const GeodeticLocation & location )
+{
+    Angle targetAltitude( 0. );
+    switch ( body )
+    {
+    case SolarSystem::Sun:
+        targetAltitude.Set( AngleDMS( 0, -50 ) );
+        break;
+    case SolarSystem::Moon:
+        //Approximate, doesn't allow for variations in lunar parallax:
+        targetAltitude.Set( 0.125, Angle::Degree );
+        break;
+    default:
+        targetAltitude.Set( AngleDMS( 0, -34 ) );
+        break;
+    }
+    if ( location.Height() > 0. )
+        targetAltitude -= Angle( AngleDMS( 0.0353
+                                          * std::sqrt( location.Height() ) ) );
+    return targetAltitude;
+}
+
+//=============================================================================
+
+void
+RiseSet::SetCacheCapacity( int numResults )
+{
+    Assert( numResults >= 0 );
+    MutexLock lock( s_cacheMutex );
+    s_cacheCapacity = max( numResults, 0 );
+    while ( (int) s_resultCache.size() > s_cacheCapacity )
+    {
+        s_resultCache.erase( s_lruResults.back() );
+        s_lruResults.pop_back( );
+        ++s_cacheStats.m_evictions;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+int
+RiseSet::CacheCapacity( )
+{
+    MutexLock lock( s_cacheMutex );
+    return s_cacheCapacity;
+}
+
+//-----------------------------------------------------------------------------
+
+void
+RiseSet::SetCacheTolerance( Angle angleTolerance, double heightTolerance )
+{
+    Assert( angleTolerance.Radians() >= 0. );
+    Assert( heightTolerance >= 0. );
+    MutexLock lock( s_cacheMutex );
+    s_cacheAngleTolerance = angleTolerance.Radians();
+    s_cacheHeightTolerance = heightTolerance;
+    //The keys already stored were quantized differently.
+    s_resultCache.clear( );
+    s_lruResults.clear( );
+}
+
+//-----------------------------------------------------------------------------
+
+RiseSet::CacheStatistics
+RiseSet::GetCacheStatistics( )
+{
+    MutexLock lock( s_cacheMutex );
+    return s_cacheStats;
+}
+
+//-----------------------------------------------------------------------------
+
+void
+RiseSet::ResetCacheStatistics( )
+{
+    MutexLock lock( s_cacheMutex );
+    s_cacheStats.m_hits = s_cacheStats.m_misses = s_cacheStats.m_evictions
+            = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void
+RiseSet::ClearCache( )
+{
+    MutexLock lock( s_cacheMutex );
+    s_resultCache.clear( );
+    s_lruResults.clear( );
+}
+
+//=============================================================================
+
 Logger &
 RiseSet::Log( )
 {
@@ -343,7 +829,97 @@ RiseSet::Test( )
     cout << "FindNext( aug12_2006, Sun, Set, longyearbyen )" << endl;
     result = FindNext( aug12_2006, SolarSystem::Sun, Set, longyearbyen );
     TESTCHECK( result.m_status, AlwaysUp, &ok );
-    
+
+    cout << "Almanac::Compute( jan13_2006, 10, ... )" << endl;
+    vector< GeodeticLocation > locations;
+    locations.push_back( boston );
+    locations.push_back( istanbul );
+    locations.push_back( longyearbyen );
+    vector< SolarSystem::EBody > bodies;
+    bodies.push_back( SolarSystem::Sun );
+    bodies.push_back( SolarSystem::Moon );
+    bodies.push_back( SolarSystem::Venus );
+    vector< EEvent > events;
+    events.push_back( Rise );
+    events.push_back( Set );
+    events.push_back( Transit );
+    Almanac almanac;
+    almanac.Compute( jan13_2006, 10, locations, bodies, events );
+    TESTCHECK( almanac.NumDays( ), 10, &ok );
+    int mismatches = 0;
+    for ( int d = 0; d < almanac.NumDays(); ++d )
+        for ( int l = 0; l < almanac.NumLocations(); ++l )
+            for ( int b = 0; b < almanac.NumBodies(); ++b )
+                for ( int e = 0; e < almanac.NumEvents(); ++e )
+                {
+                    Result expected = FindNext( jan13_2006 + d, bodies[ b ],
+                                                events[ e ], locations[ l ] );
+                    Result actual = almanac.Get( d, l, b, e );
+                    //Agreement within about 5 seconds.
+                    if ( (actual.m_status != expected.m_status)
+                         || ((expected.m_status == OK)
+                             && (fabs( actual.m_julianDay
+                                       - expected.m_julianDay ) > 6.e-5)) )
+                        ++mismatches;
+                }
+    TESTCHECK( mismatches, 0, &ok );
+    TESTCHECK( almanac.JulianDays( 1, 0, 0 )[ 0 ],
+               almanac.Get( 0, 1, 0, 0 ).m_julianDay, &ok );
+
+    cout << "FindAll( jan13_2006, jan13_2006 + 100, Moon, Rise, boston )"
+         << endl;
+    ThreadPool pool( 4 );
+    double endJD = jan13_2006 + 100.;
+    vector< double > moonRises = FindAll( jan13_2006, endJD, SolarSystem::Moon,
+                                          Rise, boston, &pool );
+    vector< double > expectedRises;
+    for ( double jd = jan13_2006; jd < endJD; )
+    {
+        result = FindNext( jd, SolarSystem::Moon, Rise, boston );
+        if ( result.m_status != OK )
+        {
+            jd += 1.;
+            continue;
+        }
+        if ( result.m_julianDay >= endJD )
+            break;
+        expectedRises.push_back( result.m_julianDay );
+        jd = result.m_julianDay + 0.5;
+    }
+    TESTCHECK( moonRises.size(), expectedRises.size(), &ok );
+    //The searches start from different days, so agreement is only to
+    // within the accuracy, about a second.
+    if ( moonRises.size() == expectedRises.size() )
+        for ( int i = 0; i < (int)moonRises.size(); ++i )
+            TESTCHECKFE( moonRises[ i ], expectedRises[ i ], &ok, 1.e-11 );
+
+    cout << "Result cache" << endl;
+    SetCacheCapacity( 3 );
+    SetCacheTolerance( Angle( 1., Angle::ArcSecond ), 1. );
+    ResetCacheStatistics( );
+    Result uncached = FindNext( jan13_2006, SolarSystem::Sun, Set, istanbul );
+    result = FindNext( jan13_2006, SolarSystem::Sun, Set, istanbul );
+    TESTCHECK( result.m_julianDay, uncached.m_julianDay, &ok );
+    GeodeticLocation nearIstanbul( Angle( 30.00001, Angle::Degree ),
+                                   Angle( 40., Angle::Degree ) );
+    result = FindNext( jan13_2006, SolarSystem::Sun, Set, nearIstanbul );
+    TESTCHECK( result.m_julianDay, uncached.m_julianDay, &ok );
+    result = FindNext( jan13_2006, SolarSystem::Sun, Rise, longyearbyen );
+    TESTCHECK( result.m_status, AlwaysDown, &ok );
+    result = FindNext( jan13_2006, SolarSystem::Sun, Rise, longyearbyen );
+    TESTCHECK( result.m_status, AlwaysDown, &ok );
+    FindNext( jan13_2006, SolarSystem::Sun, Rise, istanbul );
+    FindNext( jan13_2006, SolarSystem::Moon, Rise, istanbul );
+    FindNext( jan13_2006 + 1., SolarSystem::Sun, Set, istanbul );
+    CacheStatistics cacheStats = GetCacheStatistics( );
+    TESTCHECK( cacheStats.m_hits, (uint64_t) 3, &ok );
+    TESTCHECK( cacheStats.m_misses, (uint64_t) 5, &ok );
+    TESTCHECK( cacheStats.m_evictions, (uint64_t) 2, &ok );
+    SetCacheCapacity( 0 );
+    SetCacheTolerance( Angle( 0. ) );
+    result = FindNext( jan13_2006, SolarSystem::Sun, Set, istanbul );
+    TESTCHECK( GetCacheStatistics( ).m_hits, (uint64_t) 3, &ok );
+
     if ( ok )
         cout << "RiseSet PASSED." << endl << endl;
     else
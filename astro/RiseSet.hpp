@@ -17,6 +17,45 @@
      process. There should be no harm, however, since the algorithms typically
      converge quite rapidly.
   3. Times are ephemeris time, i.e. TDB.
+  4. FindNextFrom() is like the FindNext() template, but begins its iteration
+     at firstGuess instead of at julianDay. It still finds the first event
+     after julianDay. A good guess, such as the previous day's event plus one
+     day, saves an iteration or two.
+  5. Almanac computes the times of a set of events for a set of bodies at a
+     set of locations, on each of a range of days. (Each result is the first
+     event after the start of the day, as from FindNext().) The apparent
+     positions of the bodies are computed once, every TabulationStep days,
+     with GetApparentPositions() (see AstroPhenomena.hpp). They are shared
+     by all locations and interpolated with a cubic. Each day's search starts
+     from the previous day's result (Note 4), but if it finds the body always
+     up or always down, it is repeated from the start of the day, since that
+     status depends on where the search begins. The interpolation error is well
+     under 0.1 arcsecond, which is negligible next to that of the standard
+     altitudes.
+     The results are stored in columns: for each location, body, and event,
+     the Julian Days (and statuses) of consecutive days are contiguous, and
+     JulianDays() and Statuses() return pointers to these columns.
+  6. FindAll() returns the times of all of the body's events in
+     [startJulianDay, endJulianDay), in order, skipping days on which it is
+     always up or always down. The range is searched in parallel chunks,
+     using pPool (or a temporary ThreadPool if it is null). (See
+     EventSearch.hpp.)
+  7. The results of FindNext() for solar system bodies may be kept in a
+     least-recently-used cache, shared by all threads, so that programs that
+     ask repeatedly for the same events (e.g. the observational Islamic
+     calendar, via LunarVisibility) solve each one only once. It is disabled
+     (capacity 0) initially; SetCacheCapacity() sets the number of results
+     kept. A result is reused only for the same body, event, target
+     altitude, accuracy, and starting Julian day. The location's longitude
+     and latitude are rounded to multiples of the angle tolerance, and its
+     height to a multiple of the height tolerance, set with
+     SetCacheTolerance(). With the default tolerances of zero, only the
+     exact location matches; otherwise the result computed for one location
+     is returned for others nearby. SetCacheTolerance() empties the cache,
+     and a FindNext() that looked up its result with the previous
+     tolerances does not store it. GetCacheStatistics() reports the hits,
+     misses, and evictions. ClearCache() should be called if the registered
+     ephemerides change.
 */
 
 
@@ -29,11 +68,17 @@
 #include "Equatorial.hpp"
 #include "ConvergenceException.hpp"
 #include "Logger.hpp"
+#include "StdInt.hpp"
+#include "Assert.hpp"
+#include <vector>
 
 
 namespace EpsilonDelta
 {                                                      //namespace EpsilonDelta
 
+class ThreadPool;
+
+
 namespace RiseSet
 {                                                           //namespace RiseSet
 
@@ -59,6 +104,11 @@ template < typename BodyEquatorialFunc >
 Result FindNext( double julianDay, EEvent event, Angle targetAltitude,
                  BodyEquatorialFunc bodyEquatFunc, EBodyType bodyType,
                  const GeodeticLocation & location, double accuracySecs );
+template < typename BodyEquatorialFunc >
+Result FindNextFrom( double julianDay, double firstGuess,
+                     EEvent event, Angle targetAltitude,
+                     BodyEquatorialFunc bodyEquatFunc, EBodyType bodyType,
+                     const GeodeticLocation & location, double accuracySecs );
 
 Result FindNext( double julianDay, SolarSystem::EBody body,
                  EEvent event, Angle targetAltitude,
@@ -71,6 +121,29 @@ Result FindNextTwilight( double julianDay, EEvent event, ETwilight twilight,
                          const GeodeticLocation & location,
                          double accuracySecs = 30.0 );
 
+std::vector< double > FindAll( double startJulianDay, double endJulianDay,
+                               SolarSystem::EBody body, EEvent event,
+                               const GeodeticLocation & location,
+                               ThreadPool * pPool = 0,
+                               double accuracySecs = 1.0 );
+
+Angle StandardAltitude( SolarSystem::EBody body,
+                        const GeodeticLocation & location );
+
+//Result cache (see Note 7):
+struct CacheStatistics
+{
+    uint64_t m_hits;
+    uint64_t m_misses;
+    uint64_t m_evictions;
+};
+void SetCacheCapacity( int numResults );
+int CacheCapacity( );
+void SetCacheTolerance( Angle angleTolerance, double heightTolerance = 0. );
+CacheStatistics GetCacheStatistics( );
+void ResetCacheStatistics( );
+void ClearCache( );
+
 Logger & Log( );
 
 #ifdef DEBUG
@@ -78,6 +151,45 @@ bool Test( );
 #endif
 
 
+//*****************************************************************************
+
+
+class Almanac
+{
+public:
+    Almanac( );
+
+    void Compute( double startJulianDay, int numDays,
+                  const std::vector< GeodeticLocation > & locations,
+                  const std::vector< SolarSystem::EBody > & bodies,
+                  const std::vector< EEvent > & events,
+                  double accuracySecs = 1.0 );
+
+    double StartJulianDay( ) const;
+    int NumDays( ) const;
+    int NumLocations( ) const;
+    int NumBodies( ) const;
+    int NumEvents( ) const;
+
+    Result Get( int day, int location, int body, int event ) const;
+    const double * JulianDays( int location, int body, int event ) const;
+    const unsigned char * Statuses( int location, int body, int event ) const;
+
+    static const double TabulationStep;
+
+private:
+    int ColumnStart( int location, int body, int event ) const;
+
+    double m_startJulianDay;
+    int m_numDays;
+    int m_numLocations;
+    int m_numBodies;
+    int m_numEvents;
+    std::vector< double > m_julianDays;
+    std::vector< unsigned char > m_statuses;
+};
+
+
 //*****************************************************************************
 //*****************************************************************************
 
@@ -87,13 +199,26 @@ Result
 FindNext( double julianDay, EEvent event, Angle targetAltitude,
           BodyEquatorialFunc bodyEquatFunc, EBodyType bodyType,
           const GeodeticLocation & location, double accuracySecs )
+{
+    return FindNextFrom( julianDay, julianDay, event, targetAltitude,
+                         bodyEquatFunc, bodyType, location, accuracySecs );
+}
+
+//-----------------------------------------------------------------------------
+
+template < typename BodyEquatorialFunc >
+Result 
+FindNextFrom( double julianDay, double firstGuess,
+              EEvent event, Angle targetAltitude,
+              BodyEquatorialFunc bodyEquatFunc, EBodyType bodyType,
+              const GeodeticLocation & location, double accuracySecs )
 {
     Result result = { OK, 0. };
     double accuracyDays = accuracySecs / (24. * 60. * 60.);
     double sinTargetAlt = targetAltitude.Sin( );
     double sinLat = location.Latitude().Sin( );
     double cosLat = location.Latitude().Cos( );
-    double jd = julianDay;
+    double jd = firstGuess;
     Angle gmSidereal = GreenwichMeanSiderealTime( jd );
     Angle localSidereal = gmSidereal + location.Longitude();
     bool firstStep = true;
@@ -198,14 +323,106 @@ FindNext( double julianDay, EEvent event, Angle targetAltitude,
         if ( ++counter > 1000 )
             throw ConvergenceException( "RiseSet::FindNext() never converged" );
     } while ( fabs( correction ) > accuracyDays );
-    Log().Log( Logger::Debug, "Converged after %d iterations (accuracy=%fs)",
-               counter, accuracySecs );
+    if ( Log().IsEnabled( Logger::Debug ) )
+        Log().Log( Logger::Debug,
+                   "Converged after %d iterations (accuracy=%fs)",
+                   counter, accuracySecs );
 
     result.m_julianDay = jd;
     return  result;
 }
 
 
+//*****************************************************************************
+
+
+inline
+double
+Almanac::StartJulianDay( ) const
+{
+    return m_startJulianDay;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+int
+Almanac::NumDays( ) const
+{
+    return m_numDays;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+int
+Almanac::NumLocations( ) const
+{
+    return m_numLocations;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+int
+Almanac::NumBodies( ) const
+{
+    return m_numBodies;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+int
+Almanac::NumEvents( ) const
+{
+    return m_numEvents;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+int
+Almanac::ColumnStart( int location, int body, int event ) const
+{
+    Assert( (location >= 0) && (location < m_numLocations) );
+    Assert( (body >= 0) && (body < m_numBodies) );
+    Assert( (event >= 0) && (event < m_numEvents) );
+    return ((location * m_numBodies  +  body) * m_numEvents  +  event)
+            * m_numDays;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+Result
+Almanac::Get( int day, int location, int body, int event ) const
+{
+    Assert( (day >= 0) && (day < m_numDays) );
+    int index = ColumnStart( location, body, event ) + day;
+    Result result = { (EStatus) m_statuses[ index ], m_julianDays[ index ] };
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+const double *
+Almanac::JulianDays( int location, int body, int event ) const
+{
+    return &m_julianDays[ ColumnStart( location, body, event ) ];
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+const unsigned char *
+Almanac::Statuses( int location, int body, int event ) const
+{
+    return &m_statuses[ ColumnStart( location, body, event ) ];
+}
+
+
 //*****************************************************************************
 
 }                                                           //namespace RiseSet
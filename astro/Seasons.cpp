@@ -8,11 +8,15 @@
 
 #include "Seasons.hpp"
 #include "AstroPhenomena.hpp"
+#include "ReductionContext.hpp"
 #include "Angle.hpp"
 #include "RootFinder.hpp"
+#include "Polynomial.hpp"
 #include "TimeStandards.hpp"
 #include "DivMod.hpp"
+#include "EventSearch.hpp"
 #include "Assert.hpp"
+#include <cmath>
 #ifdef DEBUG
 #include "TestCheck.hpp"
 #include <iostream>
@@ -58,6 +62,81 @@ SeasonFunc::operator()( double julianDay )
 //*****************************************************************************
 
 
+namespace
+{                                                                   //namespace
+
+//Mean time (TDB) of the season in the given year.
+// Meeus, "Astronomical Algorithms", Tables 27.A and 27.B.
+
+double
+MeanSeason( int year, Seasons::ESeason season )
+{
+    static const Polynomial< double > polysBefore1000[4]
+            = {
+                Polynomial< double >( 4, 1721139.29189, 365242.13740,
+                                      0.06134, 0.00111, -0.00071 ),
+                Polynomial< double >( 4, 1721233.25401, 365241.72562,
+                                      -0.05323, 0.00907, 0.00025 ),
+                Polynomial< double >( 4, 1721325.70455, 365242.49558,
+                                      -0.11677, -0.00297, 0.00074 ),
+                Polynomial< double >( 4, 1721414.39987, 365242.88257,
+                                      -0.00769, -0.00933, -0.00006 )
+            };
+    static const Polynomial< double > polysAfter1000[4]
+            = {
+                Polynomial< double >( 4, 2451623.80984, 365242.37404,
+                                      0.05169, -0.00411, -0.00057 ),
+                Polynomial< double >( 4, 2451716.56767, 365241.62603,
+                                      0.00325, 0.00888, -0.00030 ),
+                Polynomial< double >( 4, 2451810.21715, 365242.01767,
+                                      -0.11575, 0.00337, 0.00078 ),
+                Polynomial< double >( 4, 2451900.05952, 365242.74049,
+                                      -0.06223, -0.00823, 0.00032 )
+            };
+    if ( year < 1000 )
+        return polysBefore1000[ season ]( year / 1000. );
+    else
+        return polysAfter1000[ season ]( (year - 2000) / 1000. );
+}
+
+}                                                                   //namespace
+
+
+//*****************************************************************************
+
+
+class NextSeasonFunc
+{
+public:
+    NextSeasonFunc( Seasons::ESeason season );
+    bool operator()( double julianDay, double * pEventJD, double * pResumeJD );
+
+private:
+    Seasons::ESeason m_season;
+};
+
+//-----------------------------------------------------------------------------
+
+NextSeasonFunc::NextSeasonFunc( Seasons::ESeason season )
+    :   m_season( season )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+bool
+NextSeasonFunc::operator()( double julianDay, double * pEventJD,
+                            double * pResumeJD )
+{
+    *pEventJD = Seasons::FindNext( julianDay, m_season );
+    *pResumeJD = *pEventJD + 1.;
+    return true;
+}
+
+
+//*****************************************************************************
+
+
 double 
 Seasons::FindNext( double julianDay, ESeason season )
 {
@@ -90,6 +169,70 @@ Seasons::FindNext( double julianDay, ESeason season )
 
 //=============================================================================
 
+double
+Seasons::FindNextFast( double julianDay, ESeason season )
+{
+    const Angle seasonAngles[4]
+            = { Angle( 0 ), Angle( M_PI / 2. ),
+                Angle( M_PI ), Angle( M_PI * 3. / 2. ) };
+    const double tropicalYear = 365.2421896698;
+    const double accuracy = 1.e-5;
+    const int maxIterations = 10;
+    int year = (int) std::floor( (julianDay - 2451545.) / tropicalYear )
+            +  2000  -  1;
+    //The estimate errs by less than a day.
+    while ( MeanSeason( year, season ) < julianDay - 1. )
+        ++year;
+    ReductionContext context;
+    while ( true )
+    {
+        double seasonJD = MeanSeason( year, season );
+        bool converged = false;
+        for ( int i = 0; i < maxIterations; ++i )
+        {
+            double rate;
+            if ( ! SolarLongitudeRate( seasonJD, context, &rate ) )
+                break;
+            Angle diff = seasonAngles[ season ]
+                    - SolarLongitude( seasonJD, context );
+            diff.Normalize( );
+            double correction = diff.Radians() / rate;
+            seasonJD += correction;
+            if ( std::fabs( correction ) < accuracy )
+            {
+                converged = true;
+                break;
+            }
+        }
+        if ( ! converged )
+            return FindNext( julianDay, season );
+        double ut_tdb = - TDB_UT( seasonJD ).Days();
+        double seasonUT = seasonJD + ut_tdb;
+        if ( seasonUT >= julianDay )
+            return seasonUT;
+        ++year;
+    }
+}
+
+//=============================================================================
+
+vector< double >
+Seasons::FindAll( double startJulianDay, double endJulianDay,
+                  ESeason season, ThreadPool * pPool )
+{
+    //Ten years per chunk. FindNext() may return a time a little before its
+    // argument, because of the difference between UT and TDB, hence the
+    // margin. Its root finder's tolerance is 1.e-4 day.
+    const double chunkDays = 3652.5;
+    const double margin = 1.;
+    const double tolerance = 2.e-4;
+    NextSeasonFunc nextSeasonFunc( season );
+    return FindAllEvents( startJulianDay, endJulianDay, chunkDays, margin,
+                          tolerance, nextSeasonFunc, pPool );
+}
+
+//=============================================================================
+
 #ifdef DEBUG
 
 bool 
@@ -124,6 +267,39 @@ Seasons::Test( )
     TESTCHECKFE( FindNext( jan2004, WinterSolstice ),
                  DateTime( 21, December, 2004, 12, 42 ).JulianDay(), &ok,
                  2.e-10 );
+    for ( int i = 0; i < 4; ++i )
+    {
+        ESeason season = static_cast< ESeason >( i );
+        TESTCHECKFE( FindNextFast( jan2003, season ),
+                     FindNext( jan2003, season ), &ok, 1.e-10 );
+        TESTCHECKFE( FindNextFast( jan2004, season ),
+                     FindNext( jan2004, season ), &ok, 1.e-10 );
+    }
+
+    ThreadPool pool( 4 );
+    for ( int i = 0; i < 4; ++i )
+    {
+        ESeason season = static_cast< ESeason >( i );
+        double endJD = jan2003 + 20. * 365.25;
+        vector< double > seasons = FindAll( jan2003, endJD, season, &pool );
+        vector< double > expected;
+        for ( double jd = FindNext( jan2003, season ); jd < endJD;
+              jd = FindNext( jd + 1., season ) )
+            expected.push_back( jd );
+        TESTCHECK( seasons.size(), expected.size(), &ok );
+        if ( seasons.size() == expected.size() )
+            for ( int j = 0; j < (int)seasons.size(); ++j )
+                TESTCHECKFE( seasons[ j ], expected[ j ], &ok, 1.e-10 );
+    }
+    //An equinox at the end of one chunk and the start of the next:
+    double equinox = FindNext( jan2004, SpringEquinox );
+    vector< double > equinoxes = FindAll( equinox - 3652.5, equinox + 3652.5,
+                                          SpringEquinox, &pool );
+    int numFound = 0;
+    for ( int j = 0; j < (int)equinoxes.size(); ++j )
+        if ( fabs( equinoxes[ j ] - equinox ) < 1.e-3 )
+            ++numFound;
+    TESTCHECK( numFound, 1, &ok );
 
     if ( ok )
         cout << "Seasons PASSED." << endl << endl;
@@ -8,12 +8,32 @@
   after the specified Julian day.
   NOTES: 
   1. Time is UTC after 2441317.5 (1 Jan 1972); UT1 (approximate), before.
+  2. FindAll() returns the Julian days of all occurrences of the season in
+     [startJulianDay, endJulianDay), in order. The range is searched in
+     parallel chunks, using pPool (or a temporary ThreadPool if it is null).
+     (See EventSearch.hpp.)
+  3. FindNextFast() is a faster alternative to FindNext(). It starts from
+     the mean equinox or solstice of the year (Meeus, "Astronomical
+     Algorithms", Tables 27.A and 27.B), which is within about an hour, and
+     refines it by Newton's method, using the rate of change of the Sun's
+     longitude from the ephemeris velocities (SolarLongitudeRate() in
+     AstroPhenomena.hpp). It typically needs two or three evaluations of the
+     longitude, where FindNext() needs about twenty, and its result is more
+     accurate. It returns the first occurrence on or after julianDay. If the
+     rate is not available or Newton's method does not converge, it falls
+     back on FindNext().
 */
 
 
+#include <vector>
+
+
 namespace EpsilonDelta
 {                                                      //namespace EpsilonDelta
 
+class ThreadPool;
+
+
 namespace Seasons
 {                                                         /*namespace Seasons*/
 
@@ -24,6 +44,9 @@ enum ESeason
     { SpringEquinox, SummerSolstice, AutumnalEquinox, WinterSolstice };
 
 double FindNext( double julianDay, ESeason season );
+double FindNextFast( double julianDay, ESeason season );
+std::vector< double > FindAll( double startJulianDay, double endJulianDay,
+                               ESeason season, ThreadPool * pPool = 0 );
 
 
 #ifdef DEBUG
@@ -9,16 +9,22 @@
 #include "Assert.hpp"
 #include "TestCheck.hpp"
 #include "AstroCoordTransformations.hpp"
+#include "DirectionArray.hpp"
 #include "JPLEphemeris.hpp"
+#include "AnalyticEphemeris.hpp"
 #include "SiderealTime.hpp"
 #include "Precession.hpp"
 #include "Obliquity.hpp"
 #include "Nutation.hpp"
 #include "CoordinateReduction.hpp"
 #include "ApparentEphemeris.hpp"
+#include "ReductionContext.hpp"
+#include "NutPrecInterpolator.hpp"
 #include "AstroPhenomena.hpp"
 #include "Seasons.hpp"
 #include "MoonPhases.hpp"
+#include "EventTable.hpp"
+#include "ChebyshevFit.hpp"
 #include "RiseSet.hpp"
 #include "LunarVisibility.hpp"
 #include "EquationOfTime.hpp"
@@ -26,6 +32,8 @@
 #include "Constellations.hpp"
 #include "Platform.hpp"
 #include "FileReader.hpp"
+#include "MappedFileReader.hpp"
+#include "FileWriter.hpp"
 #include <cstdio>
 #include <iostream>
 #include <tr1/memory>
@@ -78,6 +86,8 @@ int Main( int /*argc*/, char ** argv )
 
     if ( ! TestAstroCoordTransformations( ) )
         ok = false;
+    if ( ! DirectionArray::Test( ) )
+        ok = false;
 
     string libBasePath = argv[0];
     int slashPos = libBasePath.rfind( '/' );
@@ -121,9 +131,80 @@ int Main( int /*argc*/, char ** argv )
     if ( ! de405_2011_2020le->Test( libBasePath
                                     + "astro/test/testpo.405_2011_2020" ) )
         ok = false;
+    spReader.reset( new MappedFileReader( libBasePath
+                                          + "astrodata/JPL_DE405.le" ) );
+    shared_ptr< JPLEphemeris > de405leMapped(
+        new JPLEphemeris( spReader, true ) );
+    TESTCHECK( de405leMapped->Mapped( ), true, &ok );
+    if ( ! de405leMapped->Test( libBasePath + "astro/test/testpo.405" ) )
+        ok = false;
+    spReader.reset( new MappedFileReader( libBasePath
+                                          + "astrodata/JPL_DE406.be" ) );
+    shared_ptr< JPLEphemeris > de406beMapped(
+        new JPLEphemeris( spReader, true ) );
+    TESTCHECK( de406beMapped->Mapped( ), true, &ok );
+    if ( ! de406beMapped->Test( libBasePath + "astro/test/testpo.406" ) )
+        ok = false;
+    spReader.reset( new FileReader( libBasePath + "astrodata/JPL_DE405.le" ) );
+    shared_ptr< JPLEphemeris > de405leSmallCache(
+        new JPLEphemeris( spReader, true ) );
+    de405leSmallCache->SetCacheCapacity( 1 );
+    TESTCHECK( de405leSmallCache->CacheCapacity( ), 1, &ok );
+    if ( ! de405leSmallCache->Test( libBasePath + "astro/test/testpo.405" ) )
+        ok = false;
+    JPLEphemeris::CacheStatistics cacheStats
+            = de405leSmallCache->GetCacheStatistics( );
+    TESTCHECK( (cacheStats.m_misses > 0), true, &ok );
+    TESTCHECK( (cacheStats.m_evictions + 1 == cacheStats.m_misses), true,
+               &ok );
+    spReader.reset( new FileReader( libBasePath + "astrodata/JPL_DE406.be" ) );
+    shared_ptr< JPLEphemeris > de406bePreloaded(
+        new JPLEphemeris( spReader, true ) );
+    de406bePreloaded->Preload( );
+    TESTCHECK( de406bePreloaded->Preloaded( ), true, &ok );
+    if ( ! de406bePreloaded->Test( libBasePath + "astro/test/testpo.406" ) )
+        ok = false;
+
+    {
+        vector< JPLEphemeris::ETarget > targets;
+        targets.push_back( JPLEphemeris::Sol );
+        targets.push_back( JPLEphemeris::MoonGeo );
+        targets.push_back( JPLEphemeris::Nut );
+        string compactFileName = libBasePath + "astro/test/DE405.compact";
+        {
+            FileWriter writer( compactFileName );
+            de405le->WriteCompact( writer, targets );
+        }
+        spReader.reset( new MappedFileReader( compactFileName ) );
+        shared_ptr< JPLEphemeris > de405Compact(
+            new JPLEphemeris( spReader, true ) );
+        TESTCHECK( de405Compact->Compact( ), true, &ok );
+        TESTCHECK( de405Compact->Mapped( ), true, &ok );
+        TESTCHECK( de405Compact->BodyAvailable( JPLEphemeris::Earth ), true,
+                   &ok );
+        TESTCHECK( de405Compact->BodyAvailable( JPLEphemeris::Mars ), false,
+                   &ok );
+        TESTCHECK( de405Compact->LibrationAvailable( ), false, &ok );
+        Point3D marsPos;
+        TESTCHECK( de405Compact->GetBodyPosition( 2451545.,
+                                               JPLEphemeris::Mars,
+                                               JPLEphemeris::Sun, &marsPos ),
+                   false, &ok );
+        if ( ! de405Compact->Test( libBasePath + "astro/test/testpo.405" ) )
+            ok = false;
+        spReader.reset( );
+        de405Compact.reset( );
+        remove( compactFileName.c_str() );
+    }
 
     JPLEphemeris::RegisterEphemeris( de405le );
     JPLEphemeris::RegisterEphemeris( de406be );
+    TESTCHECK( JPLEphemeris::GetEphemeris( 2451545. ), de405le, &ok );
+    TESTCHECK( JPLEphemeris::FindEphemeris( 2451545. ), de405le.get(), &ok );
+    TESTCHECK( JPLEphemeris::FindEphemeris( de405le->lastJulianDay() ),
+               de405le.get(), &ok );
+    TESTCHECK( JPLEphemeris::FindEphemeris( 2000000. ), de406be.get(), &ok );
+    TESTCHECK( JPLEphemeris::FindEphemeris( 0. ), (JPLEphemeris *) 0, &ok );
 
     if ( ! TestGeodeticLocation( ) )
         ok = false;
@@ -135,10 +216,16 @@ int Main( int /*argc*/, char ** argv )
         ok = false;
     if ( ! Nutation::Test( de405le ) )
         ok = false;
+    if ( ! AnalyticEphemeris::Test( ) )
+        ok = false;
     if ( ! TestCoordinateReduction( de200be, de405le ) )
         ok = false;
     if ( ! TestApparentEphemeris( de200be, de405le ) )
         ok = false;
+    if ( ! ReductionContext::Test( ) )
+        ok = false;
+    if ( ! NutPrecInterpolator::Test( ) )
+        ok = false;
     if ( ! TestAstroPhenomena( ) )
         ok = false;
     if ( ! TestEquationOfTime( ) )
@@ -147,6 +234,10 @@ int Main( int /*argc*/, char ** argv )
         ok = false;
     if ( ! MoonPhases::Test( ) )
         ok = false;
+    if ( ! EventTable::Test( libBasePath + "astro/test/" ) )
+        ok = false;
+    if ( ! ChebyshevFit::Test( libBasePath + "astro/test/" ) )
+        ok = false;
     if ( ! RiseSet::Test( ) )
         ok = false;
     if ( ! LunarVisibility::Test( ) )
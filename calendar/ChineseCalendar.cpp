@@ -12,17 +12,21 @@
 #include "CalendarLibText.hpp"
 #include "TimeIncrement.hpp"
 #include "AstroPhenomena.hpp"
+#include "EventTable.hpp"
 #include "TimeStandards.hpp"
 #include "Angle.hpp"
 #include "JDDate.hpp"
+#include "Mutex.hpp"
 #include <string>
 #include <vector>
+#include <list>
 #ifdef DEBUG
 #include "Date.hpp"
+#include "JPLEphemeris.hpp"
 #include "TestCheck.hpp"
 #include <iostream>
-using namespace std;
 #endif
+using namespace std;
 
 
 namespace EpsilonDelta
@@ -52,6 +56,32 @@ long PriorNewMoon( long jdi );
 long NextNewMoon( long jdi );
 int MajorSolarTerm( long jdi );
 
+//The structure of a sui, the solar year from one winter solstice to the next
+// (see Note 5 in ChineseCalendar.hpp).
+struct SuiRecord
+{
+    long m_winterSolstice;
+    long m_nextWinterSolstice;
+    int m_numMonths;            //12 or 13
+    //The first days of the months, from the month containing the winter
+    // solstice (month 11) through month 11 of the following sui.
+    long m_newMoons[ 14 ];
+    //In a sui of 13 months, the major solar term at the end of each month,
+    // and the first month (counting from month 12 as 1) in which it does not
+    // change, or 0 if there is none.
+    int m_majorTerms[ 13 ];
+    int m_noMajorTermMonth;
+};
+
+SuiRecord SuiStartingAt( long winterSolstice );
+SuiRecord SuiContaining( long jdi );
+SuiRecord SuiStartingOnOrAfter( long jdi );
+long NewMoonOnOrAfter( const SuiRecord & sui, long jdi );
+
+const int s_suiCacheCapacity = 16;
+list< SuiRecord > s_suiCache;   //most recently used first
+Mutex s_suiCacheMutex;          //serializes access to s_suiCache
+
 }                                                                   //namespace
 
 
@@ -63,18 +93,19 @@ ChineseCalendar::JulianDayToDMYL( long julianDay,
                                   int * pDay, int * pMonth, long * pYear,
                                   int * pLeapMonth )
 {
-    long lastWS = NextWinterSolstice( julianDay + 1 );
-    long lastNM = PriorNewMoon( lastWS );
-    lastNM = PriorNewMoon( lastNM - 1 );
-    long firstWS = NextWinterSolstice( lastWS - 370 );
-    long firstNM = PriorNewMoon( firstWS );
-    long currNM = PriorNewMoon( julianDay );
+    SuiRecord sui = SuiContaining( julianDay );
+    long firstWS = sui.m_winterSolstice;
+    long firstNM = sui.m_newMoons[0];
+    int monthsInYear = sui.m_numMonths;
+    int i = monthsInYear;
+    while ( sui.m_newMoons[ i ] > julianDay )
+        --i;
+    long currNM = sui.m_newMoons[ i ];
     int day = (int)(julianDay - currNM + 1);
     int month = (int)(((currNM - firstNM) / s_synodicMonth) + 0.5 );
     long year
            = (long)(((firstWS - s_chineseEpochWS) / s_tropicalYear) + 0.5 ) + 1;
     int leapMonth = LMUnknown;
-    int monthsInYear = (int)(((lastNM - firstNM) / s_synodicMonth) + 0.5 ) + 1;
     bool prevSolYear = false;
     bool nextSolYear = false;
     if ( monthsInYear == 12 )
@@ -85,14 +116,8 @@ ChineseCalendar::JulianDayToDMYL( long julianDay,
             month += 12;
             --year;
             //Need to check previous solar year for leap month.
-            lastWS = firstWS;
-            lastNM = PriorNewMoon( firstNM );
-            lastNM = PriorNewMoon( lastNM - 1 );
-            firstWS = NextWinterSolstice( lastWS - 370 );
-            firstNM = PriorNewMoon( firstWS );
-            monthsInYear
-                    = (int)(((lastNM - firstNM) / s_synodicMonth) + 0.5 ) + 1;
-            if ( monthsInYear == 12 )
+            sui = SuiContaining( firstWS - 1 );
+            if ( sui.m_numMonths == 12 )
                 leapMonth = LMNone;
             else    //A leap month will be found in the next section.
             {
@@ -103,14 +128,8 @@ ChineseCalendar::JulianDayToDMYL( long julianDay,
         else
         {
             //Need to check following solar year for leap month.
-            firstWS = lastWS;
-            firstNM = PriorNewMoon( firstWS );
-            lastWS = NextWinterSolstice( firstWS + 1 );
-            lastNM = PriorNewMoon( lastWS );
-            lastNM = PriorNewMoon( lastNM - 1 );
-            monthsInYear
-                    = (int)(((lastNM - firstNM) / s_synodicMonth) + 0.5 ) + 1;
-            if ( monthsInYear == 12 )
+            sui = SuiStartingAt( sui.m_nextWinterSolstice );
+            if ( sui.m_numMonths == 12 )
                 leapMonth = LMNone;
             else    //A leap month may be found in the next section.
                 nextSolYear = true;
@@ -118,59 +137,52 @@ ChineseCalendar::JulianDayToDMYL( long julianDay,
     }
     if ( leapMonth == LMUnknown )
     {
-        Assert( monthsInYear == 13 );
-        //Search for leap month
-        // (= first lunar month w/ no change in major solar term).
-        long nm = NextNewMoon( firstNM + 1 );
-        //Month begins w/solar term at end of previous day.
-        int startMajor = MajorSolarTerm( nm - 1 );
-        for ( int m = 1; m < 13; ++m )
+        Assert( sui.m_numMonths == 13 );
+        //The leap month is the first lunar month w/ no change in major solar
+        // term.
+        int m = sui.m_noMajorTermMonth;
+        if ( nextSolYear && ((m == 0) || (m >= 3)) )
+            leapMonth = LMNone; //Leap month belongs to following year.
+        else if ( m > 0 )
         {
-            if ( nextSolYear && (m >= 3) )
-            {
-                leapMonth = LMNone; //Leap month belongs to following year.
-                break;
-            }
-            nm = NextNewMoon( nm + 1 );
-            int endMajor = MajorSolarTerm( nm - 1 );
-            if ( endMajor == startMajor )
+            if ( m < 3 )
             {
-                if ( m < 3 )
+                if ( prevSolYear )
                 {
-                    if ( prevSolYear )
-                        leapMonth = LMNone; //Leap month belongs to prev year.
-                    else
-                    {
-                        if ( ! nextSolYear )
-                            month -= 2;
-                        if ( month <= 0 )
-                        {
-                            month += 13;
-                            --year;
-                            leapMonth = m + 11;
-                        }
-                        else if ( nextSolYear )
-                            leapMonth = m + 11;
-                        else
-                            leapMonth = LMNone;
-                    }
+                    //Leap month belongs to the year before, so the month
+                    // was not shifted by it after all.
+                    --month;
+                    leapMonth = LMNone;
                 }
                 else
                 {
-                    if ( ! prevSolYear )
-                        --month;
+                    if ( ! nextSolYear )
+                        month -= 2;
                     if ( month <= 0 )
                     {
-                        month += 12;
+                        month += 13;
                         --year;
-                        leapMonth = LMNone; //Consecutive years can't be leap.
+                        leapMonth = m + 11;
                     }
+                    else if ( nextSolYear )
+                        leapMonth = m + 11;
                     else
-                        leapMonth = m - 1;
+                        leapMonth = LMNone;
                 }
-                break;
             }
-            startMajor = endMajor;
+            else
+            {
+                if ( ! prevSolYear )
+                    --month;
+                if ( month <= 0 )
+                {
+                    month += 12;
+                    --year;
+                    leapMonth = LMNone; //Consecutive years can't be leap.
+                }
+                else
+                    leapMonth = m - 1;
+            }
         }
     }
     Assert( leapMonth != LMUnknown );
@@ -205,39 +217,30 @@ ChineseCalendar::DMYToJulianDay( int day, int month, long year )
 {
     long firstWS
             = (long)( s_chineseEpochWS  +  (year - 1) * s_tropicalYear - 10 );
-    firstWS = NextWinterSolstice( firstWS );
-    long firstNM = PriorNewMoon( firstWS );
-    long lastWS = NextWinterSolstice( firstWS + 1 );
-    long lastNM = PriorNewMoon( lastWS );
-    lastNM = PriorNewMoon( lastNM - 1 );
-    int monthsInYear = (int)(((lastNM - firstNM) / s_synodicMonth) + 0.5 ) + 1;
+    SuiRecord sui = SuiStartingOnOrAfter( firstWS );
     long newYear;
-    if ( monthsInYear == 12 )
-    {
-        long m12 = NextNewMoon( firstNM + 1 );
-        newYear = NextNewMoon( m12 + 1 );
-    }
+    if ( sui.m_numMonths == 12 )
+        newYear = sui.m_newMoons[2];
     else
     {
-        Assert( monthsInYear == 13 );
-        long nm = NextNewMoon( firstNM + 1 );
-        int startMajor = MajorSolarTerm( nm - 1 );
+        Assert( sui.m_numMonths == 13 );
+        int nm = 1;
+        int startMajor = sui.m_majorTerms[0];
         int m = 11;
         for ( int i = 0; i < 4; ++i )   //Limit iterations to be safe.
         {
-            long nextNM = NextNewMoon( nm + 1 );
-            int endMajor = MajorSolarTerm( nextNM - 1 );
+            int endMajor = sui.m_majorTerms[ nm ];
             if ( endMajor != startMajor )
                 if ( ++m > 12 )
                     break;
-            nm = nextNM;
+            ++nm;
             startMajor = endMajor;
         }
         Assert( m == 13 );
-        newYear = nm;
+        newYear = sui.m_newMoons[ nm ];
     }
     long jd = newYear  +  (month - 1) * 29;
-    jd = NextNewMoon( jd ) + day - 1;
+    jd = NewMoonOnOrAfter( sui, jd ) + day - 1;
     return jd;
 }
 
@@ -252,6 +255,40 @@ ChineseCalendar::DMLYToJulianDay( int day, int month, bool leap, long year )
     return DMYToJulianDay( day, month, year );
 }
 
+//-----------------------------------------------------------------------------
+
+void 
+ChineseCalendar::ConvertRange( long firstJulianDay, int count,
+                               int * pDays, int * pMonths, long * pYears,
+                               int * pLeapMonths )
+{
+    Assert( pDays && pMonths && pYears && pLeapMonths );
+    //Each month is converted once. Its end is the next new moon in the sui
+    // record, the same data JulianDayToDMYL() took its start from, and the
+    // days until then share the month, year, and leap month.
+    long julianDay = firstJulianDay;
+    long lastJulianDay = firstJulianDay + count - 1;
+    int i = 0;
+    while ( julianDay <= lastJulianDay )
+    {
+        int day;
+        int month;
+        long year;
+        int leapMonth;
+        JulianDayToDMYL( julianDay, &day, &month, &year, &leapMonth );
+        SuiRecord sui = SuiContaining( julianDay );
+        long nextMonthStart = NewMoonOnOrAfter( sui, julianDay + 1 );
+        for ( ; (julianDay < nextMonthStart) && (julianDay <= lastJulianDay);
+              ++julianDay, ++day, ++i )
+        {
+            pDays[i] = day;
+            pMonths[i] = month;
+            pYears[i] = year;
+            pLeapMonths[i] = leapMonth;
+        }
+    }
+}
+
 //=============================================================================
 
 bool 
@@ -314,51 +351,33 @@ ChineseCalendar::LeapMonth( long year )
 {
     long firstWS = (long)( s_chineseEpochWS
                                       +  (year - 1) * s_tropicalYear - 10 );
-    firstWS = NextWinterSolstice( firstWS );
-    long firstNM = PriorNewMoon( firstWS );
-    long lastWS = NextWinterSolstice( firstWS + 1 );
-    long lastNM = PriorNewMoon( lastWS );
-    lastNM = PriorNewMoon( lastNM - 1 );
-    int monthsInYear = (int)(((lastNM - firstNM) / s_synodicMonth) + 0.5 ) + 1;
+    SuiRecord sui = SuiStartingOnOrAfter( firstWS );
     bool firstSolarYear = true;
-    if ( monthsInYear == 12 )
+    if ( sui.m_numMonths == 12 )
     {
-        firstWS = lastWS;
-        firstNM = PriorNewMoon( firstWS );
-        lastWS = NextWinterSolstice( firstWS + 1 );
-        lastNM = PriorNewMoon( lastWS );
-        lastNM = PriorNewMoon( lastNM - 1 );
-        monthsInYear = (int)(((lastNM - firstNM) / s_synodicMonth) + 0.5 ) + 1;
-        if ( monthsInYear == 12 )
+        sui = SuiStartingAt( sui.m_nextWinterSolstice );
+        if ( sui.m_numMonths == 12 )
             return LMNone;
         firstSolarYear = false;
     }
-    Assert( monthsInYear == 13 );
-    long nm = NextNewMoon( firstNM + 1 );
-    int startMajor = MajorSolarTerm( nm - 1 );
-    for ( int m = 1; m < 13; ++m )
+    Assert( sui.m_numMonths == 13 );
+    int m = sui.m_noMajorTermMonth;
+    if ( m > 0 )
     {
-        long nextNM = NextNewMoon( nm + 1 );
-        int endMajor = MajorSolarTerm( nextNM - 1 );
-        if ( endMajor == startMajor )
+        if ( firstSolarYear )
         {
-            if ( firstSolarYear )
-            {
-                if ( m < 3 )
-                    return LMNone;  //Leap month was in previous year.
-                else
-                    return (m - 1);
-            }
+            if ( m < 3 )
+                return LMNone;  //Leap month was in previous year.
             else
-            {
-                if ( m < 3 )
-                    return (m + 11);
-                else
-                    return LMNone;  //Leap month is in following year.
-            }
+                return (m - 1);
+        }
+        else
+        {
+            if ( m < 3 )
+                return (m + 11);
+            else
+                return LMNone;  //Leap month is in following year.
         }
-        nm = nextNM;
-        startMajor = endMajor;
     }
     Assert( 0 && "No leap month in year of 13 moons!" );
 #ifndef DEBUG   //Just to avoid compiler warnings.
@@ -375,6 +394,15 @@ ChineseCalendar::DaysInMonth( int month, long year )
              - DMYToJulianDay( 1, month, year ));
 }
 
+//-----------------------------------------------------------------------------
+
+void 
+ChineseCalendar::ClearCache( )
+{
+    MutexLock lock( s_suiCacheMutex );
+    s_suiCache.clear( );
+}
+
 //=============================================================================
 
 void 
@@ -383,6 +411,21 @@ ChineseCalendar::SolarTerms( long julianDay,
 {
     //Add 1 to date, because the solar term is based on the solar longitude
     // reached by the end of the day.
+    const EventTable * pTable = EventTable::Registered( );
+    int index = pTable
+            ?  pTable->FindPrior( JDItoJD( julianDay + 1 ),
+                                  EventTable::SolarTerm )
+            :  -1;
+    if ( index >= 0 )
+    {
+        //The solar longitude is between 15*k and 15*(k+1) degrees.
+        int k = pTable->SolarTermNumber( index );
+        if ( pMajorTerm )
+            *pMajorTerm = ((k + 2) % 24) / 2 + 1;
+        if ( pMinorTerm )
+            *pMinorTerm = ((k + 3) % 24) / 2 + 1;
+        return;
+    }
     Angle solarLong = SolarLongitude( julianDay + 1 );
     if ( pMajorTerm )
     {
@@ -409,9 +452,18 @@ ChineseCalendar::SolarTerms( long julianDay,
 long 
 ChineseCalendar::JDofNextSolarTerm( long julianDay, int term, bool major )
 {
+    double jd = JDItoJD( julianDay );
+    const EventTable * pTable = EventTable::Registered( );
+    if ( pTable )
+    {
+        int term15 = ModP( 2 * (term - 1) - (major  ?  2  :  3), 24 );
+        int index = pTable->FindNextSolarTerm( jd, term15 );
+        if ( index >= 0 )
+            return EventDay( pTable->JulianDay( EventTable::SolarTerm, index ),
+                             JDtoJDI, JDItoJD );
+    }
     Angle solarLongOfTerm = Angle( (term - 1) * (M_PI / 6.)
                                  -  (major  ?  (M_PI / 6.)  :  (M_PI / 4.)) );
-    double jd = JDItoJD( julianDay );
     const double spring2000 = 2451623.8159722;
     double term2000 = spring2000  +  solarLongOfTerm.Cycles() * s_tropicalYear;
     double offset = ModRP( (term2000 - jd), s_tropicalYear );
@@ -651,6 +703,15 @@ NextWinterSolstice( long jdi )
 long 
 PriorNewMoon( long jdi )
 {
+    const EventTable * pTable = EventTable::Registered( );
+    if ( pTable )
+    {
+        int index = pTable->FindPrior( JDItoJD( jdi + 1 ),
+                                       EventTable::NewMoon );
+        if ( index >= 0 )
+            return EventDay( pTable->JulianDay( EventTable::NewMoon, index ),
+                             JDtoJDI, JDItoJD );
+    }
     Angle lunarPhase = LunarPhase( jdi + 1 );
     lunarPhase.NormalizePositive( );
     double offset = lunarPhase.Cycles() * s_synodicMonth;
@@ -670,6 +731,14 @@ PriorNewMoon( long jdi )
 long 
 NextNewMoon( long jdi )
 {
+    const EventTable * pTable = EventTable::Registered( );
+    if ( pTable )
+    {
+        int index = pTable->FindNext( JDItoJD( jdi ), EventTable::NewMoon );
+        if ( index >= 0 )
+            return EventDay( pTable->JulianDay( EventTable::NewMoon, index ),
+                             JDtoJDI, JDItoJD );
+    }
     Angle lunarPhase = - LunarPhase( jdi );
     lunarPhase.NormalizePositive( );
     double offset = lunarPhase.Cycles() * s_synodicMonth;
@@ -694,6 +763,150 @@ MajorSolarTerm( long jdi )
     return majorTerm;
 }
 
+//=============================================================================
+
+//Looks in the cache for a sui that begins in [firstStart, lastStart] and
+// ends after jdi.
+
+bool
+FindCachedSui( long firstStart, long lastStart, long jdi, SuiRecord * pSui )
+{
+    MutexLock lock( s_suiCacheMutex );
+    for ( list< SuiRecord >::iterator pRecord = s_suiCache.begin();
+          pRecord != s_suiCache.end(); ++pRecord )
+    {
+        if ( (pRecord->m_winterSolstice >= firstStart)
+             && (pRecord->m_winterSolstice <= lastStart)
+             && (pRecord->m_nextWinterSolstice > jdi) )
+        {
+            s_suiCache.splice( s_suiCache.begin(), s_suiCache, pRecord );
+            *pSui = *pRecord;
+            return true;
+        }
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+
+void
+CacheSui( const SuiRecord & sui )
+{
+    MutexLock lock( s_suiCacheMutex );
+    for ( list< SuiRecord >::const_iterator pRecord = s_suiCache.begin();
+          pRecord != s_suiCache.end(); ++pRecord )
+        if ( pRecord->m_winterSolstice == sui.m_winterSolstice )
+            return;     //Another thread got here first.
+    while ( (int) s_suiCache.size() >= s_suiCacheCapacity )
+        s_suiCache.pop_back( );
+    s_suiCache.push_front( sui );
+}
+
+//-----------------------------------------------------------------------------
+
+SuiRecord
+ComputeSui( long winterSolstice, long nextWinterSolstice )
+{
+    SuiRecord sui;
+    sui.m_winterSolstice = winterSolstice;
+    sui.m_nextWinterSolstice = nextWinterSolstice;
+    long firstNM = PriorNewMoon( winterSolstice );
+    long lastNM = PriorNewMoon( nextWinterSolstice );
+    lastNM = PriorNewMoon( lastNM - 1 );
+    sui.m_numMonths = (int)(((lastNM - firstNM) / s_synodicMonth) + 0.5 ) + 1;
+    Assert( (sui.m_numMonths == 12) || (sui.m_numMonths == 13) );
+    sui.m_newMoons[0] = firstNM;
+    for ( int i = 1; i <= sui.m_numMonths; ++i )
+        sui.m_newMoons[ i ] = NextNewMoon( sui.m_newMoons[ i - 1 ] + 1 );
+    sui.m_noMajorTermMonth = 0;
+    if ( sui.m_numMonths == 13 )
+    {
+        //Month begins w/solar term at end of previous day.
+        for ( int i = 0; i < 13; ++i )
+        {
+            sui.m_majorTerms[ i ]
+                    = MajorSolarTerm( sui.m_newMoons[ i + 1 ] - 1 );
+            if ( (i > 0) && (sui.m_noMajorTermMonth == 0)
+                 && (sui.m_majorTerms[ i ] == sui.m_majorTerms[ i - 1 ]) )
+                sui.m_noMajorTermMonth = i;
+        }
+    }
+    CacheSui( sui );
+    return sui;
+}
+
+//-----------------------------------------------------------------------------
+
+SuiRecord 
+SuiStartingAt( long winterSolstice )
+{
+    SuiRecord sui;
+    if ( FindCachedSui( winterSolstice, winterSolstice, winterSolstice,
+                        &sui ) )
+        return sui;
+    return ComputeSui( winterSolstice,
+                       NextWinterSolstice( winterSolstice + 1 ) );
+}
+
+//-----------------------------------------------------------------------------
+
+SuiRecord 
+SuiContaining( long jdi )
+{
+    SuiRecord sui;
+    //A sui is less than 400 days long.
+    if ( FindCachedSui( jdi - 400, jdi, jdi, &sui ) )
+        return sui;
+    long lastWS = NextWinterSolstice( jdi + 1 );
+    long firstWS = NextWinterSolstice( lastWS - 370 );
+    if ( FindCachedSui( firstWS, firstWS, firstWS, &sui ) )
+        return sui;
+    return ComputeSui( firstWS, lastWS );
+}
+
+//-----------------------------------------------------------------------------
+
+//The sui beginning on NextWinterSolstice( jdi ).
+
+SuiRecord 
+SuiStartingOnOrAfter( long jdi )
+{
+    SuiRecord sui;
+    //Winter solstices are more than 360 days apart.
+    if ( FindCachedSui( jdi, jdi + 360, jdi, &sui ) )
+        return sui;
+    return SuiStartingAt( NextWinterSolstice( jdi ) );
+}
+
+//-----------------------------------------------------------------------------
+
+//The same as NextNewMoon( jdi ), but found in the sui or the one after it, if
+// jdi is in their range.
+
+long 
+NewMoonOnOrAfter( const SuiRecord & sui, long jdi )
+{
+    if ( jdi >= sui.m_newMoons[0] )
+    {
+        if ( jdi <= sui.m_newMoons[ sui.m_numMonths ] )
+        {
+            int i = 0;
+            while ( sui.m_newMoons[ i ] < jdi )
+                ++i;
+            return sui.m_newMoons[ i ];
+        }
+        SuiRecord nextSui = SuiStartingAt( sui.m_nextWinterSolstice );
+        if ( jdi <= nextSui.m_newMoons[ nextSui.m_numMonths ] )
+        {
+            int i = 0;
+            while ( nextSui.m_newMoons[ i ] < jdi )
+                ++i;
+            return nextSui.m_newMoons[ i ];
+        }
+    }
+    return NextNewMoon( jdi );
+}
+
 //-----------------------------------------------------------------------------
 
 }                                                                 /*namespace*/
@@ -838,6 +1051,66 @@ ChineseCalendar::Test( )
     jd = Date( d, m, y ).JulianDay();
     cout << " Next WS: " << NextWinterSolstice( jd ) << endl;
 
+    y = 4627;
+    cout << "Year " << y << " (cached and uncached)" << endl;
+    ClearCache( );
+    jd = Date( 27, January, 1990 ).JulianDay();
+    if ( JPLEphemeris::GetEphemeris( jd ) )
+    {
+        TESTCHECK( DMYToJulianDay( 1, 1, y ), jd, &ok );
+        TESTCHECK( LeapMonth( y ), 6, &ok );
+        TESTCHECK( DaysInMonth( 6, y ), 29, &ok );
+    }
+    else
+        cout << "No ephemeris registered for " << jd << endl;
+    jd = DMYToJulianDay( 1, 1, y );
+    int numErrors = 0;
+    for ( long j = jd; j < jd + 400; ++j )
+    {
+        int day, month, leapMonth;
+        long year;
+        JulianDayToDMYL( j, &day, &month, &year, &leapMonth );
+        if ( DMYToJulianDay( day, month, year ) != j )
+            ++numErrors;
+        //Rebuilding the cache is slow, so only sample the uncached results.
+        if ( (j - jd) % 31 != 0 )
+            continue;
+        ClearCache( );
+        int uncachedDay, uncachedMonth, uncachedLeapMonth;
+        long uncachedYear;
+        JulianDayToDMYL( j, &uncachedDay, &uncachedMonth, &uncachedYear,
+                         &uncachedLeapMonth );
+        if ( (uncachedDay != day) || (uncachedMonth != month)
+             || (uncachedYear != year) || (uncachedLeapMonth != leapMonth) )
+            ++numErrors;
+    }
+    TESTCHECK( numErrors, 0, &ok );
+    //The second range starts before the winter solstice of 2004, where the
+    // leap month of the sui before falls early (see JulianDayToDMYL()).
+    long rangeStarts[ 2 ] = { jd, Date( 1, December, 2004 ).JulianDay() };
+    for ( int r = 0; r < 2; ++r )
+    {
+        long start = rangeStarts[ r ];
+        cout << "ConvertRange( " << start << ", 800 )" << endl;
+        vector< int > days( 800 ), months( 800 ), leapMonths( 800 );
+        vector< long > years( 800 );
+        ConvertRange( start, 800,
+                      &days[0], &months[0], &years[0], &leapMonths[0] );
+        numErrors = 0;
+        for ( int i = 0; i < 800; ++i )
+        {
+            int day, month, leapMonth;
+            long year;
+            JulianDayToDMYL( start + i, &day, &month, &year, &leapMonth );
+            if ( (day != days[i]) || (month != months[i])
+                 || (year != years[i]) || (leapMonth != leapMonths[i]) )
+                ++numErrors;
+            if ( DMYToJulianDay( days[i], months[i], years[i] ) != start + i )
+                ++numErrors;
+        }
+        TESTCHECK( numErrors, 0, &ok );
+    }
+
     if ( ok )
         cout << "ChineseCalendar PASSED." << endl << endl;
     else
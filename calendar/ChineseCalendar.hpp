@@ -47,6 +47,21 @@
      month, and leapMonth is the leapMonth for that year. (leapMonth = LMNone
      if there is no leap month, and leapMonth = LMUnknown if it has not yet
      been determined.)
+  4. The new moons and solar terms are found by root finding on the
+     ephemeris, unless an EventTable (see EventTable.hpp) is registered that
+     covers the date, in which case they are looked up in it, with the same
+     results, much faster.
+  5. The structure of each sui (the solar year from one winter solstice to
+     the next) that is needed--the first days of its months, and in a sui of
+     13 months, the major solar term at the end of each and which month is
+     the leap month--is computed once and kept in a small cache, shared by
+     all threads, of the most recently used. So after the first conversion
+     in a year, others in the same year are table lookups. ClearCache()
+     should be called if the registered ephemeris or EventTable changes.
+  6. ConvertRange() converts consecutive days to the DMYL representation
+     (see Note 3). It calls JulianDayToDMYL() once per month, and takes the
+     start of the next month from the same cached sui record, just
+     incrementing the day until then.
 */
 
 
@@ -71,12 +86,16 @@ public:
                                  long * pYear );
     static long DMYToJulianDay( int day, int month, long year );
     static long DMLYToJulianDay( int day, int month, bool leap, long year );
+    static void ConvertRange( long firstJulianDay, int count,
+                              int * pDays, int * pMonths, long * pYears,
+                              int * pLeapMonths );
 
     static bool Valid( int day, int month, long year, int leapMonth );
     static long MakeValid( int * pDay, int * pMonth, long * pYear,
                           int * pLeapMonth, DateFixup::EMethod fixupMethod );
     static int LeapMonth( long year );
     static int DaysInMonth( int month, long year );
+    static void ClearCache( );
 
     static void SolarTerms( long julianDay,
                             int * pMajorTerm, int * pMinorTerm );
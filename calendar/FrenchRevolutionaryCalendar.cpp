@@ -11,6 +11,7 @@
 #include "CalendarLibText.hpp"
 #include "TimeIncrement.hpp"
 #include "AstroPhenomena.hpp"
+#include "EventTable.hpp"
 #include "TimeStandards.hpp"
 #include "Angle.hpp"
 using namespace std;
@@ -154,6 +155,14 @@ SolarLongitude( long jdi )
 long 
 PriorAutumnalEquinox( long jdi )
 {
+    const EventTable * pTable = EventTable::Registered( );
+    if ( pTable )
+    {
+        int index = pTable->FindPriorSolarTerm( JDItoJD( jdi ), 12 );
+        if ( index >= 0 )
+            return EventDay( pTable->JulianDay( EventTable::SolarTerm, index ),
+                             JDtoJDI, JDItoJD );
+    }
     double jd = JDItoJD( jdi );
     const Angle autumnLong( M_PI );
     const double autumn2000 = 2451810.22708333;
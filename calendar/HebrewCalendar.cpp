@@ -8,8 +8,10 @@
 
 #include "HebrewCalendar.hpp"
 #include "Assert.hpp"
+#include "DMYRange.hpp"
 #include "DivMod.hpp"
 #include "CalendarLibText.hpp"
+#include "Mutex.hpp"
 #include <cmath>
 using namespace std;
 
@@ -27,6 +29,18 @@ const long s_hebrewEpoch = 347998;
 
 long DaysElapsed( long year );
 
+//The first days of the months of a year, computed from the year's length.
+struct YearInfo
+{
+    bool m_valid;
+    long m_year;
+    int m_monthsInYear;
+    long m_monthStarts[ 14 ];   //indexed by month; [0] is unused.
+    long m_nextNewYear;         //1 Tishri of year + 1
+};
+
+YearInfo GetYearInfo( long year );
+
 }
 
 
@@ -41,23 +55,18 @@ HebrewCalendar::JulianDayToDMY( long julianDay,
       "Calendrical Calculations", p. 94.*/
     long approx = (long)( DivRF( (double)( julianDay - s_hebrewEpoch ),
                                 (35975351. / 98496.) ) );
-    long year = approx - 1;
     //Year begins with month 7 (Tishri)
-    for ( long y = approx; DMYToJulianDay( 1, 7, y ) <= julianDay; ++y )
-        ++year;
-    int start;
-    if ( julianDay < DMYToJulianDay( 1, 1, year ) )
-        start = 7;
-    else
-        start = 1;
-    int month = start;
-    for ( int m = start;
-          DMYToJulianDay( DaysInMonth( m, year ), m, year ) < julianDay; ++m )
+    YearInfo info = GetYearInfo( approx - 1 );
+    while ( info.m_nextNewYear <= julianDay )
+        info = GetYearInfo( info.m_year + 1 );
+    int month = (julianDay < info.m_monthStarts[1])  ?  7  :  1;
+    int lastMonth = (month == 7)  ?  info.m_monthsInYear  :  6;
+    while ( (month < lastMonth)
+            && (info.m_monthStarts[ month + 1 ] <= julianDay) )
         ++month;
-    int day = (int)(julianDay - DMYToJulianDay( 1, month, year ) + 1);
-    *pDay = day;
+    *pDay = (int)(julianDay - info.m_monthStarts[ month ] + 1);
     *pMonth = month;
-    *pYear = year;
+    *pYear = info.m_year;
 }
 
 //-----------------------------------------------------------------------------
@@ -65,17 +74,11 @@ HebrewCalendar::JulianDayToDMY( long julianDay,
 long
 HebrewCalendar::DMYToJulianDay( int day, int month, long year )
 {
-    /*Adapted from Nachum Dershowitz and Edward M. Reingold,
-      "Calendrical Calculations", p. 91-93.*/
-    long elapsedM1 = DaysElapsed( year - 1 );
-    long elapsed = DaysElapsed( year );
-    long elapsedP1 = DaysElapsed( year + 1 );
-    int newYearDelay = 0;
-    if ( elapsedP1 - elapsed == 356 )
-        newYearDelay = 2;
-    else if ( elapsed - elapsedM1 == 382 )
-        newYearDelay = 1;
-    long jd = s_hebrewEpoch + elapsed + newYearDelay + day - 1;
+    YearInfo info = GetYearInfo( year );
+    if ( (month >= 1) && (month <= info.m_monthsInYear) )
+        return info.m_monthStarts[ month ] + day - 1;
+    //Not a valid month, so sum the lengths as in "Calendrical Calculations".
+    long jd = info.m_monthStarts[ 7 ] + day - 1;
     if ( month < 7 )  //Year begins with month 7 (Tishri).
     {
         int monthsInYear = MonthsInYear( year );
@@ -92,6 +95,16 @@ HebrewCalendar::DMYToJulianDay( int day, int month, long year )
     return jd;
 }
 
+//-----------------------------------------------------------------------------
+
+void
+HebrewCalendar::ConvertRange( long firstJulianDay, int count,
+                              int * pDays, int * pMonths, long * pYears )
+{
+    ConvertDMYRange< HebrewCalendar >( firstJulianDay, count,
+                                       pDays, pMonths, pYears, Tishri );
+}
+
 //=============================================================================
 
 namespace
@@ -111,6 +124,97 @@ DaysElapsed( long year )
     return day;
 }
 
+//-----------------------------------------------------------------------------
+
+//1 Tishri of the year, given the days elapsed before it and the years
+// around it.
+
+long
+NewYear( long elapsedM1, long elapsed, long elapsedP1 )
+{
+    /*Adapted from Nachum Dershowitz and Edward M. Reingold,
+      "Calendrical Calculations", p. 91-93.*/
+    int newYearDelay = 0;
+    if ( elapsedP1 - elapsed == 356 )
+        newYearDelay = 2;
+    else if ( elapsed - elapsedM1 == 382 )
+        newYearDelay = 1;
+    return s_hebrewEpoch + elapsed + newYearDelay;
+}
+
+//-----------------------------------------------------------------------------
+
+void
+ComputeYearInfo( long year, YearInfo * pInfo )
+{
+    long elapsedM1 = DaysElapsed( year - 1 );
+    long elapsed = DaysElapsed( year );
+    long elapsedP1 = DaysElapsed( year + 1 );
+    long elapsedP2 = DaysElapsed( year + 2 );
+    long newYear = NewYear( elapsedM1, elapsed, elapsedP1 );
+    long nextNewYear = NewYear( elapsed, elapsedP1, elapsedP2 );
+    int daysInYear = (int)(nextNewYear - newYear);
+    bool leap = HebrewCalendar::IsLeapYear( year );
+    int monthsInYear = leap  ?  13  :  12;
+    //The months alternate 30 and 29 days, except that Marheshvan has 30 in
+    // a complete year, Kislev 29 in a deficient year, and Adar 30 in a leap
+    // year.
+    static const int daysInMonth[ 13 ]
+        = { 30, 29, 30, 29, 30, 29, 30, 29, 30, 29, 30, 29, 29 };
+    int lengths[ 14 ];
+    for ( int m = 1; m <= 13; ++m )
+        lengths[ m ] = daysInMonth[ m - 1 ];
+    if ( ModF( daysInYear, 10 ) == 5 )
+        lengths[ HebrewCalendar::Marheshvan ] = 30;
+    if ( ModF( daysInYear, 10 ) == 3 )
+        lengths[ HebrewCalendar::Kislev ] = 29;
+    if ( leap )
+        lengths[ HebrewCalendar::Adar ] = 30;
+    pInfo->m_valid = true;
+    pInfo->m_year = year;
+    pInfo->m_monthsInYear = monthsInYear;
+    long start = newYear;
+    for ( int m = 7; m <= monthsInYear; ++m )
+    {
+        pInfo->m_monthStarts[ m ] = start;
+        start += lengths[ m ];
+    }
+    for ( int m = 1; m < 7; ++m )
+    {
+        pInfo->m_monthStarts[ m ] = start;
+        start += lengths[ m ];
+    }
+    Assert( start == nextNewYear );
+    pInfo->m_nextNewYear = nextNewYear;
+}
+
+//-----------------------------------------------------------------------------
+
+//A small cache of YearInfo, indexed by year modulo its size.
+
+const int s_yearInfoCacheSize = 16;
+YearInfo s_yearInfoCache[ s_yearInfoCacheSize ];
+Mutex s_yearInfoCacheMutex;
+
+//.............................................................................
+
+YearInfo
+GetYearInfo( long year )
+{
+    int index = (int) ModF( year, (long) s_yearInfoCacheSize );
+    {
+        MutexLock lock( s_yearInfoCacheMutex );
+        const YearInfo & cached = s_yearInfoCache[ index ];
+        if ( cached.m_valid && (cached.m_year == year) )
+            return cached;
+    }
+    YearInfo info;
+    ComputeYearInfo( year, &info );
+    MutexLock lock( s_yearInfoCacheMutex );
+    s_yearInfoCache[ index ] = info;
+    return info;
+}
+
 } //namespace
 
 //=============================================================================
@@ -129,21 +233,11 @@ HebrewCalendar::DaysInMonth( int month, long year )
     Assert( (month > 0) && (month <= MonthsInYear( year )) );
     static const int daysInMonth[ 13 ]
         = { 30, 29, 30, 29, 30, 29, 30, 29, 30, 29, 30, 29, 29 };
-    if ( month == Marheshvan )
-    {
-        int daysInYear = DMYToJulianDay( 1, 7, year + 1 )
-            - DMYToJulianDay( 1, 7, year );
-        if ( ModF( daysInYear, 10 ) == 5 )
-            return 30;
-        return 29;
-    }
-    else if ( month == Kislev )
+    if ( (month == Marheshvan) || (month == Kislev) )
     {
-        int daysInYear = DMYToJulianDay( 1, 7, year + 1 )
-            - DMYToJulianDay( 1, 7, year );
-        if ( ModF( daysInYear, 10 ) == 3 )
-            return 29;
-        return 30;
+        YearInfo info = GetYearInfo( year );
+        return (int)(info.m_monthStarts[ month + 1 ]
+                     - info.m_monthStarts[ month ]);
     }
     else if ( month == Adar )
     {
@@ -16,6 +16,12 @@
   1 A.M. (Anno Mundi, the traditional year of the world since creation),
   is JD 347,998. The day begins at sunset for religious purposes, which is
   deemed 6 p.m. for civil purposes.
+  NOTES:
+  1. The length of a year (353-355 or 383-385 days) determines the lengths of
+     all its months. So the first days of the months of a year are computed
+     together, from the year's first day and the next year's, and kept in a
+     small cache, indexed by the year. JulianDayToDMY() and DMYToJulianDay()
+     then only look up the month in this table.
 */
 
 
@@ -34,6 +40,8 @@ public:
     static void JulianDayToDMY( long julianDay,
                                 int * pDay, int * pMonth, long * pYear );
     static long DMYToJulianDay( int day, int month, long year );
+    static void ConvertRange( long firstJulianDay, int count,
+                              int * pDays, int * pMonths, long * pYears );
     static int MonthsInYear( long year );
     static int DaysInMonth( int month, long year );
     static const std::string & MonthName( int month, long year );
@@ -10,6 +10,7 @@
 #ifdef DEBUG
 #include <iostream>
 #include "TestCheck.hpp"
+#include "DMYRange.hpp"
 #include "GregorianDate.hpp"
 #endif
 using namespace std;
@@ -225,6 +226,36 @@ TestHebrewDate( )
         TESTCHECK( hebDate.Year( ), y, &ok );
     }
 
+    cout << "Month boundaries, years -2000 to 8000" << endl;
+    int numErrors = 0;
+    for ( y = -2000; y <= 8000; ++y )
+    {
+        int monthsInYear = HebrewCalendar::MonthsInYear( y );
+        long nextYear = HebrewCalendar::DMYToJulianDay( 1, 7, y + 1 );
+        for ( m = 1; m <= monthsInYear; ++m )
+        {
+            jd = HebrewCalendar::DMYToJulianDay( 1, m, y );
+            int daysInMonth = HebrewCalendar::DaysInMonth( m, y );
+            long nextMonth = (m == 6)  ?  nextYear
+                    :  HebrewCalendar::DMYToJulianDay( 1,
+                            ((m == monthsInYear)  ?  1  :  m + 1), y );
+            int day, month;
+            long year;
+            HebrewCalendar::JulianDayToDMY( jd, &day, &month, &year );
+            if ( (nextMonth - jd != daysInMonth)
+                 || (day != 1) || (month != m) || (year != y) )
+                ++numErrors;
+            HebrewCalendar::JulianDayToDMY( nextMonth - 1,
+                                            &day, &month, &year );
+            if ( (day != daysInMonth) || (month != m) || (year != y) )
+                ++numErrors;
+        }
+    }
+    TESTCHECK( numErrors, 0, &ok );
+
+    cout << "ConvertRange( 2415021, 40000 )" << endl;
+    TESTCHECK( CheckDMYRange< HebrewCalendar >( 2415021, 40000 ), 0, &ok );
+
     if ( ok )
         cout << "HebrewDate PASSED." << endl << endl;
     else
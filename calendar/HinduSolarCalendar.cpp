@@ -13,6 +13,7 @@
 #include "HinduAstro.hpp"
 #include "DivMod.hpp"
 #include "Assert.hpp"
+#include "DMYRange.hpp"
 #include "CalendarLibText.hpp"
 using namespace std;
 
@@ -127,6 +128,18 @@ HinduSolarCalendar::DMYToJulianDay( int day, int month, long year )
     }
 }
 
+//-----------------------------------------------------------------------------
+
+void
+HinduSolarCalendar::ConvertRange( long firstJulianDay, int count,
+                                  int * pDays, int * pMonths, long * pYears )
+{
+    //The solar months are from 29 to 32 days long.
+    ConvertDMYRangeByMonthLength< HinduSolarCalendar >( firstJulianDay, count,
+                                                        pDays, pMonths, pYears,
+                                                        29 );
+}
+
 //=============================================================================
 
 int 
@@ -10,6 +10,7 @@
 #ifdef DEBUG
 #include <iostream>
 #include "TestCheck.hpp"
+#include "DMYRange.hpp"
 #include "Array.hpp"
 #endif
 using namespace std;
@@ -189,6 +190,9 @@ TestHinduSolarDate( )
     }
 
 
+    cout << "ConvertRange( 2451545, 2000 )" << endl;
+    TESTCHECK( CheckDMYRange< HinduSolarCalendar >( 2451545, 2000 ), 0, &ok );
+
     if ( ok )
         cout << "HinduSolarDate PASSED." << endl << endl;
     else
@@ -8,7 +8,9 @@
 
 
 #include "IslamicCalendar.hpp"
+#include "IslamicMonthTable.hpp"
 #include "Assert.hpp"
+#include "DMYRange.hpp"
 #include "DivMod.hpp"
 #include "CalendarLibText.hpp"
 #include "AngleDMS.hpp"
@@ -64,6 +66,17 @@ IslamicCalendar::JulianDayToDMY( long julianDay,
     ms_pSystem->JulianDayToDMY( julianDay, pDay, pMonth, pYear );
 }
 
+//.............................................................................
+
+void
+IslamicCalendar::JulianDayToDMY( long julianDay,
+                                 int * pDay, int * pMonth, long * pYear,
+                                 const Context & context )
+{
+    Assert( context.m_spSystem );
+    context.m_spSystem->JulianDayToDMY( julianDay, pDay, pMonth, pYear );
+}
+
 //-----------------------------------------------------------------------------
 
 long
@@ -73,6 +86,38 @@ IslamicCalendar::DMYToJulianDay( int day, int month, long year )
     return ms_pSystem->DMYToJulianDay( day, month, year );
 }
 
+//.............................................................................
+
+long
+IslamicCalendar::DMYToJulianDay( int day, int month, long year,
+                                 const Context & context )
+{
+    Assert( context.m_spSystem );
+    return context.m_spSystem->DMYToJulianDay( day, month, year );
+}
+
+//-----------------------------------------------------------------------------
+
+void
+IslamicCalendar::ConvertRange( long firstJulianDay, int count,
+                               int * pDays, int * pMonths, long * pYears )
+{
+    ConvertDMYRange< IslamicCalendar >( firstJulianDay, count,
+                                        pDays, pMonths, pYears );
+}
+
+//.............................................................................
+
+void
+IslamicCalendar::ConvertRange( long firstJulianDay, int count,
+                               int * pDays, int * pMonths, long * pYears,
+                               const Context & context )
+{
+    ConvertDMYRangeInContext< IslamicCalendar >( firstJulianDay, count,
+                                                 pDays, pMonths, pYears,
+                                                 context );
+}
+
 //=============================================================================
 
 int
@@ -83,6 +128,16 @@ IslamicCalendar::DaysInMonth( int month, long year )
     return ms_pSystem->DaysInMonth( month, year );
 }
 
+//.............................................................................
+
+int
+IslamicCalendar::DaysInMonth( int month, long year, const Context & context )
+{
+    Assert( (month > 0) && (month <= MonthsInYear( year )) );
+    Assert( context.m_spSystem );
+    return context.m_spSystem->DaysInMonth( month, year );
+}
+
 //-----------------------------------------------------------------------------
 
 const string &
@@ -109,6 +164,15 @@ IslamicCalendar::IsLeapYear( long year )
     return ms_pSystem->IsLeapYear( year );
 }
 
+//.............................................................................
+
+bool
+IslamicCalendar::IsLeapYear( long year, const Context & context )
+{
+    Assert( context.m_spSystem );
+    return context.m_spSystem->IsLeapYear( year );
+}
+
 
 //*****************************************************************************
 
@@ -231,7 +295,13 @@ IslamicCalendar::AstronomicalSystem::JulianDayToDMY( long julianDay,
 {
     /*Adapted from Edward M. Reingold and Nachum Dershowitz,
       "Calendrical Calculations, Millennium Edition", p 206.*/
-    long monthStart = MonthStart( julianDay );
+    long monthStart;
+    int index = m_spMonthTable  ?  m_spMonthTable->FindMonth( julianDay )
+            :  -1;
+    if ( index >= 0 )
+        monthStart = m_spMonthTable->MonthStart( index );
+    else
+        monthStart = MonthStart( julianDay );
     long elapsedMonths = (long)(
         floor( ((monthStart - s_islamicEpoch) / s_synodicMonth) + 0.5 ) );
     long month;
@@ -247,14 +317,27 @@ IslamicCalendar::AstronomicalSystem::JulianDayToDMY( long julianDay,
 long 
 IslamicCalendar::AstronomicalSystem::DMYToJulianDay( int day, int month,
                                                      long year )
+{
+    long elapsedMonths = (year - 1) * 12  +  month - 1;
+    if ( m_spMonthTable )
+    {
+        long index = elapsedMonths - m_spMonthTable->FirstMonth( );
+        if ( (index >= 0) && (index < m_spMonthTable->NumMonths( )) )
+            return m_spMonthTable->MonthStart( (int) index ) + day - 1;
+    }
+    return ComputeMonthStart( elapsedMonths ) + day - 1;
+}
+
+//-----------------------------------------------------------------------------
+
+long 
+IslamicCalendar::AstronomicalSystem::ComputeMonthStart( long elapsedMonths )
 {
     /*Adapted from Edward M. Reingold and Nachum Dershowitz,
       "Calendrical Calculations, Millennium Edition", p 206.*/
     long midMonth = s_islamicEpoch
-            + (long)( floor( ((year - 1) * 12  +  month  -  0.5)
-                                            * s_synodicMonth ) );
-    long monthStart = MonthStart( midMonth );
-    return monthStart + day - 1;
+            + (long)( floor( (elapsedMonths + 0.5) * s_synodicMonth ) );
+    return MonthStart( midMonth );
 }
 
 //-----------------------------------------------------------------------------
@@ -327,6 +410,18 @@ IslamicCalendar::LocalMonthFunc::operator()( long julianDay )
 //*****************************************************************************
 
 
+bool 
+IslamicCalendar::CrescentMonthFunc::operator()( long julianDay )
+{
+    double jd = julianDay  - 1. - m_location.Longitude().Cycles();
+    return LunarVisibility::CheckNext( jd, m_location,
+                                       LunarVisibility::Evening, m_criterion );
+}
+
+
+//*****************************************************************************
+
+
 bool 
 IslamicCalendar::UmmAlQuraVisibility( double julianDay,
                                       const GeodeticLocation & location )
@@ -22,10 +22,25 @@
         simply compares the New Moon or moonset times to sunset.
      iii) The Islamic Society of North America adopted a simple rule
         recommended by the Fiqh Council of North American, 10 June 2006.
+  2. The AstronomicalSystem finds the first day of a month by evaluating its
+     MonthFunc on several days, and for a LocalMonthFunc each evaluation
+     searches for sunset and moonset. Where a month table (see
+     IslamicMonthTable.hpp) generated with the same MonthFunc has been set
+     with SetMonthTable(), the month starts are instead looked up in it, and
+     the live computation is used only outside its range. SetMonthFunc()
+     removes the table.
+  3. SetSystem() chooses the system for the whole program. The functions
+     that take a Context use the system given in it instead, so conversions
+     by different systems may run at the same time in different threads.
+     A System should not be changed (e.g. by SetMonthFunc()) while it is in
+     use. LocalMonthFunc with LunarVisibility::CheckNext() depends on
+     LunarVisibility::SetCriterion(); CrescentMonthFunc carries its own
+     criterion.
 */
 
 
 #include "GeodeticLocation.hpp"
+#include "LunarVisibility.hpp"
 #include <tr1/memory>
 #include <string>
 
@@ -33,6 +48,8 @@
 namespace EpsilonDelta
 {                                                      //namespace EpsilonDelta
 
+class IslamicMonthTable;
+
 //*****************************************************************************
 
 
@@ -48,6 +65,8 @@ public:
     static void JulianDayToDMY( long julianDay,
                                 int * pDay, int * pMonth, long * pYear );
     static long DMYToJulianDay( int day, int month, long year );
+    static void ConvertRange( long firstJulianDay, int count,
+                              int * pDays, int * pMonths, long * pYears );
     static int MonthsInYear( long year );
     static int DaysInMonth( int month, long year );
     static const std::string & MonthName( int month, long year );
@@ -117,6 +136,9 @@ public:
         AstronomicalSystem( std::tr1::shared_ptr< MonthFunc > pMonthFunc );
         void SetMonthFunc( std::tr1::shared_ptr< MonthFunc > pMonthFunc );
         std::tr1::shared_ptr< MonthFunc > GetMonthFunc( ) const;
+        void SetMonthTable(
+            std::tr1::shared_ptr< const IslamicMonthTable > spTable );
+        std::tr1::shared_ptr< const IslamicMonthTable > MonthTable( ) const;
 
     protected:
         virtual void JulianDayToDMY( long julianDay,
@@ -127,8 +149,12 @@ public:
 
     private:
         long MonthStart( long julianDay );
+        long ComputeMonthStart( long elapsedMonths );
 
         std::tr1::shared_ptr< MonthFunc >   m_pMonthFunc;
+        std::tr1::shared_ptr< const IslamicMonthTable >   m_spMonthTable;
+
+        friend class IslamicMonthTable;
     };
 
 //-----------------------------------------------------------------------------
@@ -171,6 +197,23 @@ public:
         GeodeticLocation    m_location;
     };
 
+//.............................................................................
+
+    class CrescentMonthFunc
+        :   public MonthFunc
+    {
+    public:
+        CrescentMonthFunc( LunarVisibility::ECriterion criterion,
+                           const GeodeticLocation & location = Mecca );
+        LunarVisibility::ECriterion Criterion( ) const;
+        const GeodeticLocation & Location( ) const;
+        virtual bool operator()( long julianDay );
+
+    private:
+        LunarVisibility::ECriterion m_criterion;
+        GeodeticLocation    m_location;
+    };
+
 //-----------------------------------------------------------------------------
 
     static bool UmmAlQuraVisibility( double julianDay,
@@ -179,7 +222,36 @@ public:
 //-----------------------------------------------------------------------------
 
     static void SetSystem( std::tr1::shared_ptr< System > pSystem );
-    std::tr1::shared_ptr< System > GetSystem( );
+    static std::tr1::shared_ptr< System > GetSystem( );
+
+//-----------------------------------------------------------------------------
+
+    class Context
+    {
+    public:
+        explicit Context( std::tr1::shared_ptr< System > spSystem
+                          = IslamicCalendar::GetSystem( ) );
+        void SetSystem( std::tr1::shared_ptr< System > spSystem );
+        std::tr1::shared_ptr< System > GetSystem( ) const;
+
+    private:
+        std::tr1::shared_ptr< System > m_spSystem;
+
+        friend class IslamicCalendar;
+    };
+
+//-----------------------------------------------------------------------------
+
+    static void JulianDayToDMY( long julianDay,
+                                int * pDay, int * pMonth, long * pYear,
+                                const Context & context );
+    static long DMYToJulianDay( int day, int month, long year,
+                                const Context & context );
+    static void ConvertRange( long firstJulianDay, int count,
+                              int * pDays, int * pMonths, long * pYears,
+                              const Context & context );
+    static int DaysInMonth( int month, long year, const Context & context );
+    static bool IsLeapYear( long year, const Context & context );
 
 //=============================================================================
 
@@ -265,6 +337,7 @@ IslamicCalendar::AstronomicalSystem::SetMonthFunc(
     std::tr1::shared_ptr< MonthFunc > pMonthFunc )
 {
     m_pMonthFunc = pMonthFunc;
+    m_spMonthTable.reset( );
 }
 
 //-----------------------------------------------------------------------------
@@ -276,6 +349,25 @@ IslamicCalendar::AstronomicalSystem::GetMonthFunc( ) const
     return m_pMonthFunc;
 }
 
+//-----------------------------------------------------------------------------
+
+inline
+void
+IslamicCalendar::AstronomicalSystem::SetMonthTable(
+    std::tr1::shared_ptr< const IslamicMonthTable > spTable )
+{
+    m_spMonthTable = spTable;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+std::tr1::shared_ptr< const IslamicMonthTable >
+IslamicCalendar::AstronomicalSystem::MonthTable( ) const
+{
+    return m_spMonthTable;
+}
+
 
 //*****************************************************************************
 
@@ -328,6 +420,65 @@ IslamicCalendar::LocalMonthFunc::Location( ) const
 }
 
 
+//*****************************************************************************
+
+
+inline
+IslamicCalendar::CrescentMonthFunc::CrescentMonthFunc(
+    LunarVisibility::ECriterion criterion,
+    const GeodeticLocation & location )
+    :   m_criterion( criterion ),
+        m_location( location )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+LunarVisibility::ECriterion
+IslamicCalendar::CrescentMonthFunc::Criterion( ) const
+{
+    return m_criterion;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+const GeodeticLocation & 
+IslamicCalendar::CrescentMonthFunc::Location( ) const
+{
+    return m_location;
+}
+
+
+//*****************************************************************************
+
+
+inline
+IslamicCalendar::Context::Context( std::tr1::shared_ptr< System > spSystem )
+    :   m_spSystem( spSystem )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+void
+IslamicCalendar::Context::SetSystem( std::tr1::shared_ptr< System > spSystem )
+{
+    m_spSystem = spSystem;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+std::tr1::shared_ptr< IslamicCalendar::System >
+IslamicCalendar::Context::GetSystem( ) const
+{
+    return m_spSystem;
+}
+
+
 //*****************************************************************************
 
 }                                                      //namespace EpsilonDelta
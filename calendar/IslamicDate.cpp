@@ -10,6 +10,7 @@
 #ifdef DEBUG
 #include <iostream>
 #include "TestCheck.hpp"
+#include "DMYRange.hpp"
 #include "GregorianDate.hpp"
 #include "Array.hpp"
 #include "AngleDMS.hpp"
@@ -684,6 +685,54 @@ TestIslamicDate( )
         TESTCHECK( islDate.Year(), iy, &ok );
     }
     
+    cout << "ConvertRange( 2451545, 2000 )" << endl;
+    TESTCHECK( CheckDMYRange< IslamicCalendar >( 2451545, 2000 ), 0, &ok );
+
+    cout << "Context( pArithmeticSystem ), with ISNA_Hijri system set"
+         << endl;
+    IslamicCalendar::Context arithmetic( pArithmeticSystem );
+    const int numArithmetic = ARRAY_LENGTH( testDatesArithmetic );
+    for ( int i = 0; i < numArithmetic; ++i )
+    {
+        jd = testDatesArithmetic[i].julianDay;
+        d = testDatesArithmetic[i].day;
+        m = testDatesArithmetic[i].month;
+        y = testDatesArithmetic[i].year;
+        TESTCHECK( IslamicCalendar::DMYToJulianDay( d, m, y, arithmetic ),
+                   jd, &ok );
+        int day, month;
+        long year;
+        IslamicCalendar::JulianDayToDMY( jd, &day, &month, &year,
+                                         arithmetic );
+        TESTCHECK( day, d, &ok );
+        TESTCHECK( month, m, &ok );
+        TESTCHECK( year, y, &ok );
+    }
+    cout << "ConvertRange( 2451545, 2000, context )" << endl;
+    TESTCHECK( CheckDMYRangeInContext< IslamicCalendar >( 2451545, 2000,
+                                                          arithmetic ),
+               0, &ok );
+    IslamicCalendar::Context current;
+    TESTCHECK( current.GetSystem( ), IslamicCalendar::GetSystem( ), &ok );
+
+    cout << "CrescentMonthFunc( Shaukat, cairo )" << endl;
+    IslamicCalendar::Context shaukat(
+        shared_ptr< IslamicCalendar::System >(
+            new IslamicCalendar::AstronomicalSystem(
+                shared_ptr< IslamicCalendar::MonthFunc >(
+                    new IslamicCalendar::CrescentMonthFunc(
+                        LunarVisibility::Shaukat, cairo ) ) ) ) );
+    const int numShaukat = ARRAY_LENGTH( testDatesShaukat1996 );
+    for ( int i = 2; i < numShaukat; i += 8 )
+    {
+        jd = testDatesShaukat1996[i].julianDay;
+        d = testDatesShaukat1996[i].day;
+        m = testDatesShaukat1996[i].month;
+        y = testDatesShaukat1996[i].year;
+        TESTCHECK( IslamicCalendar::DMYToJulianDay( d, m, y, shaukat ),
+                   jd, &ok );
+    }
+
     if ( ok )
         cout << "IslamicDate PASSED." << endl << endl;
     else
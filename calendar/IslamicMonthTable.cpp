@@ -0,0 +1,360 @@
+/*
+  IslamicMonthTable.cpp
+  Copyright (C) 2011 David M. Anderson
+
+  IslamicMonthTable class: a precomputed table of the first days of the
+  months of an astronomical Islamic calendar (IslamicCalendar::
+  AstronomicalSystem), for one MonthFunc (visibility criterion and location),
+  which may be saved to a file and memory-mapped.
+*/
+
+
+#include "IslamicMonthTable.hpp"
+#include "JPLEphemeris.hpp"
+#include "MappedFileReader.hpp"
+#include "FileException.hpp"
+#include "Exception.hpp"
+#include "StringUtil.hpp"
+#include "Assert.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#ifdef DEBUG
+#include "FileReader.hpp"
+#include "FileWriter.hpp"
+#include "TestCheck.hpp"
+#include <cstdio>
+#include <iostream>
+#endif
+using namespace std;
+using namespace std::tr1;
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+namespace
+{                                                                   //namespace
+
+const char s_magic[ 8 ] = { 'E', 'D', 'I', 'S', 'M', 'T', 'B', 'L' };
+const uint32_t s_byteOrderMark = 0x01020304;
+const int s_alignment = 64;
+const long s_islamicEpoch = 1948440;
+const double s_synodicMonth = 29.5305888531;
+
+}                                                                   //namespace
+
+
+//*****************************************************************************
+
+
+IslamicMonthTable::IslamicMonthTable( )
+{
+    Clear( );
+}
+
+//-----------------------------------------------------------------------------
+
+IslamicMonthTable::IslamicMonthTable( shared_ptr< Reader > spReader )
+{
+    Clear( );
+    Load( spReader );
+}
+
+//-----------------------------------------------------------------------------
+
+void
+IslamicMonthTable::Clear( )
+{
+    m_name.clear( );
+    m_firstMonth = 0;
+    m_numMonths = 0;
+    m_monthStarts = 0;
+    m_ownedMonthStarts.clear( );
+    m_spReader.reset( );
+}
+
+//=============================================================================
+
+void
+IslamicMonthTable::Generate( long firstJulianDay, long lastJulianDay,
+                             shared_ptr< IslamicCalendar::MonthFunc >
+                                 spMonthFunc,
+                             const string & name )
+{
+    Assert( spMonthFunc );
+    if ( firstJulianDay >= lastJulianDay )
+        throw LogicError( "IslamicMonthTable::Generate: Empty date range." );
+    //The searches look back half a month and ahead a couple of days.
+    if ( (! JPLEphemeris::GetEphemeris( firstJulianDay - 60. ))
+         || (! JPLEphemeris::GetEphemeris( lastJulianDay + 60. )) )
+        throw RuntimeError( "IslamicMonthTable::Generate: The ephemeris does"
+                            " not cover the date range." );
+    IslamicCalendar::AstronomicalSystem system( spMonthFunc );
+    long firstMonth = (long)( floor( (firstJulianDay - s_islamicEpoch)
+                                     / s_synodicMonth ) ) - 1;
+    vector< int32_t > monthStarts;
+    monthStarts.push_back( (int32_t) system.ComputeMonthStart( firstMonth ) );
+    while ( monthStarts[ 0 ] > firstJulianDay )
+    {
+        --firstMonth;
+        monthStarts.insert( monthStarts.begin(),
+                        (int32_t) system.ComputeMonthStart( firstMonth ) );
+    }
+    while ( monthStarts.back() <= lastJulianDay )
+    {
+        long month = firstMonth + (long) monthStarts.size();
+        monthStarts.push_back( (int32_t) system.ComputeMonthStart( month ) );
+        if ( monthStarts.back() <= monthStarts[ monthStarts.size() - 2 ] )
+            throw RuntimeError( "IslamicMonthTable::Generate: Month "
+                                + IntToString( month )
+                                + " does not begin after the one before." );
+    }
+
+    Clear( );
+    m_name = name;
+    m_firstMonth = firstMonth;
+    m_ownedMonthStarts.swap( monthStarts );
+    m_numMonths = (int) m_ownedMonthStarts.size();
+    m_monthStarts = &m_ownedMonthStarts[0];
+}
+
+//=============================================================================
+
+void
+IslamicMonthTable::Load( shared_ptr< Reader > spReader )
+{
+    Assert( spReader );
+    Clear( );
+    char magic[ sizeof( s_magic ) ];
+    spReader->Seek( 0 );
+    spReader->Read( magic, sizeof( magic ) );
+    if ( memcmp( magic, s_magic, sizeof( magic ) ) != 0 )
+        throw FileException( "Not an Islamic month table file." );
+    uint32_t formatVersion;
+    spReader->Read( &formatVersion );
+    uint32_t byteOrderMark;
+    spReader->Read( &byteOrderMark );
+    if ( byteOrderMark != s_byteOrderMark )
+        throw FileException( "Islamic month table file has the wrong byte"
+                             " order." );
+    if ( formatVersion != FormatVersion )
+        throw FileException( "Unsupported Islamic month table file version "
+                             + IntToString( formatVersion ) + "." );
+    int32_t i32;
+    spReader->Read( &i32 );
+    int numMonths = i32;
+    spReader->Read( &i32 );
+    long firstMonth = i32;
+    spReader->Read( &i32 );
+    int nameLength = i32;
+    spReader->Read( &i32 );
+    int dataOffset = i32;
+    int fileSize = spReader->Seek( 0, RandomAccess::End );
+    //Compared by division, as the product could overflow.
+    if ( (numMonths < 0) || (nameLength < 0) || (dataOffset < 0)
+         || (dataOffset % (int) sizeof( int32_t ) != 0)
+         || (dataOffset > fileSize)
+         || (numMonths > (fileSize - dataOffset) / (int) sizeof( int32_t )) )
+        throw FileException( "Unable to read Islamic month table file"
+                             " header." );
+    const int headerSize = (int) sizeof( s_magic )
+            + 2 * (int) sizeof( uint32_t ) + 4 * (int) sizeof( int32_t );
+    if ( headerSize + nameLength > dataOffset )
+        throw FileException( "Unable to read Islamic month table file"
+                             " header." );
+    vector< char > name( nameLength + 1, 0 );
+    spReader->Seek( headerSize );
+    spReader->Read( &name[0], nameLength );
+
+    shared_ptr< MappedFileReader > spMapped
+            = dynamic_pointer_cast< MappedFileReader >( spReader );
+    if ( spMapped )
+        m_monthStarts = reinterpret_cast< const int32_t * >( spMapped->Data()
+                                                             + dataOffset );
+    else if ( numMonths > 0 )
+    {
+        m_ownedMonthStarts.resize( numMonths );
+        spReader->Seek( dataOffset );
+        spReader->Read( reinterpret_cast< char * >( &m_ownedMonthStarts[0] ),
+                        numMonths * (int) sizeof( int32_t ) );
+        m_monthStarts = &m_ownedMonthStarts[0];
+    }
+    m_name.assign( &name[0], nameLength );
+    m_firstMonth = firstMonth;
+    m_numMonths = numMonths;
+    if ( spMapped )
+        m_spReader = spReader;
+}
+
+//-----------------------------------------------------------------------------
+
+void
+IslamicMonthTable::Write( Writer & writer ) const
+{
+    const int headerSize = (int) sizeof( s_magic )
+            + 2 * (int) sizeof( uint32_t ) + 4 * (int) sizeof( int32_t );
+    int nameLength = (int) m_name.size();
+    int dataOffset = ((headerSize + nameLength + s_alignment - 1)
+                      / s_alignment) * s_alignment;
+
+    writer.Write( s_magic, (int) sizeof( s_magic ) );
+    writer.Write( (uint32_t) FormatVersion );
+    writer.Write( s_byteOrderMark );
+    writer.Write( (int32_t) m_numMonths );
+    writer.Write( (int32_t) m_firstMonth );
+    writer.Write( (int32_t) nameLength );
+    writer.Write( (int32_t) dataOffset );
+    writer.Write( m_name.data(), nameLength );
+    vector< char > padding( dataOffset - headerSize - nameLength + 1, 0 );
+    writer.Write( &padding[0], dataOffset - headerSize - nameLength );
+    if ( m_numMonths > 0 )
+        writer.Write( reinterpret_cast< const char * >( m_monthStarts ),
+                      m_numMonths * (int) sizeof( int32_t ) );
+}
+
+//=============================================================================
+
+bool
+IslamicMonthTable::Mapped( ) const
+{
+    return bool( m_spReader );
+}
+
+//=============================================================================
+
+int
+IslamicMonthTable::FindMonth( long julianDay ) const
+{
+    if ( (julianDay < FirstJulianDay( )) || (julianDay > LastJulianDay( )) )
+        return -1;
+    const int32_t * pBegin = m_monthStarts;
+    const int32_t * pEnd = pBegin + m_numMonths;
+    return (int)(upper_bound( pBegin, pEnd, (int32_t) julianDay ) - pBegin)
+            - 1;
+}
+
+
+//=============================================================================
+
+
+#ifdef DEBUG
+
+bool
+IslamicMonthTable::Test( const string & testDirectory )
+{
+    bool ok = true;
+    cout << "Testing IslamicMonthTable" << endl;
+
+    const long first = 2451545;     //1 Jan 2000
+    const long last = first + 1100;
+    shared_ptr< IslamicCalendar::LocalMonthFunc > spMonthFunc(
+        new IslamicCalendar::LocalMonthFunc(
+            IslamicCalendar::UmmAlQuraVisibility, Mecca ) );
+    shared_ptr< IslamicMonthTable > spTable( new IslamicMonthTable );
+    spTable->Generate( first, last, spMonthFunc, "Umm al-Qura, Mecca" );
+    const IslamicMonthTable & table = *spTable;
+    TESTCHECK( table.Name( ), string( "Umm al-Qura, Mecca" ), &ok );
+    TESTCHECK( table.Mapped( ), false, &ok );
+    TESTCHECK( (table.FirstJulianDay( ) <= first), true, &ok );
+    TESTCHECK( (table.LastJulianDay( ) >= last), true, &ok );
+    //1 Ramadan 1420 was 9 December 1999, and 1 Shawwal 8 January 2000.
+    int index = table.FindMonth( first );
+    TESTCHECK( table.MonthStart( index ), 2451522L, &ok );
+    TESTCHECK( table.FirstMonth( ) + index, 1419 * 12L + 8, &ok );
+    TESTCHECK( table.FindMonth( 2451551 ), index, &ok );
+    TESTCHECK( table.FindMonth( 2451552 ), index + 1, &ok );
+    TESTCHECK( table.FindMonth( table.FirstJulianDay( ) - 1 ), -1, &ok );
+    TESTCHECK( table.FindMonth( table.LastJulianDay( ) ),
+               table.NumMonths( ) - 2, &ok );
+    TESTCHECK( table.FindMonth( table.LastJulianDay( ) + 1 ), -1, &ok );
+
+    //The table gives the same dates as live computation, and none outside.
+    shared_ptr< IslamicCalendar::AstronomicalSystem > spLiveSystem(
+        new IslamicCalendar::AstronomicalSystem( spMonthFunc ) );
+    shared_ptr< IslamicCalendar::AstronomicalSystem > spTableSystem(
+        new IslamicCalendar::AstronomicalSystem( spMonthFunc ) );
+    spTableSystem->SetMonthTable( spTable );
+    TESTCHECK( spTableSystem->MonthTable( ).get(),
+               (const IslamicMonthTable *) spTable.get(), &ok );
+    shared_ptr< IslamicCalendar::System > spSystem
+            = IslamicCalendar::GetSystem( );
+    int numErrors = 0;
+    for ( long jd = first - 100; jd <= last + 100; ++jd )
+    {
+        int day, month;
+        long year;
+        int liveDay, liveMonth;
+        long liveYear;
+        IslamicCalendar::SetSystem( spTableSystem );
+        IslamicCalendar::JulianDayToDMY( jd, &day, &month, &year );
+        int daysInMonth = IslamicCalendar::DaysInMonth( month, year );
+        bool leap = IslamicCalendar::IsLeapYear( year );
+        IslamicCalendar::SetSystem( spLiveSystem );
+        IslamicCalendar::JulianDayToDMY( jd, &liveDay, &liveMonth,
+                                         &liveYear );
+        if ( (day != liveDay) || (month != liveMonth) || (year != liveYear) )
+            ++numErrors;
+        if ( day == 1 )
+        {
+            if ( daysInMonth
+                 != IslamicCalendar::DaysInMonth( month, year ) )
+                ++numErrors;
+            if ( leap != IslamicCalendar::IsLeapYear( year ) )
+                ++numErrors;
+            IslamicCalendar::SetSystem( spTableSystem );
+            if ( IslamicCalendar::DMYToJulianDay( 1, month, year ) != jd )
+                ++numErrors;
+        }
+    }
+    IslamicCalendar::SetSystem( spSystem );
+    TESTCHECK( numErrors, 0, &ok );
+    spTableSystem->SetMonthFunc( spMonthFunc );
+    TESTCHECK( spTableSystem->MonthTable( ).get(),
+               (const IslamicMonthTable *) 0, &ok );
+
+    string tableFileName = testDirectory + "islamic.tbl";
+    {
+        FileWriter writer( tableFileName );
+        table.Write( writer );
+    }
+    {
+        IslamicMonthTable mappedTable( shared_ptr< Reader >(
+                                new MappedFileReader( tableFileName ) ) );
+        IslamicMonthTable readTable( shared_ptr< Reader >(
+                                new FileReader( tableFileName ) ) );
+        TESTCHECK( mappedTable.Mapped( ), true, &ok );
+        TESTCHECK( readTable.Mapped( ), false, &ok );
+        TESTCHECK( mappedTable.Name( ), table.Name( ), &ok );
+        TESTCHECK( readTable.Name( ), table.Name( ), &ok );
+        TESTCHECK( mappedTable.FirstMonth( ), table.FirstMonth( ), &ok );
+        TESTCHECK( readTable.FirstMonth( ), table.FirstMonth( ), &ok );
+        TESTCHECK( mappedTable.NumMonths( ), table.NumMonths( ), &ok );
+        TESTCHECK( readTable.NumMonths( ), table.NumMonths( ), &ok );
+        numErrors = 0;
+        if ( (mappedTable.NumMonths( ) == table.NumMonths( ))
+             && (readTable.NumMonths( ) == table.NumMonths( )) )
+            for ( int i = 0; i < table.NumMonths( ); ++i )
+                if ( (mappedTable.MonthStart( i ) != table.MonthStart( i ))
+                     || (readTable.MonthStart( i ) != table.MonthStart( i )) )
+                    ++numErrors;
+        TESTCHECK( numErrors, 0, &ok );
+    }
+    remove( tableFileName.c_str() );
+
+    if ( ok )
+        cout << "IslamicMonthTable PASSED." << endl << endl;
+    else
+        cout << "IslamicMonthTable FAILED." << endl << endl;
+    return ok;
+}
+
+#endif //DEBUG
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
@@ -0,0 +1,161 @@
+#ifndef ISLAMICMONTHTABLE_HPP
+#define ISLAMICMONTHTABLE_HPP
+/*
+  IslamicMonthTable.hpp
+  Copyright (C) 2011 David M. Anderson
+
+  IslamicMonthTable class: a precomputed table of the first days of the
+  months of an astronomical Islamic calendar (IslamicCalendar::
+  AstronomicalSystem), for one MonthFunc (visibility criterion and location),
+  which may be saved to a file and memory-mapped.
+  NOTES:
+  1. Generate() finds the first day of each month with the MonthFunc, just
+     as AstronomicalSystem::DMYToJulianDay() does, for the months beginning
+     from before firstJulianDay through after lastJulianDay. Each month
+     start costs several evaluations of the MonthFunc, and, for a
+     LocalMonthFunc, each of those several rise-set searches, so the result
+     is meant to be saved with Write() and loaded thereafter. Generate()
+     throws a RuntimeError unless the registered ephemerides cover the
+     range.
+  2. Name() is the description given to Generate(), which is kept with the
+     table. A table is valid only for the MonthFunc it was generated with,
+     which cannot itself be saved, so the name should identify the
+     visibility criterion and the location, e.g. "Umm al-Qura, Mecca", and
+     the program should check it when it loads the table.
+  3. Months are numbered as elapsed months since the epoch, i.e.,
+     (year - 1) * 12 + month - 1. FirstMonth() is the number of the month
+     that begins on MonthStart( 0 ).
+  4. FindMonth() returns the index of the month containing julianDay, by
+     binary search, or -1 if the table does not cover julianDay. The last
+     month start only marks the end of the previous month, so the table
+     covers FirstJulianDay() through LastJulianDay(), the day before it.
+  5. Write() writes a file with a fixed header, the name, and then the month
+     starts, as 32-bit integers in native byte order, aligned to 64 bytes.
+     If the Reader given to Load() (or the constructor) is a
+     MappedFileReader, the month starts are used in place; otherwise they
+     are read into memory. A file of the other byte order is rejected with a
+     FileException.
+  6. See IslamicCalendar::AstronomicalSystem::SetMonthTable().
+*/
+
+
+#include "IslamicCalendar.hpp"
+#include "Reader.hpp"
+#include "Writer.hpp"
+#include "StdInt.hpp"
+#include <string>
+#include <vector>
+#include <tr1/memory>
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+class IslamicMonthTable
+{
+public:
+    IslamicMonthTable( );
+    explicit IslamicMonthTable( std::tr1::shared_ptr< Reader > spReader );
+
+    void Generate( long firstJulianDay, long lastJulianDay,
+                   std::tr1::shared_ptr< IslamicCalendar::MonthFunc >
+                       spMonthFunc,
+                   const std::string & name );
+    void Load( std::tr1::shared_ptr< Reader > spReader );
+    void Write( Writer & writer ) const;
+
+    const std::string & Name( ) const;
+    long FirstMonth( ) const;
+    int NumMonths( ) const;
+    long MonthStart( int index ) const;
+    long FirstJulianDay( ) const;
+    long LastJulianDay( ) const;
+    bool Mapped( ) const;
+
+    int FindMonth( long julianDay ) const;
+
+    static const int FormatVersion = 1;
+
+#ifdef DEBUG
+    static bool Test( const std::string & testDirectory );
+#endif
+
+private:
+    IslamicMonthTable( const IslamicMonthTable & );
+    IslamicMonthTable & operator=( const IslamicMonthTable & );
+
+    void Clear( );
+
+    std::string m_name;
+    long m_firstMonth;
+    int m_numMonths;
+    const int32_t * m_monthStarts;
+    std::vector< int32_t > m_ownedMonthStarts;
+    std::tr1::shared_ptr< Reader > m_spReader;
+};
+
+
+//*****************************************************************************
+
+
+inline
+const std::string &
+IslamicMonthTable::Name( ) const
+{
+    return m_name;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+long
+IslamicMonthTable::FirstMonth( ) const
+{
+    return m_firstMonth;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+int
+IslamicMonthTable::NumMonths( ) const
+{
+    return m_numMonths;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+long
+IslamicMonthTable::MonthStart( int index ) const
+{
+    return m_monthStarts[ index ];
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+long
+IslamicMonthTable::FirstJulianDay( ) const
+{
+    return (m_numMonths > 0)  ?  m_monthStarts[ 0 ]  :  0;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+long
+IslamicMonthTable::LastJulianDay( ) const
+{
+    return (m_numMonths > 0)  ?  m_monthStarts[ m_numMonths - 1 ] - 1  :  -1;
+}
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
+
+#endif //ISLAMICMONTHTABLE_HPP
@@ -8,6 +8,7 @@
 
 #include "JulianCalendar.hpp"
 #include "Assert.hpp"
+#include "DMYRange.hpp"
 #include "TimeLibText.hpp"
 using namespace std;
 
@@ -59,6 +60,16 @@ JulianCalendar::DMYToJulianDay( int day, int month, long year )
              + day - 1524 );
 }
 
+//-----------------------------------------------------------------------------
+
+void
+JulianCalendar::ConvertRange( long firstJulianDay, int count,
+                              int * pDays, int * pMonths, long * pYears )
+{
+    ConvertDMYRange< JulianCalendar >( firstJulianDay, count,
+                                       pDays, pMonths, pYears );
+}
+
 //=============================================================================
 
 int
@@ -45,6 +45,8 @@ public:
     static void JulianDayToDMY( long julianDay,
                                 int * pDay, int * pMonth, long * pYear );
     static long DMYToJulianDay( int day, int month, long year );
+    static void ConvertRange( long firstJulianDay, int count,
+                              int * pDays, int * pMonths, long * pYears );
     static int MonthsInYear( long year );
     static int DaysInMonth( int month, long year );
     static const std::string & MonthName( int month, long year );
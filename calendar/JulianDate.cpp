@@ -10,6 +10,7 @@
 #ifdef DEBUG
 #include <iostream>
 #include "TestCheck.hpp"
+#include "DMYRange.hpp"
 #include "GregorianDate.hpp"
 #endif
 using namespace std;
@@ -209,6 +210,9 @@ TestJulianDate( )
         TESTCHECK( julDate.Year( ), y, &ok );
     }
 
+    cout << "ConvertRange( 2415021, 40000 )" << endl;
+    TESTCHECK( CheckDMYRange< JulianCalendar >( 2415021, 40000 ), 0, &ok );
+
     if ( ok )
         cout << "JulianDate PASSED." << endl << endl;
     else
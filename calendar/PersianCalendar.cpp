@@ -8,10 +8,12 @@
 
 #include "PersianCalendar.hpp"
 #include "Assert.hpp"
+#include "DMYRange.hpp"
 #include "DivMod.hpp"
 #include "CalendarLibText.hpp"
 #include "TimeIncrement.hpp"
 #include "AstroPhenomena.hpp"
+#include "EventTable.hpp"
 #include "EquationOfTime.hpp"
 #include "TimeStandards.hpp"
 #include "Angle.hpp"
@@ -57,7 +59,17 @@ void
 PersianCalendar::JulianDayToDMY( long julianDay,
                                  int * pDay, int * pMonth, long * pYear )
 {
-    switch ( ms_method )
+    JulianDayToDMY( julianDay, pDay, pMonth, pYear, Context( ms_method ) );
+}
+
+//.............................................................................
+
+void
+PersianCalendar::JulianDayToDMY( long julianDay,
+                                 int * pDay, int * pMonth, long * pYear,
+                                 const Context & context )
+{
+    switch ( context.Method() )
     {
     case Astronomical:
     {
@@ -66,13 +78,17 @@ PersianCalendar::JulianDayToDMY( long julianDay,
         long newYear = PriorSpringEquinox( julianDay ) + 1;
         long year = (long)( floor( ((newYear - s_persianEpoch)
                                              / s_tropicalYear) + 0.5 ) )  +  1;
-        int dayOfYear = (int)(julianDay  -  DMYToJulianDay( 1, 1, year )  +  1);
+        int dayOfYear
+                = (int)(julianDay  -  DMYToJulianDay( 1, 1, year, context )
+                        +  1);
         int month;
         if ( dayOfYear <= 186 )
             month = (int)( ceil( dayOfYear / 31. ) );
         else
             month = (int)( ceil( (dayOfYear - 6) / 30. ) );
-        int day = (int)(julianDay  -  DMYToJulianDay( 1, month, year )  +  1);
+        int day
+                = (int)(julianDay  -  DMYToJulianDay( 1, month, year, context )
+                        +  1);
         if ( pDay )
             *pDay = day;
         if ( pMonth )
@@ -99,9 +115,11 @@ PersianCalendar::JulianDayToDMY( long julianDay,
             y = 1 + a + DivF( (2134 * a + 2816 * b + 2815), 1028522L );
         }
         long year = y + 2820 * n + 474;
-        int dy = (int)(julianDay - DMYToJulianDay( 1, 1, year ) + 1);
+        int dy = (int)(julianDay - DMYToJulianDay( 1, 1, year, context )
+                       + 1);
         int month = (dy <= 186) ? DivC( dy, 31 ) : DivC( (dy - 6), 30 );
-        int day = (int)(julianDay - DMYToJulianDay( 1, month, year ) + 1);
+        int day = (int)(julianDay - DMYToJulianDay( 1, month, year, context )
+                        + 1);
         *pDay = day;
         *pMonth = month;
         *pYear = year;
@@ -118,7 +136,16 @@ PersianCalendar::JulianDayToDMY( long julianDay,
 long
 PersianCalendar::DMYToJulianDay( int day, int month, long year )
 {
-    switch ( ms_method )
+    return DMYToJulianDay( day, month, year, Context( ms_method ) );
+}
+
+//.............................................................................
+
+long
+PersianCalendar::DMYToJulianDay( int day, int month, long year,
+                                 const Context & context )
+{
+    switch ( context.Method() )
     {
     case Astronomical:
     {
@@ -150,15 +177,45 @@ PersianCalendar::DMYToJulianDay( int day, int month, long year )
     }
 }
 
+//-----------------------------------------------------------------------------
+
+void
+PersianCalendar::ConvertRange( long firstJulianDay, int count,
+                               int * pDays, int * pMonths, long * pYears )
+{
+    ConvertDMYRange< PersianCalendar >( firstJulianDay, count,
+                                        pDays, pMonths, pYears );
+}
+
+//.............................................................................
+
+void
+PersianCalendar::ConvertRange( long firstJulianDay, int count,
+                               int * pDays, int * pMonths, long * pYears,
+                               const Context & context )
+{
+    ConvertDMYRangeInContext< PersianCalendar >( firstJulianDay, count,
+                                                 pDays, pMonths, pYears,
+                                                 context );
+}
+
 //=============================================================================
 
 int
 PersianCalendar::DaysInMonth( int month, long year )
+{
+    return DaysInMonth( month, year, Context( ms_method ) );
+}
+
+//.............................................................................
+
+int
+PersianCalendar::DaysInMonth( int month, long year, const Context & context )
 {
     Assert( (month > 0) && (month <= MonthsInYear( year )) );
     static const int daysInMonth[ 12 ]
          = { 31, 31, 31, 31, 31, 31, 30, 30, 30, 30, 30, 29 };
-    if ( (month != 12) || ! IsLeapYear( year ) )
+    if ( (month != 12) || ! IsLeapYear( year, context ) )
         return daysInMonth[ month - 1 ];
     return 30;
 }
@@ -177,12 +234,20 @@ PersianCalendar::MonthName( int month, long /*year*/ )
 bool
 PersianCalendar::IsLeapYear( long year )
 {
-    switch ( ms_method )
+    return IsLeapYear( year, Context( ms_method ) );
+}
+
+//.............................................................................
+
+bool
+PersianCalendar::IsLeapYear( long year, const Context & context )
+{
+    switch ( context.Method() )
     {
     case Astronomical:
     {
-        long daysInYear = DMYToJulianDay( 1, 1, year + 1 )
-                -  DMYToJulianDay( 1, 1, year );
+        long daysInYear = DMYToJulianDay( 1, 1, year + 1, context )
+                -  DMYToJulianDay( 1, 1, year, context );
         return daysInYear > 365;
     }
     case Arithmetic:
@@ -239,6 +304,14 @@ SolarLongitude( long jdi )
 long 
 PriorSpringEquinox( long jdi )
 {
+    const EventTable * pTable = EventTable::Registered( );
+    if ( pTable )
+    {
+        int index = pTable->FindPriorSolarTerm( JDItoJD( jdi ), 0 );
+        if ( index >= 0 )
+            return EventDay( pTable->JulianDay( EventTable::SolarTerm, index ),
+                             JDtoJDI, JDItoJD );
+    }
     const double spring2000 = 2451623.8159722;
     double jd = JDItoJD( jdi );
     double offset = ModRP( (jd - spring2000), s_tropicalYear );
@@ -13,6 +13,10 @@
   For two years around 1976 A.D., the epoch was changed so that 1355 A.H.S.
   became 2535 Sh. (Shahinshah Era) and 1356 A.H.S. became 2536 Sh.
   The day begins at sunset.
+  NOTES:
+  1. SetMethod() chooses the method for the whole program. The functions
+     that take a Context use the method given in it instead, so conversions
+     by different methods may run at the same time in different threads.
 */
 
 
@@ -31,6 +35,8 @@ public:
     static void JulianDayToDMY( long julianDay,
                                 int * pDay, int * pMonth, long * pYear );
     static long DMYToJulianDay( int day, int month, long year );
+    static void ConvertRange( long firstJulianDay, int count,
+                              int * pDays, int * pMonths, long * pYears );
     static int MonthsInYear( long year );
     static int DaysInMonth( int month, long year );
     static const std::string & MonthName( int month, long year = 0 );
@@ -50,6 +56,34 @@ public:
     static void SetMethod( EMethod method );
     static EMethod GetMethod( );
 
+//-----------------------------------------------------------------------------
+
+    class Context
+    {
+    public:
+        explicit Context( EMethod method = GetMethod( ) );
+        void SetMethod( EMethod method );
+        EMethod Method( ) const;
+
+    private:
+        EMethod m_method;
+    };
+
+//-----------------------------------------------------------------------------
+
+    static void JulianDayToDMY( long julianDay,
+                                int * pDay, int * pMonth, long * pYear,
+                                const Context & context );
+    static long DMYToJulianDay( int day, int month, long year,
+                                const Context & context );
+    static void ConvertRange( long firstJulianDay, int count,
+                              int * pDays, int * pMonths, long * pYears,
+                              const Context & context );
+    static int DaysInMonth( int month, long year, const Context & context );
+    static bool IsLeapYear( long year, const Context & context );
+
+//=============================================================================
+
 private:
     static EMethod ms_method;
 };
@@ -84,6 +118,34 @@ PersianCalendar::GetMethod( )
 }
 
 
+//*****************************************************************************
+
+
+inline
+PersianCalendar::Context::Context( EMethod method )
+    :   m_method( method )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+void
+PersianCalendar::Context::SetMethod( EMethod method )
+{
+    m_method = method;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+PersianCalendar::EMethod
+PersianCalendar::Context::Method( ) const
+{
+    return m_method;
+}
+
+
 //*****************************************************************************
 
 }                                                      //namespace EpsilonDelta
@@ -9,6 +9,7 @@
 #include "PersianDate.hpp"
 #ifdef DEBUG
 #include "TestCheck.hpp"
+#include "DMYRange.hpp"
 #include "GregorianDate.hpp"
 #include "Array.hpp"
 #include <iostream>
@@ -283,6 +284,40 @@ TestPersianDate( )
         TESTCHECK( persDate.Year( ), y, &ok );
     }
 
+    cout << "ConvertRange( 2451545, 2000 )" << endl;
+    TESTCHECK( CheckDMYRange< PersianCalendar >( 2451545, 2000 ), 0, &ok );
+
+    cout << "Context( Astronomical ), with SetMethod( Arithmetic )" << endl;
+    PersianCalendar::Context astronomical( PersianCalendar::Astronomical );
+    const int numAstronomical = ARRAY_LENGTH( astronomicalTestDates );
+    for ( int i = 0; i < numAstronomical; ++i )
+    {
+        jd = astronomicalTestDates[i].julianDay;
+        d = astronomicalTestDates[i].day;
+        m = astronomicalTestDates[i].month;
+        y = astronomicalTestDates[i].year;
+        TESTCHECK( PersianCalendar::DMYToJulianDay( d, m, y, astronomical ),
+                   jd, &ok );
+        int day, month;
+        long year;
+        PersianCalendar::JulianDayToDMY( jd, &day, &month, &year,
+                                         astronomical );
+        TESTCHECK( day, d, &ok );
+        TESTCHECK( month, m, &ok );
+        TESTCHECK( year, y, &ok );
+    }
+    TESTCHECK( PersianCalendar::GetMethod( ), PersianCalendar::Arithmetic,
+               &ok );
+    cout << "ConvertRange( 2451545, 2000, context )" << endl;
+    TESTCHECK( CheckDMYRangeInContext< PersianCalendar >( 2451545, 2000,
+                                                          astronomical ),
+               0, &ok );
+    PersianCalendar::Context arithmetic;
+    TESTCHECK( arithmetic.Method( ), PersianCalendar::Arithmetic, &ok );
+    TESTCHECK( CheckDMYRangeInContext< PersianCalendar >( 2451545, 2000,
+                                                          arithmetic ),
+               0, &ok );
+
     if ( ok )
         cout << "PersianDate PASSED." << endl << endl;
     else
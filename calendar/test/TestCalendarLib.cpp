@@ -13,6 +13,7 @@
 #include "ISO8601Date.hpp"
 #include "PersianDate.hpp"
 #include "IslamicDate.hpp"
+#include "IslamicMonthTable.hpp"
 #include "LunarVisibility.hpp"
 #include "HebrewDate.hpp"
 #include "CopticDate.hpp"
@@ -105,6 +106,8 @@ int Main( int /*argc*/, char ** argv )
         ok = false;
     if ( ! TestIslamicDate( ) )
         ok = false;
+    if ( ! IslamicMonthTable::Test( libBasePath + "calendar/test/" ) )
+        ok = false;
     if ( ! TestHebrewDate( ) )
         ok = false;
     if ( ! TestCopticDate( ) )
@@ -0,0 +1,227 @@
+/*
+  MappedFileReader.cpp
+  Copyright (C) 2011 David M. Anderson
+
+  MappedFileReader class representing a file mapped read-only into memory.
+*/
+
+
+#include "MappedFileReader.hpp"
+#include "FileException.hpp"
+#include <cstring>
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#elif defined(OS_WINDOWS)
+#include <windows.h>
+#endif
+#ifdef DEBUG
+#include "TestCheck.hpp"
+#include "FileWriter.hpp"
+#include "DirUtil.hpp"
+#include <iostream>
+#endif
+using namespace std;
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+MappedFileReader::MappedFileReader( const std::string & fileName )
+    :   m_fileName( fileName ),
+        m_data( 0 ),
+        m_size( 0 ),
+        m_curPos( 0 )
+{
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+    int fd = open( fileName.c_str(), O_RDONLY );
+    if ( fd < 0 )
+    {
+        File::Log()( Logger::Error, "Unable to open %s for mapping",
+                     m_fileName.c_str() );
+        throw FileOpenException( m_fileName, File::ReadMode );
+    }
+    struct stat statBuf;
+    if ( fstat( fd, &statBuf ) != 0 )
+    {
+        close( fd );
+        throw FileStatusException( m_fileName );
+    }
+    m_size = (int) statBuf.st_size;
+    if ( m_size > 0 )
+    {
+        void * addr = mmap( 0, (size_t) m_size, PROT_READ, MAP_SHARED, fd, 0 );
+        if ( addr == MAP_FAILED )
+        {
+            close( fd );
+            File::Log()( Logger::Error, "Unable to map %s",
+                         m_fileName.c_str() );
+            throw FileOpenException( m_fileName, File::ReadMode );
+        }
+        m_data = static_cast< const char * >( addr );
+    }
+    //The mapping remains valid after the descriptor is closed.
+    close( fd );
+#elif defined(OS_WINDOWS)
+    m_fileHandle = 0;
+    m_mappingHandle = 0;
+    HANDLE file = CreateFileA( fileName.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                               0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0 );
+    if ( file == INVALID_HANDLE_VALUE )
+    {
+        File::Log()( Logger::Error, "Unable to open %s for mapping",
+                     m_fileName.c_str() );
+        throw FileOpenException( m_fileName, File::ReadMode );
+    }
+    m_fileHandle = file;
+    m_size = (int) GetFileSize( file, 0 );
+    if ( m_size > 0 )
+    {
+        HANDLE mapping = CreateFileMappingA( file, 0, PAGE_READONLY, 0, 0, 0 );
+        if ( mapping == 0 )
+        {
+            CloseHandle( file );
+            throw FileOpenException( m_fileName, File::ReadMode );
+        }
+        m_mappingHandle = mapping;
+        m_data = static_cast< const char * >(
+            MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ) );
+        if ( m_data == 0 )
+        {
+            CloseHandle( mapping );
+            CloseHandle( file );
+            throw FileOpenException( m_fileName, File::ReadMode );
+        }
+    }
+#endif
+    File::Log()( Logger::Info, "Mapped %s (%d bytes)",
+                 m_fileName.c_str(), m_size );
+}
+
+//-----------------------------------------------------------------------------
+
+MappedFileReader::~MappedFileReader( )
+{
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+    if ( m_data != 0 )
+        munmap( const_cast< char * >( m_data ), (size_t) m_size );
+#elif defined(OS_WINDOWS)
+    if ( m_data != 0 )
+        UnmapViewOfFile( m_data );
+    if ( m_mappingHandle != 0 )
+        CloseHandle( m_mappingHandle );
+    if ( m_fileHandle != 0 )
+        CloseHandle( m_fileHandle );
+#endif
+    File::Log()( Logger::Info, "Unmapped %s", m_fileName.c_str() );
+}
+
+//=============================================================================
+
+int
+MappedFileReader::Seek( int offset, Origin origin )
+{
+    const int bases[] = { 0, m_curPos, m_size };
+    int loc = bases[ origin ] + offset;
+    if ( (loc < 0) || (loc > m_size) )
+        throw FileSeekException( m_fileName, offset, origin );
+    m_curPos = loc;
+    return m_curPos;
+}
+
+//=============================================================================
+
+void
+MappedFileReader::Read( char * buffer, int bufferSize )
+{
+    if ( (bufferSize < 0) || (m_curPos + bufferSize > m_size) )
+        throw FileReadException( m_fileName, bufferSize );
+    memcpy( buffer, m_data + m_curPos, bufferSize );
+    m_curPos += bufferSize;
+}
+
+//=============================================================================
+
+#ifdef DEBUG
+
+bool
+MappedFileReader::Test( )
+{
+    bool ok = true;
+    cout << "Testing MappedFileReader" << endl;
+
+    try
+    {
+        const string fileName = "TestFile.dat";
+        {
+            FileWriter writer( fileName );
+            for ( int i = 0; i < 20; ++i )
+                writer.Write( i );
+        }
+        {
+            cout << "MappedFileReader constructor" << endl;
+            MappedFileReader reader( fileName );
+            TESTCHECK( reader.Size( ), (int) (20 * sizeof( int )), &ok );
+            const int * data = reinterpret_cast< const int * >( reader.Data() );
+            TESTCHECK( data[0], 0, &ok );
+            TESTCHECK( data[19], 19, &ok );
+            int ii;
+            cout << "Read( int *)" << endl;
+            reader.Read( &ii );
+            TESTCHECK( ii, 0, &ok );
+            cout << "Seek( ..., Current )" << endl;
+            reader.Seek( 2 * (int) sizeof( int ), RandomAccess::Current );
+            cout << "Read( int *)" << endl;
+            reader.Read( &ii );
+            TESTCHECK( ii, 3, &ok );
+            cout << "Seek( ..., End )" << endl;
+            reader.Seek( -1 * (int) sizeof( int ), RandomAccess::End );
+            cout << "Read( int *)" << endl;
+            reader.Read( &ii );
+            TESTCHECK( ii, 19, &ok );
+            try
+            {
+                cout << "Read( int *)" << endl;
+                reader.Read( &ii );
+                cout << "Read should have thrown an exception." << endl;
+                ok = false;
+            }
+            catch ( FileReadException & except )
+            {
+                cout << "Exception here is OK" << endl;
+                cout << except.Description() << endl;
+            }
+            DataBuffer buff;
+            cout << "Load( DataBuffer * )" << endl;
+            reader.Load( &buff );
+            TESTCHECK( buff.Buffer().size(), 20 * sizeof( int ), &ok );
+            TESTCHECK( memcmp( &(buff.Buffer()[0]), reader.Data(),
+                               20 * sizeof( int ) ), 0, &ok );
+        }
+        DeleteFile( fileName );
+    }
+    catch ( FileException & except )
+    {
+        cout << except.Description() << endl;
+        ok = false;
+    }
+
+    if ( ok )
+        cout << "MappedFileReader PASSED." << endl << endl;
+    else
+        cout << "MappedFileReader FAILED." << endl << endl;
+    return ok;
+}
+
+#endif
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
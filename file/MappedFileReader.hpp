@@ -0,0 +1,100 @@
+#ifndef MAPPEDFILEREADER_HPP
+#define MAPPEDFILEREADER_HPP
+/*
+  MappedFileReader.hpp
+  Copyright (C) 2011 David M. Anderson
+
+  MappedFileReader class representing a file mapped read-only into memory.
+  NOTES:
+  1. The whole file is mapped when the object is constructed, and unmapped
+     when it is destroyed. Data() gives direct access to the mapped bytes,
+     which remain valid for the lifetime of the object. This allows users
+     such as JPLEphemeris to use the file contents in place, without any
+     system call or copy.
+  2. Read() and Seek() are also supported, so a MappedFileReader may be used
+     wherever a Reader is expected. They simply copy from the mapping.
+  3. The mapping is read-only. Users that need to modify the data (e.g. to
+     fix its endianness) should copy it first.
+*/
+
+
+#include "Reader.hpp"
+#include "Platform.hpp"
+#include "Logger.hpp"
+#include <string>
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+class MappedFileReader
+    :   public Reader
+{
+public:
+    explicit MappedFileReader( const std::string & fileName );
+    virtual ~MappedFileReader( );
+
+    virtual int Seek( int offset, Origin origin = Beginning );
+    using Reader::Read;
+    virtual void Read( char * buffer, int bufferSize );
+
+    const char * Data( ) const;
+    int Size( ) const;
+    const std::string & FileName( ) const;
+
+#ifdef DEBUG
+    static bool Test( );
+#endif
+
+private:
+    MappedFileReader( const MappedFileReader & );
+    MappedFileReader & operator=( const MappedFileReader & );
+
+    std::string     m_fileName;
+    const char *    m_data;
+    int             m_size;
+    int             m_curPos;
+#if defined(OS_WINDOWS)
+    void *          m_fileHandle;
+    void *          m_mappingHandle;
+#endif
+};
+
+
+//*****************************************************************************
+
+
+inline
+const char *
+MappedFileReader::Data( ) const
+{
+    return m_data;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+int
+MappedFileReader::Size( ) const
+{
+    return m_size;
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+const std::string &
+MappedFileReader::FileName( ) const
+{
+    return m_fileName;
+}
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
+
+#endif //MAPPEDFILEREADER_HPP
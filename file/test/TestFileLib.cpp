@@ -11,6 +11,7 @@
 #include "DataBuffer.hpp"
 #include "File.hpp"
 #include "NestedReader.hpp"
+#include "MappedFileReader.hpp"
 #include "FileName.hpp"
 #include "DirUtil.hpp"
 #include "ConfigFile.hpp"
@@ -62,6 +63,8 @@ int Main( int /*argc*/, char ** /*argv*/ )
         ok = false;
     if ( ! NestedReader::Test( ) )
         ok = false;
+    if ( ! MappedFileReader::Test( ) )
+        ok = false;
     if ( ! FileName::Test( ) )
         ok = false;
     if ( ! TestDirUtil( ) )
@@ -0,0 +1,355 @@
+#ifndef DMYRANGE_HPP
+#define DMYRANGE_HPP
+/*
+  DMYRange.hpp
+  Copyright (C) 2011 David M. Anderson
+
+  ConvertDMYRange, ConvertDMYRangeByMonthLength, and ConvertDMYRangeInContext
+  function templates: convert a range of consecutive Julian days to
+  (day, month, year) in a calendar, for the ConvertRange() functions of the
+  calendar classes.
+  NOTES:
+  1. Cal should provide JulianDayToDMY(), MonthsInYear(), and DaysInMonth(),
+     as for DMYDate (see Note 1 in DMYDate.hpp).
+  2. Only the first day is converted with JulianDayToDMY(). After that, the
+     day is incremented, and DaysInMonth() and MonthsInYear() are called only
+     at the end of each month, so the cost per day is a few instructions, and
+     for the astronomical calendars, the expensive computations are done once
+     per month instead of once per day.
+  3. The months of a year are numbered consecutively from firstMonth through
+     MonthsInYear(), and then from 1 to firstMonth - 1. So firstMonth is 1
+     for most calendars, but 7 (Tishri) for the Hebrew calendar.
+  4. For calendars in which DaysInMonth() costs more than JulianDayToDMY(),
+     as when it converts the first days of two months to Julian days by
+     searching, ConvertDMYRangeByMonthLength() may be used instead. Given
+     the length of the shortest month, it increments the day until it
+     reaches that length, and then calls JulianDayToDMY() for each day until
+     the next month begins. The results are those of JulianDayToDMY().
+  5. pDays, pMonths, and pYears must each have room for count elements.
+  6. ConvertDMYRangeInContext() is the same as ConvertDMYRange(), but for
+     calendars whose settings are given as a Context object (as
+     PersianCalendar::Context and IslamicCalendar::Context), which is passed
+     as the last argument to each of the functions in Note 1.
+  7. Both are implemented by ConvertDMYRangeWith(), which calls the
+     functions of Note 1 through the member functions of its first argument,
+     a StaticDMYFuncs or a ContextDMYFuncs, so that the day, month, and year
+     are advanced by the same code for both.
+*/
+
+
+#include "Assert.hpp"
+#ifdef DEBUG
+#include <vector>
+#endif
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+//The functions of Note 1, called as static members of Cal.
+template < typename Cal >
+class StaticDMYFuncs
+{
+public:
+    void JulianDayToDMY( long julianDay,
+                         int * pDay, int * pMonth, long * pYear ) const;
+    int DaysInMonth( int month, long year ) const;
+    int MonthsInYear( long year ) const;
+    void ConvertRange( long firstJulianDay, int count,
+                       int * pDays, int * pMonths, long * pYears ) const;
+};
+
+//.............................................................................
+
+//The functions of Note 1, called with a Context (see Note 6).
+template < typename Cal, typename Context >
+class ContextDMYFuncs
+{
+public:
+    explicit ContextDMYFuncs( const Context & context );
+
+    void JulianDayToDMY( long julianDay,
+                         int * pDay, int * pMonth, long * pYear ) const;
+    int DaysInMonth( int month, long year ) const;
+    int MonthsInYear( long year ) const;
+    void ConvertRange( long firstJulianDay, int count,
+                       int * pDays, int * pMonths, long * pYears ) const;
+
+private:
+    const Context & m_context;
+};
+
+//.............................................................................
+
+template < typename DMYFuncs >
+void ConvertDMYRangeWith( const DMYFuncs & funcs,
+                          long firstJulianDay, int count,
+                          int * pDays, int * pMonths, long * pYears,
+                          int firstMonth = 1 );
+template < typename Cal >
+void ConvertDMYRange( long firstJulianDay, int count,
+                      int * pDays, int * pMonths, long * pYears,
+                      int firstMonth = 1 );
+template < typename Cal >
+void ConvertDMYRangeByMonthLength( long firstJulianDay, int count,
+                                   int * pDays, int * pMonths, long * pYears,
+                                   int minDaysInMonth );
+template < typename Cal, typename Context >
+void ConvertDMYRangeInContext( long firstJulianDay, int count,
+                               int * pDays, int * pMonths, long * pYears,
+                               const Context & context );
+
+#ifdef DEBUG
+template < typename DMYFuncs >
+int CheckDMYRangeWith( const DMYFuncs & funcs,
+                       long firstJulianDay, int count );
+template < typename Cal >
+int CheckDMYRange( long firstJulianDay, int count );
+template < typename Cal, typename Context >
+int CheckDMYRangeInContext( long firstJulianDay, int count,
+                            const Context & context );
+#endif
+
+
+//*****************************************************************************
+
+
+template < typename Cal >
+inline
+void
+StaticDMYFuncs< Cal >::JulianDayToDMY( long julianDay,
+                                       int * pDay, int * pMonth,
+                                       long * pYear ) const
+{
+    Cal::JulianDayToDMY( julianDay, pDay, pMonth, pYear );
+}
+
+//.............................................................................
+
+template < typename Cal >
+inline
+int
+StaticDMYFuncs< Cal >::DaysInMonth( int month, long year ) const
+{
+    return Cal::DaysInMonth( month, year );
+}
+
+//.............................................................................
+
+template < typename Cal >
+inline
+int
+StaticDMYFuncs< Cal >::MonthsInYear( long year ) const
+{
+    return Cal::MonthsInYear( year );
+}
+
+//.............................................................................
+
+template < typename Cal >
+inline
+void
+StaticDMYFuncs< Cal >::ConvertRange( long firstJulianDay, int count,
+                                     int * pDays, int * pMonths,
+                                     long * pYears ) const
+{
+    Cal::ConvertRange( firstJulianDay, count, pDays, pMonths, pYears );
+}
+
+//=============================================================================
+
+template < typename Cal, typename Context >
+inline
+ContextDMYFuncs< Cal, Context >::ContextDMYFuncs( const Context & context )
+    :   m_context( context )
+{
+}
+
+//.............................................................................
+
+template < typename Cal, typename Context >
+inline
+void
+ContextDMYFuncs< Cal, Context >::JulianDayToDMY( long julianDay,
+                                                 int * pDay, int * pMonth,
+                                                 long * pYear ) const
+{
+    Cal::JulianDayToDMY( julianDay, pDay, pMonth, pYear, m_context );
+}
+
+//.............................................................................
+
+template < typename Cal, typename Context >
+inline
+int
+ContextDMYFuncs< Cal, Context >::DaysInMonth( int month, long year ) const
+{
+    return Cal::DaysInMonth( month, year, m_context );
+}
+
+//.............................................................................
+
+template < typename Cal, typename Context >
+inline
+int
+ContextDMYFuncs< Cal, Context >::MonthsInYear( long year ) const
+{
+    return Cal::MonthsInYear( year );
+}
+
+//.............................................................................
+
+template < typename Cal, typename Context >
+inline
+void
+ContextDMYFuncs< Cal, Context >::ConvertRange( long firstJulianDay,
+                                               int count, int * pDays,
+                                               int * pMonths,
+                                               long * pYears ) const
+{
+    Cal::ConvertRange( firstJulianDay, count, pDays, pMonths, pYears,
+                       m_context );
+}
+
+//=============================================================================
+
+template < typename DMYFuncs >
+void
+ConvertDMYRangeWith( const DMYFuncs & funcs,
+                     long firstJulianDay, int count,
+                     int * pDays, int * pMonths, long * pYears,
+                     int firstMonth )
+{
+    Assert( pDays && pMonths && pYears );
+    if ( count <= 0 )
+        return;
+    int day, month;
+    long year;
+    funcs.JulianDayToDMY( firstJulianDay, &day, &month, &year );
+    int daysInMonth = funcs.DaysInMonth( month, year );
+    for ( int i = 0; i < count; ++i )
+    {
+        if ( day > daysInMonth )
+        {
+            day = 1;
+            if ( ++month > funcs.MonthsInYear( year ) )
+                month = 1;
+            if ( month == firstMonth )
+                ++year;
+            daysInMonth = funcs.DaysInMonth( month, year );
+        }
+        pDays[i] = day;
+        pMonths[i] = month;
+        pYears[i] = year;
+        ++day;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+template < typename Cal >
+void
+ConvertDMYRange( long firstJulianDay, int count,
+                 int * pDays, int * pMonths, long * pYears, int firstMonth )
+{
+    ConvertDMYRangeWith( StaticDMYFuncs< Cal >( ), firstJulianDay, count,
+                         pDays, pMonths, pYears, firstMonth );
+}
+
+//-----------------------------------------------------------------------------
+
+template < typename Cal >
+void
+ConvertDMYRangeByMonthLength( long firstJulianDay, int count,
+                              int * pDays, int * pMonths, long * pYears,
+                              int minDaysInMonth )
+{
+    Assert( pDays && pMonths && pYears );
+    Assert( minDaysInMonth > 0 );
+    int day = minDaysInMonth;
+    int month = 0;
+    long year = 0;
+    for ( int i = 0; i < count; ++i )
+    {
+        if ( day < minDaysInMonth )
+            ++day;
+        else
+            Cal::JulianDayToDMY( firstJulianDay + i, &day, &month, &year );
+        pDays[i] = day;
+        pMonths[i] = month;
+        pYears[i] = year;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+template < typename Cal, typename Context >
+void
+ConvertDMYRangeInContext( long firstJulianDay, int count,
+                          int * pDays, int * pMonths, long * pYears,
+                          const Context & context )
+{
+    ConvertDMYRangeWith( ContextDMYFuncs< Cal, Context >( context ),
+                         firstJulianDay, count, pDays, pMonths, pYears );
+}
+
+//=============================================================================
+
+#ifdef DEBUG
+
+//Returns the number of days for which Cal::ConvertRange() and
+// Cal::JulianDayToDMY() disagree.
+
+template < typename DMYFuncs >
+int
+CheckDMYRangeWith( const DMYFuncs & funcs, long firstJulianDay, int count )
+{
+    std::vector< int > days( count );
+    std::vector< int > months( count );
+    std::vector< long > years( count );
+    funcs.ConvertRange( firstJulianDay, count, &days[0], &months[0],
+                        &years[0] );
+    int numErrors = 0;
+    for ( int i = 0; i < count; ++i )
+    {
+        int day, month;
+        long year;
+        funcs.JulianDayToDMY( firstJulianDay + i, &day, &month, &year );
+        if ( (day != days[i]) || (month != months[i]) || (year != years[i]) )
+            ++numErrors;
+    }
+    return numErrors;
+}
+
+//-----------------------------------------------------------------------------
+
+template < typename Cal >
+int
+CheckDMYRange( long firstJulianDay, int count )
+{
+    return CheckDMYRangeWith( StaticDMYFuncs< Cal >( ), firstJulianDay,
+                              count );
+}
+
+//-----------------------------------------------------------------------------
+
+template < typename Cal, typename Context >
+int
+CheckDMYRangeInContext( long firstJulianDay, int count,
+                        const Context & context )
+{
+    return CheckDMYRangeWith( ContextDMYFuncs< Cal, Context >( context ),
+                              firstJulianDay, count );
+}
+
+#endif //DEBUG
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
+
+#endif //DMYRANGE_HPP
@@ -9,6 +9,7 @@
 #include "GregorianCalendar.hpp"
 #include "TimeLibText.hpp"
 #include "Assert.hpp"
+#include "DMYRange.hpp"
 #include <ctime>
 using namespace std;
 
@@ -64,6 +65,16 @@ GregorianCalendar::DMYToJulianDay( int day, int month, long year )
              + day + b - 1524 );
 }
 
+//-----------------------------------------------------------------------------
+
+void
+GregorianCalendar::ConvertRange( long firstJulianDay, int count,
+                                 int * pDays, int * pMonths, long * pYears )
+{
+    ConvertDMYRange< GregorianCalendar >( firstJulianDay, count,
+                                          pDays, pMonths, pYears );
+}
+
 //=============================================================================
 
 int
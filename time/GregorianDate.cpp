@@ -9,6 +9,7 @@
 #include "GregorianDate.hpp"
 #ifdef DEBUG
 #include "TestCheck.hpp"
+#include "DMYRange.hpp"
 #include "Date.hpp"
 #include <iostream>
 #endif
@@ -256,6 +257,9 @@ TestGregorianDate( )
         TESTCHECK( gregDate.Year( ), y, &ok );
     }
 
+    cout << "ConvertRange( 2415021, 40000 )" << endl;
+    TESTCHECK( CheckDMYRange< GregorianCalendar >( 2415021, 40000 ), 0, &ok );
+
     if ( ok )
         cout << "GregorianDate PASSED." << endl << endl;
     else
@@ -15,6 +15,8 @@
 #ifdef DEBUG
 #include "TestCheck.hpp"
 #include <cstdio>
+#include <iostream>
+#include <vector>
 #endif
 using namespace std;
 
@@ -25,15 +27,30 @@ namespace EpsilonDelta
 //*****************************************************************************
 
 
-TimeIncrement 
-TDB_TT( double julianDay )
+namespace
+{
+//.............................................................................
+
+inline
+double
+TDB_TTSeconds( double julianDay )
 {
     //Explanatory Supplement (2.222-1). This is approximate, but "sufficient 
     // in most cases".
     Angle g( (357.53  +  0.9856003 * (julianDay - 2451545.0)),
              Angle::Degree );
-    double s = 0.001658 * Sin( g )  +  0.000014 * Sin( 2. * g );
-    return TimeIncrement( 0, 0, s );
+    return 0.001658 * Sin( g )  +  0.000014 * Sin( 2. * g );
+}
+
+//.............................................................................
+} //namespace
+
+//.............................................................................
+
+TimeIncrement 
+TDB_TT( double julianDay )
+{
+    return TimeIncrement( 0, 0, TDB_TTSeconds( julianDay ) );
 }
 
 //-----------------------------------------------------------------------------
@@ -60,8 +77,12 @@ TCB_TDB( double julianDay )
 
 //-----------------------------------------------------------------------------
 
-TimeIncrement 
-TT_UT1( double julianDay )
+namespace
+{
+//.............................................................................
+
+double
+TT_UT1Seconds( double julianDay )
 {
     double s = 0.;
     if ( (julianDay < 1578982.0)        //before 390 B.C.
@@ -108,7 +129,27 @@ TT_UT1( double julianDay )
         double t = Century2000( julianDay );
         s = 2715.6  +  t * (573.36  +  t * 46.5);
     }
-    return TimeIncrement( 0, 0, s );
+    return s;
+}
+
+//.............................................................................
+} //namespace
+
+//.............................................................................
+
+TimeIncrement 
+TT_UT1( double julianDay )
+{
+    return TimeIncrement( 0, 0, TT_UT1Seconds( julianDay ) );
+}
+
+//-----------------------------------------------------------------------------
+
+void
+TT_UT1( const double * julianDays, int count, TimeIncrement * pIncrements )
+{
+    for ( int i = 0; i < count; ++i )
+        pIncrements[i].Set( 0, 0, TT_UT1Seconds( julianDays[i] ) );
 }
 
 //-----------------------------------------------------------------------------
@@ -156,12 +197,20 @@ const int s_kNumLeapSeconds
 const double s_kLeapSecondsValidUntil = 2455742.5;
 
 //.............................................................................
-} //namespace
+
+//TAI - UTC, in seconds, for each day from the first leap second to the last,
+// built from s_kLeapSeconds during static initialization. The leap seconds
+// fall on day boundaries, so indexing by whole days from the first gives the
+// same result as scanning the table. The table is zero-initialized, so until
+// it is built (or if the leap seconds outgrow it) the table is scanned.
+const int s_kLeapSecondTableSize = 16384;
+signed char s_leapSecondTable[ s_kLeapSecondTableSize ];
+int s_leapSecondTableDays = 0;
 
 //.............................................................................
 
-TimeIncrement 
-TAI_UTC( double julianDay )
+double
+ScanLeapSeconds( double julianDay )
 {
     double s = 10.;
     for ( int i = 0; i < s_kNumLeapSeconds; ++i )
@@ -169,7 +218,91 @@ TAI_UTC( double julianDay )
             s += s_kLeapSeconds[i].step;
         else
             break;
-    return TimeIncrement( 0, 0, s );
+    return s;
+}
+
+//.............................................................................
+
+int
+BuildLeapSecondTable( )
+{
+    double firstDay = s_kLeapSeconds[0].julianDay;
+    double lastDay = s_kLeapSeconds[ s_kNumLeapSeconds - 1 ].julianDay;
+    int numDays = (int)(lastDay - firstDay) + 1;
+    Assert( numDays <= s_kLeapSecondTableSize );
+    if ( numDays > s_kLeapSecondTableSize )
+        return 0;
+    for ( int d = 0; d < numDays; ++d )
+    {
+        double s = ScanLeapSeconds( firstDay + d );
+        Assert( (s == floor( s )) && (s > -128.) && (s < 128.) );
+        s_leapSecondTable[ d ] = (signed char) s;
+    }
+    return numDays;
+}
+
+//.............................................................................
+
+struct LeapSecondTableBuilder
+{
+    LeapSecondTableBuilder( )
+    {
+        s_leapSecondTableDays = BuildLeapSecondTable( );
+    }
+};
+
+LeapSecondTableBuilder s_leapSecondTableBuilder;
+
+//.............................................................................
+
+inline
+double
+TAI_UTCSeconds( double julianDay )
+{
+    double firstDay = s_kLeapSeconds[0].julianDay;
+    if ( ! (julianDay >= firstDay) )
+        return 10.;
+    if ( s_leapSecondTableDays == 0 )
+        return ScanLeapSeconds( julianDay );
+    double day = julianDay - firstDay;
+    int index = (day < s_leapSecondTableDays)
+            ?  (int) day  :  s_leapSecondTableDays - 1;
+    return s_leapSecondTable[ index ];
+}
+
+//.............................................................................
+
+inline
+double
+TDB_UTSeconds( double julianDay )
+{
+    //Added in the same order as TDB_TT() + TT_UTC() or TT_UT1(), so that
+    // the results are identical.
+    if ( (julianDay < 2441317.5) || (julianDay > s_kLeapSecondsValidUntil) )
+        return TDB_TTSeconds( julianDay )  +  TT_UT1Seconds( julianDay );
+    else
+        return TDB_TTSeconds( julianDay )
+                +  (TT_TAI().Seconds()  +  TAI_UTCSeconds( julianDay ));
+}
+
+//.............................................................................
+} //namespace
+
+//.............................................................................
+
+TimeIncrement 
+TAI_UTC( double julianDay )
+{
+    return TimeIncrement( 0, 0, TAI_UTCSeconds( julianDay ) );
+}
+
+//-----------------------------------------------------------------------------
+
+void
+TAI_UTC( const double * julianDays, int count, TimeIncrement * pIncrements )
+{
+    for ( int i = 0; i < count; ++i )
+        pIncrements[i].Set( 0, 0, TAI_UTCSeconds( julianDays[i] ) );
 }
 
 //-----------------------------------------------------------------------------
@@ -192,13 +325,121 @@ TDB_UTC( double julianDay )
 
 TimeIncrement 
 TDB_UT( double julianDay )
+{
+    return TimeIncrement( 0, 0, TDB_UTSeconds( julianDay ) );
+}
+
+//-----------------------------------------------------------------------------
+
+void
+TDB_UT( const double * julianDays, int count, TimeIncrement * pIncrements )
+{
+    for ( int i = 0; i < count; ++i )
+        pIncrements[i].Set( 0, 0, TDB_UTSeconds( julianDays[i] ) );
+}
+
+//=============================================================================
+
+#ifdef DEBUG
+
+namespace
+{
+//.............................................................................
+
+//The straightforward forms of TAI_UTC() and TDB_UT(), to check the tables.
+
+double
+ReferenceTDB_UT( double julianDay )
 {
     if ( (julianDay < 2441317.5) || (julianDay > s_kLeapSecondsValidUntil) )
-        return TDB_TT( julianDay ) + TT_UT1( julianDay );
+        return (TDB_TT( julianDay ) + TT_UT1( julianDay )).Seconds();
+    else
+        return (TDB_TT( julianDay )
+                + (TT_TAI( )
+                   + TimeIncrement( 0, 0, ScanLeapSeconds( julianDay ) )))
+                .Seconds();
+}
+
+//.............................................................................
+} //namespace
+
+//.............................................................................
+
+bool
+TestTimeStandards( )
+{
+    bool ok = true;
+    cout << "Testing TimeStandards" << endl;
+
+    TESTCHECK( TAI_UTC( 2441317.5 ).Seconds(), 10., &ok );
+    TESTCHECK( TAI_UTC( 2441498.4 ).Seconds(), 10., &ok );
+    TESTCHECK( TAI_UTC( 2441498.5 ).Seconds(), 11., &ok );
+    TESTCHECK( TAI_UTC( 2451545. ).Seconds(), 32., &ok );
+    TESTCHECK( TAI_UTC( 2454831.49 ).Seconds(), 33., &ok );
+    TESTCHECK( TAI_UTC( 2454831.5 ).Seconds(), 34., &ok );
+    TESTCHECK( TAI_UTC( 2455500. ).Seconds(), 34., &ok );
+    TESTCHECK( TT_UTC( 2451545. ).Seconds(), 64.184, &ok );
+    TESTCHECKFE( TT_UT1( 2451545. ).Seconds(), 102.3, &ok, 1.e-12 );
+
+    //The table and the batch overloads should agree exactly with the
+    // straightforward forms.
+    int numDays = 0;
+    int numTT_UT1Diffs = 0;
+    int numTAI_UTCDiffs = 0;
+    int numTDB_UTDiffs = 0;
+    vector< double > days;
+    for ( double jd = 1000000.25; jd < 2600000.; jd += 37.3 )
+        days.push_back( jd );
+    for ( double jd = 2441300.; jd < 2455800.; jd += 0.25 )
+        days.push_back( jd );
+    const double boundaries[]
+            = { 1578982.0, 2067310.0, 2312753.0, 2341973.0, 2378495.0,
+                2415020.0, 2441317.5, 2447162.0, s_kLeapSecondsValidUntil };
+    for ( int i = 0; i < (int)( sizeof( boundaries ) / sizeof( double ) );
+          ++i )
+    {
+        days.push_back( boundaries[i] - 1.e-6 );
+        days.push_back( boundaries[i] );
+        days.push_back( boundaries[i] + 1.e-6 );
+    }
+    for ( int i = 0; i < s_kNumLeapSeconds; ++i )
+    {
+        days.push_back( s_kLeapSeconds[i].julianDay - 1.e-6 );
+        days.push_back( s_kLeapSeconds[i].julianDay );
+    }
+    numDays = (int) days.size( );
+    vector< TimeIncrement > tt_ut1( numDays );
+    vector< TimeIncrement > tai_utc( numDays );
+    vector< TimeIncrement > tdb_ut( numDays );
+    TT_UT1( &days[0], numDays, &tt_ut1[0] );
+    TAI_UTC( &days[0], numDays, &tai_utc[0] );
+    TDB_UT( &days[0], numDays, &tdb_ut[0] );
+    for ( int i = 0; i < numDays; ++i )
+    {
+        double jd = days[i];
+        if ( tt_ut1[i].Seconds() != TT_UT1( jd ).Seconds() )
+            ++numTT_UT1Diffs;
+        if ( (TAI_UTC( jd ).Seconds() != ScanLeapSeconds( jd ))
+             || (tai_utc[i].Seconds() != ScanLeapSeconds( jd )) )
+            ++numTAI_UTCDiffs;
+        if ( (TDB_UT( jd ).Seconds() != ReferenceTDB_UT( jd ))
+             || (tdb_ut[i].Seconds() != ReferenceTDB_UT( jd )) )
+            ++numTDB_UTDiffs;
+    }
+    cout << numDays << " days compared" << endl;
+    TESTCHECK( numTT_UT1Diffs, 0, &ok );
+    TESTCHECK( numTAI_UTCDiffs, 0, &ok );
+    TESTCHECK( numTDB_UTDiffs, 0, &ok );
+
+    if ( ok )
+        cout << "TimeStandards PASSED." << endl << endl;
     else
-        return TDB_UTC( julianDay );
+        cout << "TimeStandards FAILED." << endl << endl;
+    return ok;
 }
 
+#endif //DEBUG
+
 
 //*****************************************************************************
 
@@ -80,6 +80,10 @@
      microseconds). The occasional exception concerns UTC at the moments when
      leap second are introduced; in this instance, UTC is the appropriate
      time system for the argument.
+  7. TAI_UTC() looks up a table indexed by day, built from the leap-second
+     table when the program starts. The overloads taking arrays of Julian
+     days fill arrays of TimeIncrements; the results are identical to those
+     of the single-day functions.
 */
 
 
@@ -103,6 +107,17 @@ TimeIncrement TDB_UTC( double julianDay );
 TimeIncrement TDB_UT( double julianDay );
 TimeIncrement TAI_GPST( );
 
+void TT_UT1( const double * julianDays, int count,
+             TimeIncrement * pIncrements );
+void TAI_UTC( const double * julianDays, int count,
+              TimeIncrement * pIncrements );
+void TDB_UT( const double * julianDays, int count,
+             TimeIncrement * pIncrements );
+
+#ifdef DEBUG
+bool TestTimeStandards( );
+#endif
+
 
 //*****************************************************************************
 
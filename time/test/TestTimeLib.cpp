@@ -15,6 +15,7 @@
 #include "Time.hpp"
 #include "ModifiedJulianDay.hpp"
 #include "Epoch.hpp"
+#include "TimeStandards.hpp"
 #include "JDDate.hpp"
 #include "GregorianDate.hpp"
 #include "DateTime.hpp"
@@ -70,6 +71,8 @@ int Main( int /*argc*/, char ** /*argv*/ )
         ok = false;
     if ( ! Epoch::Test( ) )
         ok = false;
+    if ( ! TestTimeStandards( ) )
+        ok = false;
     if ( ! JDDate::Test( ) )
         ok = false;
     if ( ! TestGregorianDate( ) )
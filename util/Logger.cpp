@@ -322,8 +322,12 @@ Logger::Test( )
                        "[One] Warning: This could be bad\n" ),
                &ok );
 
+    TESTCHECK( log2.IsEnabled( Logger::Warning ), true, &ok );
+    TESTCHECK( log2.IsEnabled( Logger::Info ), false, &ok );
     cout << "log2.SetVerbosity( Info )" << endl;
     log2.SetVerbosity( Logger::Info );
+    TESTCHECK( log2.IsEnabled( Logger::Info ), true, &ok );
+    TESTCHECK( log2.IsEnabled( Logger::Debug ), false, &ok );
     lss.str( "" );
     Talk( );
     TESTCHECK( lss.str(),
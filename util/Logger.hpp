@@ -24,6 +24,9 @@
      Warning, and std::cout for higher levels.
   8. SetDestination() sets the destination for all levels if level < 0.
   9. On Android, the default is to pass through to the native log facility.
+  10. A message passed as a std::string is assembled before Log() can reject
+     it. On frequently-executed paths, test IsEnabled( level ) first, so that
+     the cost of a disabled message is just this inline comparison.
 */
 
 
@@ -65,6 +68,7 @@ public:
 
     void SetVerbosity( int maxLevel );
     int GetVerbosity( ) const;
+    bool IsEnabled( int level ) const;
 
     void SetOutputFunc( std::tr1::shared_ptr< OutputFunc > func
                         = std::tr1::shared_ptr< OutputFunc >() );
@@ -102,6 +106,17 @@ private:
 extern Logger g_generalLogger;
 
 
+//*****************************************************************************
+
+
+inline
+bool 
+Logger::IsEnabled( int level ) const
+{
+    return (level <= m_verbosity);
+}
+
+
 //*****************************************************************************
 
 }                                                      //namespace EpsilonDelta
@@ -0,0 +1,69 @@
+/*
+  Mutex.cpp
+  Copyright (C) 2011 David M. Anderson
+
+  Mutex class: a simple mutual-exclusion lock, wrapped for platform
+  independence.
+*/
+
+
+#include "Mutex.hpp"
+#include "Exception.hpp"
+using namespace std;
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+Mutex::Mutex( )
+{
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+    if ( pthread_mutex_init( &m_mutex, 0 ) != 0 )
+        throw RuntimeError( "Unable to create mutex." );
+#elif defined(OS_WINDOWS)
+    InitializeCriticalSection( &m_criticalSection );
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+Mutex::~Mutex( )
+{
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+    pthread_mutex_destroy( &m_mutex );
+#elif defined(OS_WINDOWS)
+    DeleteCriticalSection( &m_criticalSection );
+#endif
+}
+
+//=============================================================================
+
+void
+Mutex::Lock( )
+{
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+    pthread_mutex_lock( &m_mutex );
+#elif defined(OS_WINDOWS)
+    EnterCriticalSection( &m_criticalSection );
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void
+Mutex::Unlock( )
+{
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+    pthread_mutex_unlock( &m_mutex );
+#elif defined(OS_WINDOWS)
+    LeaveCriticalSection( &m_criticalSection );
+#endif
+}
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
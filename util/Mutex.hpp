@@ -0,0 +1,92 @@
+#ifndef MUTEX_HPP
+#define MUTEX_HPP
+/*
+  Mutex.hpp
+  Copyright (C) 2011 David M. Anderson
+
+  Mutex class: a simple mutual-exclusion lock, wrapped for platform
+  independence.
+  MutexLock class: locks a Mutex for the duration of a scope.
+  NOTES:
+  1. The Mutex is not recursive: a thread must not Lock() a Mutex it already
+     holds.
+  2. Copying a Mutex is not meaningful, so it is disallowed.
+*/
+
+
+#include "Platform.hpp"
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+#include <pthread.h>
+#elif defined(OS_WINDOWS)
+#include <windows.h>
+#endif
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+class Mutex
+{
+public:
+    Mutex( );
+    ~Mutex( );
+
+    void Lock( );
+    void Unlock( );
+
+private:
+    Mutex( const Mutex & );
+    Mutex & operator=( const Mutex & );
+
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+    pthread_mutex_t     m_mutex;
+#elif defined(OS_WINDOWS)
+    CRITICAL_SECTION    m_criticalSection;
+#endif
+};
+
+
+//*****************************************************************************
+
+
+class MutexLock
+{
+public:
+    explicit MutexLock( Mutex & mutex );
+    ~MutexLock( );
+
+private:
+    MutexLock( const MutexLock & );
+    MutexLock & operator=( const MutexLock & );
+
+    Mutex & m_mutex;
+};
+
+
+//*****************************************************************************
+
+
+inline
+MutexLock::MutexLock( Mutex & mutex )
+    :   m_mutex( mutex )
+{
+    m_mutex.Lock( );
+}
+
+//-----------------------------------------------------------------------------
+
+inline
+MutexLock::~MutexLock( )
+{
+    m_mutex.Unlock( );
+}
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
+
+#endif //MUTEX_HPP
@@ -0,0 +1,70 @@
+/*
+  PublishedPtr.cpp
+  Copyright (C) 2011 David M. Anderson
+
+  PublishedPtr template class: a pointer to an immutable object, published by
+  writers and read by any number of threads without locking.
+*/
+
+
+#include "PublishedPtr.hpp"
+#ifdef DEBUG
+#include "TestCheck.hpp"
+#include <string>
+#include <iostream>
+using namespace std;
+using namespace std::tr1;
+#endif
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+#ifdef DEBUG
+
+bool
+TestPublishedPtr( )
+{
+    bool ok = true;
+    cout << "Testing PublishedPtr" << endl;
+
+    PublishedPtr< string > published;
+    TESTCHECK( published.Get( ) == 0, true, &ok );
+    TESTCHECK( (bool) published.GetShared( ), false, &ok );
+    shared_ptr< string > spFirst( new string( "first" ) );
+    cout << "Publish( first )" << endl;
+    published.Publish( spFirst );
+    TESTCHECK( published.Get( ) == spFirst.get(), true, &ok );
+    TESTCHECK( published.GetShared( ) == spFirst, true, &ok );
+    const string * pFirst = published.Get( );
+    cout << "Publish( second ) and release first" << endl;
+    published.Publish( shared_ptr< string >( new string( "second" ) ) );
+    spFirst.reset( );
+    TESTCHECK( *published.Get( ), string( "second" ), &ok );
+    TESTCHECK( *pFirst, string( "first" ), &ok );
+    cout << "Publish( 0 )" << endl;
+    shared_ptr< string > spSecond = published.GetShared( );
+    published.Publish( shared_ptr< string >( ) );
+    TESTCHECK( published.Get( ) == 0, true, &ok );
+    TESTCHECK( (bool) published.GetShared( ), false, &ok );
+    cout << "Publish( second ) again" << endl;
+    published.Publish( spSecond );
+    TESTCHECK( *published.Get( ), string( "second" ), &ok );
+    TESTCHECK( (int) spSecond.use_count( ), 3, &ok );
+
+    if ( ok )
+        cout << "PublishedPtr PASSED." << endl << endl;
+    else
+        cout << "PublishedPtr FAILED." << endl << endl;
+    return ok;
+}
+
+#endif
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
@@ -0,0 +1,127 @@
+#ifndef PUBLISHEDPTR_HPP
+#define PUBLISHEDPTR_HPP
+/*
+  PublishedPtr.hpp
+  Copyright (C) 2011 David M. Anderson
+
+  PublishedPtr template class: a pointer to an immutable object, published by
+  writers and read by any number of threads without locking.
+  NOTES:
+  1. Get() returns the object most recently published, or 0, without locking
+     (an acquire load), so it is cheap enough for hot paths. Publish() stores
+     the new object with release semantics, so a reader that sees the pointer
+     also sees the object fully constructed. Publishing a null pointer
+     clears it. GetShared() returns the same object as a shared_ptr, under
+     the mutex, e.g. so that it may be published again later.
+  2. A reader may go on using an object after another has been published, so
+     a published object is never freed while the PublishedPtr exists: each
+     distinct object published is retained. Republishing an object already
+     retained (e.g. restoring an earlier one) adds nothing, but every new
+     object adds to the memory held, so PublishedPtr is meant for occasional
+     updates, such as registrations at startup, not for frequent ones.
+  3. Publish() is serialized internally. A writer that derives the new object
+     from the current one must hold a lock of its own across Get() and
+     Publish(), or two concurrent updates could each lose the other's.
+  4. T should not be modified once published, though it may be non-const so
+     that GetShared() can return the pointer given to Publish().
+*/
+
+
+#include "Platform.hpp"
+#include "Mutex.hpp"
+#include <vector>
+#include <algorithm>
+#include <tr1/memory>
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+template < typename T >
+class PublishedPtr
+{
+public:
+    PublishedPtr( );
+
+    const T * Get( ) const;
+    std::tr1::shared_ptr< T > GetShared( ) const;
+    void Publish( std::tr1::shared_ptr< T > spObject );
+
+private:
+    PublishedPtr( const PublishedPtr & );
+    PublishedPtr & operator=( const PublishedPtr & );
+
+    const T * volatile m_pCurrent;
+    std::tr1::shared_ptr< T > m_spCurrent;
+    std::vector< std::tr1::shared_ptr< T > > m_retained;
+    mutable Mutex m_mutex;
+};
+
+//.............................................................................
+
+#ifdef DEBUG
+bool TestPublishedPtr( );
+#endif
+
+
+//#############################################################################
+
+
+template < typename T >
+PublishedPtr< T >::PublishedPtr( )
+    :   m_pCurrent( 0 )
+{
+}
+
+//=============================================================================
+
+template < typename T >
+inline
+const T *
+PublishedPtr< T >::Get( ) const
+{
+#if defined(COMPILER_GNU)
+    return __atomic_load_n( &m_pCurrent, __ATOMIC_ACQUIRE );
+#else
+    return m_pCurrent;      //MSC: volatile reads have acquire semantics
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+template < typename T >
+std::tr1::shared_ptr< T >
+PublishedPtr< T >::GetShared( ) const
+{
+    MutexLock lock( m_mutex );
+    return m_spCurrent;
+}
+
+//-----------------------------------------------------------------------------
+
+template < typename T >
+void
+PublishedPtr< T >::Publish( std::tr1::shared_ptr< T > spObject )
+{
+    MutexLock lock( m_mutex );
+    if ( spObject
+         && (std::find( m_retained.begin(), m_retained.end(), spObject )
+             == m_retained.end()) )
+        m_retained.push_back( spObject );
+    m_spCurrent = spObject;
+#if defined(COMPILER_GNU)
+    __atomic_store_n( &m_pCurrent, spObject.get(), __ATOMIC_RELEASE );
+#else
+    m_pCurrent = spObject.get();  //MSC: volatile writes have release semantics
+#endif
+}
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
+
+#endif //PUBLISHEDPTR_HPP
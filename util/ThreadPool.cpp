@@ -0,0 +1,493 @@
+/*
+  ThreadPool.cpp
+  Copyright (C) 2011 David M. Anderson
+
+  ThreadPool class: a fixed set of worker threads that carry out the
+  iterations of a loop in parallel.
+*/
+
+
+#include "ThreadPool.hpp"
+#include "Exception.hpp"
+#include "StdInt.hpp"
+#include "Assert.hpp"
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+#include <unistd.h>
+#endif
+#ifdef DEBUG
+#include "TestCheck.hpp"
+#include <iostream>
+#endif
+using namespace std;
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+ThreadPool::Task::~Task( )
+{
+}
+
+
+//*****************************************************************************
+
+
+ThreadPool::ThreadPool( int numThreads )
+    :   m_numThreads( (numThreads > 0)  ?  numThreads  :  NumProcessors() ),
+        m_pTask( 0 ),
+        m_ranges( m_numThreads ),
+        m_workerArgs( m_numThreads ),
+        m_generation( 0 ),
+        m_busyWorkers( 0 ),
+        m_shutdown( false ),
+        m_failed( false )
+{
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+    if ( pthread_mutex_init( &m_mutex, 0 ) != 0 )
+        throw RuntimeError( "Unable to create thread pool synchronization." );
+    if ( pthread_cond_init( &m_workCondition, 0 ) != 0 )
+    {
+        pthread_mutex_destroy( &m_mutex );
+        throw RuntimeError( "Unable to create thread pool synchronization." );
+    }
+    if ( pthread_cond_init( &m_doneCondition, 0 ) != 0 )
+    {
+        pthread_cond_destroy( &m_workCondition );
+        pthread_mutex_destroy( &m_mutex );
+        throw RuntimeError( "Unable to create thread pool synchronization." );
+    }
+#elif defined(OS_WINDOWS)
+    InitializeCriticalSection( &m_criticalSection );
+    InitializeConditionVariable( &m_workCondition );
+    InitializeConditionVariable( &m_doneCondition );
+#endif
+    //If a thread cannot be created, those already running must be stopped
+    // before throwing, since the destructor will not be called.
+    try
+    {
+        m_threads.reserve( m_numThreads - 1 );
+    }
+    catch ( ... )
+    {
+        Shutdown( );
+        throw;
+    }
+    for ( int t = 1; t < m_numThreads; ++t )
+    {
+        m_workerArgs[ t ].m_pPool = this;
+        m_workerArgs[ t ].m_thread = t;
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+        pthread_t thread;
+        if ( pthread_create( &thread, 0, ThreadMain, &m_workerArgs[ t ] )
+             != 0 )
+        {
+            Shutdown( );
+            throw RuntimeError( "Unable to create thread." );
+        }
+        m_threads.push_back( thread );
+#elif defined(OS_WINDOWS)
+        HANDLE thread = CreateThread( 0, 0, ThreadMain, &m_workerArgs[ t ],
+                                      0, 0 );
+        if ( thread == 0 )
+        {
+            Shutdown( );
+            throw RuntimeError( "Unable to create thread." );
+        }
+        m_threads.push_back( thread );
+#endif
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+ThreadPool::~ThreadPool( )
+{
+    Shutdown( );
+}
+
+//-----------------------------------------------------------------------------
+
+void
+ThreadPool::Shutdown( )
+{
+    Lock( );
+    m_shutdown = true;
+    SignalWork( );
+    Unlock( );
+    for ( int i = 0; i < (int)m_threads.size(); ++i )
+    {
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+        pthread_join( m_threads[ i ], 0 );
+#elif defined(OS_WINDOWS)
+        WaitForSingleObject( m_threads[ i ], INFINITE );
+        CloseHandle( m_threads[ i ] );
+#endif
+    }
+    m_threads.clear( );
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+    pthread_cond_destroy( &m_doneCondition );
+    pthread_cond_destroy( &m_workCondition );
+    pthread_mutex_destroy( &m_mutex );
+#elif defined(OS_WINDOWS)
+    DeleteCriticalSection( &m_criticalSection );
+#endif
+}
+
+//=============================================================================
+
+void
+ThreadPool::Run( Task & task, int count )
+{
+    MutexLock runLock( m_runMutex );
+    if ( count <= 0 )
+        return;
+    if ( (m_numThreads == 1) || (count == 1) )
+    {
+        for ( int i = 0; i < count; ++i )
+            task( i );
+        return;
+    }
+
+    Lock( );
+    for ( int t = 0; t < m_numThreads; ++t )
+    {
+        m_ranges[ t ].m_begin = (int)( (int64_t) count * t / m_numThreads );
+        m_ranges[ t ].m_end
+                = (int)( (int64_t) count * (t + 1) / m_numThreads );
+    }
+    m_pTask = &task;
+    m_failed = false;
+    m_failure.clear( );
+    m_busyWorkers = m_numThreads - 1;
+    ++m_generation;
+    SignalWork( );
+    Unlock( );
+
+    Work( 0 );
+
+    Lock( );
+    while ( m_busyWorkers > 0 )
+        WaitForWorkers( );
+    m_pTask = 0;
+    bool failed = m_failed;
+    string failure = m_failure;
+    Unlock( );
+    if ( failed )
+        throw RuntimeError( failure );
+}
+
+//=============================================================================
+
+void
+ThreadPool::WorkerLoop( int thread )
+{
+    int generation = 0;
+    Lock( );
+    while ( true )
+    {
+        while ( (! m_shutdown) && (m_generation == generation) )
+            WaitForWork( );
+        if ( m_shutdown )
+            break;
+        generation = m_generation;
+        Unlock( );
+        Work( thread );
+        Lock( );
+        if ( --m_busyWorkers == 0 )
+            SignalDone( );
+    }
+    Unlock( );
+}
+
+//-----------------------------------------------------------------------------
+
+void
+ThreadPool::Work( int thread )
+{
+    while ( true )
+    {
+        int index;
+        Lock( );
+        bool more = NextIndex( thread, &index );
+        Unlock( );
+        if ( ! more )
+            return;
+        string failure;
+        try
+        {
+            (*m_pTask)( index );
+            continue;
+        }
+        catch ( Exception & except )
+        {
+            failure = except.Description( );
+        }
+        catch ( std::exception & except )
+        {
+            failure = except.what( );
+        }
+        catch ( ... )
+        {
+            failure = "Unknown exception!";
+        }
+        Lock( );
+        if ( ! m_failed )
+        {
+            m_failed = true;
+            m_failure = failure;
+        }
+        Unlock( );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//Called with the lock held.
+
+bool
+ThreadPool::NextIndex( int thread, int * pIndex )
+{
+    if ( m_failed )
+        return false;
+    Range & range = m_ranges[ thread ];
+    if ( range.m_begin >= range.m_end )
+    {
+        int victim = -1;
+        int mostLeft = 0;
+        for ( int t = 0; t < m_numThreads; ++t )
+        {
+            int left = m_ranges[ t ].m_end - m_ranges[ t ].m_begin;
+            if ( left > mostLeft )
+            {
+                victim = t;
+                mostLeft = left;
+            }
+        }
+        if ( victim < 0 )
+            return false;
+        Range & victimRange = m_ranges[ victim ];
+        range.m_end = victimRange.m_end;
+        range.m_begin = victimRange.m_end - (mostLeft + 1) / 2;
+        victimRange.m_end = range.m_begin;
+    }
+    *pIndex = range.m_begin++;
+    return true;
+}
+
+//=============================================================================
+
+int
+ThreadPool::NumProcessors( )
+{
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+    long numProcs = sysconf( _SC_NPROCESSORS_ONLN );
+    return (numProcs > 0)  ?  (int) numProcs  :  1;
+#elif defined(OS_WINDOWS)
+    SYSTEM_INFO sysInfo;
+    GetSystemInfo( &sysInfo );
+    return (sysInfo.dwNumberOfProcessors > 0)
+            ?  (int) sysInfo.dwNumberOfProcessors  :  1;
+#else
+    return 1;
+#endif
+}
+
+//=============================================================================
+
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+
+void *
+ThreadPool::ThreadMain( void * arg )
+{
+    WorkerArg * pArg = static_cast< WorkerArg * >( arg );
+    pArg->m_pPool->WorkerLoop( pArg->m_thread );
+    return 0;
+}
+
+#elif defined(OS_WINDOWS)
+
+DWORD WINAPI
+ThreadPool::ThreadMain( LPVOID arg )
+{
+    WorkerArg * pArg = static_cast< WorkerArg * >( arg );
+    pArg->m_pPool->WorkerLoop( pArg->m_thread );
+    return 0;
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+void
+ThreadPool::Lock( )
+{
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+    pthread_mutex_lock( &m_mutex );
+#elif defined(OS_WINDOWS)
+    EnterCriticalSection( &m_criticalSection );
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void
+ThreadPool::Unlock( )
+{
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+    pthread_mutex_unlock( &m_mutex );
+#elif defined(OS_WINDOWS)
+    LeaveCriticalSection( &m_criticalSection );
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void
+ThreadPool::WaitForWork( )
+{
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+    pthread_cond_wait( &m_workCondition, &m_mutex );
+#elif defined(OS_WINDOWS)
+    SleepConditionVariableCS( &m_workCondition, &m_criticalSection, INFINITE );
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void
+ThreadPool::WaitForWorkers( )
+{
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+    pthread_cond_wait( &m_doneCondition, &m_mutex );
+#elif defined(OS_WINDOWS)
+    SleepConditionVariableCS( &m_doneCondition, &m_criticalSection, INFINITE );
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void
+ThreadPool::SignalWork( )
+{
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+    pthread_cond_broadcast( &m_workCondition );
+#elif defined(OS_WINDOWS)
+    WakeAllConditionVariable( &m_workCondition );
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void
+ThreadPool::SignalDone( )
+{
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+    pthread_cond_signal( &m_doneCondition );
+#elif defined(OS_WINDOWS)
+    WakeConditionVariable( &m_doneCondition );
+#endif
+}
+
+
+//=============================================================================
+
+
+#ifdef DEBUG
+
+namespace
+{                                                                   //namespace
+
+class SquareTask
+    :   public ThreadPool::Task
+{
+public:
+    SquareTask( vector< int > & results )
+        :   m_results( results )
+    {
+    }
+
+    virtual void operator()( int index )
+    {
+        //Uneven work, to exercise the stealing.
+        volatile int sum = 0;
+        for ( int i = 0; i < (index % 7) * 1000; ++i )
+            sum += i % 3;
+        m_results[ index ] = index * index;
+    }
+
+private:
+    SquareTask & operator=( const SquareTask & );
+
+    vector< int > & m_results;
+};
+
+//.............................................................................
+
+class FailingTask
+    :   public ThreadPool::Task
+{
+public:
+    virtual void operator()( int index )
+    {
+        if ( index == 37 )
+            throw RuntimeError( "Task 37 failed." );
+    }
+};
+
+}                                                                   //namespace
+
+//-----------------------------------------------------------------------------
+
+bool
+ThreadPool::Test( )
+{
+    bool ok = true;
+    cout << "Testing ThreadPool" << endl;
+
+    TESTCHECK( (NumProcessors( ) >= 1), true, &ok );
+    for ( int numThreads = 1; numThreads <= 4; ++numThreads )
+    {
+        ThreadPool pool( numThreads );
+        TESTCHECK( pool.NumThreads( ), numThreads, &ok );
+        for ( int run = 0; run < 3; ++run )
+        {
+            int count = 1000 + run * 17;
+            vector< int > results( count, -1 );
+            SquareTask task( results );
+            pool.Run( task, count );
+            int bad = 0;
+            for ( int i = 0; i < count; ++i )
+                if ( results[ i ] != i * i )
+                    ++bad;
+            TESTCHECK( bad, 0, &ok );
+        }
+        FailingTask failingTask;
+        string failure;
+        try
+        {
+            pool.Run( failingTask, 100 );
+        }
+        catch ( RuntimeError & except )
+        {
+            failure = except.Description( );
+        }
+        TESTCHECK( (failure.find( "Task 37 failed." ) != string::npos),
+                   true, &ok );
+    }
+
+    if ( ok )
+        cout << "ThreadPool PASSED." << endl << endl;
+    else
+        cout << "ThreadPool FAILED." << endl << endl;
+    return ok;
+}
+
+#endif //DEBUG
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
@@ -0,0 +1,144 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+/*
+  ThreadPool.hpp
+  Copyright (C) 2011 David M. Anderson
+
+  ThreadPool class: a fixed set of worker threads that carry out the
+  iterations of a loop in parallel.
+  NOTES:
+  1. Run( task, count ) calls task( i ) for each i from 0 to count-1, and
+     returns when all of the calls have finished. The calling thread takes
+     part in the work, so a pool of n threads starts only n-1 workers.
+  2. The indices are divided into contiguous ranges, one per thread. A
+     thread works through its own range from the bottom; when that is empty,
+     it steals the upper half of the largest remaining range. So the load is
+     balanced even when the iterations take very different times, while each
+     thread mostly works on neighboring indices.
+  3. The Task's operator() must be safe to call concurrently for different
+     indices.
+  4. If an iteration throws an exception, no further iterations are started,
+     and, when the running ones have finished, Run() throws a RuntimeError
+     with the description of the first exception.
+  5. The constructor's argument is the total number of threads; if it is 0,
+     NumProcessors() is used. With one thread (or one iteration), Run()
+     simply loops in the calling thread, and exceptions pass through as they
+     are.
+  6. Calls to Run() on the same pool from different threads are serialized.
+     Run() must not be called from within a task running on the same pool.
+*/
+
+
+#include "Mutex.hpp"
+#include "Platform.hpp"
+#include <vector>
+#include <string>
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+#include <pthread.h>
+#elif defined(OS_WINDOWS)
+#include <windows.h>
+#endif
+
+
+namespace EpsilonDelta
+{                                                      //namespace EpsilonDelta
+
+//*****************************************************************************
+
+
+class ThreadPool
+{
+public:
+    class Task
+    {
+    public:
+        virtual ~Task( );
+        virtual void operator()( int index ) = 0;
+    };
+
+    explicit ThreadPool( int numThreads = 0 );
+    ~ThreadPool( );
+
+    int NumThreads( ) const;
+    void Run( Task & task, int count );
+
+    static int NumProcessors( );
+
+#ifdef DEBUG
+    static bool Test( );
+#endif
+
+private:
+    ThreadPool( const ThreadPool & );
+    ThreadPool & operator=( const ThreadPool & );
+
+    struct Range
+    {
+        int m_begin;
+        int m_end;
+    };
+
+    struct WorkerArg
+    {
+        ThreadPool * m_pPool;
+        int m_thread;
+    };
+
+    void Shutdown( );
+    void WorkerLoop( int thread );
+    void Work( int thread );
+    bool NextIndex( int thread, int * pIndex );
+    void Lock( );
+    void Unlock( );
+    void WaitForWork( );
+    void WaitForWorkers( );
+    void SignalWork( );
+    void SignalDone( );
+
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+    static void * ThreadMain( void * arg );
+#elif defined(OS_WINDOWS)
+    static DWORD WINAPI ThreadMain( LPVOID arg );
+#endif
+
+    int m_numThreads;
+    Mutex m_runMutex;
+    Task * m_pTask;
+    std::vector< Range > m_ranges;
+    std::vector< WorkerArg > m_workerArgs;
+    int m_generation;
+    int m_busyWorkers;
+    bool m_shutdown;
+    bool m_failed;
+    std::string m_failure;
+
+#if defined(OS_UNIX) || defined(OS_ANDROID)
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_workCondition;
+    pthread_cond_t m_doneCondition;
+    std::vector< pthread_t > m_threads;
+#elif defined(OS_WINDOWS)
+    CRITICAL_SECTION m_criticalSection;
+    CONDITION_VARIABLE m_workCondition;
+    CONDITION_VARIABLE m_doneCondition;
+    std::vector< HANDLE > m_threads;
+#endif
+};
+
+
+//*****************************************************************************
+
+
+inline
+int
+ThreadPool::NumThreads( ) const
+{
+    return m_numThreads;
+}
+
+
+//*****************************************************************************
+
+}                                                      //namespace EpsilonDelta
+
+#endif //THREADPOOL_HPP
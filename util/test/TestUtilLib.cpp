@@ -9,6 +9,8 @@
 #include "Exception.hpp"
 #include "TestCheck.hpp"
 #include "Logger.hpp"
+#include "ThreadPool.hpp"
+#include "PublishedPtr.hpp"
 #include "FixEndian.hpp"
 #include "CharType.hpp"
 #include "StringUtil.hpp"
@@ -88,6 +90,10 @@ int Main( int /*argc*/, char ** argv )
 
     if ( ! Logger::Test( ) )
         ok = false;
+    if ( ! ThreadPool::Test( ) )
+        ok = false;
+    if ( ! TestPublishedPtr( ) )
+        ok = false;
     if ( ! TestFixEndian( ) )
         ok = false;
     if ( ! TestCharType( ) )